@@ -6,18 +6,25 @@
 #include <QDir>
 #include <QFileDialog>
 #include <QStandardPaths>
+#include <QProgressDialog>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
 
 #include <QUaCommonDialog>
-#include <QUaLogWidget>
 
 const QString QUaModbus::m_strAppName   = QObject::tr("QUaModbusClient");
 const QString QUaModbus::m_strUntitiled = QObject::tr("Untitled");
 const QString QUaModbus::m_strDefault   = QObject::tr("Default");
+const QString QUaModbus::m_strValueCacheSuffix = ".values";
+#ifdef UA_ENABLE_HISTORIZING
+const QString QUaModbus::m_strHistoryStoreSuffix = ".history";
+#endif // UA_ENABLE_HISTORIZING
 
 const QString QUaModbus::m_strModbusTree    = QObject::tr("Modbus Tree");
 const QString QUaModbus::m_strModbusClients = QObject::tr("Modbus Client Edit");
 const QString QUaModbus::m_strModbusBlocks  = QObject::tr("Modbus DataBlock Edit");
 const QString QUaModbus::m_strModbusValues  = QObject::tr("Modbus Value Edit");
+const QString QUaModbus::m_strModbusLog     = QObject::tr("Modbus Log");
 
 QUaModbus::QUaModbus(QWidget *parent)
     : QMainWindow(parent)
@@ -101,44 +108,40 @@ void QUaModbus::on_openConfig()
 		{
 			return;
 		}
-		// try load config
-		auto errorLogs = this->setXmlConfig(byteContents);
-		if (!errorLogs.isEmpty())
+		// dock state is restored once the clients are imported in the background
+		QByteArray byteDockState;
+		QXmlStreamReader xml(byteContents);
+		if (xml.readNextStartElement() && 
+			xml.name() == QLatin1String(QUaModbus::staticMetaObject.className()) &&
+			xml.attributes().hasAttribute("DockState"))
 		{
-			// setup log widget
-			auto logWidget = new QUaLogWidget;
-			logWidget->setFilterVisible(false);
-			logWidget->setSettingsVisible(false);
-			logWidget->setClearVisible(false);
-			logWidget->setColumnVisible(QUaLogWidget::Columns::Timestamp, false);
-			logWidget->setColumnVisible(QUaLogWidget::Columns::Category, false);
-			logWidget->setLevelColor(QUaLogLevel::Error, QBrush(QColor("#8E2F1C")));
-			logWidget->setLevelColor(QUaLogLevel::Warning, QBrush(QColor("#766B0F")));
-			logWidget->setLevelColor(QUaLogLevel::Info, QBrush(QColor("#265EB6")));
-			bool hasError = false;
-			while (errorLogs.count() > 0)
-			{
-				auto errorLog = errorLogs.dequeue();
-				hasError = hasError || errorLog.level == QUaLogLevel::Error ? true : false;
-				logWidget->addLog(errorLog);
-			}
-			// NOTE : dialog takes ownershit
-			QUaCommonDialog dialog(this);
-			dialog.setWindowTitle(tr("Config Issues"));
-			dialog.setWidget(logWidget);
-			dialog.clearButtons();
-			dialog.addButton(tr("Close"), QDialogButtonBox::ButtonRole::AcceptRole);
-			dialog.exec();
-			if (hasError)
-			{
-				this->on_closeConfig(true);
-				return;
-			}
+			byteDockState = QByteArray::fromHex(xml.attributes().value("DockState").toUtf8());
+		}
+		// NOTE : progress dialog owns the connections, so they only live for this import
+		auto mod      = this->modbusClientList();
+		auto progress = new QProgressDialog(tr("Loading %1").arg(QFileInfo(strConfigFileName).fileName()), tr("Cancel"), 0, 100, this);
+		progress->setWindowTitle(tr("Open Config"));
+		progress->setWindowModality(Qt::WindowModal);
+		progress->setMinimumDuration(500);
+		progress->setAutoClose(false);
+		progress->setAutoReset(false);
+		QObject::connect(progress, &QProgressDialog::canceled, mod, &QUaModbusClientList::cancelImport);
+		QObject::connect(mod, &QUaModbusClientList::importProgressChanged, progress,
+		[progress](const quint32 &nodesDone, const quint32 &nodesTotal) {
+			progress->setValue(nodesTotal > 0 ? static_cast<int>(100.0 * nodesDone / nodesTotal) : 100);
+		});
+		QObject::connect(mod, &QUaModbusClientList::importFinished, progress,
+		[this, progress, strConfigFileName, byteDockState](const QQueue<QUaLog> &importLogs, const bool &cancelled) {
+			progress->deleteLater();
+			this->on_configImported(strConfigFileName, byteDockState, importLogs, cancelled);
+		});
+		if (!mod->startXmlImport(byteContents))
+		{
+			// NOTE : also disconnects the import signals
+			delete progress;
+			msgBox.setText(tr("File %1 could not be loaded, another config is being imported.").arg(strConfigFileName));
+			msgBox.exec();
 		}
-		// update file name
-		m_strConfigFile = strConfigFileName;
-		// update title
-		this->setWindowTitle(m_strTitle.arg(strConfigFileName).arg(QUaModbus::m_strAppName));
 	}
 	else
 	{
@@ -147,6 +150,66 @@ void QUaModbus::on_openConfig()
 	}
 }
 
+void QUaModbus::on_configImported(const QString &strConfigFileName, const QByteArray &byteDockState, const QQueue<QUaLog> &importLogs, const bool &cancelled)
+{
+	auto errorLogs = importLogs;
+	if (!errorLogs.isEmpty())
+	{
+		// setup log widget
+		auto logWidget = new QUaLogWidget;
+		logWidget->setFilterVisible(false);
+		logWidget->setSettingsVisible(false);
+		logWidget->setClearVisible(false);
+		logWidget->setColumnVisible(QUaLogWidget::Columns::Timestamp, false);
+		logWidget->setColumnVisible(QUaLogWidget::Columns::Category, false);
+		logWidget->setLevelColor(QUaLogLevel::Error, QBrush(QColor("#8E2F1C")));
+		logWidget->setLevelColor(QUaLogLevel::Warning, QBrush(QColor("#766B0F")));
+		logWidget->setLevelColor(QUaLogLevel::Info, QBrush(QColor("#265EB6")));
+		bool hasError = false;
+		while (errorLogs.count() > 0)
+		{
+			auto errorLog = errorLogs.dequeue();
+			hasError = hasError || errorLog.level == QUaLogLevel::Error ? true : false;
+			logWidget->addLog(errorLog);
+		}
+		// NOTE : dialog takes ownershit
+		QUaCommonDialog dialog(this);
+		dialog.setWindowTitle(tr("Config Issues"));
+		dialog.setWidget(logWidget);
+		dialog.clearButtons();
+		dialog.addButton(tr("Close"), QDialogButtonBox::ButtonRole::AcceptRole);
+		dialog.exec();
+		if (hasError)
+		{
+			this->on_closeConfig(true);
+			return;
+		}
+	}
+	// partial config is not kept
+	if (cancelled)
+	{
+		this->on_closeConfig(true);
+		return;
+	}
+	// layout of the imported config
+	if (!byteDockState.isEmpty())
+	{
+		m_dockManager->restoreState(byteDockState);
+	}
+	// update file name
+	m_strConfigFile = strConfigFileName;
+	// update title
+	this->setWindowTitle(m_strTitle.arg(strConfigFileName).arg(QUaModbus::m_strAppName));
+	// warm start, last known values are kept next to the config
+	// NOTE : a missing or invalid cache only means a cold start
+	this->modbusClientList()->setValueCacheFile(strConfigFileName + QUaModbus::m_strValueCacheSuffix);
+#ifdef UA_ENABLE_HISTORIZING
+	// history that no longer fits in memory is also kept next to the config
+	// NOTE : a store that cannot be opened only means history is kept in memory
+	this->modbusClientList()->setHistoryStorePath(strConfigFileName + QUaModbus::m_strHistoryStoreSuffix);
+#endif // UA_ENABLE_HISTORIZING
+}
+
 void QUaModbus::on_saveConfig()
 {
 	if (m_strConfigFile.isEmpty())
@@ -160,11 +223,15 @@ void QUaModbus::on_saveConfig()
 	{
 		// save last path used
 		m_strLastPathUsed = QFileInfo(fileConfig).absoluteFilePath();
-		// create streams
-		QTextStream streamConfig(&fileConfig);
 		// save config in file
-		auto byteContents = this->xmlConfig();
-		streamConfig << byteContents;
+		if (!this->writeXmlConfig(&fileConfig))
+		{
+			QMessageBox msgBox;
+			msgBox.setWindowTitle("Error");
+			msgBox.setIcon(QMessageBox::Critical);
+			msgBox.setText(tr("Error writing file %1.").arg(m_strConfigFile));
+			msgBox.exec();
+		}
 		// update title
 		this->setWindowTitle(m_strTitle.arg(m_strConfigFile).arg(QUaModbus::m_strAppName));
 	}
@@ -223,6 +290,11 @@ bool QUaModbus::on_closeConfig(const bool& force)
 	}
 	// close indeed
 	this->clearWidgets();
+	// NOTE : flushes last known values before they are deleted
+	mod->setValueCacheFile(QString());
+#ifdef UA_ENABLE_HISTORIZING
+	mod->setHistoryStorePath(QString());
+#endif // UA_ENABLE_HISTORIZING
 	mod->clearInmediatly();
 	// update file name
 	m_strConfigFile = QString();
@@ -370,9 +442,28 @@ void QUaModbus::setupWidgets()
 	m_dockManager->addDockWidget(QAd::BottomDockWidgetArea, pDockValueEdit, pAreaClientEdit);
 	// disable intially
 	m_valueWidget->setEnabled(false);
+	// create log and put it inside a dock
+	m_logWidget = new QUaLogWidget(m_dockManager);
+	m_logWidget->setLevelColor(QUaLogLevel::Error, QBrush(QColor("#8E2F1C")));
+	m_logWidget->setLevelColor(QUaLogLevel::Warning, QBrush(QColor("#766B0F")));
+	m_logWidget->setLevelColor(QUaLogLevel::Info, QBrush(QColor("#265EB6")));
+	auto pDockLog = new QAdDockWidget(QUaModbus::m_strModbusLog, m_dockManager);
+	pDockLog->setWidget(m_logWidget);
+	m_dockManager->addDockWidget(QAd::BottomDockWidgetArea, pDockLog, pAreaTree);
 
 	// setup widgets
 	QUaModbusClientList * mod = this->modbusClientList();
+	// runtime messages (lag, edit validation, merge summaries, warm start, history store)
+	QObject::connect(mod, &QUaModbusClientList::logMessage, m_logWidget, &QUaLogWidget::addLog);
+	// register conflicts found after an edit are warnings, show them without waiting for a reload
+	QObject::connect(mod, &QUaModbusClientList::logMessage, this,
+	[this](const QUaLog &log) {
+		if (log.level != QUaLogLevel::Warning && log.level != QUaLogLevel::Error)
+		{
+			return;
+		}
+		this->setIsDockVisible(QUaModbus::m_strModbusLog, true);
+	});
 	// set client list
 	m_modbusTreeWidget->setClientList(mod);
 	// bind selected
@@ -477,6 +568,7 @@ void QUaModbus::setupMenuBar()
 	ui->menuView->addAction(m_dockManager->findDockWidget(QUaModbus::m_strModbusClients)->toggleViewAction());
 	ui->menuView->addAction(m_dockManager->findDockWidget(QUaModbus::m_strModbusBlocks )->toggleViewAction());
 	ui->menuView->addAction(m_dockManager->findDockWidget(QUaModbus::m_strModbusValues )->toggleViewAction());
+	ui->menuView->addAction(m_dockManager->findDockWidget(QUaModbus::m_strModbusLog    )->toggleViewAction());
 	// handle help menu events
 	QObject::connect(ui->actionAbout, &QAction::triggered, this, &QUaModbus::on_about);
 }
@@ -590,85 +682,22 @@ bool QUaModbus::setIsDockVisible(const QString& strDockName, const bool& visible
 	return true;
 }
 
-QByteArray QUaModbus::xmlConfig()
-{
-	// create dom doc
-	QDomDocument doc;
-	// set xml header
-	QDomProcessingInstruction header = doc.createProcessingInstruction("xml", "version='1.0' encoding='UTF-8'");
-	doc.appendChild(header);
-	// convert config to xml
-	auto elem = this->toDomElement(doc);
-	doc.appendChild(elem);
-	// get contents bytearray
-	return doc.toByteArray();
-}
-
-QQueue<QUaLog> QUaModbus::setXmlConfig(const QByteArray& xmlConfig)
-{
-	QQueue<QUaLog> errorLogs;
-	QString strError;
-	// set to dom doc
-	QDomDocument doc;
-	int line, col;
-	doc.setContent(xmlConfig, &strError, &line, &col);
-	if (!strError.isEmpty())
-	{
-		errorLogs << QUaLog(
-			tr("Invalid XML in Line %1 Column %2 Error %3.").arg(line).arg(col).arg(strError),
-			QUaLogLevel::Error,
-			QUaLogCategory::Serialization
-		);
-		return errorLogs;
-	}
-	// get config
-	QDomElement elemApp = doc.firstChildElement(QUaModbus::staticMetaObject.className());
-	if (elemApp.isNull())
-	{
-		errorLogs << QUaLog(
-			tr("No Application %2 element found in XML config.").arg(QUaModbus::staticMetaObject.className()),
-			QUaLogLevel::Error,
-			QUaLogCategory::Serialization
-		);
-		return errorLogs;
-	}
-	// load config from xml
-	this->fromDomElement(elemApp, errorLogs);
-	return errorLogs;
-}
-
-QDomElement QUaModbus::toDomElement(QDomDocument& domDoc) const
+bool QUaModbus::writeXmlConfig(QIODevice * device)
 {
-	// add element
-	QDomElement elemApp = domDoc.createElement(QUaModbus::staticMetaObject.className());
-	// modbus
-	QUaModbusClientList* mod = this->modbusClientList();
-	elemApp.appendChild(mod->toDomElement(domDoc));
+	QXmlStreamWriter xml(device);
+	xml.setAutoFormatting(true);
+	xml.setAutoFormattingIndent(1);
+	xml.writeStartDocument();
+	// add element, attributes go before the modbus contents
+	xml.writeStartElement(QUaModbus::staticMetaObject.className());
 	// dock
-	elemApp.setAttribute("DockState", QString(m_dockManager->saveState().toHex()));
-	// return element
-	return elemApp;
-}
-
-void QUaModbus::fromDomElement(QDomElement& domElem, QQueue<QUaLog>& errorLogs)
-{
+	xml.writeAttribute("DockState", QString(m_dockManager->saveState().toHex()));
 	// modbus
-	QDomElement elemMod = domElem.firstChildElement(QUaModbusClientList::staticMetaObject.className());
-	if (elemMod.isNull())
-	{
-		errorLogs << QUaLog(
-			tr("No Modbus Client List %1 element found in XML config.").arg(QUaModbusClientList::staticMetaObject.className()),
-			QUaLogLevel::Error,
-			QUaLogCategory::Serialization
-		);
-		return;
-	}
+	// NOTE : streamed by the list, only one client is held as dom at a time
 	QUaModbusClientList* mod = this->modbusClientList();
-	mod->fromDomElement(elemMod, errorLogs);
-	// dock
-	if (domElem.hasAttribute("DockState"))
-	{
-		m_dockManager->restoreState(QByteArray::fromHex(domElem.attribute("DockState").toUtf8()));
-	}
+	mod->writeXmlConfig(xml);
+	xml.writeEndElement();
+	xml.writeEndDocument();
+	return !xml.hasError();
 }
 
@@ -19,6 +19,8 @@
 #include <QUaModbusDataBlockWidget>
 #include <QUaModbusValueWidget>
 
+#include <QUaLogWidget>
+
 #include <DockManager.h>
 #include <DockWidget.h>
 #include <DockAreaWidget.h>
@@ -48,6 +50,7 @@ public:
 private slots:
 	void on_newConfig();
 	void on_openConfig();
+	void on_configImported(const QString &strConfigFileName, const QByteArray &byteDockState, const QQueue<QUaLog> &importLogs, const bool &cancelled);
 	void on_saveConfig();
 	void on_saveAsConfig();
 	bool on_closeConfig(const bool& force = false);
@@ -70,16 +73,22 @@ private:
 	QUaModbusClientWidget    * m_clientWidget    ;
 	QUaModbusDataBlockWidget * m_blockWidget     ;
 	QUaModbusValueWidget	 * m_valueWidget     ; 
+	QUaLogWidget             * m_logWidget       ;
 	QAdDockManager           * m_dockManager     ;
 
 	// constants
 	const static QString m_strAppName;
 	const static QString m_strUntitiled;
 	const static QString m_strDefault;
+	const static QString m_strValueCacheSuffix;
+#ifdef UA_ENABLE_HISTORIZING
+	const static QString m_strHistoryStoreSuffix;
+#endif // UA_ENABLE_HISTORIZING
 	const static QString m_strModbusTree;
 	const static QString m_strModbusClients;
 	const static QString m_strModbusBlocks;
 	const static QString m_strModbusValues;
+	const static QString m_strModbusLog;
 
 	// methods
 	void setupInfoModel();
@@ -95,10 +104,7 @@ private:
 	bool isDockVisible(const QString& strDockName);
 	bool setIsDockVisible(const QString& strDockName, const bool& visible);
 
-	// xml import / export
-	QByteArray     xmlConfig();
-	QQueue<QUaLog> setXmlConfig(const QByteArray& xmlConfig);
-	QDomElement    toDomElement(QDomDocument& domDoc) const;
-	void           fromDomElement(QDomElement& domElem, QQueue<QUaLog>& errorLogs);
+	// xml export
+	bool           writeXmlConfig(QIODevice * device);
 };
 #endif // QUAMODBUS_H
@@ -446,16 +446,18 @@ void QUaModbusDataBlockQmlContext::bindValues(QUaModbusValueList* values)
 		this->bindValue(value);
 	}
 	// bind new added
-	QObject::connect(values, &QUaNode::childAdded, this,
-	[this](QUaNode* node) {
-		// bind new
-		auto value = qobject_cast<QUaModbusValue*>(node);
-		Q_ASSERT(value);
-		this->bindValue(value);
+	QObject::connect(values, &QUaModbusValueList::valuesAdded, this,
+	[this](const QList<QUaModbusValue*> &listValues) {
+		// bind new, notify once for all
+		for (auto value : listValues)
+		{
+			this->bindValue(value, false);
+		}
+		emit this->valuesChanged();
 	}/*, Qt::QueuedConnection // NOTE : do not queue or will not be available on view load */);
 }
 
-void QUaModbusDataBlockQmlContext::bindValue(QUaModbusValue* value)
+void QUaModbusDataBlockQmlContext::bindValue(QUaModbusValue* value, const bool &notify/* = true*/)
 {
 	// get id
 	QString strId = value->browseName().name();
@@ -476,7 +478,10 @@ void QUaModbusDataBlockQmlContext::bindValue(QUaModbusValue* value)
 		this->removeValue(value);
 	});
 	// notify changes
-	emit this->valuesChanged();
+	if (notify)
+	{
+		emit this->valuesChanged();
+	}
 }
 
 void QUaModbusDataBlockQmlContext::removeValue(QUaModbusValue* value)
@@ -1012,16 +1017,18 @@ void QUaModbusClientQmlContext::bindBlocks(QUaModbusDataBlockList* blocks)
 		this->bindBlock(block);
 	}
 	// bind block added
-	QObject::connect(blocks, &QUaNode::childAdded, this,
-	[this](QUaNode* node) {
-		// bind new block
-		auto block = qobject_cast<QUaModbusDataBlock*>(node);
-		Q_ASSERT(block);
-		this->bindBlock(block);
+	QObject::connect(blocks, &QUaModbusDataBlockList::blocksAdded, this,
+	[this](const QList<QUaModbusDataBlock*> &listBlocks) {
+		// bind new blocks, notify once for all
+		for (auto block : listBlocks)
+		{
+			this->bindBlock(block, false);
+		}
+		emit this->blocksChanged();
 	}/*, Qt::QueuedConnection // NOTE : do not queue or blocks will not be available on view load */);
 }
 
-void QUaModbusClientQmlContext::bindBlock(QUaModbusDataBlock* block)
+void QUaModbusClientQmlContext::bindBlock(QUaModbusDataBlock* block, const bool &notify/* = true*/)
 {
 	// get id
 	QString strId = block->browseName().name();
@@ -1042,7 +1049,10 @@ void QUaModbusClientQmlContext::bindBlock(QUaModbusDataBlock* block)
 		this->removeBlock(block);
 	});
 	// notify changes
-	emit this->blocksChanged();
+	if (notify)
+	{
+		emit this->blocksChanged();
+	}
 }
 
 void QUaModbusClientQmlContext::removeBlock(QUaModbusDataBlock* block)
@@ -196,7 +196,7 @@ private:
     // QUaModbusValueList
     QVariantMap m_values;
     void bindValues(QUaModbusValueList* values);
-    void bindValue(QUaModbusValue* value);
+    void bindValue(QUaModbusValue* value, const bool &notify = true);
     void removeValue(QUaModbusValue* value);
 };
 
@@ -334,7 +334,7 @@ private:
     // QUaModbusDataBlockList
     QVariantMap m_blocks;
     void bindBlocks(QUaModbusDataBlockList* blocks);
-    void bindBlock(QUaModbusDataBlock* block);
+    void bindBlock(QUaModbusDataBlock* block, const bool &notify = true);
     void removeBlock(QUaModbusDataBlock* block);
 };
 
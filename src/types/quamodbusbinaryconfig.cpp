@@ -0,0 +1,543 @@
+#include "quamodbusbinaryconfig.h"
+
+#include "quamodbustcpclient.h"
+#include "quamodbusrtuserialclient.h"
+#include "quamodbusdatablocklist.h"
+#include "quamodbusdatablock.h"
+#include "quamodbusvaluelist.h"
+#include "quamodbusvalue.h"
+#include "quamodbusserialportregistry.h"
+
+#include <QHash>
+#include <QMetaEnum>
+#include <QtEndian>
+
+#ifdef QUA_ACCESS_CONTROL
+#include <QUaPermissions>
+#endif // QUA_ACCESS_CONTROL
+
+// NOTE : records are only made of 32 bit words, so byte order is fixed word by word
+template<typename T>
+static void appendRecord(QByteArray &byteData, T record)
+{
+	Q_STATIC_ASSERT(sizeof(T) % sizeof(quint32) == 0);
+	auto words = reinterpret_cast<quint32*>(&record);
+	for (size_t i = 0; i < sizeof(T) / sizeof(quint32); i++)
+	{
+		words[i] = qToLittleEndian(words[i]);
+	}
+	byteData.append(reinterpret_cast<const char*>(&record), sizeof(T));
+}
+
+// NOTE : copies, mapped data need not be aligned and records of newer versions may be larger
+template<typename T>
+static T readRecord(const char * data, const quint32 &recordSize)
+{
+	Q_STATIC_ASSERT(sizeof(T) % sizeof(quint32) == 0);
+	T record;
+	memcpy(&record, data, qMin(static_cast<size_t>(recordSize), sizeof(T)));
+	auto words = reinterpret_cast<quint32*>(&record);
+	for (size_t i = 0; i < sizeof(T) / sizeof(quint32); i++)
+	{
+		words[i] = qFromLittleEndian(words[i]);
+	}
+	return record;
+}
+
+// enum values are stored as plain words, only known ones are loaded
+template<typename T>
+static bool isEnumValue(const qint32 &value)
+{
+	return QMetaEnum::fromType<T>().valueToKey(value) != nullptr;
+}
+
+// doubles are stored as two words, so records stay made of 32 bit words
+static quint64 doubleToBits(const double &value)
+{
+	quint64 bits;
+	memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
+
+#ifdef UA_ENABLE_HISTORIZING
+static double bitsToDouble(const quint64 &bits)
+{
+	double value;
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+#endif // UA_ENABLE_HISTORIZING
+
+// string pool used while serializing
+class QUaModbusStringPool
+{
+public:
+	quint32 add(const QString &strValue)
+	{
+		if (strValue.isEmpty())
+		{
+			return QUaModbusBinaryConfig::m_noString;
+		}
+		auto it = m_indexes.find(strValue);
+		if (it != m_indexes.end())
+		{
+			return it.value();
+		}
+		auto byteValue = strValue.toUtf8();
+		quint32 index = static_cast<quint32>(m_records.count());
+		m_records.append({ static_cast<quint32>(m_data.size()), static_cast<quint32>(byteValue.size()) });
+		m_data.append(byteValue);
+		m_indexes.insert(strValue, index);
+		return index;
+	}
+	QVector<QUaModbusBinaryConfig::StringRecord> m_records;
+	QByteArray                                   m_data;
+
+private:
+	QHash<QString, quint32> m_indexes;
+};
+
+template<typename T>
+static quint32 addPermissions(QUaModbusStringPool &strings, T * node)
+{
+#ifdef QUA_ACCESS_CONTROL
+	if (node->hasPermissionsObject())
+	{
+		QString strNodeId = node->permissionsObject()->nodeId();
+		return strings.add(strNodeId);
+	}
+#else
+	Q_UNUSED(strings);
+	Q_UNUSED(node);
+#endif // QUA_ACCESS_CONTROL
+	return QUaModbusBinaryConfig::m_noString;
+}
+
+#ifdef QUA_ACCESS_CONTROL
+template<typename T>
+static void loadPermissions(T * node, const QString &strNodeId, QQueue<QUaLog> &errorLogs)
+{
+	if (strNodeId.isEmpty())
+	{
+		return;
+	}
+	QString strError = node->setPermissions(strNodeId);
+	if (strError.contains("Error"))
+	{
+		errorLogs << QUaLog(
+			strError,
+			QUaLogLevel::Error,
+			QUaLogCategory::Serialization
+		);
+	}
+}
+#endif // QUA_ACCESS_CONTROL
+
+QByteArray QUaModbusBinaryConfig::serialize(const QUaModbusClientList * list)
+{
+	auto listNonConst = const_cast<QUaModbusClientList*>(list);
+	QUaModbusStringPool strings;
+	QVector<ClientRecord> clientRecords;
+	QVector<BlockRecord>  blockRecords;
+	QVector<ValueRecord>  valueRecords;
+	for (auto client : listNonConst->clients())
+	{
+		ClientRecord clientRecord;
+		memset(&clientRecord, 0, sizeof(ClientRecord));
+		clientRecord.name               = strings.add(client->browseName().name());
+		clientRecord.type               = static_cast<quint32>(client->getType());
+		clientRecord.permissions        = addPermissions(strings, client);
+		clientRecord.serverAddress      = client->getServerAddress();
+		clientRecord.keepConnecting     = client->getKeepConnecting();
+		clientRecord.timeout            = client->getTimeout();
+		clientRecord.numberOfRetries    = client->getNumberOfRetries();
+		clientRecord.adaptiveTimeout    = client->getAdaptiveTimeout();
+		clientRecord.diagnosticsEnabled = client->getDiagnosticsEnabled();
+		clientRecord.networkAddress     = m_noString;
+		clientRecord.comPort            = m_noString;
+		if (auto clientTcp = qobject_cast<QUaModbusTcpClient*>(client))
+		{
+			clientRecord.networkAddress = strings.add(clientTcp->getNetworkAddress());
+			clientRecord.networkPort    = clientTcp->getNetworkPort();
+		}
+		else if (auto clientSerial = qobject_cast<QUaModbusRtuSerialClient*>(client))
+		{
+			// NOTE : by name as in xml, keys are not stable across restarts
+			clientRecord.comPort  = strings.add(QUaModbusSerialPortRegistry::instance()->portName(clientSerial->getComPortKey()));
+			clientRecord.parity   = clientSerial->getParity  ();
+			clientRecord.baudRate = clientSerial->getBaudRate();
+			clientRecord.dataBits = clientSerial->getDataBits();
+			clientRecord.stopBits = clientSerial->getStopBits();
+		}
+		clientRecord.firstBlock = static_cast<quint32>(blockRecords.count());
+		auto blocks = client->dataBlocks()->blocks();
+		for (auto block : blocks)
+		{
+			BlockRecord blockRecord;
+			blockRecord.name         = strings.add(block->browseName().name());
+			blockRecord.permissions  = addPermissions(strings, block);
+			blockRecord.type         = block->getType();
+			blockRecord.address      = block->getAddress();
+			blockRecord.size         = block->getSize();
+			blockRecord.samplingTime = block->getSamplingTime();
+#ifdef UA_ENABLE_HISTORIZING
+			blockRecord.historizing  = block->getHistorizing();
+#else
+			blockRecord.historizing  = 0;
+#endif // UA_ENABLE_HISTORIZING
+			blockRecord.firstValue   = static_cast<quint32>(valueRecords.count());
+			auto values = block->values()->values();
+			for (auto value : values)
+			{
+				ValueRecord valueRecord;
+				valueRecord.name              = strings.add(value->browseName().name());
+				valueRecord.permissions       = addPermissions(strings, value);
+				valueRecord.type              = value->getType();
+				valueRecord.addressOffset     = value->getAddressOffset();
+#ifndef QUAMODBUS_NOCYCLIC_WRITE
+				valueRecord.cyclicWriteMode   = value->getCyclicWriteMode();
+				valueRecord.cyclicWritePeriod = value->getCyclicWritePeriod();
+#else
+				valueRecord.cyclicWriteMode   = 0;
+				valueRecord.cyclicWritePeriod = 0;
+#endif // !QUAMODBUS_NOCYCLIC_WRITE
+#ifdef UA_ENABLE_HISTORIZING
+				valueRecord.historizing       = value->getHistorizing();
+				auto deviationBits            = doubleToBits(value->getHistoryDeviation());
+#else
+				valueRecord.historizing       = 0;
+				auto deviationBits            = doubleToBits(0.0);
+#endif // UA_ENABLE_HISTORIZING
+				valueRecord.historyDeviation[0] = static_cast<quint32>(deviationBits);
+				valueRecord.historyDeviation[1] = static_cast<quint32>(deviationBits >> 32);
+				valueRecords << valueRecord;
+			}
+			blockRecord.valueCount = static_cast<quint32>(values.count());
+			blockRecords << blockRecord;
+		}
+		clientRecord.blockCount = static_cast<quint32>(blocks.count());
+		clientRecords << clientRecord;
+	}
+	// layout tables one after the other
+	Header header;
+	header.magic            = m_magic;
+	header.version          = m_version;
+	header.headerSize       = sizeof(Header);
+	header.checksum         = 0;
+	header.lagThreshold     = list->getLagThreshold();
+	header.connectConcurrency = list->getConnectConcurrency();
+	header.errorStatusCodes   = list->getErrorStatusCodes() ? 1 : 0;
+	header.compactValues      = list->getCompactValues() ? 1 : 0;
+#ifdef UA_ENABLE_HISTORIZING
+	header.historyMemoryLimit = list->getHistoryMemoryLimit();
+#else
+	header.historyMemoryLimit = 0;
+#endif // UA_ENABLE_HISTORIZING
+	header.permissions      = addPermissions(strings, listNonConst);
+	header.clientCount      = static_cast<quint32>(clientRecords.count());
+	header.clientSize       = sizeof(ClientRecord);
+	header.clientsOffset    = header.headerSize;
+	header.blockCount       = static_cast<quint32>(blockRecords.count());
+	header.blockSize        = sizeof(BlockRecord);
+	header.blocksOffset     = header.clientsOffset + header.clientCount * header.clientSize;
+	header.valueCount       = static_cast<quint32>(valueRecords.count());
+	header.valueSize        = sizeof(ValueRecord);
+	header.valuesOffset     = header.blocksOffset + header.blockCount * header.blockSize;
+	header.stringCount      = static_cast<quint32>(strings.m_records.count());
+	header.stringsOffset    = header.valuesOffset + header.valueCount * header.valueSize;
+	header.stringDataOffset = header.stringsOffset + header.stringCount * sizeof(StringRecord);
+	header.stringDataSize   = static_cast<quint32>(strings.m_data.size());
+	QByteArray byteData;
+	byteData.reserve(header.stringDataOffset + header.stringDataSize);
+	appendRecord(byteData, header);
+	for (auto &record : clientRecords)
+	{
+		appendRecord(byteData, record);
+	}
+	for (auto &record : blockRecords)
+	{
+		appendRecord(byteData, record);
+	}
+	for (auto &record : valueRecords)
+	{
+		appendRecord(byteData, record);
+	}
+	for (auto &record : strings.m_records)
+	{
+		appendRecord(byteData, record);
+	}
+	byteData.append(strings.m_data);
+	// checksum of everything after header
+	auto crc = qToLittleEndian(QUaModbusBinaryConfig::checksum(byteData.constData() + header.headerSize, byteData.size() - header.headerSize));
+	memcpy(byteData.data() + offsetof(Header, checksum), &crc, sizeof(quint32));
+	return byteData;
+}
+
+bool QUaModbusBinaryConfig::deserialize(QUaModbusClientList * list, const char * data, const qint64 & size, QQueue<QUaLog>& errorLogs)
+{
+	auto logError = [&errorLogs](const QString &strMessage) {
+		errorLogs << QUaLog(
+			strMessage,
+			QUaLogLevel::Error,
+			QUaLogCategory::Serialization
+		);
+		return false;
+	};
+	// header
+	if (!data || size < static_cast<qint64>(2 * sizeof(quint32)))
+	{
+		return logError(tr("Binary config is empty or truncated."));
+	}
+	auto magic   = qFromLittleEndian<quint32>(data);
+	auto version = qFromLittleEndian<quint32>(data + sizeof(quint32));
+	if (magic != m_magic)
+	{
+		return logError(tr("Data is not a Modbus binary config."));
+	}
+	if (version != m_version)
+	{
+		return logError(tr("Unsupported Modbus binary config version %1, expected %2.").arg(version).arg(m_version));
+	}
+	if (size < static_cast<qint64>(sizeof(Header)))
+	{
+		return logError(tr("Binary config is empty or truncated."));
+	}
+	auto header = readRecord<Header>(data, sizeof(Header));
+	// tables must fit in data and records must not be smaller than known ones
+	auto tableFits = [size](const quint32 &offset, const quint32 &count, const quint32 &recordSize) {
+		return static_cast<qint64>(offset) + static_cast<qint64>(count) * recordSize <= size;
+	};
+	if (header.headerSize < sizeof(Header) ||
+		header.clientSize < sizeof(ClientRecord) ||
+		header.blockSize  < sizeof(BlockRecord ) ||
+		header.valueSize  < sizeof(ValueRecord ) ||
+		!tableFits(header.clientsOffset   , header.clientCount, header.clientSize        ) ||
+		!tableFits(header.blocksOffset    , header.blockCount , header.blockSize         ) ||
+		!tableFits(header.valuesOffset    , header.valueCount , header.valueSize         ) ||
+		!tableFits(header.stringsOffset   , header.stringCount, sizeof(StringRecord)     ) ||
+		!tableFits(header.stringDataOffset, 1                 , header.stringDataSize    ))
+	{
+		return logError(tr("Binary config is empty or truncated."));
+	}
+	if (QUaModbusBinaryConfig::checksum(data + header.headerSize, size - header.headerSize) != header.checksum)
+	{
+		return logError(tr("Binary config checksum mismatch, data is corrupted."));
+	}
+	// string pool
+	QVector<QString> strings(header.stringCount);
+	for (quint32 i = 0; i < header.stringCount; i++)
+	{
+		auto record = readRecord<StringRecord>(data + header.stringsOffset + i * sizeof(StringRecord), sizeof(StringRecord));
+		if (static_cast<qint64>(record.offset) + record.size > header.stringDataSize)
+		{
+			return logError(tr("Invalid string %1 in binary config.").arg(i));
+		}
+		strings[i] = QString::fromUtf8(data + header.stringDataOffset + record.offset, static_cast<int>(record.size));
+	}
+	auto string = [&strings](const quint32 &index) {
+		return index < static_cast<quint32>(strings.count()) ? strings.at(static_cast<int>(index)) : QString();
+	};
+	// check ranges before touching the tree, so nothing is loaded from inconsistent data
+	for (quint32 c = 0; c < header.clientCount; c++)
+	{
+		auto clientRecord = readRecord<ClientRecord>(data + header.clientsOffset + c * header.clientSize, header.clientSize);
+		if (static_cast<quint64>(clientRecord.firstBlock) + clientRecord.blockCount > header.blockCount)
+		{
+			return logError(tr("Invalid block range in client %1 of binary config.").arg(string(clientRecord.name)));
+		}
+		if (clientRecord.type != QModbusClientType::Tcp && clientRecord.type != QModbusClientType::Serial)
+		{
+			return logError(tr("Invalid type in client %1 of binary config.").arg(string(clientRecord.name)));
+		}
+		if (clientRecord.type == QModbusClientType::Serial && (
+			!isEnumValue<QParity  >(clientRecord.parity  ) ||
+			!isEnumValue<QBaudRate>(clientRecord.baudRate) ||
+			!isEnumValue<QDataBits>(clientRecord.dataBits) ||
+			!isEnumValue<QStopBits>(clientRecord.stopBits)))
+		{
+			return logError(tr("Invalid serial settings in client %1 of binary config.").arg(string(clientRecord.name)));
+		}
+	}
+	for (quint32 b = 0; b < header.blockCount; b++)
+	{
+		auto blockRecord = readRecord<BlockRecord>(data + header.blocksOffset + b * header.blockSize, header.blockSize);
+		if (static_cast<quint64>(blockRecord.firstValue) + blockRecord.valueCount > header.valueCount)
+		{
+			return logError(tr("Invalid value range in block %1 of binary config.").arg(string(blockRecord.name)));
+		}
+		if (!isEnumValue<QModbusDataBlockType>(blockRecord.type))
+		{
+			return logError(tr("Invalid type in block %1 of binary config.").arg(string(blockRecord.name)));
+		}
+	}
+	for (quint32 v = 0; v < header.valueCount; v++)
+	{
+		auto valueRecord = readRecord<ValueRecord>(data + header.valuesOffset + v * header.valueSize, header.valueSize);
+		if (!isEnumValue<QModbusValueType>(valueRecord.type))
+		{
+			return logError(tr("Invalid type in value %1 of binary config.").arg(string(valueRecord.name)));
+		}
+#ifndef QUAMODBUS_NOCYCLIC_WRITE
+		if (!isEnumValue<QModbusCyclicWriteMode>(valueRecord.cyclicWriteMode))
+		{
+			return logError(tr("Invalid cyclic write mode in value %1 of binary config.").arg(string(valueRecord.name)));
+		}
+#endif // !QUAMODBUS_NOCYCLIC_WRITE
+	}
+	// list
+	list->setLagThreshold(header.lagThreshold);
+	list->setConnectConcurrency(header.connectConcurrency);
+	list->setErrorStatusCodes(header.errorStatusCodes != 0);
+	list->setCompactValues(header.compactValues != 0);
+#ifdef UA_ENABLE_HISTORIZING
+	list->setHistoryMemoryLimit(header.historyMemoryLimit);
+#endif // UA_ENABLE_HISTORIZING
+#ifdef QUA_ACCESS_CONTROL
+	loadPermissions(list, string(header.permissions), errorLogs);
+#endif // QUA_ACCESS_CONTROL
+	// clients
+	for (quint32 c = 0; c < header.clientCount; c++)
+	{
+		auto clientRecord = readRecord<ClientRecord>(data + header.clientsOffset + c * header.clientSize, header.clientSize);
+		auto strClientName = string(clientRecord.name);
+		if (list->browseChild<QUaModbusClient>(strClientName))
+		{
+			errorLogs << QUaLog(
+				tr("Modbus client with %1 BrowseName already exists. Skipping.").arg(strClientName),
+				QUaLogLevel::Error,
+				QUaLogCategory::Serialization
+			);
+			continue;
+		}
+		QString strResult = clientRecord.type == QModbusClientType::Tcp ?
+			list->addTcpClient(strClientName) :
+			list->addRtuSerialClient(strClientName);
+		auto client = list->browseChild<QUaModbusClient>(strClientName);
+		if (!client)
+		{
+			errorLogs << QUaLog(
+				tr("Failed to create client with %1 BrowseName. %2. Skipping.").arg(strClientName).arg(strResult),
+				QUaLogLevel::Error,
+				QUaLogCategory::Serialization
+			);
+			continue;
+		}
+#ifdef QUA_ACCESS_CONTROL
+		loadPermissions(client, string(clientRecord.permissions), errorLogs);
+#endif // QUA_ACCESS_CONTROL
+		client->setServerAddress     (static_cast<quint8>(clientRecord.serverAddress));
+		client->setKeepConnecting    (clientRecord.keepConnecting != 0);
+		client->setTimeout           (clientRecord.timeout);
+		client->setNumberOfRetries   (clientRecord.numberOfRetries);
+		client->setAdaptiveTimeout   (clientRecord.adaptiveTimeout != 0);
+		client->setDiagnosticsEnabled(clientRecord.diagnosticsEnabled != 0);
+		if (auto clientTcp = qobject_cast<QUaModbusTcpClient*>(client))
+		{
+			clientTcp->setNetworkAddress(string(clientRecord.networkAddress));
+			clientTcp->setNetworkPort   (static_cast<quint16>(clientRecord.networkPort));
+		}
+		else if (auto clientSerial = qobject_cast<QUaModbusRtuSerialClient*>(client))
+		{
+			auto comPort = string(clientRecord.comPort);
+			if (!comPort.isEmpty())
+			{
+				clientSerial->setComPortKey(QUaModbusSerialPortRegistry::instance()->portKey(comPort));
+			}
+			clientSerial->setParity  (static_cast<QParity  >(clientRecord.parity  ));
+			clientSerial->setBaudRate(static_cast<QBaudRate>(clientRecord.baudRate));
+			clientSerial->setDataBits(static_cast<QDataBits>(clientRecord.dataBits));
+			clientSerial->setStopBits(static_cast<QStopBits>(clientRecord.stopBits));
+		}
+		// blocks
+		auto blockList = client->dataBlocks();
+		for (quint32 b = clientRecord.firstBlock; b < clientRecord.firstBlock + clientRecord.blockCount; b++)
+		{
+			auto blockRecord = readRecord<BlockRecord>(data + header.blocksOffset + b * header.blockSize, header.blockSize);
+			auto strBlockName = string(blockRecord.name);
+			strResult = blockList->addDataBlock(strBlockName);
+			auto block = blockList->browseChild<QUaModbusDataBlock>(strBlockName);
+			if (!block)
+			{
+				errorLogs << QUaLog(
+					tr("Failed to create block %1 in client %2. %3. Skipping.").arg(strBlockName).arg(strClientName).arg(strResult),
+					QUaLogLevel::Error,
+					QUaLogCategory::Serialization
+				);
+				continue;
+			}
+#ifdef QUA_ACCESS_CONTROL
+			loadPermissions(block, string(blockRecord.permissions), errorLogs);
+#endif // QUA_ACCESS_CONTROL
+			block->setType        (static_cast<QModbusDataBlockType>(blockRecord.type));
+			block->setAddress     (blockRecord.address);
+			block->setSize        (blockRecord.size);
+			block->setSamplingTime(blockRecord.samplingTime);
+#ifdef UA_ENABLE_HISTORIZING
+			block->setHistorizing (blockRecord.historizing != 0);
+#endif // UA_ENABLE_HISTORIZING
+			// values
+			auto valueList = block->values();
+			for (quint32 v = blockRecord.firstValue; v < blockRecord.firstValue + blockRecord.valueCount; v++)
+			{
+				auto valueRecord = readRecord<ValueRecord>(data + header.valuesOffset + v * header.valueSize, header.valueSize);
+				auto strValueName = string(valueRecord.name);
+				strResult = valueList->addValue(strValueName);
+				auto value = valueList->browseChild<QUaModbusValue>(strValueName);
+				if (!value)
+				{
+					errorLogs << QUaLog(
+						tr("Failed to create value %1 in block %2. %3. Skipping.").arg(strValueName).arg(strBlockName).arg(strResult),
+						QUaLogLevel::Error,
+						QUaLogCategory::Serialization
+					);
+					continue;
+				}
+#ifdef QUA_ACCESS_CONTROL
+				loadPermissions(value, string(valueRecord.permissions), errorLogs);
+#endif // QUA_ACCESS_CONTROL
+				value->setType         (static_cast<QModbusValueType>(valueRecord.type));
+				value->setAddressOffset(valueRecord.addressOffset);
+#ifndef QUAMODBUS_NOCYCLIC_WRITE
+				value->setCyclicWriteMode  (static_cast<QModbusCyclicWriteMode>(valueRecord.cyclicWriteMode));
+				value->setCyclicWritePeriod(valueRecord.cyclicWritePeriod);
+#endif // !QUAMODBUS_NOCYCLIC_WRITE
+#ifdef UA_ENABLE_HISTORIZING
+				value->setHistoryDeviation(bitsToDouble(
+					static_cast<quint64>(valueRecord.historyDeviation[1]) << 32 | valueRecord.historyDeviation[0]
+				));
+				value->setHistorizing     (valueRecord.historizing != 0);
+#endif // UA_ENABLE_HISTORIZING
+			}
+		}
+		// connect if keepConnecting is set, through the startup ramp
+		if (client->getKeepConnecting())
+		{
+			list->queueConnect(client);
+		}
+	}
+	return true;
+}
+
+quint32 QUaModbusBinaryConfig::checksum(const char * data, const qint64 & size)
+{
+	// crc32 (ieee 802.3), table built once
+	static const QVector<quint32> table = []() {
+		QVector<quint32> table(256);
+		for (quint32 i = 0; i < 256; i++)
+		{
+			quint32 crc = i;
+			for (int j = 0; j < 8; j++)
+			{
+				crc = crc & 1 ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+			}
+			table[static_cast<int>(i)] = crc;
+		}
+		return table;
+	}();
+	quint32 crc = 0xFFFFFFFF;
+	for (qint64 i = 0; i < size; i++)
+	{
+		crc = table.at((crc ^ static_cast<quint8>(data[i])) & 0xFF) ^ (crc >> 8);
+	}
+	return crc ^ 0xFFFFFFFF;
+}
@@ -0,0 +1,118 @@
+#ifndef QUAMODBUSBINARYCONFIG_H
+#define QUAMODBUSBINARYCONFIG_H
+
+#include "quamodbusclientlist.h"
+
+#include <QCoreApplication>
+
+// Versioned binary snapshot of the whole client / block / value tree, for fast restarts.
+// Layout (all little endian 32 bit words, so it can be read in place from a mapped file) :
+//   Header | ClientRecord[] | BlockRecord[] | ValueRecord[] | StringRecord[] | utf8 string data
+// Clients own a contiguous range of blocks and blocks a contiguous range of values.
+// Strings (names, network addresses, com ports, permissions node ids) are pooled and
+// referenced by index, m_noString if not set. A crc32 of everything after the header
+// guards against truncated or corrupted files.
+// NOTE : attributes are the same as in toDomElement, keep both in sync
+class QUaModbusBinaryConfig
+{
+	Q_DECLARE_TR_FUNCTIONS(QUaModbusBinaryConfig)
+
+public:
+	static QByteArray serialize(const QUaModbusClientList * list);
+	// returns false if the data is not a valid snapshot, in which case nothing is loaded
+	static bool       deserialize(QUaModbusClientList * list, const char * data, const qint64 &size, QQueue<QUaLog> &errorLogs);
+
+	static const quint32 m_magic    = 0x424D5551; // "QUMB"
+	// NOTE : bump whenever the header or a record changes, other versions are rejected
+	//  1 : initial layout
+	//  2 : Header::connectConcurrency
+	//  3 : Header::historyMemoryLimit, BlockRecord::historizing, ValueRecord::historizing and historyDeviation
+	//  4 : Header::errorStatusCodes
+	//  5 : Header::compactValues
+	static const quint32 m_version  = 5;
+	static const quint32 m_noString = 0xFFFFFFFF;
+
+	struct Header
+	{
+		quint32 magic;
+		quint32 version;
+		quint32 headerSize;
+		quint32 checksum;
+		quint32 lagThreshold;
+		quint32 permissions;
+		quint32 clientCount;
+		quint32 clientsOffset;
+		quint32 clientSize;
+		quint32 blockCount;
+		quint32 blocksOffset;
+		quint32 blockSize;
+		quint32 valueCount;
+		quint32 valuesOffset;
+		quint32 valueSize;
+		quint32 stringCount;
+		quint32 stringsOffset;
+		quint32 stringDataOffset;
+		quint32 stringDataSize;
+		quint32 connectConcurrency;
+		quint32 historyMemoryLimit;
+		quint32 errorStatusCodes;
+		quint32 compactValues;
+	};
+
+	struct ClientRecord
+	{
+		quint32 name;
+		quint32 type;
+		quint32 permissions;
+		quint32 serverAddress;
+		quint32 keepConnecting;
+		quint32 timeout;
+		quint32 numberOfRetries;
+		quint32 adaptiveTimeout;
+		quint32 diagnosticsEnabled;
+		quint32 networkAddress; // tcp only
+		quint32 networkPort;    // tcp only
+		quint32 comPort;        // serial only
+		qint32  parity;         // serial only
+		qint32  baudRate;       // serial only
+		qint32  dataBits;       // serial only
+		qint32  stopBits;       // serial only
+		quint32 firstBlock;
+		quint32 blockCount;
+	};
+
+	struct BlockRecord
+	{
+		quint32 name;
+		quint32 permissions;
+		qint32  type;
+		qint32  address;
+		quint32 size;
+		quint32 samplingTime;
+		quint32 historizing;
+		quint32 firstValue;
+		quint32 valueCount;
+	};
+
+	struct ValueRecord
+	{
+		quint32 name;
+		quint32 permissions;
+		qint32  type;
+		qint32  addressOffset;
+		qint32  cyclicWriteMode;
+		quint32 cyclicWritePeriod;
+		quint32 historizing;
+		quint32 historyDeviation[2]; // bits of the double, low word first
+	};
+
+	struct StringRecord
+	{
+		quint32 offset;
+		quint32 size;
+	};
+
+	static quint32 checksum(const char * data, const qint64 &size);
+};
+
+#endif // QUAMODBUSBINARYCONFIG_H
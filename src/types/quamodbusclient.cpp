@@ -1,10 +1,30 @@
 #include "quamodbusclient.h"
 
 #include <QMutexLocker>
+#include <QElapsedTimer>
+#include <QtMath>
+#if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
+#include <QRandomGenerator>
+#endif
 
 #include <QUaModbusDataBlock>
 #include <QUaModbusClientList>
 
+// NOTE : needed for the implementation of QUaBaseObject::addChild
+#include <QUaServer>
+
+quint32 QUaModbusClient::m_minTimeout    = 50;
+double  QUaModbusClient::m_rttGain       = 0.125;
+double  QUaModbusClient::m_rttDeviations = 4.0;
+
+quint32 QUaModbusClient::m_maxConsecutiveTimeouts = 3;
+quint32 QUaModbusClient::m_minReconnectBackoff    = 1000;
+quint32 QUaModbusClient::m_maxReconnectBackoff    = 60000;
+
+quint32 QUaModbusClient::m_diagnosticsPeriod = 1000;
+
+quint32 QUaModbusClient::m_resumeStagger = 10;
+
 QUaModbusClient::QUaModbusClient(QUaServer *server)
 #ifndef QUA_ACCESS_CONTROL
 	: QUaBaseObject(server)
@@ -12,14 +32,44 @@ QUaModbusClient::QUaModbusClient(QUaServer *server)
 	: QUaBaseObjectProtected(server)
 #endif // !QUA_ACCESS_CONTROL
 	, m_mutex(QMutex::Recursive)
+	, m_stateCache(QModbusState::UnconnectedState)
+	, m_config({ 1 })
+	, m_workerTasksPending(0)
+	, m_repliesPending(0)
+	, m_lagProbePosted(-1)
+	, m_lagMeasured(0)
 {
 	m_disconnectRequested = false;
+	m_reconnectRequested  = false;
+	m_connectGeneration   = 0;
 	m_type = nullptr;
 	m_serverAddress = nullptr;
 	m_keepConnecting = nullptr;
+	m_timeout = nullptr;
+	m_numberOfRetries = nullptr;
+	m_adaptiveTimeout = nullptr;
+	m_diagnosticsEnabled = nullptr;
 	m_state = nullptr;
 	m_lastError = nullptr;
+	m_circuitState = nullptr;
+	m_reconnectCount = nullptr;
+	m_reconnectBackoff = nullptr;
+	m_workerLag = nullptr;
+	m_workerQueueDepth = nullptr;
 	m_dataBlocks = nullptr;
+	m_diagnostics = nullptr;
+	m_backoffAttempts = 0;
+	m_timeoutConfigured = 1000;
+	m_timeoutAdaptive   = false;
+	m_timeoutCurrent    = 1000;
+	m_rttSampled        = false;
+	m_rttMean           = 0.0;
+	m_rttVariance       = 0.0;
+	m_circuitStateCache   = QModbusCircuitState::Closed;
+	m_consecutiveTimeouts = 0;
+	m_probeInFlight       = false;
+	m_aduOverhead         = 0;
+	m_lagging             = false;
 	if (QMetaType::type("QModbusError") == QMetaType::UnknownType)
 	{
 		qRegisterMetaType<QModbusError>("QModbusError");
@@ -28,34 +78,85 @@ QUaModbusClient::QUaModbusClient(QUaServer *server)
 	{
 		qRegisterMetaType<QModbusState>("QModbusState");
 	}
+	if (QMetaType::type("QModbusCircuitState") == QMetaType::UnknownType)
+	{
+		qRegisterMetaType<QModbusCircuitState>("QModbusCircuitState");
+	}
 	// set defaults
 	state         ()->setDataTypeEnum(QMetaEnum::fromType<QModbusState>());
 	state         ()->setValue(QModbusState::UnconnectedState);
 	lastError     ()->setDataTypeEnum(QMetaEnum::fromType<QModbusError>());
 	lastError     ()->setValue(QModbusError::NoError);
+	circuitState    ()->setDataTypeEnum(QMetaEnum::fromType<QModbusCircuitState>());
+	circuitState    ()->setValue(QModbusCircuitState::Closed);
+	reconnectCount  ()->setDataType(QMetaType::UInt);
+	reconnectCount  ()->setValue(0);
+	reconnectBackoff()->setDataType(QMetaType::UInt);
+	reconnectBackoff()->setValue(0);
+	workerLag       ()->setDataType(QMetaType::Double);
+	workerLag       ()->setValue(0.0);
+	workerQueueDepth()->setDataType(QMetaType::UInt);
+	workerQueueDepth()->setValue(0);
 	serverAddress ()->setDataType(QMetaType::UChar);
 	serverAddress ()->setValue(1);
 	keepConnecting()->setValue(false);
+	timeout        ()->setDataType(QMetaType::UInt);
+	timeout        ()->setValue(m_timeoutConfigured);
+	numberOfRetries()->setDataType(QMetaType::UInt);
+	numberOfRetries()->setValue(3);
+	adaptiveTimeout()->setValue(m_timeoutAdaptive);
+	diagnosticsEnabled()->setValue(false);
 	// set initial conditions
-	serverAddress ()->setWriteAccess(true);
-	keepConnecting()->setWriteAccess(true);
+	serverAddress  ()->setWriteAccess(true);
+	keepConnecting ()->setWriteAccess(true);
+	timeout        ()->setWriteAccess(true);
+	numberOfRetries()->setWriteAccess(true);
+	adaptiveTimeout()->setWriteAccess(true);
+	diagnosticsEnabled()->setWriteAccess(true);
 	// set descriptions
 	/*
 	type          ()->setDescription(tr("Modbus client communication type (TCP or RTU Serial)."));
 	serverAddress ()->setDescription(tr("Modbus server Device Id or Modbus address."));
 	keepConnecting()->setDescription(tr("Whether the client should try to keep connecting after connection failure"));
+	timeout        ()->setDescription(tr("Time (in milliseconds) to wait for a reply before the request is considered timed out."));
+	numberOfRetries()->setDescription(tr("Number of times a request is resent after a timeout before failing."));
+	adaptiveTimeout()->setDescription(tr("Whether the timeout adapts to the measured round trip time (Timeout is then the upper limit)."));
+	diagnosticsEnabled()->setDescription(tr("Whether communication metrics are published in Diagnostics objects of the client and its blocks."));
 	state         ()->setDescription(tr("Modbus connection state."));
 	lastError     ()->setDescription(tr("Last error occured at connection level."));
+	circuitState    ()->setDescription(tr("Whether polling is allowed (Closed), stopped because the device is dead (Open) or probing (HalfOpen)."));
+	reconnectCount  ()->setDescription(tr("Number of reconnection attempts made so far."));
+	reconnectBackoff()->setDescription(tr("Current delay (in milliseconds) before the next reconnection attempt."));
+	workerLag       ()->setDescription(tr("Time (in milliseconds) a task waits in the worker thread event loop before it executes."));
+	workerQueueDepth()->setDescription(tr("Number of tasks waiting in the worker thread queue."));
 	dataBlocks    ()->setDescription(tr("List of Modbus data blocks updated through polling."));
 	*/
 	// handle changes
 	QObject::connect(serverAddress() , &QUaBaseVariable::valueChanged, this, &QUaModbusClient::on_serverAddressChanged , Qt::QueuedConnection);
 	QObject::connect(keepConnecting(), &QUaBaseVariable::valueChanged, this, &QUaModbusClient::on_keepConnectingChanged, Qt::QueuedConnection);
+	QObject::connect(timeout        (), &QUaBaseVariable::valueChanged, this, &QUaModbusClient::on_timeoutChanged        , Qt::QueuedConnection);
+	QObject::connect(numberOfRetries(), &QUaBaseVariable::valueChanged, this, &QUaModbusClient::on_numberOfRetriesChanged, Qt::QueuedConnection);
+	QObject::connect(adaptiveTimeout(), &QUaBaseVariable::valueChanged, this, &QUaModbusClient::on_adaptiveTimeoutChanged, Qt::QueuedConnection);
+	QObject::connect(diagnosticsEnabled(), &QUaBaseVariable::valueChanged, this, &QUaModbusClient::on_diagnosticsEnabledChanged, Qt::QueuedConnection);
+	// to safely update circuit state in ua server thread
+	QObject::connect(this, &QUaModbusClient::updateCircuitState, this, &QUaModbusClient::on_updateCircuitState);
+	// delayed reconnection
+	m_lagClock.start();
+	m_reconnectTimer.setSingleShot(true);
+	QObject::connect(&m_reconnectTimer, &QTimer::timeout, this, &QUaModbusClient::on_reconnectTimeout);
+	// periodic publishing of metrics
+	QObject::connect(&m_diagnosticsTimer, &QTimer::timeout, this, &QUaModbusClient::on_diagnosticsTimeout);
 }
 
 QUaModbusClient::~QUaModbusClient()
 {
 	emit this->aboutToDestroy();
+	// free its slot in the startup ramp
+	auto list = this->list();
+	if (list)
+	{
+		list->dequeueConnect(this);
+	}
 	emit m_dataBlocks->aboutToClear();
 	// delete while client still valid, because in views blocks reference parent client
 	for (auto block : m_dataBlocks->blocks())
@@ -94,6 +195,46 @@ QUaProperty * QUaModbusClient::keepConnecting()
 	return m_keepConnecting;
 }
 
+QUaProperty * QUaModbusClient::timeout()
+{
+	QMutexLocker locker(&this->m_mutex);
+	if (!m_timeout)
+	{
+		m_timeout = this->browseChild<QUaProperty>("Timeout");
+	}
+	return m_timeout;
+}
+
+QUaProperty * QUaModbusClient::numberOfRetries()
+{
+	QMutexLocker locker(&this->m_mutex);
+	if (!m_numberOfRetries)
+	{
+		m_numberOfRetries = this->browseChild<QUaProperty>("NumberOfRetries");
+	}
+	return m_numberOfRetries;
+}
+
+QUaProperty * QUaModbusClient::adaptiveTimeout()
+{
+	QMutexLocker locker(&this->m_mutex);
+	if (!m_adaptiveTimeout)
+	{
+		m_adaptiveTimeout = this->browseChild<QUaProperty>("AdaptiveTimeout");
+	}
+	return m_adaptiveTimeout;
+}
+
+QUaProperty * QUaModbusClient::diagnosticsEnabled()
+{
+	QMutexLocker locker(&this->m_mutex);
+	if (!m_diagnosticsEnabled)
+	{
+		m_diagnosticsEnabled = this->browseChild<QUaProperty>("DiagnosticsEnabled");
+	}
+	return m_diagnosticsEnabled;
+}
+
 QUaBaseDataVariable * QUaModbusClient::state()
 {
 	QMutexLocker locker(&this->m_mutex);
@@ -114,6 +255,56 @@ QUaBaseDataVariable * QUaModbusClient::lastError()
 	return m_lastError;
 }
 
+QUaBaseDataVariable * QUaModbusClient::circuitState()
+{
+	QMutexLocker locker(&this->m_mutex);
+	if (!m_circuitState)
+	{
+		m_circuitState = this->browseChild<QUaBaseDataVariable>("CircuitState");
+	}
+	return m_circuitState;
+}
+
+QUaBaseDataVariable * QUaModbusClient::reconnectCount()
+{
+	QMutexLocker locker(&this->m_mutex);
+	if (!m_reconnectCount)
+	{
+		m_reconnectCount = this->browseChild<QUaBaseDataVariable>("ReconnectCount");
+	}
+	return m_reconnectCount;
+}
+
+QUaBaseDataVariable * QUaModbusClient::reconnectBackoff()
+{
+	QMutexLocker locker(&this->m_mutex);
+	if (!m_reconnectBackoff)
+	{
+		m_reconnectBackoff = this->browseChild<QUaBaseDataVariable>("ReconnectBackoff");
+	}
+	return m_reconnectBackoff;
+}
+
+QUaBaseDataVariable * QUaModbusClient::workerLag()
+{
+	QMutexLocker locker(&this->m_mutex);
+	if (!m_workerLag)
+	{
+		m_workerLag = this->browseChild<QUaBaseDataVariable>("WorkerLag");
+	}
+	return m_workerLag;
+}
+
+QUaBaseDataVariable * QUaModbusClient::workerQueueDepth()
+{
+	QMutexLocker locker(&this->m_mutex);
+	if (!m_workerQueueDepth)
+	{
+		m_workerQueueDepth = this->browseChild<QUaBaseDataVariable>("WorkerQueueDepth");
+	}
+	return m_workerQueueDepth;
+}
+
 QUaModbusDataBlockList * QUaModbusClient::dataBlocks()
 {
 	QMutexLocker locker(&this->m_mutex);
@@ -140,21 +331,47 @@ void QUaModbusClient::connectDevice()
 		return;
 	}
 	// exec in thread, for thread-safety
-	m_workerThread.execInThread([this]() {
+	this->execInThread([this]() {
 		m_modbusClient->connectDevice();
 	});
 }
 
+void QUaModbusClient::startConnect()
+{
+	this->connectDevice();
+}
+
+void QUaModbusClient::reconnectDevice()
+{
+	if (this->getState() == QModbusState::UnconnectedState)
+	{
+		return;
+	}
+	// NOTE : connect in on_stateChanged, after the disconnection reset the modbus client with the new parameters
+	m_reconnectRequested = true;
+	this->disconnectDevice();
+}
+
 void QUaModbusClient::disconnectDevice()
 {
 	QMutexLocker locker(&m_mutex);
+	// cancel pending reconnection, also if waiting in startup ramp or for a host lookup
+	m_reconnectTimer.stop();
+	m_connectGeneration++;
+	auto list = this->list();
+	if (list)
+	{
+		list->dequeueConnect(this);
+	}
+	m_backoffAttempts = 0;
+	this->reconnectBackoff()->setValue(0);
 	// check if same
 	if (this->getState() == QModbusState::UnconnectedState)
 	{
 		return;
 	}
 	// exec in thread, for thread-safety
-	m_workerThread.execInThread([this]() {
+	this->execInThread([this]() {
 		// NOTE : reset pointer in order to reduce "ClosingState" large timeouts 
 		//        for requested disconnections on unexisting servers
 		m_disconnectRequested = true;
@@ -193,6 +410,58 @@ void QUaModbusClient::setKeepConnecting(const bool & keepConnecting)
 	this->on_keepConnectingChanged(keepConnecting, true);
 }
 
+quint32 QUaModbusClient::getTimeout() const
+{
+	QMutexLocker locker(&(const_cast<QUaModbusClient*>(this)->m_mutex));
+	return const_cast<QUaModbusClient*>(this)->timeout()->value().value<quint32>();
+}
+
+void QUaModbusClient::setTimeout(const quint32 & timeout)
+{
+	QMutexLocker locker(&m_mutex);
+	this->timeout()->setValue(timeout);
+	this->on_timeoutChanged(timeout, true);
+}
+
+quint32 QUaModbusClient::getNumberOfRetries() const
+{
+	QMutexLocker locker(&(const_cast<QUaModbusClient*>(this)->m_mutex));
+	return const_cast<QUaModbusClient*>(this)->numberOfRetries()->value().value<quint32>();
+}
+
+void QUaModbusClient::setNumberOfRetries(const quint32 & numberOfRetries)
+{
+	QMutexLocker locker(&m_mutex);
+	this->numberOfRetries()->setValue(numberOfRetries);
+	this->on_numberOfRetriesChanged(numberOfRetries, true);
+}
+
+bool QUaModbusClient::getAdaptiveTimeout() const
+{
+	QMutexLocker locker(&(const_cast<QUaModbusClient*>(this)->m_mutex));
+	return const_cast<QUaModbusClient*>(this)->adaptiveTimeout()->value().toBool();
+}
+
+void QUaModbusClient::setAdaptiveTimeout(const bool & adaptiveTimeout)
+{
+	QMutexLocker locker(&m_mutex);
+	this->adaptiveTimeout()->setValue(adaptiveTimeout);
+	this->on_adaptiveTimeoutChanged(adaptiveTimeout, true);
+}
+
+bool QUaModbusClient::getDiagnosticsEnabled() const
+{
+	QMutexLocker locker(&(const_cast<QUaModbusClient*>(this)->m_mutex));
+	return const_cast<QUaModbusClient*>(this)->diagnosticsEnabled()->value().toBool();
+}
+
+void QUaModbusClient::setDiagnosticsEnabled(const bool & diagnosticsEnabled)
+{
+	QMutexLocker locker(&m_mutex);
+	this->diagnosticsEnabled()->setValue(diagnosticsEnabled);
+	this->on_diagnosticsEnabledChanged(diagnosticsEnabled, true);
+}
+
 QModbusError QUaModbusClient::getLastError() const
 {
 	QMutexLocker locker(&(const_cast<QUaModbusClient*>(this)->m_mutex));
@@ -205,6 +474,42 @@ void QUaModbusClient::setLastError(const QModbusError & error)
 	this->on_errorChanged(error);
 }
 
+QModbusCircuitState QUaModbusClient::getCircuitState() const
+{
+	QMutexLocker locker(&(const_cast<QUaModbusClient*>(this)->m_mutex));
+	return const_cast<QUaModbusClient*>(this)->circuitState()->value().value<QModbusCircuitState>();
+}
+
+quint32 QUaModbusClient::getReconnectCount() const
+{
+	QMutexLocker locker(&(const_cast<QUaModbusClient*>(this)->m_mutex));
+	return const_cast<QUaModbusClient*>(this)->reconnectCount()->value().value<quint32>();
+}
+
+quint32 QUaModbusClient::getReconnectBackoff() const
+{
+	QMutexLocker locker(&(const_cast<QUaModbusClient*>(this)->m_mutex));
+	return const_cast<QUaModbusClient*>(this)->reconnectBackoff()->value().value<quint32>();
+}
+
+double QUaModbusClient::getWorkerLag() const
+{
+	QMutexLocker locker(&(const_cast<QUaModbusClient*>(this)->m_mutex));
+	return const_cast<QUaModbusClient*>(this)->workerLag()->value().toDouble();
+}
+
+quint32 QUaModbusClient::getWorkerQueueDepth() const
+{
+	QMutexLocker locker(&(const_cast<QUaModbusClient*>(this)->m_mutex));
+	return const_cast<QUaModbusClient*>(this)->workerQueueDepth()->value().value<quint32>();
+}
+
+const QUaModbusMetrics & QUaModbusClient::metrics() const
+{
+	// NOTE : atomics, no lock needed
+	return m_metrics;
+}
+
 QUaModbusClientList * QUaModbusClient::list() const
 {
 	QMutexLocker locker(&(const_cast<QUaModbusClient*>(this)->m_mutex));
@@ -219,13 +524,14 @@ QModbusClientType QUaModbusClient::getType() const
 
 QModbusState QUaModbusClient::getState() const
 {
-	QMutexLocker locker(&(const_cast<QUaModbusClient*>(this)->m_mutex));
-	return const_cast<QUaModbusClient*>(this)->state()->value().value<QModbusState>();
+	// NOTE : lock-free, called by polling loops in every cycle
+	return static_cast<QModbusState>(m_stateCache.loadAcquire());
 }
 
 void QUaModbusClient::setState(const QModbusState & state)
 {
 	QMutexLocker locker(&m_mutex);
+	m_stateCache.storeRelease(state);
 	this->state()->setValue(state);
 	// NOTE : need to add custom signal because OPC UA valueChanged
 	//        only works for changes through network
@@ -235,6 +541,18 @@ void QUaModbusClient::setState(const QModbusState & state)
 
 void QUaModbusClient::resetModbusClient()
 {
+	// NOTE : exec'd in thread, learned round trip time survives the new instance
+	m_timeoutConfigured = this->getTimeout();
+	m_timeoutAdaptive   = this->getAdaptiveTimeout();
+	m_modbusClient->setNumberOfRetries(static_cast<int>(this->getNumberOfRetries()));
+	this->updateTimeout();
+	// tcp mbap header, or rtu address and crc
+	m_aduOverhead = qobject_cast<QModbusTcpClient*>(m_modbusClient.data()) ? 7 : 3;
+	// update lock-free state as soon as it changes in thread
+	QObject::connect(m_modbusClient.data(), &QModbusClient::stateChanged, m_modbusClient.data(),
+	[this](QModbusState state) {
+		m_stateCache.storeRelease(state);
+	});
 	// subscribe to events
 	QObject::connect(m_modbusClient.data(), &QModbusClient::stateChanged , this, &QUaModbusClient::on_stateChanged, Qt::QueuedConnection);
 	QObject::connect(m_modbusClient.data(), &QModbusClient::errorOccurred, this, &QUaModbusClient::on_errorChanged, Qt::QueuedConnection);
@@ -263,8 +581,12 @@ void QUaModbusClient::on_serverAddressChanged(const QVariant & value, const bool
 	{
 		return;
 	}
+	// update polling loops config
+	QUaModbusClientConfig config = *m_config.load();
+	config.serverAddress = value.value<quint8>();
+	m_config.store(config, m_workerThread);
 	// emit
-	emit this->serverAddressChanged(value.value<quint8>());
+	emit this->serverAddressChanged(config.serverAddress);
 }
 
 void QUaModbusClient::on_keepConnectingChanged(const QVariant & value, const bool& networkChange)
@@ -274,17 +596,322 @@ void QUaModbusClient::on_keepConnectingChanged(const QVariant & value, const boo
 	{
 		return;
 	}
+	// cancel pending reconnection
+	if (!value.toBool() && this->getState() == QModbusState::UnconnectedState)
+	{
+		m_reconnectTimer.stop();
+	}
 	// emit
 	emit this->keepConnectingChanged(value.toBool());
 }
 
+void QUaModbusClient::on_timeoutChanged(const QVariant & value, const bool& networkChange)
+{
+	if (!networkChange)
+	{
+		return;
+	}
+	// do not allow less than minimum
+	auto timeout = value.value<quint32>();
+	if (timeout < QUaModbusClient::m_minTimeout)
+	{
+		// set minumum
+		this->timeout()->setValue(QUaModbusClient::m_minTimeout);
+		timeout = QUaModbusClient::m_minTimeout;
+	}
+	// set in thread, for thread-safety
+	this->execInThread([this, timeout]() {
+		m_timeoutConfigured = timeout;
+		this->updateTimeout();
+	});
+	// emit
+	emit this->timeoutChanged(timeout);
+}
+
+void QUaModbusClient::on_numberOfRetriesChanged(const QVariant & value, const bool& networkChange)
+{
+	if (!networkChange)
+	{
+		return;
+	}
+	auto numberOfRetries = value.value<quint32>();
+	// set in thread, for thread-safety
+	this->execInThread([this, numberOfRetries]() {
+		m_modbusClient->setNumberOfRetries(static_cast<int>(numberOfRetries));
+	});
+	// emit
+	emit this->numberOfRetriesChanged(numberOfRetries);
+}
+
+void QUaModbusClient::on_adaptiveTimeoutChanged(const QVariant & value, const bool& networkChange)
+{
+	if (!networkChange)
+	{
+		return;
+	}
+	auto adaptiveTimeout = value.toBool();
+	// set in thread, for thread-safety
+	this->execInThread([this, adaptiveTimeout]() {
+		// start learning from scratch
+		m_timeoutAdaptive = adaptiveTimeout;
+		m_rttSampled      = false;
+		this->updateTimeout();
+	});
+	// emit
+	emit this->adaptiveTimeoutChanged(adaptiveTimeout);
+}
+
+void QUaModbusClient::on_diagnosticsEnabledChanged(const QVariant & value, const bool & networkChange)
+{
+	if (!networkChange)
+	{
+		return;
+	}
+	auto diagnosticsEnabled = value.toBool();
+	// metrics are always counted, only publishing is optional
+	if (diagnosticsEnabled)
+	{
+		m_diagnosticsTimer.start(static_cast<int>(QUaModbusClient::m_diagnosticsPeriod));
+	}
+	else
+	{
+		m_diagnosticsTimer.stop();
+	}
+	this->updateDiagnostics(diagnosticsEnabled);
+	// emit
+	emit this->diagnosticsEnabledChanged(diagnosticsEnabled);
+}
+
+void QUaModbusClient::on_diagnosticsTimeout()
+{
+	this->updateDiagnostics(true);
+}
+
+void QUaModbusClient::updateDiagnostics(const bool & enabled)
+{
+	// add or remove diagnostics objects on demand
+	if (!enabled)
+	{
+		delete m_diagnostics;
+		m_diagnostics = nullptr;
+	}
+	else
+	{
+		if (!m_diagnostics)
+		{
+			m_diagnostics = this->addChild<QUaModbusDiagnostics>("Diagnostics");
+		}
+		m_diagnostics->update(m_metrics);
+	}
+	// also blocks added in between
+	for (auto block : this->dataBlocks()->blocks())
+	{
+		block->updateDiagnostics(enabled);
+	}
+}
+
+void QUaModbusClient::updateLoopMonitor()
+{
+	auto now    = m_lagClock.nsecsElapsed();
+	auto posted = m_lagProbePosted.loadAcquire();
+	// a probe still pending means the worker is at least this late
+	auto lag = posted >= 0 ? now - posted : m_lagMeasured.loadAcquire();
+	this->workerLag()->setValue(lag / 1000000.0);
+	this->workerQueueDepth()->setValue(static_cast<quint32>(qMax(0, m_workerTasksPending.loadAcquire())));
+	if (posted >= 0)
+	{
+		return;
+	}
+	// post next probe, time from posted to executed is the lag
+	m_lagProbePosted.storeRelease(now);
+	m_workerThread.execInThread([this, now]() {
+		m_lagMeasured.storeRelease(m_lagClock.nsecsElapsed() - now);
+		m_lagProbePosted.storeRelease(-1);
+	});
+}
+
+void QUaModbusClient::trackReply(QModbusReply * reply, const quint32 & requestSize, QSharedPointer<QUaModbusMetrics> blockMetrics)
+{
+	QElapsedTimer timer;
+	timer.start();
+	// count request on the wire
+	m_metrics.addRequest(requestSize + m_aduOverhead);
+	if (blockMetrics)
+	{
+		blockMetrics->addRequest(requestSize + m_aduOverhead);
+	}
+	// NOTE : reply lives in worker thread, so lambda is exec'd in worker thread
+	QObject::connect(reply, &QModbusReply::finished, reply,
+	[this, reply, timer, blockMetrics]() {
+		// reply handler is now queued in ua server thread
+		m_repliesPending.ref();
+		auto error = reply->error();
+		// count reply (block metrics kept alive by shared pointer if block was removed)
+		auto rtt   = timer.elapsed();
+		auto pdu   = reply->rawResult();
+		auto bytes = pdu.isValid() ? static_cast<quint32>(pdu.size()) + m_aduOverhead : 0;
+		m_metrics.addReply(reply, bytes, rtt);
+		if (blockMetrics)
+		{
+			blockMetrics->addReply(reply, bytes, rtt);
+		}
+		// supervise connection
+		this->updateCircuit(error);
+		if (!m_timeoutAdaptive)
+		{
+			return;
+		}
+		// back off exponentially until configured timeout if server is slower than expected
+		if (error == QModbusError::TimeoutError)
+		{
+			m_timeoutCurrent = qMin(2 * m_timeoutCurrent, static_cast<int>(m_timeoutConfigured));
+			m_modbusClient->setTimeout(m_timeoutCurrent);
+			return;
+		}
+		// exception responses are also valid round trips
+		if (error != QModbusError::NoError && error != QModbusError::ProtocolError)
+		{
+			return;
+		}
+		// ignore ambiguous samples of requests that were retried (Karn's algorithm)
+		if (rtt >= m_timeoutCurrent)
+		{
+			return;
+		}
+		this->updateRoundTripTime(rtt);
+	});
+	// NOTE : owned by the client, so the count is right even if the block or value that sent
+	//        the request is deleted before its queued handler runs
+	QObject::connect(reply, &QModbusReply::finished, this,
+	[this]() {
+		m_repliesPending.deref();
+	}, Qt::QueuedConnection);
+}
+
+void QUaModbusClient::updateCircuit(const QModbusError & error)
+{
+	m_probeInFlight = false;
+	// ignore late replies of requests sent before circuit opened
+	if (m_circuitStateCache == QModbusCircuitState::Open)
+	{
+		return;
+	}
+	// consecutive timeouts mean dead peer, failed probe means still dead
+	if (error == QModbusError::TimeoutError)
+	{
+		m_consecutiveTimeouts++;
+		if (m_circuitStateCache == QModbusCircuitState::HalfOpen ||
+			m_consecutiveTimeouts >= QUaModbusClient::m_maxConsecutiveTimeouts)
+		{
+			m_circuitStateCache = QModbusCircuitState::Open;
+			emit this->updateCircuitState(m_circuitStateCache);
+		}
+		return;
+	}
+	// NOTE : connection errors are handled by state changes
+	if (error != QModbusError::NoError && error != QModbusError::ProtocolError)
+	{
+		return;
+	}
+	// any reply means the device is alive
+	m_consecutiveTimeouts = 0;
+	if (m_circuitStateCache == QModbusCircuitState::Closed)
+	{
+		return;
+	}
+	m_circuitStateCache = QModbusCircuitState::Closed;
+	emit this->updateCircuitState(m_circuitStateCache);
+}
+
+bool QUaModbusClient::requestAllowed()
+{
+	switch (m_circuitStateCache)
+	{
+	case QModbusCircuitState::Closed:
+		return true;
+	case QModbusCircuitState::HalfOpen:
+		// only one probe at a time
+		if (m_probeInFlight)
+		{
+			return false;
+		}
+		m_probeInFlight = true;
+		return true;
+	default:
+		return false;
+	}
+}
+
+void QUaModbusClient::updateRoundTripTime(const qint64 & rtt)
+{
+	// exponentially weighted mean and variance of round trip time
+	if (!m_rttSampled)
+	{
+		m_rttMean     = rtt;
+		m_rttVariance = (rtt * rtt) / 4.0;
+		m_rttSampled  = true;
+	}
+	else
+	{
+		double diff   = rtt - m_rttMean;
+		m_rttMean    += m_rttGain * diff;
+		m_rttVariance = (1.0 - m_rttGain) * (m_rttVariance + m_rttGain * diff * diff);
+	}
+	this->updateTimeout();
+}
+
+void QUaModbusClient::updateTimeout()
+{
+	int timeout = static_cast<int>(m_timeoutConfigured);
+	// mean + k * stddev, bounded by [minimum, configured]
+	if (m_timeoutAdaptive && m_rttSampled)
+	{
+		timeout = qBound(
+			static_cast<int>(QUaModbusClient::m_minTimeout),
+			qCeil(m_rttMean + m_rttDeviations * qSqrt(m_rttVariance)),
+			static_cast<int>(m_timeoutConfigured)
+		);
+	}
+	if (timeout == m_timeoutCurrent && m_modbusClient->timeout() == timeout)
+	{
+		return;
+	}
+	m_timeoutCurrent = timeout;
+	m_modbusClient->setTimeout(m_timeoutCurrent);
+}
+
 void QUaModbusClient::on_stateChanged(QModbusState state)
 {
 	this->setState(state);
+	// attempt finished, next client of the startup ramp can connect
+	if (state == QModbusState::ConnectedState || state == QModbusState::UnconnectedState)
+	{
+		auto list = this->list();
+		if (list)
+		{
+			list->dequeueConnect(this);
+		}
+	}
 	// no error if connected correctly
 	if (state == QModbusState::ConnectedState)
 	{
 		this->setLastError(QModbusError::NoError);
+		// probe before resuming all polling if reconnected after failure
+		// NOTE : with no blocks there would be no probe, so the connection itself closes the circuit
+		auto circuitState = m_backoffAttempts > 0 && !this->dataBlocks()->blocks().isEmpty() ? 
+			QModbusCircuitState::HalfOpen : 
+			QModbusCircuitState::Closed;
+		if (circuitState == QModbusCircuitState::Closed)
+		{
+			m_backoffAttempts = 0;
+			this->reconnectBackoff()->setValue(0);
+		}
+		this->execInThread([this, circuitState]() {
+			m_consecutiveTimeouts = 0;
+			m_probeInFlight       = false;
+			m_circuitStateCache   = circuitState;
+			emit this->updateCircuitState(circuitState);
+		});
 	}
 	// only allow to write connection params if not connected
 	if (state == QModbusState::UnconnectedState)
@@ -294,26 +921,126 @@ void QUaModbusClient::on_stateChanged(QModbusState state)
 		bool keepConnecting = this->keepConnecting()->value().toBool();
 		if (keepConnecting && !m_disconnectRequested)
 		{
-			this->connectDevice();
+			this->scheduleReconnect();
 		}
 		m_disconnectRequested = false;
+		if (m_reconnectRequested)
+		{
+			m_reconnectRequested = false;
+			this->connectDevice();
+		}
 	}
 	else
 	{
 		serverAddress()->setWriteAccess(false);
 	}
-	// update block errors
+	// resume polling
+	auto blocks = this->dataBlocks()->blocks();
 	if (state == QModbusState::ConnectedState)
 	{
+		// NOTE : first reads are spread instead of sent in a burst on connect
+		for (int i = 0; i < blocks.count(); i++)
+		{
+			auto block = blocks.at(i);
+			QTimer::singleShot(static_cast<int>(i * QUaModbusClient::m_resumeStagger), block, [block]() {
+				block->resumeLoop();
+			});
+		}
 		return;
 	}
-	auto blocks = this->dataBlocks()->blocks();
+	// suspend polling and update block errors once
 	for (int i = 0; i < blocks.count(); i++)
 	{
+		blocks.at(i)->suspendLoop();
 		blocks.at(i)->setLastError(QModbusError::ConnectionError);
 	}
 }
 
+void QUaModbusClient::on_updateCircuitState(const QModbusCircuitState & circuitState)
+{
+	if (circuitState == this->getCircuitState())
+	{
+		return;
+	}
+	this->circuitState()->setValue(circuitState);
+	// emit
+	emit this->circuitStateChanged(circuitState);
+	switch (circuitState)
+	{
+	case QModbusCircuitState::Closed:
+		// device alive, start over
+		m_backoffAttempts = 0;
+		this->reconnectBackoff()->setValue(0);
+		break;
+	case QModbusCircuitState::Open:
+		if (this->getKeepConnecting())
+		{
+			// drop dead connection, reconnect is scheduled when unconnected
+			this->execInThread([this]() {
+				m_modbusClient->disconnectDevice();
+			});
+		}
+		else
+		{
+			// probe again after backoff on same connection
+			this->scheduleReconnect();
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+void QUaModbusClient::on_reconnectTimeout()
+{
+	// probe if still connected
+	if (this->getState() == QModbusState::ConnectedState)
+	{
+		this->execInThread([this]() {
+			if (m_circuitStateCache != QModbusCircuitState::Open)
+			{
+				return;
+			}
+			m_probeInFlight     = false;
+			m_circuitStateCache = QModbusCircuitState::HalfOpen;
+			emit this->updateCircuitState(m_circuitStateCache);
+		});
+		return;
+	}
+	if (!this->getKeepConnecting())
+	{
+		return;
+	}
+	this->reconnectCount()->setValue(this->getReconnectCount() + 1);
+	// NOTE : reconnects after a network outage go through the ramp as well
+	auto list = this->list();
+	if (list)
+	{
+		list->queueConnect(this);
+		return;
+	}
+	this->startConnect();
+}
+
+void QUaModbusClient::scheduleReconnect()
+{
+	// exponential backoff with equal jitter, avoids reconnect storms
+	quint32 backoff = QUaModbusClient::m_minReconnectBackoff;
+	for (quint32 i = 0; i < m_backoffAttempts && backoff < QUaModbusClient::m_maxReconnectBackoff; i++)
+	{
+		backoff *= 2;
+	}
+	backoff = qMin(backoff, QUaModbusClient::m_maxReconnectBackoff);
+#if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
+	backoff = backoff / 2 + QRandomGenerator::global()->bounded(backoff / 2 + 1);
+#else
+	backoff = backoff / 2 + static_cast<quint32>(qrand()) % (backoff / 2 + 1);
+#endif
+	m_backoffAttempts++;
+	this->reconnectBackoff()->setValue(backoff);
+	m_reconnectTimer.start(static_cast<int>(backoff));
+}
+
 // NOTE : need to add custom signal because OPC UA valueChanged
 //        only works for changes through network
 void QUaModbusClient::on_errorChanged(QModbusError error)
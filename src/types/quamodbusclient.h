@@ -7,6 +7,8 @@
 #include <QSerialPort>
 #include <QMutex>
 #include <QSharedPointer>
+#include <QTimer>
+#include <QElapsedTimer>
 
 #include <QLambdaThreadWorker>
 
@@ -23,6 +25,9 @@
 #include <QDomElement>
 
 #include "quamodbusdatablocklist.h"
+#include "quamodbussnapshot.h"
+#include "quamodbusdiagnostics.h"
+#include "quamodbustrace.h"
 
 class QUaModbusClientList;
 class QUaModbusDataBlock;
@@ -30,6 +35,12 @@ class QUaModbusDataBlock;
 typedef QModbusDevice::State QModbusState;
 typedef QModbusDevice::Error QModbusError;
 
+// configuration read by the polling loops in the worker thread
+struct QUaModbusClientConfig
+{
+	quint8 serverAddress;
+};
+
 #ifndef QUA_ACCESS_CONTROL
 class QUaModbusClient : public QUaBaseObject
 #else
@@ -47,10 +58,19 @@ class QUaModbusClient : public QUaBaseObjectProtected
 	Q_PROPERTY(QUaProperty * Type           READ type          )
 	Q_PROPERTY(QUaProperty * ServerAddress  READ serverAddress )
 	Q_PROPERTY(QUaProperty * KeepConnecting READ keepConnecting)
+	Q_PROPERTY(QUaProperty * Timeout         READ timeout        )
+	Q_PROPERTY(QUaProperty * NumberOfRetries READ numberOfRetries)
+	Q_PROPERTY(QUaProperty * AdaptiveTimeout READ adaptiveTimeout)
+	Q_PROPERTY(QUaProperty * DiagnosticsEnabled READ diagnosticsEnabled)
 
 	// UA variables
 	Q_PROPERTY(QUaBaseDataVariable * State     READ state    )
 	Q_PROPERTY(QUaBaseDataVariable * LastError READ lastError)
+	Q_PROPERTY(QUaBaseDataVariable * CircuitState     READ circuitState    )
+	Q_PROPERTY(QUaBaseDataVariable * ReconnectCount   READ reconnectCount  )
+	Q_PROPERTY(QUaBaseDataVariable * ReconnectBackoff READ reconnectBackoff)
+	Q_PROPERTY(QUaBaseDataVariable * WorkerLag        READ workerLag       )
+	Q_PROPERTY(QUaBaseDataVariable * WorkerQueueDepth READ workerQueueDepth)
 
 	// UA objects
 	Q_PROPERTY(QUaModbusDataBlockList * DataBlocks READ dataBlocks)
@@ -67,16 +87,33 @@ public:
 	Q_ENUM(ClientType)
 	typedef QUaModbusClient::ClientType QModbusClientType;
 
+	enum CircuitState {
+		Closed   = 0, // requests flow normally
+		Open     = 1, // device considered dead, polling stopped until backoff elapses
+		HalfOpen = 2  // a single probe request is allowed to test if device is alive
+	};
+	Q_ENUM(CircuitState)
+	typedef QUaModbusClient::CircuitState QModbusCircuitState;
+
 	// UA properties
 
 	QUaProperty * type();
 	QUaProperty * serverAddress();
 	QUaProperty * keepConnecting();
+	QUaProperty * timeout();
+	QUaProperty * numberOfRetries();
+	QUaProperty * adaptiveTimeout();
+	QUaProperty * diagnosticsEnabled();
 
 	// UA variables
 
 	QUaBaseDataVariable * state();
 	QUaBaseDataVariable * lastError();
+	QUaBaseDataVariable * circuitState();
+	QUaBaseDataVariable * reconnectCount();
+	QUaBaseDataVariable * reconnectBackoff();
+	QUaBaseDataVariable * workerLag();
+	QUaBaseDataVariable * workerQueueDepth();
 
 	// UA objects
 
@@ -101,49 +138,179 @@ public:
 	bool   getKeepConnecting() const;
 	void   setKeepConnecting(const bool &keepConnecting);
 
+	quint32 getTimeout() const;
+	void    setTimeout(const quint32 &timeout);
+
+	quint32 getNumberOfRetries() const;
+	void    setNumberOfRetries(const quint32 &numberOfRetries);
+
+	bool    getAdaptiveTimeout() const;
+	void    setAdaptiveTimeout(const bool &adaptiveTimeout);
+
+	bool    getDiagnosticsEnabled() const;
+	void    setDiagnosticsEnabled(const bool &diagnosticsEnabled);
+
 	QModbusError getLastError() const;
 	void         setLastError(const QModbusError &error);
 
+	QModbusCircuitState getCircuitState() const;
+
+	quint32 getReconnectCount() const;
+
+	quint32 getReconnectBackoff() const;
+
+	double  getWorkerLag() const;
+
+	quint32 getWorkerQueueDepth() const;
+
+	// counters and round trip time histogram since creation, published or not
+	const QUaModbusMetrics & metrics() const;
+
 	QUaModbusClientList * list() const;
 
     // Fix for GCC : cannot be protected or "virtual is protected within this context" error
     virtual void resetModbusClient();
+	// connection attempt of the startup ramp, see QUaModbusClientList::queueConnect
+	virtual void startConnect();
+	// disconnect and connect again if not unconnected, so changed connection parameters are used
+	void reconnectDevice();
 
 signals:
 	// C++ API
 	void serverAddressChanged (const quint8 &serverAddress );
 	void keepConnectingChanged(const bool   &keepConnecting);
+	void timeoutChanged        (const quint32 &timeout        );
+	void numberOfRetriesChanged(const quint32 &numberOfRetries);
+	void adaptiveTimeoutChanged(const bool    &adaptiveTimeout);
+	void diagnosticsEnabledChanged(const bool &diagnosticsEnabled);
 	void stateChanged    (const QModbusState &state);
 	void lastErrorChanged(const QModbusError &error);
+	void circuitStateChanged(const QModbusCircuitState &circuitState);
 	void aboutToDestroy();
 
+	// (internal) to safely update circuit state in ua server thread
+	void updateCircuitState(const QModbusCircuitState &circuitState);
+
 protected:
 	QMutex m_mutex;
 	QLambdaThreadWorker           m_workerThread;
 	QSharedPointer<QModbusClient> m_modbusClient;
+	// lock-free copies for the polling hot path
+	QAtomicInt                               m_stateCache;
+	QUaModbusSnapshot<QUaModbusClientConfig> m_config;
+	// NOTE : only modified in thread, published as diagnostics in ua server thread
+	QUaModbusMetrics m_metrics;
+	// tasks queued in worker thread and replies queued in ua server thread
+	QAtomicInt m_workerTasksPending;
+	QAtomicInt m_repliesPending;
+	// incremented by disconnectDevice, attempts started before (e.g. waiting for a host lookup) are dropped
+	quint32 m_connectGeneration;
+
+	// NOTE : queue task in worker thread, counted for the event loop monitor
+	template<typename F>
+	void execInThread(F task, Qt::EventPriority priority = Qt::NormalEventPriority);
 
 	// XML import / export
 	// NOTE : cannot be pure virtual, else moc fails
 	virtual QDomElement toDomElement  (QDomDocument & domDoc) const;
 	virtual void        fromDomElement(QDomElement  & domElem, QQueue<QUaLog>& errorLogs);
 
+	// NOTE : only call in thread, measures round trip time of a sent request,
+	//        supervises the connection (circuit breaker) and counts metrics
+	void trackReply(QModbusReply * reply, const quint32 &requestSize, 
+		QSharedPointer<QUaModbusMetrics> blockMetrics = QSharedPointer<QUaModbusMetrics>());
+	void updateCircuit(const QModbusError &error);
+	bool requestAllowed();
+
 private slots:
-	void on_serverAddressChanged (const QVariant & value, const bool& networkChange);
-	void on_keepConnectingChanged(const QVariant & value, const bool& networkChange);
+	void on_serverAddressChanged  (const QVariant & value, const bool& networkChange);
+	void on_keepConnectingChanged (const QVariant & value, const bool& networkChange);
+	void on_timeoutChanged        (const QVariant & value, const bool& networkChange);
+	void on_numberOfRetriesChanged(const QVariant & value, const bool& networkChange);
+	void on_adaptiveTimeoutChanged(const QVariant & value, const bool& networkChange);
+	void on_diagnosticsEnabledChanged(const QVariant & value, const bool& networkChange);
 	void on_stateChanged(QModbusState state);
 	void on_errorChanged(QModbusError error);
+	void on_updateCircuitState(const QModbusCircuitState &circuitState);
+	void on_reconnectTimeout();
+	void on_diagnosticsTimeout();
 
 private:
 	bool m_disconnectRequested;
+	// connect again once unconnected, see reconnectDevice
+	bool m_reconnectRequested;
 	QUaProperty* m_type;
 	QUaProperty* m_serverAddress;
 	QUaProperty* m_keepConnecting;
+	QUaProperty* m_timeout;
+	QUaProperty* m_numberOfRetries;
+	QUaProperty* m_adaptiveTimeout;
+	QUaProperty* m_diagnosticsEnabled;
 	QUaBaseDataVariable* m_state;
 	QUaBaseDataVariable* m_lastError;
+	QUaBaseDataVariable* m_circuitState;
+	QUaBaseDataVariable* m_reconnectCount;
+	QUaBaseDataVariable* m_reconnectBackoff;
+	QUaBaseDataVariable* m_workerLag;
+	QUaBaseDataVariable* m_workerQueueDepth;
 	QUaModbusDataBlockList* m_dataBlocks;
+	QUaModbusDiagnostics*   m_diagnostics;
+	QTimer  m_reconnectTimer;
+	QTimer  m_diagnosticsTimer;
+	quint32 m_backoffAttempts;
+	// NOTE : only modify and access in thread
+	quint32 m_timeoutConfigured;
+	bool    m_timeoutAdaptive;
+	int     m_timeoutCurrent;
+	bool    m_rttSampled;
+	double  m_rttMean;
+	double  m_rttVariance;
+	QModbusCircuitState m_circuitStateCache;
+	quint32 m_consecutiveTimeouts;
+	bool    m_probeInFlight;
+	quint32 m_aduOverhead;
+	QElapsedTimer           m_lagClock;
+	QAtomicInteger<qint64>  m_lagProbePosted;
+	QAtomicInteger<qint64>  m_lagMeasured;
+	bool                    m_lagging;
+
+	void updateRoundTripTime(const qint64 &rtt);
+	void updateTimeout();
+	void scheduleReconnect();
+	void updateDiagnostics(const bool &enabled);
+	// measure worker event loop lag (in ua server thread)
+	void updateLoopMonitor();
+
+	static quint32 m_minTimeout;
+	static double  m_rttGain;
+	static double  m_rttDeviations;
+	static quint32 m_maxConsecutiveTimeouts;
+	static quint32 m_minReconnectBackoff;
+	static quint32 m_maxReconnectBackoff;
+	static quint32 m_diagnosticsPeriod;
+	static quint32 m_resumeStagger;
 };
 
 typedef QUaModbusClient::ClientType QModbusClientType;
+typedef QUaModbusClient::CircuitState QModbusCircuitState;
+
+template<typename F>
+inline void QUaModbusClient::execInThread(F task, Qt::EventPriority priority)
+{
+	m_workerTasksPending.ref();
+	m_workerThread.execInThread([this, task]() mutable {
+		m_workerTasksPending.deref();
+		// trace worker event loop activity
+		if (!QUaModbusTrace::isEnabled())
+		{
+			task();
+			return;
+		}
+		auto traceStarted = QUaModbusTrace::now();
+		task();
+		QUaModbusTrace::addSpan("worker task", QString(), traceStarted, QUaModbusTrace::now());
+	}, priority);
+}
 
 #endif // QUAMODBUSCLIENT_H
 
@@ -1,5 +1,10 @@
 QT += core serialbus serialport network xml
 
+# tcp keep-alive settings (see QUaModbusTcpClient::setKeepAlive)
+win32 {
+	LIBS += -lws2_32
+}
+
 CONFIG += c++11
 
 INCLUDEPATH += $$PWD/
@@ -12,7 +17,18 @@ HEADERS += \
 	$$PWD/quamodbusdatablocklist.h \
 	$$PWD/quamodbusdatablock.h \
 	$$PWD/quamodbusvaluelist.h \
-	$$PWD/quamodbusvalue.h
+	$$PWD/quamodbusvalue.h \
+	$$PWD/quamodbussnapshot.h \
+	$$PWD/quamodbusdiagnostics.h \
+	$$PWD/quamodbustrace.h \
+	$$PWD/quamodbusbinaryconfig.h \
+	$$PWD/quamodbuscsv.h \
+	$$PWD/quamodbusconfigvalidator.h \
+	$$PWD/quamodbusserialportregistry.h \
+	$$PWD/quamodbusvaluecache.h \
+	$$PWD/quamodbushostcache.h \
+	$$PWD/quamodbushistorian.h \
+	$$PWD/quamodbushistorystore.h
 
 SOURCES += \
 	$$PWD/quamodbusclientlist.cpp \
@@ -22,4 +38,14 @@ SOURCES += \
 	$$PWD/quamodbusdatablocklist.cpp \
 	$$PWD/quamodbusdatablock.cpp \
 	$$PWD/quamodbusvaluelist.cpp \
-	$$PWD/quamodbusvalue.cpp
+	$$PWD/quamodbusvalue.cpp \
+	$$PWD/quamodbusdiagnostics.cpp \
+	$$PWD/quamodbustrace.cpp \
+	$$PWD/quamodbusbinaryconfig.cpp \
+	$$PWD/quamodbuscsv.cpp \
+	$$PWD/quamodbusconfigvalidator.cpp \
+	$$PWD/quamodbusserialportregistry.cpp \
+	$$PWD/quamodbusvaluecache.cpp \
+	$$PWD/quamodbushostcache.cpp \
+	$$PWD/quamodbushistorian.cpp \
+	$$PWD/quamodbushistorystore.cpp
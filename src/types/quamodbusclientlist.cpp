@@ -9,13 +9,33 @@
 #include "quamodbusvaluelist.h"
 #include "quamodbusvalue.h"
 
+#include "quamodbustrace.h"
+#include "quamodbusbinaryconfig.h"
+#include "quamodbuscsv.h"
+#include "quamodbusconfigvalidator.h"
+#include "quamodbusserialportregistry.h"
+
 #include <QUaServer>
 
+#include <QBuffer>
+#include <QFile>
+#include <QSet>
+
 #ifdef QUA_ACCESS_CONTROL
 #include <QUaPermissions>
 #include <QUaPermissionsList>
 #endif // QUA_ACCESS_CONTROL
 
+quint32 QUaModbusClientList::m_monitorPeriod = 1000;
+int     QUaModbusClientList::m_maxRangeIds   = 10000;
+int     QUaModbusClientList::m_importSlice   = 20;
+int     QUaModbusClientList::m_validateDelay = 250;
+int     QUaModbusClientList::m_valueCachePeriod = 5000;
+int     QUaModbusClientList::m_connectTimeout   = 5000;
+const QStringList QUaModbusClientList::m_connectionAttributes = {
+	"NetworkAddress", "NetworkPort", "ComPort", "Parity", "BaudRate", "DataBits", "StopBits"
+};
+
 QUaModbusClientList::QUaModbusClientList(QUaServer *server)
 #ifndef QUA_ACCESS_CONTROL
 	: QUaFolderObject(server)
@@ -30,19 +50,124 @@ QUaModbusClientList::QUaModbusClientList(QUaServer *server)
 	server->registerType<QUaModbusDataBlock      >();
 	server->registerType<QUaModbusValueList      >();
 	server->registerType<QUaModbusValue          >();
+	server->registerType<QUaModbusDiagnostics         >();
+	server->registerType<QUaModbusDataBlockDiagnostics>();
 	// register enums (need to register enums that are not part of custom types)
 	server->registerEnum<QModbusClientType>();
 	server->registerEnum<QModbusState     >();
 	server->registerEnum<QModbusError     >();
+	server->registerEnum<QModbusCircuitState>();
 	server->registerEnum<QParity          >();
 	server->registerEnum<QBaudRate        >();
 	server->registerEnum<QDataBits        >();
 	server->registerEnum<QStopBits        >();
-	server->registerEnum(QUaModbusRtuSerialClient::ComPorts, QUaModbusRtuSerialClient::EnumComPorts());
+	auto registry = QUaModbusSerialPortRegistry::instance();
+	server->registerEnum(QUaModbusRtuSerialClient::ComPorts, registry->ports());
+	// NOTE : keys are stable, so only hotplugged ports need to be added to the enum
+	QObject::connect(registry, &QUaModbusSerialPortRegistry::portAdded, this,
+	[server](const int &portKey, const QString &strPortName) {
+		server->updateEnumEntry(QUaModbusRtuSerialClient::ComPorts, portKey,
+			{
+				{ "", strPortName.toUtf8() },
+				{ "", "" }
+			}
+		);
+	});
+	// event loop monitor
+	m_lagThreshold = nullptr;
+	m_connectConcurrency = nullptr;
+	m_errorStatusCodes = nullptr;
+	m_compactValues = nullptr;
+	m_errorStatusCodesCache = false;
+	m_compactValuesCache    = false;
+#ifdef UA_ENABLE_HISTORIZING
+	m_historyMemoryLimit = nullptr;
+#endif // UA_ENABLE_HISTORIZING
+	m_eventLoopLag = nullptr;
+	m_eventLoopQueueDepth = nullptr;
+	m_lagging = false;
+	// background import
+	m_importWorker   = nullptr;
+	m_importing      = false;
+	m_importDone     = 0;
+	m_importTotal    = 0;
+	m_importProgress = nullptr;
+	importProgress()->setDataType(QMetaType::Double);
+	importProgress()->setValue(0.0);
+	m_importTimer.setSingleShot(true);
+	m_importTimer.setInterval(0);
+	QObject::connect(&m_importTimer, &QTimer::timeout, this, &QUaModbusClientList::on_importTimeout);
+	// config validation
+	m_validateTimer.setSingleShot(true);
+	m_validateTimer.setInterval(QUaModbusClientList::m_validateDelay);
+	QObject::connect(&m_validateTimer, &QTimer::timeout, this, &QUaModbusClientList::on_validateTimeout);
+	// warm start
+	m_valueCacheTimer.setSingleShot(true);
+	m_valueCacheTimer.setInterval(QUaModbusClientList::m_valueCachePeriod);
+	QObject::connect(&m_valueCacheTimer, &QTimer::timeout, this, &QUaModbusClientList::on_valueCacheTimeout);
+	lagThreshold       ()->setDataType(QMetaType::UInt);
+	lagThreshold       ()->setValue(500);
+	lagThreshold       ()->setWriteAccess(true);
+	connectConcurrency ()->setDataType(QMetaType::UInt);
+	connectConcurrency ()->setValue(16);
+	connectConcurrency ()->setWriteAccess(true);
+	errorStatusCodes   ()->setDataType(QMetaType::Bool);
+	errorStatusCodes   ()->setValue(false);
+	errorStatusCodes   ()->setWriteAccess(true);
+	compactValues      ()->setDataType(QMetaType::Bool);
+	compactValues      ()->setValue(false);
+	compactValues      ()->setWriteAccess(true);
+#ifdef UA_ENABLE_HISTORIZING
+	// NOTE : one historian per server, the list owns it so it lives as long as the nodes it serves
+	server->setHistorizer(m_historian);
+	historyMemoryLimit ()->setDataType(QMetaType::UInt);
+	historyMemoryLimit ()->setValue(65536);
+	historyMemoryLimit ()->setWriteAccess(true);
+	m_historian.setMemoryLimit(65536 * 1024ull);
+#endif // UA_ENABLE_HISTORIZING
+	eventLoopLag       ()->setDataType(QMetaType::Double);
+	eventLoopLag       ()->setValue(0.0);
+	eventLoopQueueDepth()->setDataType(QMetaType::UInt);
+	eventLoopQueueDepth()->setValue(0);
+	// set descriptions
+	/*
+	lagThreshold       ()->setDescription(tr("Event loop lag (in milliseconds) above which a warning is logged, zero disables it."));
+	connectConcurrency ()->setDescription(tr("Maximum number of clients connecting at the same time, zero is no limit."));
+	errorStatusCodes   ()->setDescription(tr("Whether errors of blocks and values are the status code of Data and Value instead of LastError variables."));
+	compactValues      ()->setDescription(tr("Whether values only have their Value variable, configured through the setXmlConfig method."));
+	historyMemoryLimit ()->setDescription(tr("Memory (in kilobytes) for the history of all values and blocks, zero is no limit."));
+	eventLoopLag       ()->setDescription(tr("Time (in milliseconds) the ua server thread event loop is behind schedule."));
+	eventLoopQueueDepth()->setDescription(tr("Number of Modbus replies waiting to be handled in the ua server thread."));
+	importProgress     ()->setDescription(tr("Percentage of nodes created by the running or last background import."));
+	*/
+	QObject::connect(lagThreshold(), &QUaBaseVariable::valueChanged, this, &QUaModbusClientList::on_lagThresholdChanged, Qt::QueuedConnection);
+	QObject::connect(connectConcurrency(), &QUaBaseVariable::valueChanged, this, &QUaModbusClientList::on_connectConcurrencyChanged, Qt::QueuedConnection);
+	QObject::connect(errorStatusCodes  (), &QUaBaseVariable::valueChanged, this, &QUaModbusClientList::on_errorStatusCodesChanged  , Qt::QueuedConnection);
+	QObject::connect(compactValues     (), &QUaBaseVariable::valueChanged, this, &QUaModbusClientList::on_compactValuesChanged     , Qt::QueuedConnection);
+#ifdef UA_ENABLE_HISTORIZING
+	QObject::connect(historyMemoryLimit(), &QUaBaseVariable::valueChanged, this, &QUaModbusClientList::on_historyMemoryLimitChanged, Qt::QueuedConnection);
+#endif // UA_ENABLE_HISTORIZING
+	m_connectClock.start();
+	// NOTE : lag of this timer is the lag of the ua server thread
+	m_monitorTimer.setTimerType(Qt::PreciseTimer);
+	QObject::connect(&m_monitorTimer, &QTimer::timeout, this, &QUaModbusClientList::on_monitorTimeout);
+	m_monitorClock.start();
+	m_monitorTimer.start(static_cast<int>(QUaModbusClientList::m_monitorPeriod));
 }
 
 QUaModbusClientList::~QUaModbusClientList()
 {
+	// NOTE : worker deletion waits for the parse, its result is dropped with this object
+	m_importCancel.storeRelease(1);
+	delete m_importWorker;
+	// last values read are not lost, waits for the write
+	this->on_valueCacheTimeout();
+	m_valueCache.reset();
+#ifdef UA_ENABLE_HISTORIZING
+	// last chunks in memory are written down before the store closes
+	m_historian.setStore(nullptr);
+	m_historyStore.reset();
+#endif // UA_ENABLE_HISTORIZING
 	emit this->aboutToDestroy();
 	this->clearInmediatly();
 }
@@ -59,6 +184,9 @@ QString QUaModbusClientList::addRtuSerialClient(const QUaQualifiedName& clientId
 
 void QUaModbusClientList::clear()
 {
+	this->cancelImport();
+	m_connectQueue.clear();
+	m_connectQueued.clear();
 	emit this->aboutToClear();
 	for (auto client : this->clients())
 	{
@@ -68,47 +196,27 @@ void QUaModbusClientList::clear()
 
 QString QUaModbusClientList::xmlConfig()
 {
-	QDomDocument doc;
-	// set xml header
-	QDomProcessingInstruction header = doc.createProcessingInstruction("xml", "version='1.0' encoding='UTF-8'");
-	doc.appendChild(header);
-	// convert config to xml
-	auto elemClients = this->toDomElement(doc);
-	doc.appendChild(elemClients);
+	QBuffer buffer;
+	buffer.open(QIODevice::WriteOnly);
+	this->writeXmlConfig(&buffer);
 	// get config
-	return doc.toByteArray();
+	return QString::fromUtf8(buffer.data());
 }
 
 QString QUaModbusClientList::setXmlConfig(QString strXmlConfig)
 {
 	QQueue<QUaLog> errorLogs;
-	// set to dom doc
-	QDomDocument doc;
-	int line, col;
-	QString strError;
-	doc.setContent(strXmlConfig, &strError, &line, &col);
-	if (!strError.isEmpty())
+	// NOTE : streamed from the string, no dom document of the whole config
+	QXmlStreamReader xmlCheck(strXmlConfig);
+	if (!QUaModbusClientList::checkXml(xmlCheck, errorLogs))
 	{
-		errorLogs << QUaLog(
-			tr("Invalid XML in Line %1 Column %2 Error %3").arg(line).arg(col).arg(strError),
-			QUaLogLevel::Error,
-			QUaLogCategory::Serialization
-		);
 		return QUaLog::toString(errorLogs);
 	}
-	// get list of clients
-	QDomElement elemClientList = doc.firstChildElement(QUaModbusClientList::staticMetaObject.className());
-	if (elemClientList.isNull())
+	QXmlStreamReader xml(strXmlConfig);
+	if (!this->readXmlConfig(xml, errorLogs))
 	{
-		errorLogs << QUaLog(
-			tr("No Modbus client list found in XML config."),
-			QUaLogLevel::Error,
-			QUaLogCategory::Serialization
-		);
 		return QUaLog::toString(errorLogs);
 	}
-	// load config from xml
-	this->fromDomElement(elemClientList, errorLogs);
 	if (!errorLogs.isEmpty())
 	{
 		QUaLog::toString(errorLogs);
@@ -116,210 +224,742 @@ QString QUaModbusClientList::setXmlConfig(QString strXmlConfig)
 	return "Success.";
 }
 
-QString QUaModbusClientList::csvClients()
+QString QUaModbusClientList::importXmlConfig(QString strXmlConfig)
 {
-	QString strCsv;
-#ifndef QUA_ACCESS_CONTROL
-	strCsv += QString("%1, %2, %3, %4, %5, %6\n")
-#else
-	strCsv += QString("%1, %2, %3, %4, %5, %6, %7\n")
-#endif // !QUA_ACCESS_CONTROL
-		.arg(tr("Name"          ))
-		.arg(tr("Type"          ))
-		.arg(tr("ServerAddress" ))
-		.arg(tr("KeepConnecting"))
-		.arg(tr("NetworkAddress"))
-		.arg(tr("NetworkPort"   ))
-#ifndef QUA_ACCESS_CONTROL
-		;
-#else
-		.arg(tr("Permissions"));
-#endif // !QUA_ACCESS_CONTROL
-		
-	auto clientsTcp = this->browseChildren<QUaModbusTcpClient>();
-	for (auto clientTcp : clientsTcp)
+	if (!this->startXmlImport(strXmlConfig.toUtf8()))
 	{
-		auto strType = QString(QMetaEnum::fromType<QModbusClientType>().valueToKey(clientTcp->getType()));
-#ifndef QUA_ACCESS_CONTROL
-		strCsv += QString("%1, %2, %3, %4, %5, %6\n")
-#else
-		strCsv += QString("%1, %2, %3, %4, %5, %6, %7\n")
-#endif // !QUA_ACCESS_CONTROL
-			.arg(clientTcp->browseName().name())
-			.arg(strType)
-			.arg(clientTcp->getServerAddress ())
-			.arg(clientTcp->getKeepConnecting())
-			.arg(clientTcp->getNetworkAddress())
-			.arg(clientTcp->getNetworkPort   ())
-#ifndef QUA_ACCESS_CONTROL
-			;
-#else
-			.arg(clientTcp->permissionsObject() ? clientTcp->permissionsObject()->browseName().name() : "");
-#endif // !QUA_ACCESS_CONTROL	
+		return tr("%1 : An import is already running.").arg("Error");
 	}
-#ifndef QUA_ACCESS_CONTROL
-	strCsv += QString("%1, %2, %3, %4, %5, %6, %7, %8, %9\n")
-#else
-	strCsv += QString("%1, %2, %3, %4, %5, %6, %7, %8, %9, %10\n")
-#endif // !QUA_ACCESS_CONTROL
-	
-		.arg(tr("Name"          ))
-		.arg(tr("Type"          ))
-		.arg(tr("ServerAddress" ))
-		.arg(tr("KeepConnecting"))
-		.arg(tr("ComPort"       ))
-		.arg(tr("Parity"        ))
-		.arg(tr("BaudRate"      ))
-		.arg(tr("DataBits"      ))
-		.arg(tr("StopBits"      ))
-#ifndef QUA_ACCESS_CONTROL
-		;
-#else
-		.arg(tr("Permissions"));
-#endif // !QUA_ACCESS_CONTROL
-	auto clientsSerial = this->browseChildren<QUaModbusRtuSerialClient>();
-	for (auto clientSerial : clientsSerial)
+	return "Success.";
+}
+
+void QUaModbusClientList::cancelImport()
+{
+	if (!m_importing)
 	{
-		auto strType     = QString(QMetaEnum::fromType<QModbusClientType>().valueToKey(clientSerial->getType()));
-		auto strParity   = QString(QMetaEnum::fromType<QParity  >().valueToKey(clientSerial->getParity  ()));
-		auto strBaudRate = QString(QMetaEnum::fromType<QBaudRate>().valueToKey(clientSerial->getBaudRate()));
-		auto strDataBits = QString(QMetaEnum::fromType<QDataBits>().valueToKey(clientSerial->getDataBits()));
-		auto strStopBits = QString(QMetaEnum::fromType<QStopBits>().valueToKey(clientSerial->getStopBits()));
-#ifndef QUA_ACCESS_CONTROL
-		strCsv += QString("%1, %2, %3, %4, %5, %6, %7, %8, %9\n")
-#else
-		strCsv += QString("%1, %2, %3, %4, %5, %6, %7, %8, %9, %10\n")
-#endif // !QUA_ACCESS_CONTROL	
-			.arg(clientSerial->browseName().name())
-			.arg(strType)
-			.arg(clientSerial->getServerAddress ())
-			.arg(clientSerial->getKeepConnecting())
-			.arg(clientSerial->getComPort       ())
-			.arg(strParity)
-			.arg(strBaudRate)
-			.arg(strDataBits)
-			.arg(strStopBits)
-#ifndef QUA_ACCESS_CONTROL
-			;
-#else
-			.arg(clientSerial->permissionsObject() ? clientSerial->permissionsObject()->browseName().name() : "");
-#endif // !QUA_ACCESS_CONTROL	
+		return;
 	}
-	return strCsv;
+	// NOTE : seen by the worker between clients and by the next time slice
+	m_importCancel.storeRelease(1);
 }
 
-QString QUaModbusClientList::csvBlocks()
+bool QUaModbusClientList::startXmlImport(const QByteArray & byteXmlConfig)
 {
-	QString strCsv;
-#ifndef QUA_ACCESS_CONTROL
-	strCsv += QString("%1, %2, %3, %4, %5, %6\n")
-#else
-	strCsv += QString("%1, %2, %3, %4, %5, %6, %7\n")
-#endif // !QUA_ACCESS_CONTROL
-		.arg(tr("Name"        ))
-		.arg(tr("Client"      ))
-		.arg(tr("Type"        ))
-		.arg(tr("Address"     ))
-		.arg(tr("Size"        ))
-		.arg(tr("SamplingTime"))
-#ifndef QUA_ACCESS_CONTROL
-		;
-#else
-		.arg(tr("Permissions"));
-#endif // !QUA_ACCESS_CONTROL
-	auto clients = this->browseChildren<QUaModbusClient>();
-	for (auto client : clients)
+	if (m_importing)
 	{
-		auto blocks = client->dataBlocks()->blocks();
-		for (auto block : blocks)
+		return false;
+	}
+	m_importing = true;
+	m_importCancel.storeRelease(0);
+	m_importSteps.clear();
+	m_importLogs.clear();
+	m_importDone   = 0;
+	m_importTotal  = 0;
+	m_importClient = nullptr;
+	this->importProgress()->setValue(0.0);
+	if (!m_importWorker)
+	{
+		m_importWorker = new QLambdaThreadWorker;
+	}
+	m_importWorker->execInThread([this, byteXmlConfig]() {
+		QQueue<ImportStep> steps;
+		QQueue<QUaLog>     errorLogs;
+		bool ok = QUaModbusClientList::parseXmlImport(byteXmlConfig, steps, errorLogs, m_importCancel);
+		// hand over to the ua server thread, dropped if list is gone
+		QMetaObject::invokeMethod(this, [this, ok, steps, errorLogs]() {
+			m_importLogs << errorLogs;
+			// NOTE : nothing is created if the config is not valid
+			if (!ok)
+			{
+				this->finishImport(false);
+				return;
+			}
+			if (m_importCancel.loadAcquire())
+			{
+				this->finishImport(true);
+				return;
+			}
+			m_importSteps = steps;
+			for (auto &step : m_importSteps)
+			{
+				m_importTotal += step.nodes;
+			}
+			m_importTimer.start();
+		}, Qt::QueuedConnection);
+	});
+	return true;
+}
+
+bool QUaModbusClientList::isImporting() const
+{
+	return m_importing;
+}
+
+QString QUaModbusClientList::mergeXmlConfig(QString strXmlConfig)
+{
+	QQueue<QUaLog> errorLogs;
+	QUaModbusConfigDiff diff;
+	QXmlStreamReader xmlCheck(strXmlConfig);
+	if (!QUaModbusClientList::checkXml(xmlCheck, errorLogs))
+	{
+		return QUaLog::toString(errorLogs);
+	}
+	QXmlStreamReader xml(strXmlConfig);
+	// NOTE : register layout conflicts of merged clients are logged once deferred removals are done
+	if (!this->readXmlConfig(xml, errorLogs, &diff))
+	{
+		return QUaLog::toString(errorLogs);
+	}
+	return "Success.";
+}
+
+QUaProperty * QUaModbusClientList::lagThreshold()
+{
+	if (!m_lagThreshold)
+	{
+		m_lagThreshold = this->browseChild<QUaProperty>("LagThreshold");
+	}
+	return m_lagThreshold;
+}
+
+QUaProperty * QUaModbusClientList::connectConcurrency()
+{
+	if (!m_connectConcurrency)
+	{
+		m_connectConcurrency = this->browseChild<QUaProperty>("ConnectConcurrency");
+	}
+	return m_connectConcurrency;
+}
+
+QUaProperty * QUaModbusClientList::errorStatusCodes()
+{
+	if (!m_errorStatusCodes)
+	{
+		m_errorStatusCodes = this->browseChild<QUaProperty>("ErrorStatusCodes");
+	}
+	return m_errorStatusCodes;
+}
+
+QUaProperty * QUaModbusClientList::compactValues()
+{
+	if (!m_compactValues)
+	{
+		m_compactValues = this->browseChild<QUaProperty>("CompactValues");
+	}
+	return m_compactValues;
+}
+
+#ifdef UA_ENABLE_HISTORIZING
+QUaProperty * QUaModbusClientList::historyMemoryLimit()
+{
+	if (!m_historyMemoryLimit)
+	{
+		m_historyMemoryLimit = this->browseChild<QUaProperty>("HistoryMemoryLimit");
+	}
+	return m_historyMemoryLimit;
+}
+#endif // UA_ENABLE_HISTORIZING
+
+QUaBaseDataVariable * QUaModbusClientList::eventLoopLag()
+{
+	if (!m_eventLoopLag)
+	{
+		m_eventLoopLag = this->browseChild<QUaBaseDataVariable>("EventLoopLag");
+	}
+	return m_eventLoopLag;
+}
+
+QUaBaseDataVariable * QUaModbusClientList::eventLoopQueueDepth()
+{
+	if (!m_eventLoopQueueDepth)
+	{
+		m_eventLoopQueueDepth = this->browseChild<QUaBaseDataVariable>("EventLoopQueueDepth");
+	}
+	return m_eventLoopQueueDepth;
+}
+
+QUaBaseDataVariable * QUaModbusClientList::importProgress()
+{
+	if (!m_importProgress)
+	{
+		m_importProgress = this->browseChild<QUaBaseDataVariable>("ImportProgress");
+	}
+	return m_importProgress;
+}
+
+quint32 QUaModbusClientList::getLagThreshold() const
+{
+	return const_cast<QUaModbusClientList*>(this)->lagThreshold()->value().value<quint32>();
+}
+
+void QUaModbusClientList::setLagThreshold(const quint32 & lagThreshold)
+{
+	this->lagThreshold()->setValue(lagThreshold);
+	this->on_lagThresholdChanged(lagThreshold, true);
+}
+
+quint32 QUaModbusClientList::getConnectConcurrency() const
+{
+	return const_cast<QUaModbusClientList*>(this)->connectConcurrency()->value().value<quint32>();
+}
+
+void QUaModbusClientList::setConnectConcurrency(const quint32 & connectConcurrency)
+{
+	this->connectConcurrency()->setValue(connectConcurrency);
+	this->on_connectConcurrencyChanged(connectConcurrency, true);
+}
+
+bool QUaModbusClientList::getErrorStatusCodes() const
+{
+	return const_cast<QUaModbusClientList*>(this)->errorStatusCodes()->value().toBool();
+}
+
+void QUaModbusClientList::setErrorStatusCodes(const bool & errorStatusCodes)
+{
+	this->errorStatusCodes()->setValue(errorStatusCodes);
+	this->on_errorStatusCodesChanged(errorStatusCodes, true);
+}
+
+bool QUaModbusClientList::getCompactValues() const
+{
+	return const_cast<QUaModbusClientList*>(this)->compactValues()->value().toBool();
+}
+
+void QUaModbusClientList::setCompactValues(const bool & compactValues)
+{
+	this->compactValues()->setValue(compactValues);
+	this->on_compactValuesChanged(compactValues, true);
+}
+
+#ifdef UA_ENABLE_HISTORIZING
+quint32 QUaModbusClientList::getHistoryMemoryLimit() const
+{
+	return const_cast<QUaModbusClientList*>(this)->historyMemoryLimit()->value().value<quint32>();
+}
+
+void QUaModbusClientList::setHistoryMemoryLimit(const quint32 & historyMemoryLimit)
+{
+	this->historyMemoryLimit()->setValue(historyMemoryLimit);
+	this->on_historyMemoryLimitChanged(historyMemoryLimit, true);
+}
+
+QUaModbusHistorian * QUaModbusClientList::historian()
+{
+	return &m_historian;
+}
+
+QQueue<QUaLog> QUaModbusClientList::setHistoryStorePath(const QString & strDirPath)
+{
+	QQueue<QUaLog> errorLogs;
+	// flush current one
+	m_historian.setStore(nullptr);
+	m_historyStore.reset();
+	if (strDirPath.isEmpty())
+	{
+		return errorLogs;
+	}
+	m_historyStore.reset(new QUaModbusHistoryStore(strDirPath));
+	if (!m_historyStore->open(errorLogs))
+	{
+		m_historyStore.reset();
+		return errorLogs;
+	}
+	m_historian.setStore(m_historyStore.data());
+	emit this->logMessage(QUaLog(
+		tr("History store opened in %1, %2 bytes used.").arg(strDirPath).arg(m_historyStore->sizeUsed()),
+		QUaLogLevel::Info,
+		QUaLogCategory::History
+	));
+	return errorLogs;
+}
+
+QString QUaModbusClientList::historyStorePath() const
+{
+	return m_historyStore ? m_historyStore->dirPath() : QString();
+}
+
+QUaModbusHistoryStore * QUaModbusClientList::historyStore()
+{
+	return m_historyStore.data();
+}
+#endif // UA_ENABLE_HISTORIZING
+
+double QUaModbusClientList::getEventLoopLag() const
+{
+	return const_cast<QUaModbusClientList*>(this)->eventLoopLag()->value().toDouble();
+}
+
+quint32 QUaModbusClientList::getEventLoopQueueDepth() const
+{
+	return const_cast<QUaModbusClientList*>(this)->eventLoopQueueDepth()->value().value<quint32>();
+}
+
+void QUaModbusClientList::on_lagThresholdChanged(const QVariant & value, const bool & networkChange)
+{
+	if (!networkChange)
+	{
+		return;
+	}
+	// emit
+	emit this->lagThresholdChanged(value.value<quint32>());
+}
+
+void QUaModbusClientList::on_connectConcurrencyChanged(const QVariant & value, const bool & networkChange)
+{
+	if (!networkChange)
+	{
+		return;
+	}
+	// more slots may be free now
+	this->connectNext();
+	// emit
+	emit this->connectConcurrencyChanged(value.value<quint32>());
+}
+
+void QUaModbusClientList::on_errorStatusCodesChanged(const QVariant & value, const bool & networkChange)
+{
+	if (!networkChange)
+	{
+		return;
+	}
+	auto errorStatusCodes = value.toBool();
+	// avoid update or emit if no change, improves performance
+	if (errorStatusCodes == m_errorStatusCodesCache)
+	{
+		return;
+	}
+	m_errorStatusCodesCache = errorStatusCodes;
+	// NOTE : blocks and values added later take it from the list
+	for (auto client : this->clients())
+	{
+		for (auto block : client->dataBlocks()->blocks())
 		{
-			auto strType = QString(QMetaEnum::fromType<QModbusDataBlockType>().valueToKey(block->getType()));
-#ifndef QUA_ACCESS_CONTROL
-			strCsv += QString("%1, %2, %3, %4, %5, %6\n")
-#else
-			strCsv += QString("%1, %2, %3, %4, %5, %6, %7\n")
-#endif // !QUA_ACCESS_CONTROL
-				.arg(block->browseName().name())
-				.arg(client->browseName().name())
-				.arg(strType)
-				.arg(block->getAddress())
-				.arg(block->getSize())
-				.arg(block->getSamplingTime())
-#ifndef QUA_ACCESS_CONTROL
-				;
-#else
-				.arg(block->permissionsObject() ? block->permissionsObject()->browseName().name() : "");
-#endif // !QUA_ACCESS_CONTROL
+			block->updateErrorStatus(errorStatusCodes);
 		}
 	}
-	return strCsv;
+	// emit
+	emit this->errorStatusCodesChanged(errorStatusCodes);
 }
 
-QString QUaModbusClientList::csvValues()
+void QUaModbusClientList::on_compactValuesChanged(const QVariant & value, const bool & networkChange)
 {
-	QString strCsv;
-#ifndef QUA_ACCESS_CONTROL
-	strCsv += QString("%1, %2, %3, %4, %5\n")
-#else
-	strCsv += QString("%1, %2, %3, %4, %5, %6\n")
-#endif // !QUA_ACCESS_CONTROL
-		.arg(tr("Name"))
-		.arg(tr("Client"))
-		.arg(tr("Block"))
-		.arg(tr("Type"))
-		.arg(tr("AddressOffset"))
-#ifndef QUA_ACCESS_CONTROL
-		;
-#else
-		.arg(tr("Permissions"));
-#endif // !QUA_ACCESS_CONTROL
-	auto clients = this->browseChildren<QUaModbusClient>();
-	for (auto client : clients)
+	if (!networkChange)
 	{
-		auto blocks = client->dataBlocks()->blocks();
-		for (auto block : blocks)
+		return;
+	}
+	auto compactValues = value.toBool();
+	// avoid update or emit if no change, improves performance
+	if (compactValues == m_compactValuesCache)
+	{
+		return;
+	}
+	m_compactValuesCache = compactValues;
+	// NOTE : values added later take it from the list
+	for (auto client : this->clients())
+	{
+		for (auto block : client->dataBlocks()->blocks())
 		{
-			auto values = block->values()->values();
-			for (auto value : values)
+			for (auto modbusValue : block->values()->values())
 			{
-				auto strType = QString(QMetaEnum::fromType<QModbusValueType>().valueToKey(value->getType()));
-#ifndef QUA_ACCESS_CONTROL
-				strCsv += QString("%1, %2, %3, %4, %5\n")
-#else
-				strCsv += QString("%1, %2, %3, %4, %5, %6\n")
-#endif // !QUA_ACCESS_CONTROL
-					.arg(value->browseName().name())
-					.arg(client->browseName().name())
-					.arg(block->browseName().name())
-					.arg(strType)
-					.arg(value->getAddressOffset())
-#ifndef QUA_ACCESS_CONTROL
-					;
-#else
-					.arg(value->permissionsObject() ? value->permissionsObject()->browseName().name() : "");
-#endif // !QUA_ACCESS_CONTROL
+				modbusValue->updateCompact(compactValues);
 			}
 		}
 	}
-	return strCsv;
+	// emit
+	emit this->compactValuesChanged(compactValues);
 }
 
-QQueue<QUaLog> QUaModbusClientList::setCsvClients(QString strCsvClients)
+#ifdef UA_ENABLE_HISTORIZING
+void QUaModbusClientList::on_historyMemoryLimitChanged(const QVariant & value, const bool & networkChange)
 {
-	QQueue<QUaLog> errorLogs;
-	auto listRows = strCsvClients.split("\n");
-	for (auto strRow : listRows)
+	if (!networkChange)
 	{
-		bool bOK = false;
-		auto listCols = strRow.split(",");
-		// check length
-		if (listCols.count() <= 1)
+		return;
+	}
+	// NOTE : lowering the limit drops the oldest history right away
+	auto historyMemoryLimit = value.value<quint32>();
+	m_historian.setMemoryLimit(static_cast<quint64>(historyMemoryLimit) * 1024);
+	// emit
+	emit this->historyMemoryLimitChanged(historyMemoryLimit);
+}
+#endif // UA_ENABLE_HISTORIZING
+
+void QUaModbusClientList::on_monitorTimeout()
+{
+	// ua server thread lag is how late this timer fired
+	auto elapsed = m_monitorClock.restart();
+	auto lag = qMax(Q_INT64_C(0), elapsed - static_cast<qint64>(QUaModbusClientList::m_monitorPeriod));
+	this->eventLoopLag()->setValue(static_cast<double>(lag));
+	m_lagging = this->checkLag(tr("UA server thread"), lag, m_lagging);
+	// worker threads, replies waiting for ua server thread are its queue
+	int repliesPending = 0;
+	for (auto client : this->clients())
+	{
+		client->updateLoopMonitor();
+		client->m_lagging = this->checkLag(
+			tr("Modbus client %1 worker thread").arg(client->browseName().name()), 
+			client->getWorkerLag(), 
+			client->m_lagging
+		);
+		repliesPending += qMax(0, client->m_repliesPending.loadAcquire());
+	}
+	this->eventLoopQueueDepth()->setValue(static_cast<quint32>(repliesPending));
+	// trace event loop activity of all threads as counters
+	if (QUaModbusTrace::isEnabled())
+	{
+		QUaModbusTrace::addCounter("event loop lag"  , tr("UA Server"), static_cast<double>(lag));
+		QUaModbusTrace::addCounter("event loop queue", tr("UA Server"), static_cast<double>(repliesPending));
+		for (auto client : this->clients())
+		{
+			auto strName = client->browseName().name();
+			QUaModbusTrace::addCounter("event loop lag"  , strName, client->getWorkerLag());
+			QUaModbusTrace::addCounter("event loop queue", strName, static_cast<double>(client->getWorkerQueueDepth()));
+		}
+	}
+	// free slots of attempts taking too long, they go on but do not hold the ramp back
+	auto connectNow = m_connectClock.elapsed();
+	for (auto it = m_connecting.begin(); it != m_connecting.end();)
+	{
+		if (connectNow - it.value() >= QUaModbusClientList::m_connectTimeout)
 		{
+			it = m_connecting.erase(it);
 			continue;
 		}
-#ifndef QUA_ACCESS_CONTROL
-		if (listCols.count() < 6)
-#else
+		++it;
+	}
+	this->connectNext();
+}
+
+void QUaModbusClientList::queueConnect(QUaModbusClient * client)
+{
+	if (m_connectQueued.contains(client) || m_connecting.contains(client))
+	{
+		return;
+	}
+	m_connectQueue.enqueue(client);
+	m_connectQueued.insert(client);
+	this->connectNext();
+}
+
+void QUaModbusClientList::dequeueConnect(QUaModbusClient * client)
+{
+	if (m_connectQueued.remove(client))
+	{
+		m_connectQueue.removeOne(client);
+	}
+	if (m_connecting.remove(client) > 0)
+	{
+		this->connectNext();
+	}
+}
+
+void QUaModbusClientList::connectNext()
+{
+	auto concurrency = this->getConnectConcurrency();
+	while (!m_connectQueue.isEmpty() && 
+		(concurrency == 0 || static_cast<quint32>(m_connecting.count()) < concurrency))
+	{
+		auto client = m_connectQueue.dequeue();
+		m_connectQueued.remove(client);
+		// connected meanwhile, e.g. by the user
+		if (client->getState() != QModbusState::UnconnectedState)
+		{
+			continue;
+		}
+		m_connecting.insert(client, m_connectClock.elapsed());
+		client->startConnect();
+	}
+}
+
+bool QUaModbusClientList::checkLag(const QString & strThread, const double & lag, const bool & wasLagging)
+{
+	auto threshold = this->getLagThreshold();
+	bool isLagging = threshold > 0 && lag > threshold;
+	// only log transitions
+	if (isLagging == wasLagging)
+	{
+		return isLagging;
+	}
+	emit this->logMessage(QUaLog(
+		isLagging ?
+			tr("Event loop lag of %1 ms in %2 exceeds threshold of %3 ms.").arg(lag, 0, 'f', 1).arg(strThread).arg(threshold) :
+			tr("Event loop lag of %1 ms in %2 back below threshold of %3 ms.").arg(lag, 0, 'f', 1).arg(strThread).arg(threshold),
+		isLagging ? QUaLogLevel::Warning : QUaLogLevel::Info,
+		QUaLogCategory::Server
+	));
+	return isLagging;
+}
+
+void QUaModbusClientList::startTrace()
+{
+	QUaModbusTrace::setEnabled(true);
+	// name threads for the trace viewer
+	QUaModbusTrace::setThreadName(tr("UA Server"));
+	for (auto client : this->clients())
+	{
+		auto threadName = tr("%1 Worker").arg(client->browseName().name());
+		client->m_workerThread.execInThread([threadName]() {
+			QUaModbusTrace::setThreadName(threadName);
+		});
+	}
+}
+
+void QUaModbusClientList::stopTrace()
+{
+	// NOTE : recorded spans are kept until next start
+	QUaModbusTrace::setEnabled(false);
+}
+
+QString QUaModbusClientList::chromeTrace()
+{
+	return QString::fromUtf8(QUaModbusTrace::chromeJson());
+}
+
+QString QUaModbusClientList::csvClients()
+{
+	QString strCsv;
+	QUaModbusCsvWriter writer(&strCsv);
+	this->writeCsvClients(writer);
+	return strCsv;
+}
+
+QString QUaModbusClientList::csvBlocks()
+{
+	QString strCsv;
+	QUaModbusCsvWriter writer(&strCsv);
+	this->writeCsvBlocks(writer);
+	return strCsv;
+}
+
+QString QUaModbusClientList::csvValues()
+{
+	QString strCsv;
+	QUaModbusCsvWriter writer(&strCsv);
+	this->writeCsvValues(writer);
+	return strCsv;
+}
+
+bool QUaModbusClientList::writeCsvClients(QIODevice * device)
+{
+	if (!device || !device->isWritable())
+	{
+		return false;
+	}
+	QUaModbusCsvWriter writer(device);
+	this->writeCsvClients(writer);
+	return !writer.hasError();
+}
+
+bool QUaModbusClientList::writeCsvBlocks(QIODevice * device)
+{
+	if (!device || !device->isWritable())
+	{
+		return false;
+	}
+	QUaModbusCsvWriter writer(device);
+	this->writeCsvBlocks(writer);
+	return !writer.hasError();
+}
+
+bool QUaModbusClientList::writeCsvValues(QIODevice * device)
+{
+	if (!device || !device->isWritable())
+	{
+		return false;
+	}
+	QUaModbusCsvWriter writer(device);
+	this->writeCsvValues(writer);
+	return !writer.hasError();
+}
+
+void QUaModbusClientList::writeCsvClients(QUaModbusCsvWriter & writer)
+{
+	writer 
+		<< tr("Name"          )
+		<< tr("Type"          )
+		<< tr("ServerAddress" )
+		<< tr("KeepConnecting")
+		<< tr("NetworkAddress")
+		<< tr("NetworkPort"   );
+#ifdef QUA_ACCESS_CONTROL
+	writer << tr("Permissions");
+#endif // QUA_ACCESS_CONTROL
+	writer.endRow();
+	auto clientsTcp = this->browseChildren<QUaModbusTcpClient>();
+	for (auto clientTcp : clientsTcp)
+	{
+		auto strType = QString(QMetaEnum::fromType<QModbusClientType>().valueToKey(clientTcp->getType()));
+		writer
+			<< clientTcp->browseName().name()
+			<< strType
+			<< clientTcp->getServerAddress ()
+			<< clientTcp->getKeepConnecting()
+			<< clientTcp->getNetworkAddress()
+			<< clientTcp->getNetworkPort   ();
+#ifdef QUA_ACCESS_CONTROL
+		writer << (clientTcp->permissionsObject() ? clientTcp->permissionsObject()->browseName().name() : "");
+#endif // QUA_ACCESS_CONTROL
+		writer.endRow();
+	}
+	writer
+		<< tr("Name"          )
+		<< tr("Type"          )
+		<< tr("ServerAddress" )
+		<< tr("KeepConnecting")
+		<< tr("ComPort"       )
+		<< tr("Parity"        )
+		<< tr("BaudRate"      )
+		<< tr("DataBits"      )
+		<< tr("StopBits"      );
+#ifdef QUA_ACCESS_CONTROL
+	writer << tr("Permissions");
+#endif // QUA_ACCESS_CONTROL
+	writer.endRow();
+	auto clientsSerial = this->browseChildren<QUaModbusRtuSerialClient>();
+	for (auto clientSerial : clientsSerial)
+	{
+		auto strType     = QString(QMetaEnum::fromType<QModbusClientType>().valueToKey(clientSerial->getType()));
+		auto strParity   = QString(QMetaEnum::fromType<QParity  >().valueToKey(clientSerial->getParity  ()));
+		auto strBaudRate = QString(QMetaEnum::fromType<QBaudRate>().valueToKey(clientSerial->getBaudRate()));
+		auto strDataBits = QString(QMetaEnum::fromType<QDataBits>().valueToKey(clientSerial->getDataBits()));
+		auto strStopBits = QString(QMetaEnum::fromType<QStopBits>().valueToKey(clientSerial->getStopBits()));
+		writer
+			<< clientSerial->browseName().name()
+			<< strType
+			<< clientSerial->getServerAddress ()
+			<< clientSerial->getKeepConnecting()
+			<< clientSerial->getComPort       ()
+			<< strParity
+			<< strBaudRate
+			<< strDataBits
+			<< strStopBits;
+#ifdef QUA_ACCESS_CONTROL
+		writer << (clientSerial->permissionsObject() ? clientSerial->permissionsObject()->browseName().name() : "");
+#endif // QUA_ACCESS_CONTROL
+		writer.endRow();
+	}
+}
+
+void QUaModbusClientList::writeCsvBlocks(QUaModbusCsvWriter & writer)
+{
+	writer
+		<< tr("Name"        )
+		<< tr("Client"      )
+		<< tr("Type"        )
+		<< tr("Address"     )
+		<< tr("Size"        )
+		<< tr("SamplingTime");
+#ifdef QUA_ACCESS_CONTROL
+	writer << tr("Permissions");
+#endif // QUA_ACCESS_CONTROL
+	writer.endRow();
+	auto clients = this->browseChildren<QUaModbusClient>();
+	for (auto client : clients)
+	{
+		auto strClientName = client->browseName().name();
+		auto blocks = client->dataBlocks()->blocks();
+		for (auto block : blocks)
+		{
+			auto strType = QString(QMetaEnum::fromType<QModbusDataBlockType>().valueToKey(block->getType()));
+			writer
+				<< block->browseName().name()
+				<< strClientName
+				<< strType
+				<< block->getAddress()
+				<< block->getSize()
+				<< block->getSamplingTime();
+#ifdef QUA_ACCESS_CONTROL
+			writer << (block->permissionsObject() ? block->permissionsObject()->browseName().name() : "");
+#endif // QUA_ACCESS_CONTROL
+			writer.endRow();
+		}
+	}
+}
+
+void QUaModbusClientList::writeCsvValues(QUaModbusCsvWriter & writer)
+{
+	writer
+		<< tr("Name")
+		<< tr("Client")
+		<< tr("Block")
+		<< tr("Type")
+		<< tr("AddressOffset");
+#ifdef QUA_ACCESS_CONTROL
+	writer << tr("Permissions");
+#endif // QUA_ACCESS_CONTROL
+	writer.endRow();
+	// NOTE : type names looked up once, not per value
+	auto metaValueType = QMetaEnum::fromType<QModbusValueType>();
+	QHash<int, QString> typeNames;
+	for (int i = 0; i < metaValueType.keyCount(); i++)
+	{
+		typeNames.insert(metaValueType.value(i), QString(metaValueType.key(i)));
+	}
+	auto clients = this->browseChildren<QUaModbusClient>();
+	for (auto client : clients)
+	{
+		auto strClientName = client->browseName().name();
+		auto blocks = client->dataBlocks()->blocks();
+		for (auto block : blocks)
+		{
+			auto strBlockName = block->browseName().name();
+			auto values = block->values()->values();
+			for (auto value : values)
+			{
+				writer
+					<< value->browseName().name()
+					<< strClientName
+					<< strBlockName
+					<< typeNames.value(value->getType())
+					<< value->getAddressOffset();
+#ifdef QUA_ACCESS_CONTROL
+				writer << (value->permissionsObject() ? value->permissionsObject()->browseName().name() : "");
+#endif // QUA_ACCESS_CONTROL
+				writer.endRow();
+			}
+		}
+	}
+}
+
+QQueue<QUaLog> QUaModbusClientList::setCsvClients(QString strCsvClients)
+{
+	QUaModbusCsvReader reader(&strCsvClients);
+	return this->readCsvClients(reader);
+}
+
+QQueue<QUaLog> QUaModbusClientList::readCsvClients(QIODevice * device)
+{
+	if (!device || !device->isReadable())
+	{
+		QQueue<QUaLog> errorLogs;
+		errorLogs << QUaLog(
+			tr("Cannot read CSV clients from device."),
+			QUaLogLevel::Error,
+			QUaLogCategory::Serialization
+		);
+		return errorLogs;
+	}
+	QUaModbusCsvReader reader(device);
+	return this->readCsvClients(reader);
+}
+
+QQueue<QUaLog> QUaModbusClientList::readCsvClients(QUaModbusCsvReader & reader)
+{
+	QQueue<QUaLog> errorLogs;
+	QUaModbusCsvIndex index(this);
+	QStringList listCols;
+	QString     strRow;
+	while (reader.readRow(listCols, strRow))
+	{
+		bool bOK = false;
+		// check length
+		if (listCols.count() <= 1)
+		{
+			continue;
+		}
+#ifndef QUA_ACCESS_CONTROL
+		if (listCols.count() < 6)
+#else
 		if (listCols.count() < 7)
 #endif // !QUA_ACCESS_CONTROL
 		{
@@ -395,7 +1035,8 @@ QQueue<QUaLog> QUaModbusClientList::setCsvClients(QString strCsvClients)
 					);
 				}
 				// check if tcp client exists
-				auto clientTcp = this->browseChild<QUaModbusTcpClient>(strBrowseName);
+				auto client    = index.client(strBrowseName);
+				auto clientTcp = qobject_cast<QUaModbusTcpClient*>(client);
 				if (clientTcp)
 				{
 					errorLogs << QUaLog(
@@ -407,8 +1048,7 @@ QQueue<QUaLog> QUaModbusClientList::setCsvClients(QString strCsvClients)
 				else
 				{
 					// check if serial client exists
-					auto clientSerial = this->browseChild<QUaModbusRtuSerialClient>(strBrowseName);
-					if (clientSerial)
+					if (client)
 					{
 						errorLogs << QUaLog(
 							tr("There already exists a serial client '%1' defined in row [%2]. Delete it first.").arg(strBrowseName).arg(strRow),
@@ -418,26 +1058,18 @@ QQueue<QUaLog> QUaModbusClientList::setCsvClients(QString strCsvClients)
 						continue;
 					}
 					// actually add client
-					auto strNewError = this->addTcpClient(strBrowseName);
-					if (strNewError.contains("Error", Qt::CaseInsensitive))
-					{
-						errorLogs << QUaLog(
-							strNewError,
-							QUaLogLevel::Error,
-							QUaLogCategory::Serialization
-						);
-						continue;
-					}
-					clientTcp = this->browseChild<QUaModbusTcpClient>(strBrowseName);
+					QString strNewError;
+					clientTcp = this->createClient<QUaModbusTcpClient>(strBrowseName, strNewError);
 					if (!clientTcp)
 					{
 						errorLogs << QUaLog(
-							tr("Failed to find '%1' client in client list after adding row [%2].").arg(strBrowseName).arg(strRow),
+							strNewError,
 							QUaLogLevel::Error,
 							QUaLogCategory::Serialization
 						);
 						continue;
 					}
+					index.insert(clientTcp);
 				}
 				// set props
 				clientTcp->setServerAddress (serverAddress );
@@ -539,7 +1171,8 @@ QQueue<QUaLog> QUaModbusClientList::setCsvClients(QString strCsvClients)
 					);
 				}
 				// check if serial client exists
-				auto clientSerial = this->browseChild<QUaModbusRtuSerialClient>(strBrowseName);
+				auto client       = index.client(strBrowseName);
+				auto clientSerial = qobject_cast<QUaModbusRtuSerialClient*>(client);
 				if (clientSerial)
 				{
 					errorLogs << QUaLog(
@@ -551,8 +1184,7 @@ QQueue<QUaLog> QUaModbusClientList::setCsvClients(QString strCsvClients)
 				else
 				{
 					// check if tcp client exists
-					auto clientTcp = this->browseChild<QUaModbusTcpClient>(strBrowseName);
-					if (clientTcp)
+					if (client)
 					{
 						errorLogs << QUaLog(
 							tr("There already exists a tcp client '%1' defined in row [%2]. Delete it first.").arg(strBrowseName).arg(strRow),
@@ -562,26 +1194,18 @@ QQueue<QUaLog> QUaModbusClientList::setCsvClients(QString strCsvClients)
 						continue;
 					}
 					// actually add client
-					auto strNewError = this->addRtuSerialClient(strBrowseName);
-					if (strNewError.contains("Error", Qt::CaseInsensitive))
-					{
-						errorLogs << QUaLog(
-							strNewError,
-							QUaLogLevel::Error,
-							QUaLogCategory::Serialization
-						);
-						continue;
-					}
-					clientSerial = this->browseChild<QUaModbusRtuSerialClient>(strBrowseName);
+					QString strNewError;
+					clientSerial = this->createClient<QUaModbusRtuSerialClient>(strBrowseName, strNewError);
 					if (!clientSerial)
 					{
 						errorLogs << QUaLog(
-							tr("Failed to find '%1' client in client list after adding row [%2].").arg(strBrowseName).arg(strRow),
+							strNewError,
 							QUaLogLevel::Error,
 							QUaLogCategory::Serialization
 						);
 						continue;
 					}
+					index.insert(clientSerial);
 				}
 				// set props
 				clientSerial->setServerAddress(serverAddress);
@@ -624,13 +1248,36 @@ QQueue<QUaLog> QUaModbusClientList::setCsvClients(QString strCsvClients)
 }
 
 QQueue<QUaLog> QUaModbusClientList::setCsvBlocks(QString strCsvBlocks)
+{
+	QUaModbusCsvReader reader(&strCsvBlocks);
+	return this->readCsvBlocks(reader);
+}
+
+QQueue<QUaLog> QUaModbusClientList::readCsvBlocks(QIODevice * device)
+{
+	if (!device || !device->isReadable())
+	{
+		QQueue<QUaLog> errorLogs;
+		errorLogs << QUaLog(
+			tr("Cannot read CSV blocks from device."),
+			QUaLogLevel::Error,
+			QUaLogCategory::Serialization
+		);
+		return errorLogs;
+	}
+	QUaModbusCsvReader reader(device);
+	return this->readCsvBlocks(reader);
+}
+
+QQueue<QUaLog> QUaModbusClientList::readCsvBlocks(QUaModbusCsvReader & reader)
 {
 	QQueue<QUaLog> errorLogs;
-	auto listRows = strCsvBlocks.split("\n");
-	for (auto strRow : listRows)
+	QUaModbusCsvIndex index(this);
+	QStringList listCols;
+	QString     strRow;
+	while (reader.readRow(listCols, strRow))
 	{
 		bool bOK = false;
-		auto listCols = strRow.split(",");
 		// check length
 		if (listCols.count() <= 1)
 		{
@@ -658,7 +1305,7 @@ QQueue<QUaLog> QUaModbusClientList::setCsvBlocks(QString strCsvBlocks)
 		}
 		// get client
 		auto strClientName = listCols.at(1).trimmed();
-		auto client = this->browseChild<QUaModbusClient>(strClientName);
+		auto client = index.client(strClientName);
 		if (!client)
 		{
 			errorLogs << QUaLog(
@@ -710,7 +1357,7 @@ QQueue<QUaLog> QUaModbusClientList::setCsvBlocks(QString strCsvBlocks)
 		}
 		// check if block exists
 		auto blocks = client->dataBlocks();
-		auto block  = blocks->browseChild<QUaModbusDataBlock>(strBrowseName);
+		auto block  = index.block(client, strBrowseName);
 		if (block)
 		{
 			errorLogs << QUaLog(
@@ -722,26 +1369,18 @@ QQueue<QUaLog> QUaModbusClientList::setCsvBlocks(QString strCsvBlocks)
 		else
 		{
 			// actually add block
-			auto strNewError = blocks->addDataBlock(strBrowseName);
-			if (strNewError.contains("Error", Qt::CaseInsensitive))
-			{
-				errorLogs << QUaLog(
-					strNewError,
-					QUaLogLevel::Error,
-					QUaLogCategory::Serialization
-				);
-				continue;
-			}
-			block = blocks->browseChild<QUaModbusDataBlock>(strBrowseName);
+			QString strNewError;
+			block = blocks->createDataBlock(strBrowseName, strNewError);
 			if (!block)
 			{
 				errorLogs << QUaLog(
-					tr("Failed to find '%1' block in client '%2' list after adding row [%3].").arg(client->browseName().name()).arg(strBrowseName).arg(strRow),
+					strNewError,
 					QUaLogLevel::Error,
 					QUaLogCategory::Serialization
 				);
 				continue;
 			}
+			index.insert(client, block);
 		}	
 		// set properties
 		block->setType(type);
@@ -771,17 +1410,41 @@ QQueue<QUaLog> QUaModbusClientList::setCsvBlocks(QString strCsvBlocks)
 		}
 #endif // QUA_ACCESS_CONTROL
 	}
+	this->validateNow(errorLogs);
 	return errorLogs;
 }
 
 QQueue<QUaLog> QUaModbusClientList::setCsvValues(QString strCsvValues)
+{
+	QUaModbusCsvReader reader(&strCsvValues);
+	return this->readCsvValues(reader);
+}
+
+QQueue<QUaLog> QUaModbusClientList::readCsvValues(QIODevice * device)
+{
+	if (!device || !device->isReadable())
+	{
+		QQueue<QUaLog> errorLogs;
+		errorLogs << QUaLog(
+			tr("Cannot read CSV values from device."),
+			QUaLogLevel::Error,
+			QUaLogCategory::Serialization
+		);
+		return errorLogs;
+	}
+	QUaModbusCsvReader reader(device);
+	return this->readCsvValues(reader);
+}
+
+QQueue<QUaLog> QUaModbusClientList::readCsvValues(QUaModbusCsvReader & reader)
 {
 	QQueue<QUaLog> errorLogs;
-	auto listRows = strCsvValues.split("\n");
-	for (auto strRow : listRows)
+	QUaModbusCsvIndex index(this);
+	QStringList listCols;
+	QString     strRow;
+	while (reader.readRow(listCols, strRow))
 	{
 		bool bOK = false;
-		auto listCols = strRow.split(",");
 		// check length
 		if (listCols.count() <= 1)
 		{
@@ -809,7 +1472,7 @@ QQueue<QUaLog> QUaModbusClientList::setCsvValues(QString strCsvValues)
 		}
 		// get client
 		auto strClientName = listCols.at(1).trimmed();
-		auto client = this->browseChild<QUaModbusClient>(strClientName);
+		auto client = index.client(strClientName);
 		if (!client)
 		{
 			errorLogs << QUaLog(
@@ -821,7 +1484,7 @@ QQueue<QUaLog> QUaModbusClientList::setCsvValues(QString strCsvValues)
 		}
 		// get block
 		auto strBlockName = listCols.at(2).trimmed();
-		auto block = client->dataBlocks()->browseChild<QUaModbusDataBlock>(strBlockName);
+		auto block = index.block(client, strBlockName);
 		if (!block)
 		{
 			errorLogs << QUaLog(
@@ -852,7 +1515,7 @@ QQueue<QUaLog> QUaModbusClientList::setCsvValues(QString strCsvValues)
 			);
 		}
 		auto values = block->values();
-		auto value  = values->browseChild<QUaModbusValue>(strBrowseName);
+		auto value  = index.value(block, strBrowseName);
 		if (value)
 		{
 			errorLogs << QUaLog(
@@ -864,26 +1527,18 @@ QQueue<QUaLog> QUaModbusClientList::setCsvValues(QString strCsvValues)
 		else
 		{
 			// actually add block
-			auto strNewError = values->addValue(strBrowseName);
-			if (strNewError.contains("Error", Qt::CaseInsensitive))
-			{
-				errorLogs << QUaLog(
-					strNewError,
-					QUaLogLevel::Error,
-					QUaLogCategory::Serialization
-				);
-				continue;
-			}
-			value = values->browseChild<QUaModbusValue>(strBrowseName);
+			QString strNewError;
+			value = values->createValue(strBrowseName, strNewError);
 			if (!value)
 			{
 				errorLogs << QUaLog(
-					tr("Failed to find '%2' value in client %2, block '%3' list after adding row [%4].").arg(client->browseName().name()).arg(block->browseName().name()).arg(strBrowseName).arg(strRow),
+					strNewError,
 					QUaLogLevel::Error,
 					QUaLogCategory::Serialization
 				);
 				continue;
 			}
+			index.insert(block, value);
 		}
 		// set properties
 		value->setType(type);
@@ -911,6 +1566,7 @@ QQueue<QUaLog> QUaModbusClientList::setCsvValues(QString strCsvValues)
 		}
 #endif // QUA_ACCESS_CONTROL
 	}
+	this->validateNow(errorLogs);
 	return errorLogs;
 }
 
@@ -919,8 +1575,48 @@ QList<QUaModbusClient*> QUaModbusClientList::clients()
 	return this->browseChildren<QUaModbusClient>();
 }
 
+QString QUaModbusClientList::expandIds(const QString & strIds, QStringList & listIds)
+{
+	static const QRegularExpression rxRange("^(\\w*)\\[(\\d+)\\.\\.(\\d+)\\]$");
+	auto listEntries = strIds.split(",", QString::SkipEmptyParts);
+	for (auto strEntry : listEntries)
+	{
+		strEntry = strEntry.trimmed();
+		if (strEntry.isEmpty())
+		{
+			continue;
+		}
+		auto match = rxRange.match(strEntry);
+		if (!match.hasMatch())
+		{
+			listIds << strEntry;
+			continue;
+		}
+		bool bFirstOK = false;
+		bool bLastOK  = false;
+		auto strFirst = match.captured(2);
+		auto first    = strFirst.toInt(&bFirstOK);
+		auto last     = match.captured(3).toInt(&bLastOK);
+		if (!bFirstOK || !bLastOK || last < first || last - first >= m_maxRangeIds)
+		{
+			return tr("%1 : Invalid range '%2', it must be ascending and contain at most %3 ids.").arg("Error").arg(strEntry).arg(m_maxRangeIds);
+		}
+		// NOTE : leading zeros in the first index pad all indexes to the same width
+		auto strPrefix = match.captured(1);
+		int  width     = strFirst.startsWith('0') ? strFirst.length() : 0;
+		for (int i = first; i <= last; i++)
+		{
+			listIds << QString("%1%2").arg(strPrefix).arg(i, width, 10, QLatin1Char('0'));
+		}
+	}
+	return "Success";
+}
+
 void QUaModbusClientList::clearInmediatly()
 {
+	// NOTE : deleted clients free their slots, must not start the ones waiting
+	m_connectQueue.clear();
+	m_connectQueued.clear();
 	emit this->aboutToClear();
 	for (auto client : this->clients())
 	{
@@ -948,13 +1644,7 @@ QDomElement QUaModbusClientList::toDomElement(QDomDocument & domDoc) const
 {
 	// add client list element
 	QDomElement elemListClients = domDoc.createElement(QUaModbusClientList::staticMetaObject.className());
-#ifdef QUA_ACCESS_CONTROL
-	// set parmissions if any
-	if (this->hasPermissionsObject())
-	{
-		elemListClients.setAttribute("Permissions", this->permissionsObject()->nodeId());
-	}
-#endif // QUA_ACCESS_CONTROL
+	this->attributesToDomElement(elemListClients);
 	// loop children and add them as children
 	auto clients = this->browseChildren<QUaModbusClient>();
 	for (auto client : clients)
@@ -968,131 +1658,977 @@ QDomElement QUaModbusClientList::toDomElement(QDomDocument & domDoc) const
 
 void QUaModbusClientList::fromDomElement(QDomElement & domElem, QQueue<QUaLog>& errorLogs)
 {
-#ifdef QUA_ACCESS_CONTROL
-	// load permissions if any
-	if (domElem.hasAttribute("Permissions") && !domElem.attribute("Permissions").isEmpty())
-	{
-		QString strError = this->setPermissions(domElem.attribute("Permissions"));
-		if (strError.contains("Error"))
-		{
-			errorLogs << QUaLog(
-				strError,
-				QUaLogLevel::Error,
-				QUaLogCategory::Serialization
-			);
-		}
-	}
-#endif // QUA_ACCESS_CONTROL
+	this->attributesFromDomElement(domElem, errorLogs);
 	// add TCP clients
 	QDomNodeList listTcpClients = domElem.elementsByTagName(QUaModbusTcpClient::staticMetaObject.className());
 	for (int i = 0; i < listTcpClients.count(); i++)
 	{
 		QDomElement elemClient = listTcpClients.at(i).toElement();
 		Q_ASSERT(!elemClient.isNull());
-		if (!elemClient.hasAttribute("BrowseName"))
+		this->clientFromDomElement(elemClient, errorLogs);
+	}
+	// add Serial clients
+	QDomNodeList listSerialClients = domElem.elementsByTagName(QUaModbusRtuSerialClient::staticMetaObject.className());
+	for (int i = 0; i < listSerialClients.count(); i++)
+	{
+		QDomElement elemClient = listSerialClients.at(i).toElement();
+		Q_ASSERT(!elemClient.isNull());
+		this->clientFromDomElement(elemClient, errorLogs);
+	}
+}
+
+QQueue<QUaLog> QUaModbusClientList::mergeXmlConfig(QIODevice * device)
+{
+	QQueue<QUaLog> errorLogs;
+	if (!device || !device->isReadable())
+	{
+		errorLogs << QUaLog(
+			tr("Cannot read XML config from device."),
+			QUaLogLevel::Error,
+			QUaLogCategory::Serialization
+		);
+		return errorLogs;
+	}
+	// NOTE : sequential devices cannot be read twice
+	QBuffer buffer;
+	if (device->isSequential())
+	{
+		buffer.setData(device->readAll());
+		buffer.open(QIODevice::ReadOnly);
+		device = &buffer;
+	}
+	if (!QUaModbusClientList::checkXml(device, errorLogs))
+	{
+		return errorLogs;
+	}
+	QUaModbusConfigDiff diff;
+	QXmlStreamReader xml(device);
+	this->readXmlConfig(xml, errorLogs, &diff);
+	return errorLogs;
+}
+
+QQueue<QUaLog> QUaModbusClientList::readXmlConfig(QIODevice * device)
+{
+	QQueue<QUaLog> errorLogs;
+	if (!device || !device->isReadable())
+	{
+		errorLogs << QUaLog(
+			tr("Cannot read XML config from device."),
+			QUaLogLevel::Error,
+			QUaLogCategory::Serialization
+		);
+		return errorLogs;
+	}
+	// NOTE : sequential devices cannot be read twice
+	QBuffer buffer;
+	if (device->isSequential())
+	{
+		buffer.setData(device->readAll());
+		buffer.open(QIODevice::ReadOnly);
+		device = &buffer;
+	}
+	if (!QUaModbusClientList::checkXml(device, errorLogs))
+	{
+		return errorLogs;
+	}
+	QXmlStreamReader xml(device);
+	this->readXmlConfig(xml, errorLogs);
+	return errorLogs;
+}
+
+bool QUaModbusClientList::checkXml(QXmlStreamReader & xml, QQueue<QUaLog>& errorLogs)
+{
+	while (!xml.atEnd())
+	{
+		xml.readNext();
+	}
+	if (!xml.hasError())
+	{
+		return true;
+	}
+	errorLogs << QUaLog(
+		tr("Invalid XML in Line %1 Column %2 Error %3").arg(xml.lineNumber()).arg(xml.columnNumber()).arg(xml.errorString()),
+		QUaLogLevel::Error,
+		QUaLogCategory::Serialization
+	);
+	return false;
+}
+
+bool QUaModbusClientList::checkXml(QIODevice * device, QQueue<QUaLog>& errorLogs)
+{
+	// NOTE : read from where the caller left the device and rewind there for the second pass
+	auto pos = device->pos();
+	bool isValid;
+	{
+		QXmlStreamReader xml(device);
+		isValid = QUaModbusClientList::checkXml(xml, errorLogs);
+	}
+	if (!device->seek(pos))
+	{
+		errorLogs << QUaLog(
+			tr("Cannot read XML config from device."),
+			QUaLogLevel::Error,
+			QUaLogCategory::Serialization
+		);
+		return false;
+	}
+	return isValid;
+}
+
+bool QUaModbusClientList::writeXmlConfig(QIODevice * device) const
+{
+	if (!device || !device->isWritable())
+	{
+		return false;
+	}
+	QXmlStreamWriter xml(device);
+	xml.setAutoFormatting(true);
+	xml.setAutoFormattingIndent(1);
+	xml.writeStartDocument();
+	this->writeXmlConfig(xml);
+	xml.writeEndDocument();
+	return !xml.hasError();
+}
+
+void QUaModbusClientList::writeXmlConfig(QXmlStreamWriter & xml) const
+{
+	// list element first, then clients one by one
+	QDomDocument docList;
+	QDomElement elemListClients = docList.createElement(QUaModbusClientList::staticMetaObject.className());
+	this->attributesToDomElement(elemListClients);
+	xml.writeStartElement(elemListClients.tagName());
+	QUaModbusClientList::writeDomAttributes(xml, elemListClients);
+	auto clients = this->browseChildren<QUaModbusClient>();
+	for (auto client : clients)
+	{
+		// NOTE : only one client is held as dom at a time
+		QDomDocument docClient;
+		QUaModbusClientList::writeDomElement(xml, client->toDomElement(docClient));
+	}
+	xml.writeEndElement();
+}
+
+QByteArray QUaModbusClientList::binaryConfig() const
+{
+	return QUaModbusBinaryConfig::serialize(this);
+}
+
+QQueue<QUaLog> QUaModbusClientList::setBinaryConfig(const QByteArray & byteConfig)
+{
+	QQueue<QUaLog> errorLogs;
+	if (QUaModbusBinaryConfig::deserialize(this, byteConfig.constData(), byteConfig.size(), errorLogs))
+	{
+		this->validateNow(errorLogs);
+	}
+	return errorLogs;
+}
+
+bool QUaModbusClientList::writeBinaryConfig(QIODevice * device) const
+{
+	if (!device || !device->isWritable())
+	{
+		return false;
+	}
+	auto byteConfig = this->binaryConfig();
+	return device->write(byteConfig) == byteConfig.size();
+}
+
+QQueue<QUaLog> QUaModbusClientList::readBinaryConfig(QIODevice * device)
+{
+	QQueue<QUaLog> errorLogs;
+	if (!device || !device->isReadable())
+	{
+		errorLogs << QUaLog(
+			tr("Cannot read binary config from device."),
+			QUaLogLevel::Error,
+			QUaLogCategory::Serialization
+		);
+		return errorLogs;
+	}
+	// read in place from mapped file
+	auto file = qobject_cast<QFile*>(device);
+	uchar * mapped = file ? file->map(0, file->size()) : nullptr;
+	if (mapped)
+	{
+		bool ok = QUaModbusBinaryConfig::deserialize(this, reinterpret_cast<const char*>(mapped), file->size(), errorLogs);
+		file->unmap(mapped);
+		if (ok)
+		{
+			this->validateNow(errorLogs);
+		}
+		return errorLogs;
+	}
+	auto byteConfig = device->readAll();
+	if (QUaModbusBinaryConfig::deserialize(this, byteConfig.constData(), byteConfig.size(), errorLogs))
+	{
+		this->validateNow(errorLogs);
+	}
+	return errorLogs;
+}
+
+QQueue<QUaLog> QUaModbusClientList::setValueCacheFile(const QString & strFileName)
+{
+	QQueue<QUaLog> errorLogs;
+	// flush current one
+	this->on_valueCacheTimeout();
+	m_valueCache.reset();
+	m_valueCacheTimer.stop();
+	m_valueCacheBlocks.clear();
+	if (strFileName.isEmpty())
+	{
+		return errorLogs;
+	}
+	m_valueCache.reset(new QUaModbusValueCache(strFileName));
+	QUaModbusValueCache::Entries entries;
+	m_valueCache->read(entries, errorLogs);
+	// NOTE : entries of values no longer in the config or of another type are dropped
+	QUaModbusValueCache::Entries entriesKept;
+	int restored = 0;
+	for (auto client : this->clients())
+	{
+		for (auto block : client->dataBlocks()->blocks())
+		{
+			auto strPrefix = QString("%1.%2.").arg(client->browseName().name()).arg(block->browseName().name());
+			for (auto value : block->values()->values())
+			{
+				auto strKey = strPrefix + value->browseName().name();
+				auto it = entries.find(strKey);
+				if (it == entries.end() || it.value().type != static_cast<qint32>(value->getType()))
+				{
+					continue;
+				}
+				entriesKept.insert(strKey, it.value());
+				// already read
+				if (value->getLastError() == QModbusError::NoError)
+				{
+					continue;
+				}
+				value->setLastKnownValue(it.value().value, it.value().timestamp);
+				restored++;
+			}
+		}
+	}
+	m_valueCache->reset(entriesKept);
+	emit this->logMessage(QUaLog(
+		tr("Restored %1 last known values from %2.").arg(restored).arg(strFileName),
+		QUaLogLevel::Info,
+		QUaLogCategory::Serialization
+	));
+	return errorLogs;
+}
+
+QString QUaModbusClientList::valueCacheFile() const
+{
+	return m_valueCache ? m_valueCache->fileName() : QString();
+}
+
+void QUaModbusClientList::valueCacheChanged(QUaModbusDataBlock * block)
+{
+	if (!m_valueCache)
+	{
+		return;
+	}
+	m_valueCacheBlocks.insert(block, block);
+	// NOTE : not restarted, so values are written at most once per period
+	if (!m_valueCacheTimer.isActive())
+	{
+		m_valueCacheTimer.start();
+	}
+}
+
+void QUaModbusClientList::on_valueCacheTimeout()
+{
+	if (!m_valueCache || m_valueCacheBlocks.isEmpty())
+	{
+		return;
+	}
+	QUaModbusValueCache::Entries changed;
+	for (auto &block : m_valueCacheBlocks)
+	{
+		// removed in the meantime
+		if (!block)
+		{
+			continue;
+		}
+		auto strPrefix = QString("%1.%2.").arg(block->client()->browseName().name()).arg(block->browseName().name());
+		for (auto value : block->values()->values())
+		{
+			// only values with good data
+			if (value->getLastError() != QModbusError::NoError)
+			{
+				continue;
+			}
+			changed.insert(strPrefix + value->browseName().name(), {
+				static_cast<qint32>(value->getType()),
+				value->getValue(),
+				value->value()->sourceTimestamp()
+			});
+		}
+	}
+	m_valueCacheBlocks.clear();
+	// NOTE : lets the cache drop entries of values removed since
+	QUaModbusValueCache::Types live;
+	for (auto client : this->clients())
+	{
+		for (auto block : client->dataBlocks()->blocks())
+		{
+			auto strPrefix = QString("%1.%2.").arg(client->browseName().name()).arg(block->browseName().name());
+			for (auto value : block->values()->values())
+			{
+				live.insert(strPrefix + value->browseName().name(), static_cast<qint32>(value->getType()));
+			}
+		}
+	}
+	m_valueCache->write(changed, live, [this](const QUaLog &log) {
+		// hand over to the ua server thread, dropped if list is gone
+		QMetaObject::invokeMethod(this, [this, log]() {
+			emit this->logMessage(log);
+		}, Qt::QueuedConnection);
+	});
+}
+
+void QUaModbusClientList::attributesToDomElement(QDomElement & domElem) const
+{
+#ifdef QUA_ACCESS_CONTROL
+	// set parmissions if any
+	if (this->hasPermissionsObject())
+	{
+		domElem.setAttribute("Permissions", this->permissionsObject()->nodeId());
+	}
+#endif // QUA_ACCESS_CONTROL
+	// set list attributes
+	domElem.setAttribute("LagThreshold", getLagThreshold());
+	domElem.setAttribute("ConnectConcurrency", getConnectConcurrency());
+	domElem.setAttribute("ErrorStatusCodes", getErrorStatusCodes() ? 1 : 0);
+	domElem.setAttribute("CompactValues", getCompactValues() ? 1 : 0);
+#ifdef UA_ENABLE_HISTORIZING
+	domElem.setAttribute("HistoryMemoryLimit", getHistoryMemoryLimit());
+#endif // UA_ENABLE_HISTORIZING
+}
+
+void QUaModbusClientList::attributesFromDomElement(QDomElement & domElem, QQueue<QUaLog>& errorLogs)
+{
+#ifdef QUA_ACCESS_CONTROL
+	// load permissions if any
+	if (domElem.hasAttribute("Permissions") && !domElem.attribute("Permissions").isEmpty())
+	{
+		QString strError = this->setPermissions(domElem.attribute("Permissions"));
+		if (strError.contains("Error"))
 		{
 			errorLogs << QUaLog(
-				tr("Cannot add TCP client without BrowseName attribute. Skipping."),
+				strError,
 				QUaLogLevel::Error,
 				QUaLogCategory::Serialization
 			);
-			continue;
 		}
-		QString strBrowseName = elemClient.attribute("BrowseName");
-		if (strBrowseName.isEmpty())
+	}
+#endif // QUA_ACCESS_CONTROL
+	// LagThreshold (optional)
+	if (domElem.hasAttribute("LagThreshold"))
+	{
+		bool bOK;
+		auto lagThreshold = domElem.attribute("LagThreshold").toUInt(&bOK);
+		if (bOK)
+		{
+			this->setLagThreshold(lagThreshold);
+		}
+		else
 		{
 			errorLogs << QUaLog(
-				tr("Cannot add TCP client with empty BrowseName attribute. Skipping."),
-				QUaLogLevel::Error,
+				tr("Invalid LagThreshold attribute '%1' in Modbus client list. Default value set.").arg(domElem.attribute("LagThreshold")),
+				QUaLogLevel::Warning,
 				QUaLogCategory::Serialization
 			);
-			continue;
 		}
-		// check if exists
-		auto client = this->browseChild<QUaModbusClient>(strBrowseName);
-		if (client)
+	}
+	// ConnectConcurrency (optional)
+	if (domElem.hasAttribute("ConnectConcurrency"))
+	{
+		bool bOK;
+		auto connectConcurrency = domElem.attribute("ConnectConcurrency").toUInt(&bOK);
+		if (bOK)
+		{
+			this->setConnectConcurrency(connectConcurrency);
+		}
+		else
 		{
 			errorLogs << QUaLog(
-				tr("Modbus client with %1 BrowseName already exists. Merging client configuration.").arg(strBrowseName),
+				tr("Invalid ConnectConcurrency attribute '%1' in Modbus client list. Default value set.").arg(domElem.attribute("ConnectConcurrency")),
 				QUaLogLevel::Warning,
 				QUaLogCategory::Serialization
 			);
-			// merge client config
-			client->fromDomElement(elemClient, errorLogs);
-			continue;
 		}
-		this->addClient<QUaModbusTcpClient>(strBrowseName);
-		client = this->browseChild<QUaModbusTcpClient>(strBrowseName);
-		if (!client)
+	}
+	// ErrorStatusCodes (optional)
+	if (domElem.hasAttribute("ErrorStatusCodes"))
+	{
+		bool bOK;
+		auto errorStatusCodes = domElem.attribute("ErrorStatusCodes").toUInt(&bOK);
+		if (bOK)
+		{
+			this->setErrorStatusCodes(errorStatusCodes != 0);
+		}
+		else
 		{
 			errorLogs << QUaLog(
-				tr("Failed to create TCP client with %1 BrowseName. Skipping.").arg(strBrowseName),
-				QUaLogLevel::Error,
+				tr("Invalid ErrorStatusCodes attribute '%1' in Modbus client list. Default value set.").arg(domElem.attribute("ErrorStatusCodes")),
+				QUaLogLevel::Warning,
 				QUaLogCategory::Serialization
 			);
-			continue;
 		}
-		// set client config
-		client->fromDomElement(elemClient, errorLogs);
-		// connect if keepConnecting is set
-		if (client->keepConnecting()->value().toBool())
+	}
+	// CompactValues (optional)
+	if (domElem.hasAttribute("CompactValues"))
+	{
+		bool bOK;
+		auto compactValues = domElem.attribute("CompactValues").toUInt(&bOK);
+		if (bOK)
 		{
-			client->connectDevice();
+			this->setCompactValues(compactValues != 0);
+		}
+		else
+		{
+			errorLogs << QUaLog(
+				tr("Invalid CompactValues attribute '%1' in Modbus client list. Default value set.").arg(domElem.attribute("CompactValues")),
+				QUaLogLevel::Warning,
+				QUaLogCategory::Serialization
+			);
 		}
 	}
-	// add Serial clients
-	QDomNodeList listSerialClients = domElem.elementsByTagName(QUaModbusRtuSerialClient::staticMetaObject.className());
-	for (int i = 0; i < listSerialClients.count(); i++)
+#ifdef UA_ENABLE_HISTORIZING
+	// HistoryMemoryLimit (optional)
+	if (domElem.hasAttribute("HistoryMemoryLimit"))
 	{
-		QDomElement elemClient = listSerialClients.at(i).toElement();
-		Q_ASSERT(!elemClient.isNull());
-		if (!elemClient.hasAttribute("BrowseName"))
+		bool bOK;
+		auto historyMemoryLimit = domElem.attribute("HistoryMemoryLimit").toUInt(&bOK);
+		if (bOK)
+		{
+			this->setHistoryMemoryLimit(historyMemoryLimit);
+		}
+		else
 		{
 			errorLogs << QUaLog(
+				tr("Invalid HistoryMemoryLimit attribute '%1' in Modbus client list. Default value set.").arg(domElem.attribute("HistoryMemoryLimit")),
+				QUaLogLevel::Warning,
+				QUaLogCategory::Serialization
+			);
+		}
+	}
+#endif // UA_ENABLE_HISTORIZING
+}
+
+void QUaModbusClientList::clientFromDomElement(QDomElement & elemClient, QQueue<QUaLog>& errorLogs)
+{
+	bool isTcp = elemClient.tagName() == QUaModbusTcpClient::staticMetaObject.className();
+	if (!elemClient.hasAttribute("BrowseName"))
+	{
+		errorLogs << QUaLog(
+			isTcp ?
+				tr("Cannot add TCP client without BrowseName attribute. Skipping.") :
 				tr("Cannot add Serial client without BrowseName attribute. Skipping."),
+			QUaLogLevel::Error,
+			QUaLogCategory::Serialization
+		);
+		return;
+	}
+	QString strBrowseName = elemClient.attribute("BrowseName");
+	if (strBrowseName.isEmpty())
+	{
+		errorLogs << QUaLog(
+			isTcp ?
+				tr("Cannot add TCP client with empty BrowseName attribute. Skipping.") :
+				tr("Cannot add Serial client with empty BrowseName. Skipping."),
+			QUaLogLevel::Error,
+			QUaLogCategory::Serialization
+		);
+		return;
+	}
+	// check if exists
+	auto client = this->browseChild<QUaModbusClient>(strBrowseName);
+	if (client)
+	{
+		// NOTE : only tcp clients are merged
+		if (!isTcp)
+		{
+			errorLogs << QUaLog(
+				tr("Modbus client with %1 BrowseName already exists. Skipping.").arg(strBrowseName),
 				QUaLogLevel::Error,
 				QUaLogCategory::Serialization
 			);
-			continue;
+			return;
 		}
-		QString strBrowseName = elemClient.attribute("BrowseName");
-		if (strBrowseName.isEmpty())
+		errorLogs << QUaLog(
+			tr("Modbus client with %1 BrowseName already exists. Merging client configuration.").arg(strBrowseName),
+			QUaLogLevel::Warning,
+			QUaLogCategory::Serialization
+		);
+		// merge client config
+		client->fromDomElement(elemClient, errorLogs);
+		return;
+	}
+	if (isTcp)
+	{
+		this->addClient<QUaModbusTcpClient>(strBrowseName);
+		client = this->browseChild<QUaModbusTcpClient>(strBrowseName);
+	}
+	else
+	{
+		this->addClient<QUaModbusRtuSerialClient>(strBrowseName);
+		client = this->browseChild<QUaModbusRtuSerialClient>(strBrowseName);
+	}
+	if (!client)
+	{
+		errorLogs << QUaLog(
+			isTcp ?
+				tr("Failed to create TCP client with %1 BrowseName. Skipping.").arg(strBrowseName) :
+				tr("Failed to create Serial client with %1 BrowseName. Skipping.").arg(strBrowseName),
+			QUaLogLevel::Error,
+			QUaLogCategory::Serialization
+		);
+		return;
+	}
+	// set client config
+	client->fromDomElement(elemClient, errorLogs);
+	// connect if keepConnecting is set, through the startup ramp
+	if (client->keepConnecting()->value().toBool())
+	{
+		this->queueConnect(client);
+	}
+}
+
+bool QUaModbusClientList::readXmlConfig(QXmlStreamReader & xml, QQueue<QUaLog>& errorLogs, QUaModbusConfigDiff * diff/* = nullptr*/)
+{
+	// root element must be the client list
+	if (!xml.readNextStartElement() || xml.name() != QLatin1String(QUaModbusClientList::staticMetaObject.className()))
+	{
+		if (xml.hasError())
 		{
 			errorLogs << QUaLog(
-				tr("Cannot add Serial client with empty BrowseName. Skipping."),
+				tr("Invalid XML in Line %1 Column %2 Error %3").arg(xml.lineNumber()).arg(xml.columnNumber()).arg(xml.errorString()),
 				QUaLogLevel::Error,
 				QUaLogCategory::Serialization
 			);
+			return false;
+		}
+		errorLogs << QUaLog(
+			tr("No Modbus client list found in XML config."),
+			QUaLogLevel::Error,
+			QUaLogCategory::Serialization
+		);
+		return false;
+	}
+	QDomDocument docList;
+	QDomElement elemListClients = docList.createElement(xml.name().toString());
+	QUaModbusClientList::readDomAttributes(xml, elemListClients);
+	this->attributesFromDomElement(elemListClients, errorLogs);
+	// in merge mode clients not found in the config are removed at the end
+	QHash<QString, QUaModbusClient*> liveClients;
+	if (diff)
+	{
+		for (auto client : this->clients())
+		{
+			liveClients.insert(client->browseName().name(), client);
+		}
+	}
+	// NOTE : clients are applied as they are read, so only one client is held as dom at a time.
+	//        Callers check the syntax in a first pass (see checkXml), so nothing is applied from a malformed config
+	while (xml.readNextStartElement())
+	{
+		if (xml.name() != QLatin1String(QUaModbusTcpClient::staticMetaObject.className()) &&
+			xml.name() != QLatin1String(QUaModbusRtuSerialClient::staticMetaObject.className()))
+		{
+			xml.skipCurrentElement();
 			continue;
 		}
-		// check if exists
-		auto client = this->browseChild<QUaModbusClient>(strBrowseName);
+		QDomDocument docClient;
+		QDomElement elemClient = QUaModbusClientList::readDomElement(xml, docClient);
+		if (xml.hasError())
+		{
+			break;
+		}
+		if (diff)
+		{
+			this->mergeClientFromDomElement(elemClient, errorLogs, liveClients, *diff);
+			continue;
+		}
+		this->clientFromDomElement(elemClient, errorLogs);
+	}
+	if (xml.hasError())
+	{
+		// NOTE : in merge mode nothing is removed, config was not read to the end
+		errorLogs << QUaLog(
+			tr("Invalid XML in Line %1 Column %2 Error %3").arg(xml.lineNumber()).arg(xml.columnNumber()).arg(xml.errorString()),
+			QUaLogLevel::Error,
+			QUaLogCategory::Serialization
+		);
+		return false;
+	}
+	if (diff)
+	{
+		for (auto client : liveClients)
+		{
+			for (auto block : client->dataBlocks()->blocks())
+			{
+				diff->blocks.removed++;
+				diff->values.removed += block->values()->values().count();
+			}
+			client->remove();
+			diff->clients.removed++;
+		}
+		auto log = QUaLog(
+			tr("Merged config. Clients added %1, removed %2, changed %3. Blocks added %4, removed %5, changed %6. Values added %7, removed %8, changed %9.")
+				.arg(diff->clients.added).arg(diff->clients.removed).arg(diff->clients.changed)
+				.arg(diff->blocks.added ).arg(diff->blocks.removed ).arg(diff->blocks.changed )
+				.arg(diff->values.added ).arg(diff->values.removed ).arg(diff->values.changed ),
+			QUaLogLevel::Info,
+			QUaLogCategory::Serialization
+		);
+		emit this->logMessage(log);
+		return true;
+	}
+	this->validateNow(errorLogs);
+	return true;
+}
+
+void QUaModbusClientList::mergeClientFromDomElement(QDomElement & elemClient, QQueue<QUaLog>& errorLogs, QHash<QString, QUaModbusClient*>& liveClients, QUaModbusConfigDiff & diff)
+{
+	QString strBrowseName = elemClient.attribute("BrowseName");
+	auto client = liveClients.take(strBrowseName);
+	if (!client)
+	{
+		// new client, same as a normal load
+		this->clientFromDomElement(elemClient, errorLogs);
+		client = this->browseChild<QUaModbusClient>(strBrowseName);
 		if (client)
+		{
+			diff.clients.added++;
+			for (auto block : client->dataBlocks()->blocks())
+			{
+				diff.blocks.added++;
+				diff.values.added += block->values()->values().count();
+			}
+		}
+		return;
+	}
+	bool isTcp = elemClient.tagName() == QUaModbusTcpClient::staticMetaObject.className();
+	if (isTcp != (qobject_cast<QUaModbusTcpClient*>(client) != nullptr))
+	{
+		// NOTE : removal is deferred, so it cannot be re-created with the same name in this pass
+		errorLogs << QUaLog(
+			tr("Modbus client %1 changed its type. Delete it first. Skipping.").arg(strBrowseName),
+			QUaLogLevel::Error,
+			QUaLogCategory::Serialization
+		);
+		return;
+	}
+	QDomDocument docLive;
+	auto elemLive = client->toDomElement(docLive);
+	if (QUaModbusClientList::attributesChanged(elemLive, elemClient))
+	{
+		// NOTE : only client attributes, blocks are merged below
+		auto elemAttrs = QUaModbusClientList::shallowDomElement(elemClient, QUaModbusDataBlockList::staticMetaObject.className());
+		client->fromDomElement(elemAttrs, errorLogs);
+		diff.clients.changed++;
+		// NOTE : an open connection keeps its old parameters until reconnected
+		if (QUaModbusClientList::attributesChanged(elemLive, elemClient, QUaModbusClientList::m_connectionAttributes))
+		{
+			client->reconnectDevice();
+		}
+		if (client->keepConnecting()->value().toBool())
+		{
+			this->queueConnect(client);
+		}
+	}
+	// NOTE : a missing block list is an empty one, so live blocks are removed
+	auto elemBlockList = elemClient.firstChildElement(QUaModbusDataBlockList::staticMetaObject.className());
+	if (elemBlockList.isNull())
+	{
+		elemBlockList = elemClient.ownerDocument().createElement(QUaModbusDataBlockList::staticMetaObject.className());
+	}
+	client->dataBlocks()->mergeDomElement(elemBlockList, errorLogs, diff);
+}
+
+void QUaModbusClientList::on_importTimeout()
+{
+	QElapsedTimer timerSlice;
+	timerSlice.start();
+	while (!m_importSteps.isEmpty() && timerSlice.elapsed() < m_importSlice)
+	{
+		if (m_importCancel.loadAcquire())
+		{
+			this->finishImport(true);
+			return;
+		}
+		auto step = m_importSteps.dequeue();
+		auto strTagName = step.domElem.tagName();
+		if (strTagName == QUaModbusClientList::staticMetaObject.className())
+		{
+			this->attributesFromDomElement(step.domElem, m_importLogs);
+		}
+		else if (strTagName == QUaModbusDataBlockList::staticMetaObject.className())
+		{
+			// NOTE : steps of a client come right after it, so lookup happens once per client
+			if (!m_importClient || m_importClient->browseName().name() != step.strClient)
+			{
+				m_importClient = this->browseChild<QUaModbusClient>(step.strClient);
+			}
+			// client creation failed and was already logged
+			if (m_importClient)
+			{
+				m_importClient->dataBlocks()->fromDomElement(step.domElem, m_importLogs);
+			}
+		}
+		else
+		{
+			this->clientFromDomElement(step.domElem, m_importLogs);
+			m_importClient = this->browseChild<QUaModbusClient>(step.strClient);
+		}
+		m_importDone += step.nodes;
+	}
+	this->importProgress()->setValue(m_importTotal > 0 ? 100.0 * m_importDone / m_importTotal : 100.0);
+	emit this->importProgressChanged(m_importDone, m_importTotal);
+	if (m_importSteps.isEmpty())
+	{
+		this->finishImport(false);
+		return;
+	}
+	// yield to the event loop before the next slice
+	m_importTimer.start();
+}
+
+void QUaModbusClientList::finishImport(const bool & cancelled)
+{
+	m_importTimer.stop();
+	m_importSteps.clear();
+	m_importClient = nullptr;
+	m_importing    = false;
+	if (cancelled)
+	{
+		m_importLogs << QUaLog(
+			tr("Import cancelled. %1 of %2 nodes were created.").arg(m_importDone).arg(m_importTotal),
+			QUaLogLevel::Warning,
+			QUaLogCategory::Serialization
+		);
+	}
+	// NOTE : also what was created before a cancellation
+	this->validateNow(m_importLogs);
+	QQueue<QUaLog> errorLogs;
+	errorLogs.swap(m_importLogs);
+	emit this->importFinished(errorLogs, cancelled);
+}
+
+void QUaModbusClientList::on_validateTimeout()
+{
+	// finishImport validates the whole list
+	if (m_importing)
+	{
+		return;
+	}
+	auto setClients = m_validateClients;
+	m_validateClients.clear();
+	for (auto &strClient : setClients)
+	{
+		// removed in the meantime
+		auto client = this->browseChild<QUaModbusClient>(strClient);
+		if (!client)
+		{
+			continue;
+		}
+		for (auto &log : QUaModbusConfigValidator::validate(client))
+		{
+			emit this->logMessage(log);
+		}
+	}
+}
+
+void QUaModbusClientList::validateLater(QUaModbusClient * client)
+{
+	m_validateClients.insert(client->browseName().name());
+	// NOTE : restarted on each edit, so a burst of edits is checked once
+	m_validateTimer.start();
+}
+
+void QUaModbusClientList::validateNow(QQueue<QUaLog>& errorLogs)
+{
+	// pending edits are covered by the whole list check
+	m_validateTimer.stop();
+	m_validateClients.clear();
+	errorLogs << QUaModbusConfigValidator::validate(this);
+}
+
+bool QUaModbusClientList::parseXmlImport(const QByteArray & byteXmlConfig, QQueue<ImportStep>& steps, QQueue<QUaLog>& errorLogs, const QAtomicInt & cancel)
+{
+	QXmlStreamReader xml(byteXmlConfig);
+	// find client list at any depth
+	bool found = false;
+	while (!found && !xml.atEnd())
+	{
+		xml.readNext();
+		found = xml.isStartElement() && xml.name() == QLatin1String(QUaModbusClientList::staticMetaObject.className());
+	}
+	if (!found)
+	{
+		errorLogs << QUaLog(
+			xml.hasError() ?
+				tr("Invalid XML in Line %1 Column %2 Error %3").arg(xml.lineNumber()).arg(xml.columnNumber()).arg(xml.errorString()) :
+				tr("No Modbus client list found in XML config."),
+			QUaLogLevel::Error,
+			QUaLogCategory::Serialization
+		);
+		return false;
+	}
+	// list attributes first
+	ImportStep stepList;
+	stepList.domElem = stepList.domDoc.createElement(xml.name().toString());
+	stepList.nodes   = 0;
+	QUaModbusClientList::readDomAttributes(xml, stepList.domElem);
+	steps << stepList;
+	auto strBlockList = QString(QUaModbusDataBlockList::staticMetaObject.className());
+	auto strBlock     = QString(QUaModbusDataBlock::staticMetaObject.className());
+	auto strValue     = QString(QUaModbusValue::staticMetaObject.className());
+	QSet<QString> setClients;
+	while (xml.readNextStartElement())
+	{
+		if (cancel.loadAcquire())
+		{
+			return true;
+		}
+		bool isTcp = xml.name() == QLatin1String(QUaModbusTcpClient::staticMetaObject.className());
+		if (!isTcp && xml.name() != QLatin1String(QUaModbusRtuSerialClient::staticMetaObject.className()))
+		{
+			xml.skipCurrentElement();
+			continue;
+		}
+		QDomDocument docClient;
+		QDomElement elemClient = QUaModbusClientList::readDomElement(xml, docClient);
+		if (xml.hasError())
+		{
+			break;
+		}
+		// validate
+		QString strBrowseName = elemClient.attribute("BrowseName");
+		if (strBrowseName.isEmpty())
 		{
 			errorLogs << QUaLog(
-				tr("Modbus client with %1 BrowseName already exists. Skipping.").arg(strBrowseName),
+				isTcp ?
+					tr("Cannot add TCP client with empty BrowseName attribute. Skipping.") :
+					tr("Cannot add Serial client with empty BrowseName. Skipping."),
 				QUaLogLevel::Error,
 				QUaLogCategory::Serialization
 			);
 			continue;
 		}
-		this->addClient<QUaModbusRtuSerialClient>(strBrowseName);
-		client = this->browseChild<QUaModbusRtuSerialClient>(strBrowseName);
-		if (!client)
+		if (setClients.contains(strBrowseName))
 		{
 			errorLogs << QUaLog(
-				tr("Failed to create Serial client with %1 BrowseName. Skipping.").arg(strBrowseName),
-				QUaLogLevel::Error,
+				tr("Modbus client %1 is defined more than once in XML config.").arg(strBrowseName),
+				QUaLogLevel::Warning,
 				QUaLogCategory::Serialization
 			);
+		}
+		setClients.insert(strBrowseName);
+		// client attributes, then one step per block
+		ImportStep stepClient;
+		stepClient.domDoc    = docClient;
+		stepClient.domElem   = QUaModbusClientList::shallowDomElement(elemClient, strBlockList);
+		stepClient.strClient = strBrowseName;
+		stepClient.nodes     = 1;
+		steps << stepClient;
+		QDomElement elemBlockList = elemClient.firstChildElement(strBlockList);
+		QDomElement elemBlock     = elemBlockList.firstChildElement(strBlock);
+		while (!elemBlock.isNull())
+		{
+			// NOTE : block is moved, not copied, into its own list element
+			QDomElement elemNext = elemBlock.nextSiblingElement(strBlock);
+			ImportStep stepBlock;
+			stepBlock.domDoc    = docClient;
+			stepBlock.domElem   = elemBlockList.cloneNode(false).toElement();
+			stepBlock.domElem.appendChild(elemBlock);
+			stepBlock.strClient = strBrowseName;
+			stepBlock.nodes     = 1 + static_cast<quint32>(elemBlock.elementsByTagName(strValue).count());
+			steps << stepBlock;
+			elemBlock = elemNext;
+		}
+	}
+	if (xml.hasError())
+	{
+		errorLogs << QUaLog(
+			tr("Invalid XML in Line %1 Column %2 Error %3").arg(xml.lineNumber()).arg(xml.columnNumber()).arg(xml.errorString()),
+			QUaLogLevel::Error,
+			QUaLogCategory::Serialization
+		);
+		return false;
+	}
+	return true;
+}
+
+bool QUaModbusClientList::attributesChanged(const QDomElement & elemLive, const QDomElement & elemNew, const QStringList & strAttrNames)
+{
+	// NOTE : attributes missing in elemNew keep their live value on load, so they are not a change
+	auto attrsNew = elemNew.attributes();
+	for (int i = 0; i < attrsNew.count(); i++)
+	{
+		auto attrNew = attrsNew.item(i).toAttr();
+		if (!strAttrNames.isEmpty() && !strAttrNames.contains(attrNew.name()))
+		{
 			continue;
 		}
-		// set client config
-		client->fromDomElement(elemClient, errorLogs);
-		// connect if keepConnecting is set
-		if (client->keepConnecting()->value().toBool())
+		if (elemLive.attribute(attrNew.name()) != attrNew.value())
 		{
-			client->connectDevice();
+			return true;
 		}
 	}
+	return false;
+}
+
+QDomElement QUaModbusClientList::shallowDomElement(const QDomElement & domElem, const QString & strListName)
+{
+	// NOTE : element clones keep their attributes
+	QDomElement elemShallow = domElem.cloneNode(false).toElement();
+	QDomElement elemList    = domElem.firstChildElement(strListName);
+	elemShallow.appendChild(elemList.isNull() ?
+		domElem.ownerDocument().createElement(strListName) :
+		elemList.cloneNode(false));
+	return elemShallow;
+}
+
+QDomElement QUaModbusClientList::readDomElement(QXmlStreamReader & xml, QDomDocument & domDoc)
+{
+	QDomElement domElem = domDoc.createElement(xml.name().toString());
+	QUaModbusClientList::readDomAttributes(xml, domElem);
+	// NOTE : schema has no text content, only attributes and child elements
+	while (xml.readNextStartElement())
+	{
+		domElem.appendChild(QUaModbusClientList::readDomElement(xml, domDoc));
+	}
+	return domElem;
+}
+
+void QUaModbusClientList::readDomAttributes(QXmlStreamReader & xml, QDomElement & domElem)
+{
+	for (auto &attr : xml.attributes())
+	{
+		domElem.setAttribute(attr.qualifiedName().toString(), attr.value().toString());
+	}
+}
+
+void QUaModbusClientList::writeDomElement(QXmlStreamWriter & xml, const QDomElement & domElem)
+{
+	xml.writeStartElement(domElem.tagName());
+	QUaModbusClientList::writeDomAttributes(xml, domElem);
+	for (auto elemChild = domElem.firstChildElement(); !elemChild.isNull(); elemChild = elemChild.nextSiblingElement())
+	{
+		QUaModbusClientList::writeDomElement(xml, elemChild);
+	}
+	xml.writeEndElement();
+}
+
+void QUaModbusClientList::writeDomAttributes(QXmlStreamWriter & xml, const QDomElement & domElem)
+{
+	auto attrs = domElem.attributes();
+	for (int i = 0; i < attrs.count(); i++)
+	{
+		auto attr = attrs.item(i).toAttr();
+		xml.writeAttribute(attr.name(), attr.value());
+	}
 }
\ No newline at end of file
@@ -8,12 +8,45 @@
 class QUaPermissionsList;
 #endif // !QUA_ACCESS_CONTROL
 
+#include <QUaProperty>
+#include <QUaBaseDataVariable>
+
 #include <QDomDocument>
 #include <QDomElement>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
 #include <QRegularExpression>
 #include <QRegularExpressionMatch>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QAtomicInt>
+#include <QPointer>
+#include <QScopedPointer>
+#include <QSet>
+
+#include <QLambdaThreadWorker>
+
+#include "quamodbusvaluecache.h"
+#include "quamodbushistorian.h"
 
 class QUaModbusClient;
+class QUaModbusDataBlock;
+class QUaModbusCsvReader;
+class QUaModbusCsvWriter;
+
+// what a config merge added, removed or reconfigured, per tree level
+struct QUaModbusConfigDiff
+{
+	struct Counts
+	{
+		int added   = 0;
+		int removed = 0;
+		int changed = 0;
+	};
+	Counts clients;
+	Counts blocks;
+	Counts values;
+};
 
 #ifndef QUA_ACCESS_CONTROL
 class QUaModbusClientList : public QUaFolderObject
@@ -21,12 +54,48 @@ class QUaModbusClientList : public QUaFolderObject
 class QUaModbusClientList : public QUaFolderObjectProtected
 #endif // !QUA_ACCESS_CONTROL
 {
+	friend class QUaModbusDataBlockList;
+	friend class QUaModbusValueList;
+	friend class QUaModbusDataBlock;
+	friend class QUaModbusClient;
+	friend class QUaModbusBinaryConfig;
+
     Q_OBJECT
 
+	// UA properties
+	Q_PROPERTY(QUaProperty * LagThreshold       READ lagThreshold      )
+	Q_PROPERTY(QUaProperty * ConnectConcurrency READ connectConcurrency)
+	Q_PROPERTY(QUaProperty * ErrorStatusCodes   READ errorStatusCodes  )
+	Q_PROPERTY(QUaProperty * CompactValues      READ compactValues     )
+#ifdef UA_ENABLE_HISTORIZING
+	Q_PROPERTY(QUaProperty * HistoryMemoryLimit READ historyMemoryLimit)
+#endif // UA_ENABLE_HISTORIZING
+
+	// UA variables
+	Q_PROPERTY(QUaBaseDataVariable * EventLoopLag        READ eventLoopLag       )
+	Q_PROPERTY(QUaBaseDataVariable * EventLoopQueueDepth READ eventLoopQueueDepth)
+	Q_PROPERTY(QUaBaseDataVariable * ImportProgress      READ importProgress     )
+
 public:
 	Q_INVOKABLE explicit QUaModbusClientList(QUaServer *server);
 	~QUaModbusClientList();
 
+	// UA properties
+
+	QUaProperty * lagThreshold();
+	QUaProperty * connectConcurrency();
+	QUaProperty * errorStatusCodes  ();
+	QUaProperty * compactValues     ();
+#ifdef UA_ENABLE_HISTORIZING
+	QUaProperty * historyMemoryLimit();
+#endif // UA_ENABLE_HISTORIZING
+
+	// UA variables
+
+	QUaBaseDataVariable * eventLoopLag();
+	QUaBaseDataVariable * eventLoopQueueDepth();
+	QUaBaseDataVariable * importProgress();
+
 	// UA methods
 
 	Q_INVOKABLE QString addTcpClient(const QUaQualifiedName& clientId);
@@ -39,10 +108,66 @@ public:
 
 	Q_INVOKABLE QString setXmlConfig(QString strXmlConfig);
 
+	// diff / merge mode of setXmlConfig, removes what is not in the config
+	// and only touches what changed, so untouched devices keep connected and polling
+	Q_INVOKABLE QString mergeXmlConfig(QString strXmlConfig);
+
+	// background mode of setXmlConfig, returns once started, see importFinished
+	Q_INVOKABLE QString importXmlConfig(QString strXmlConfig);
+
+	Q_INVOKABLE void cancelImport();
+
+	Q_INVOKABLE void startTrace();
+
+	Q_INVOKABLE void stopTrace();
+
+	Q_INVOKABLE QString chromeTrace();
+
 	// C++ API
 
 	QList<QUaModbusClient*> clients();
 
+	quint32 getLagThreshold() const;
+	void    setLagThreshold(const quint32 &lagThreshold);
+
+	double  getEventLoopLag() const;
+
+	// clients connecting at the same time when a config is loaded or after an outage, zero is no limit
+	quint32 getConnectConcurrency() const;
+	void    setConnectConcurrency(const quint32 &connectConcurrency);
+
+	// errors of blocks and values as the status code of their Data and Value (e.g. BadTimeout)
+	// instead of LastError variables, which are removed. Halves the nodes to subscribe to
+	bool getErrorStatusCodes() const;
+	void setErrorStatusCodes(const bool &errorStatusCodes);
+
+	// values without the nodes of their configuration, only Value is in the address space and
+	// errors are its status code. Configuration through C++, XML or QUaModbusValue::setXmlConfig
+	bool getCompactValues() const;
+	void setCompactValues(const bool &compactValues);
+
+#ifdef UA_ENABLE_HISTORIZING
+	// memory (in kilobytes) of the history of all values and blocks with Historizing, zero is no limit
+	quint32 getHistoryMemoryLimit() const;
+	void    setHistoryMemoryLimit(const quint32 &historyMemoryLimit);
+	// serves HistoryRead of the Value of values and the Data of blocks
+	QUaModbusHistorian * historian();
+	// disk tier of the historian, a directory per client under strDirPath. Chunks dropped from
+	// memory stay readable from disk until the retention of the store deletes them.
+	// NOTE : an empty path disables it, retention is set through historyStore()
+	QQueue<QUaLog>          setHistoryStorePath(const QString &strDirPath);
+	QString                 historyStorePath() const;
+	QUaModbusHistoryStore * historyStore();
+#endif // UA_ENABLE_HISTORIZING
+
+	// parsing and validation run in a worker thread, nodes are then created in time sliced
+	// batches on this thread so the ua server keeps answering. False if an import is running.
+	// NOTE : the client list may be the root element or be nested, e.g. in an application config
+	bool startXmlImport(const QByteArray &byteXmlConfig);
+	bool isImporting() const;
+
+	quint32 getEventLoopQueueDepth() const;
+
 	QString csvClients();
 
 	QString csvBlocks();
@@ -55,8 +180,41 @@ public:
 
 	QQueue<QUaLog> setCsvValues(QString strCsvValues);
 
+	// streaming CSV import / export, same format as the string versions
+	bool           writeCsvClients(QIODevice * device);
+	bool           writeCsvBlocks (QIODevice * device);
+	bool           writeCsvValues (QIODevice * device);
+	QQueue<QUaLog> readCsvClients (QIODevice * device);
+	QQueue<QUaLog> readCsvBlocks  (QIODevice * device);
+	QQueue<QUaLog> readCsvValues  (QIODevice * device);
+
+	// streaming XML import / export, same schema as toDomElement
+	QQueue<QUaLog> readXmlConfig (QIODevice * device);
+	bool           writeXmlConfig(QIODevice * device) const;
+	// writes the list element only, so it can be embedded in an application document
+	void           writeXmlConfig(QXmlStreamWriter & xml) const;
+	QQueue<QUaLog> mergeXmlConfig(QIODevice * device);
+
+	// binary snapshot import / export, for fast restarts (see QUaModbusBinaryConfig)
+	QByteArray     binaryConfig() const;
+	QQueue<QUaLog> setBinaryConfig(const QByteArray &byteConfig);
+	bool           writeBinaryConfig(QIODevice * device) const;
+	// NOTE : files are memory mapped if possible
+	QQueue<QUaLog> readBinaryConfig (QIODevice * device);
+
+	// warm start, restores the last known values found in the file into values not read yet,
+	// with UncertainLastUsableValue status and their original timestamps. Then values read
+	// successfully are written back asynchronously, at most once per m_valueCachePeriod.
+	// NOTE : call once the config is loaded, an empty file name disables it
+	QQueue<QUaLog> setValueCacheFile(const QString &strFileName);
+	QString        valueCacheFile() const;
+
 	void clearInmediatly();
 
+	// expands a compact id specification for bulk creation, returns "Success" or an error.
+	// comma separated ids, an id may end in a range, e.g. "Flow, Temp[1..8], Level[001..100]"
+	static QString expandIds(const QString &strIds, QStringList &listIds);
+
 #ifdef QUA_ACCESS_CONTROL
 	QUaPermissionsList * getPermissionsList();
 #endif // QUA_ACCESS_CONTROL
@@ -66,54 +224,200 @@ public:
 	void        fromDomElement(QDomElement  & domElem, QQueue<QUaLog>& errorLogs);
 
 signals:
+	void lagThresholdChanged(const quint32 &lagThreshold);
+	void connectConcurrencyChanged(const quint32 &connectConcurrency);
+	void errorStatusCodesChanged  (const bool    &errorStatusCodes  );
+	void compactValuesChanged     (const bool    &compactValues     );
+#ifdef UA_ENABLE_HISTORIZING
+	void historyMemoryLimitChanged(const quint32 &historyMemoryLimit);
+#endif // UA_ENABLE_HISTORIZING
+	void logMessage(const QUaLog &log);
 	void aboutToClear();
 	void aboutToDestroy();
+	void importProgressChanged(const quint32 &nodesDone, const quint32 &nodesTotal);
+	// NOTE : nodes created before a cancellation are kept
+	void importFinished(const QQueue<QUaLog> &errorLogs, const bool &cancelled);
+
+private slots:
+	void on_lagThresholdChanged(const QVariant &value, const bool &networkChange);
+	void on_connectConcurrencyChanged(const QVariant &value, const bool &networkChange);
+	void on_errorStatusCodesChanged  (const QVariant &value, const bool &networkChange);
+	void on_compactValuesChanged     (const QVariant &value, const bool &networkChange);
+#ifdef UA_ENABLE_HISTORIZING
+	void on_historyMemoryLimitChanged(const QVariant &value, const bool &networkChange);
+#endif // UA_ENABLE_HISTORIZING
+	void on_monitorTimeout();
+	void on_importTimeout();
+	void on_validateTimeout();
+	void on_valueCacheTimeout();
 
 private:
 	template<typename T>
 	QString addClient(const QUaQualifiedName &clientId);
+	// does not look for an existing client, so callers with their own index (csv import) do not
+	// browse the children. nullptr and strError if it fails
+	template<typename T>
+	T * createClient(const QUaQualifiedName &clientId, QString &strError);
+
+	QUaProperty*         m_lagThreshold;
+	QUaProperty*         m_connectConcurrency;
+	QUaProperty*         m_errorStatusCodes;
+	QUaProperty*         m_compactValues;
+	// last applied, writing the same value again does not visit every block
+	bool                 m_errorStatusCodesCache;
+	bool                 m_compactValuesCache;
+#ifdef UA_ENABLE_HISTORIZING
+	QUaProperty*         m_historyMemoryLimit;
+	QUaModbusHistorian   m_historian;
+	QScopedPointer<QUaModbusHistoryStore> m_historyStore;
+#endif // UA_ENABLE_HISTORIZING
+	QUaBaseDataVariable* m_eventLoopLag;
+	QUaBaseDataVariable* m_eventLoopQueueDepth;
+	QTimer        m_monitorTimer;
+	QElapsedTimer m_monitorClock;
+	bool          m_lagging;
+
+	// one step of a background import, the list attributes, a client or a block of a client
+	struct ImportStep
+	{
+		QDomDocument domDoc;
+		QDomElement  domElem;
+		QString      strClient;
+		quint32      nodes;
+	};
+	QLambdaThreadWorker     * m_importWorker;
+	QAtomicInt                m_importCancel;
+	bool                      m_importing;
+	QQueue<ImportStep>        m_importSteps;
+	QQueue<QUaLog>            m_importLogs;
+	quint32                   m_importDone;
+	quint32                   m_importTotal;
+	QPointer<QUaModbusClient> m_importClient;
+	QTimer                    m_importTimer;
+	QUaBaseDataVariable     * m_importProgress;
+	static int                m_importSlice;
+
+	// runs in the worker thread, no nodes are touched
+	static bool parseXmlImport(const QByteArray &byteXmlConfig, QQueue<ImportStep> &steps, QQueue<QUaLog> &errorLogs, const QAtomicInt &cancel);
+	void finishImport(const bool &cancelled);
+
+	// register layout checks (see QUaModbusConfigValidator), edits are checked once they
+	// settle and conflicts go to logMessage, imports add them to their error logs instead
+	QTimer        m_validateTimer;
+	QSet<QString> m_validateClients;
+	static int    m_validateDelay;
+	void validateLater(QUaModbusClient * client);
+	void validateNow(QQueue<QUaLog> &errorLogs);
+
+	// warm start, blocks read successfully since the last cache write
+	QScopedPointer<QUaModbusValueCache> m_valueCache;
+	QTimer                              m_valueCacheTimer;
+	QHash<QUaModbusDataBlock*, QPointer<QUaModbusDataBlock>> m_valueCacheBlocks;
+	static int                          m_valueCachePeriod;
+	void valueCacheChanged(QUaModbusDataBlock * block);
+
+	// startup ramp, clients with KeepConnecting wait in line for one of ConnectConcurrency slots.
+	// A slot is freed when the attempt succeeds or fails, or after m_connectTimeout so devices
+	// that do not answer (long TCP connect timeouts) do not stall the rest
+	QQueue<QUaModbusClient*>        m_connectQueue;
+	QSet<QUaModbusClient*>          m_connectQueued;
+	QHash<QUaModbusClient*, qint64> m_connecting;
+	QElapsedTimer                   m_connectClock;
+	static int                      m_connectTimeout;
+	void queueConnect  (QUaModbusClient * client);
+	// NOTE : also called on destruction, so no deleted clients are kept
+	void dequeueConnect(QUaModbusClient * client);
+	void connectNext();
+
+	// logs when lag crosses threshold, returns if lagging
+	bool checkLag(const QString &strThread, const double &lag, const bool &wasLagging);
+
+	// XML helpers shared by dom and stream import / export
+	void attributesToDomElement  (QDomElement & domElem) const;
+	void attributesFromDomElement(QDomElement & domElem, QQueue<QUaLog>& errorLogs);
+	void clientFromDomElement    (QDomElement & elemClient, QQueue<QUaLog>& errorLogs);
+	// returns false if the config is not valid XML or has no client list
+	bool readXmlConfig(QXmlStreamReader & xml, QQueue<QUaLog>& errorLogs, QUaModbusConfigDiff * diff = nullptr);
+	// first pass without dom or nodes, so a config with a syntax error loads nothing
+	static bool checkXml(QXmlStreamReader & xml, QQueue<QUaLog>& errorLogs);
+	static bool checkXml(QIODevice * device, QQueue<QUaLog>& errorLogs);
+	// merge mode, clients found are taken out of liveClients
+	void mergeClientFromDomElement(QDomElement & elemClient, QQueue<QUaLog>& errorLogs, QHash<QString, QUaModbusClient*> &liveClients, QUaModbusConfigDiff &diff);
+	// true if any attribute of elemNew has a different value in elemLive, children not compared
+	// only strAttrNames if not empty
+	static bool        attributesChanged(const QDomElement & elemLive, const QDomElement & elemNew, const QStringList & strAttrNames = QStringList());
+	// client attributes only used when connecting
+	static const QStringList m_connectionAttributes;
+	// copy of domElem with an empty child list, so fromDomElement only applies its attributes
+	static QDomElement shallowDomElement(const QDomElement & domElem, const QString & strListName);
+	// NOTE : a single client is converted to or from dom at a time, so schema stays in toDomElement / fromDomElement
+	static QDomElement readDomElement   (QXmlStreamReader & xml, QDomDocument & domDoc);
+	static void        readDomAttributes(QXmlStreamReader & xml, QDomElement & domElem);
+	static void        writeDomElement   (QXmlStreamWriter & xml, const QDomElement & domElem);
+	static void        writeDomAttributes(QXmlStreamWriter & xml, const QDomElement & domElem);
+	// CSV helpers shared by string and device import / export
+	void           writeCsvClients(QUaModbusCsvWriter & writer);
+	void           writeCsvBlocks (QUaModbusCsvWriter & writer);
+	void           writeCsvValues (QUaModbusCsvWriter & writer);
+	QQueue<QUaLog> readCsvClients (QUaModbusCsvReader & reader);
+	QQueue<QUaLog> readCsvBlocks  (QUaModbusCsvReader & reader);
+	QQueue<QUaLog> readCsvValues  (QUaModbusCsvReader & reader);
+
+	static quint32 m_monitorPeriod;
+	static int     m_maxRangeIds;
 
 };
 
 template<typename T>
 inline QString QUaModbusClientList::addClient(const QUaQualifiedName& clientId)
+{
+	// check if id already exists
+	if (this->hasChild(clientId))
+	{
+		return tr("%1 : Client Id already exists.").arg("Error");
+	}
+	QString strError;
+	return this->createClient<T>(clientId, strError) ? "Success" : strError;
+}
+
+template<typename T>
+inline T * QUaModbusClientList::createClient(const QUaQualifiedName& clientId, QString &strError)
 {
 	auto strClientId = clientId.name();
 	// check empty
 	if (strClientId.isEmpty())
 	{
-		return tr("%1 : Client Id argument cannot be empty.").arg("Error");
+		strError = tr("%1 : Client Id argument cannot be empty.").arg("Error");
+		return nullptr;
 	}
 	// check valid length
 	if (strClientId.count() > 40)
 	{
-		return tr("%1 : Client Id cannot contain more than 40 characters.").arg("Error");
+		strError = tr("%1 : Client Id cannot contain more than 40 characters.").arg("Error");
+		return nullptr;
 	}
 	// check not called Name
 	if (strClientId.compare("Name", Qt::CaseSensitive) == 0)
 	{
-		return tr("%1 : Client Id cannot be 'Name'.").arg("Error");
+		strError = tr("%1 : Client Id cannot be 'Name'.").arg("Error");
+		return nullptr;
 	}
 	// check valid characters
-	QRegularExpression rx("^[a-zA-Z0-9_]*$");
+	static const QRegularExpression rx("^[a-zA-Z0-9_]*$");
 	QRegularExpressionMatch match = rx.match(strClientId, 0, QRegularExpression::PartialPreferCompleteMatch);
 	if (!match.hasMatch())
 	{
-		return tr("%1 : Client Id can only contain numbers, letters and underscores /^[a-zA-Z0-9_]*$/.").arg("Error");
-	}
-	// check if id already exists
-	if (this->hasChild(clientId))
-	{
-		return tr("%1 : Client Id already exists.").arg("Error");
+		strError = tr("%1 : Client Id can only contain numbers, letters and underscores /^[a-zA-Z0-9_]*$/.").arg("Error");
+		return nullptr;
 	}
 	// create instance
 	QUaNodeId nodeId = { 0, QString("modbus.%1").arg(strClientId) };
 	auto client = this->addChild<T>(clientId, nodeId);
 	if (!client)
 	{
-		return  tr("%1 : NodeId %2 already exists.").arg("Error").arg(nodeId);
+		strError = tr("%1 : NodeId %2 already exists.").arg("Error").arg(nodeId);
 	}
-	return "Success";
+	return client;
 }
 
 #endif // QUAMODBUSCLIENTLIST_H
@@ -0,0 +1,199 @@
+#include "quamodbusconfigvalidator.h"
+
+#include "quamodbusclient.h"
+#include "quamodbusdatablocklist.h"
+#include "quamodbusvaluelist.h"
+#include "quamodbusvalue.h"
+
+#include <QMetaEnum>
+
+#include <algorithm>
+#include <climits>
+
+QUaModbusIntervalIndex::QUaModbusIntervalIndex(const QVector<Interval> &intervals)
+	: m_intervals(intervals)
+{
+	std::sort(m_intervals.begin(), m_intervals.end(), [](const Interval &a, const Interval &b) {
+		return a.start != b.start ? a.start < b.start : a.end < b.end;
+	});
+	m_maxEnd.resize(m_intervals.count());
+	this->build(0, m_intervals.count());
+}
+
+const QVector<QUaModbusIntervalIndex::Interval> & QUaModbusIntervalIndex::intervals() const
+{
+	return m_intervals;
+}
+
+QVector<int> QUaModbusIntervalIndex::overlapping(const int & start, const int & end) const
+{
+	QVector<int> matches;
+	this->query(0, m_intervals.count(), start, end, matches);
+	return matches;
+}
+
+int QUaModbusIntervalIndex::build(const int & lo, const int & hi)
+{
+	if (lo >= hi)
+	{
+		return INT_MIN;
+	}
+	// NOTE : middle of each sorted sub range is the root of its subtree
+	int mid = lo + (hi - lo) / 2;
+	m_maxEnd[mid] = qMax(m_intervals.at(mid).end, qMax(this->build(lo, mid), this->build(mid + 1, hi)));
+	return m_maxEnd.at(mid);
+}
+
+void QUaModbusIntervalIndex::query(const int & lo, const int & hi, const int & start, const int & end, QVector<int>& matches) const
+{
+	if (lo >= hi)
+	{
+		return;
+	}
+	int mid = lo + (hi - lo) / 2;
+	// nothing in this subtree reaches start
+	if (m_maxEnd.at(mid) <= start)
+	{
+		return;
+	}
+	this->query(lo, mid, start, end, matches);
+	// this one and everything to the right start after end
+	if (m_intervals.at(mid).start >= end)
+	{
+		return;
+	}
+	if (m_intervals.at(mid).end > start)
+	{
+		matches << mid;
+	}
+	this->query(mid + 1, hi, start, end, matches);
+}
+
+QQueue<QUaLog> QUaModbusConfigValidator::validate(QUaModbusClientList * list)
+{
+	QQueue<QUaLog> errorLogs;
+	for (auto client : list->clients())
+	{
+		errorLogs << QUaModbusConfigValidator::validate(client);
+	}
+	return errorLogs;
+}
+
+QQueue<QUaLog> QUaModbusConfigValidator::validate(QUaModbusClient * client)
+{
+	QQueue<QUaLog> errorLogs;
+	auto strClient = client->browseName().name();
+	auto metaType  = QMetaEnum::fromType<QModbusDataBlockType>();
+	auto indexes   = QUaModbusConfigValidator::indexes(client);
+	for (auto it = indexes.begin(); it != indexes.end(); ++it)
+	{
+		auto strType    = QString(metaType.valueToKey(it.key()));
+		auto &intervals = it.value().intervals();
+		for (int i = 0; i < intervals.count(); i++)
+		{
+			auto &interval = intervals.at(i);
+			// NOTE : each pair is reported once, by the one that comes first
+			for (int j : it.value().overlapping(interval.start, interval.end))
+			{
+				if (j <= i)
+				{
+					continue;
+				}
+				auto &other = intervals.at(j);
+				if (interval.start == other.start && interval.end == other.end)
+				{
+					errorLogs << QUaLog(
+						tr("Blocks %1 and %2 of client %3 read the same %4 range [%5, %6).")
+							.arg(interval.block->browseName().name()).arg(other.block->browseName().name())
+							.arg(strClient).arg(strType).arg(interval.start).arg(interval.end),
+						QUaLogLevel::Warning,
+						QUaLogCategory::Serialization
+					);
+					continue;
+				}
+				errorLogs << QUaLog(
+					tr("Blocks %1 and %2 of client %3 overlap on %4 range [%5, %6).")
+						.arg(interval.block->browseName().name()).arg(other.block->browseName().name())
+						.arg(strClient).arg(strType).arg(qMax(interval.start, other.start)).arg(qMin(interval.end, other.end)),
+					QUaLogLevel::Warning,
+					QUaLogCategory::Serialization
+				);
+			}
+		}
+	}
+	for (auto block : client->dataBlocks()->blocks())
+	{
+		QUaModbusConfigValidator::validateValues(client, block, errorLogs);
+	}
+	return errorLogs;
+}
+
+QUaModbusCoverageMap QUaModbusConfigValidator::coverage(QUaModbusClient * client)
+{
+	QUaModbusCoverageMap coverage;
+	auto indexes = QUaModbusConfigValidator::indexes(client);
+	for (auto it = indexes.begin(); it != indexes.end(); ++it)
+	{
+		auto &ranges = coverage[it.key()];
+		// sorted by start, so a range only grows at its end
+		for (auto &interval : it.value().intervals())
+		{
+			if (!ranges.isEmpty() && interval.start <= ranges.last().end)
+			{
+				ranges.last().end = qMax(ranges.last().end, interval.end);
+				ranges.last().blocks << interval.block;
+				continue;
+			}
+			ranges << QUaModbusRegisterRange({ interval.start, interval.end, { interval.block } });
+		}
+	}
+	return coverage;
+}
+
+QMap<QModbusDataBlockType, QUaModbusIntervalIndex> QUaModbusConfigValidator::indexes(QUaModbusClient * client)
+{
+	QMap<QModbusDataBlockType, QVector<QUaModbusIntervalIndex::Interval>> intervals;
+	for (auto block : client->dataBlocks()->blocks())
+	{
+		auto type    = block->getType();
+		auto address = block->getAddress();
+		auto size    = block->getSize();
+		if (type == QModbusDataBlockType::Invalid || address < 0 || size == 0)
+		{
+			continue;
+		}
+		intervals[type] << QUaModbusIntervalIndex::Interval({ address, address + static_cast<int>(size), block });
+	}
+	QMap<QModbusDataBlockType, QUaModbusIntervalIndex> indexes;
+	for (auto it = intervals.begin(); it != intervals.end(); ++it)
+	{
+		indexes.insert(it.key(), QUaModbusIntervalIndex(it.value()));
+	}
+	return indexes;
+}
+
+void QUaModbusConfigValidator::validateValues(QUaModbusClient * client, QUaModbusDataBlock * block, QQueue<QUaLog>& errorLogs)
+{
+	auto size = static_cast<int>(block->getSize());
+	for (auto value : block->values()->values())
+	{
+		auto type   = value->getType();
+		auto offset = value->getAddressOffset();
+		if (type == QModbusValueType::Invalid || offset < 0)
+		{
+			continue;
+		}
+		auto registersUsed = QUaModbusValue::typeBlockSize(type);
+		if (offset + registersUsed <= size)
+		{
+			continue;
+		}
+		errorLogs << QUaLog(
+			tr("Value %1 of block %2 of client %3 uses registers [%4, %5) but block size is %6.")
+				.arg(value->browseName().name()).arg(block->browseName().name())
+				.arg(client->browseName().name()).arg(offset).arg(offset + registersUsed).arg(size),
+			QUaLogLevel::Warning,
+			QUaLogCategory::Serialization
+		);
+	}
+}
@@ -0,0 +1,73 @@
+#ifndef QUAMODBUSCONFIGVALIDATOR_H
+#define QUAMODBUSCONFIGVALIDATOR_H
+
+#include "quamodbusclientlist.h"
+#include "quamodbusdatablock.h"
+
+#include <QCoreApplication>
+#include <QVector>
+#include <QMap>
+
+// Static interval tree over the register ranges of the blocks of one client and register type.
+// Ranges are sorted by start address and the implicit balanced tree over the sorted array keeps
+// the largest end of each subtree, so building is O(n log n) and queries O(log n + matches).
+class QUaModbusIntervalIndex
+{
+public:
+	// half open register range [start, end) read by a block
+	struct Interval
+	{
+		int                  start;
+		int                  end;
+		QUaModbusDataBlock * block;
+	};
+
+	explicit QUaModbusIntervalIndex(const QVector<Interval> &intervals = QVector<Interval>());
+
+	// sorted by start, then by end
+	const QVector<Interval> & intervals() const;
+	// positions in intervals() of the ranges that share at least one register with [start, end)
+	QVector<int> overlapping(const int &start, const int &end) const;
+
+private:
+	QVector<Interval> m_intervals;
+	QVector<int>      m_maxEnd;
+
+	int  build(const int &lo, const int &hi);
+	void query(const int &lo, const int &hi, const int &start, const int &end, QVector<int> &matches) const;
+};
+
+// contiguous registers covered by one or more blocks, [start, end)
+struct QUaModbusRegisterRange
+{
+	int start;
+	int end;
+	QList<QUaModbusDataBlock*> blocks;
+};
+// sorted ranges per register type, adjacent and overlapping blocks are merged,
+// so each range could be read with a single request if the device allows it
+typedef QMap<QModbusDataBlockType, QVector<QUaModbusRegisterRange>> QUaModbusCoverageMap;
+
+// Checks the register layout of the config :
+//   blocks of a client reading the same range or overlapping ranges of the same type
+//   values whose AddressOffset + RegistersUsed do not fit in the block Size
+// NOTE : conflicts are warnings, so configs that loaded before still load. Blocks with invalid
+//        type, address or size and values with invalid type or offset are not reported here,
+//        they already show a ConfigurationError
+class QUaModbusConfigValidator
+{
+	Q_DECLARE_TR_FUNCTIONS(QUaModbusConfigValidator)
+
+public:
+	static QQueue<QUaLog> validate(QUaModbusClientList * list);
+	static QQueue<QUaLog> validate(QUaModbusClient     * client);
+
+	static QUaModbusCoverageMap coverage(QUaModbusClient * client);
+
+private:
+	// one index per register type used by the client
+	static QMap<QModbusDataBlockType, QUaModbusIntervalIndex> indexes(QUaModbusClient * client);
+	static void validateValues(QUaModbusClient * client, QUaModbusDataBlock * block, QQueue<QUaLog> &errorLogs);
+};
+
+#endif // QUAMODBUSCONFIGVALIDATOR_H
@@ -0,0 +1,200 @@
+#include "quamodbuscsv.h"
+
+#include "quamodbusclientlist.h"
+#include "quamodbusclient.h"
+#include "quamodbusdatablocklist.h"
+#include "quamodbusdatablock.h"
+#include "quamodbusvaluelist.h"
+#include "quamodbusvalue.h"
+
+QUaModbusCsvReader::QUaModbusCsvReader(QIODevice * device)
+	: m_stream(device)
+{
+	m_stream.setCodec("UTF-8");
+}
+
+QUaModbusCsvReader::QUaModbusCsvReader(QString * string)
+	: m_stream(string, QIODevice::ReadOnly)
+{
+}
+
+bool QUaModbusCsvReader::readRow(QStringList & fields, QString & strRow)
+{
+	if (!m_stream.readLineInto(&strRow))
+	{
+		return false;
+	}
+	// quoted field spans more lines while quotes are unbalanced
+	while (strRow.count('"') % 2 != 0 && m_stream.readLineInto(&m_line))
+	{
+		strRow += '\n';
+		strRow += m_line;
+	}
+	QUaModbusCsvReader::splitRow(QStringView(strRow), fields);
+	return true;
+}
+
+void QUaModbusCsvReader::splitRow(QStringView row, QStringList & fields)
+{
+	fields.clear();
+	QString strField;
+	bool quoted  = false;
+	int  segment = 0;
+	// NOTE : plain runs are appended in one go, only quotes and separators are special
+	for (int i = 0; i < row.size(); i++)
+	{
+		auto c = row.at(i);
+		if (c == '"')
+		{
+			strField.append(row.data() + segment, i - segment);
+			// escaped quote inside quoted field
+			if (quoted && i + 1 < row.size() && row.at(i + 1) == '"')
+			{
+				strField.append('"');
+				i++;
+			}
+			else
+			{
+				quoted = !quoted;
+			}
+			segment = i + 1;
+		}
+		else if (c == ',' && !quoted)
+		{
+			strField.append(row.data() + segment, i - segment);
+			fields << strField;
+			strField.clear();
+			segment = i + 1;
+		}
+	}
+	strField.append(row.data() + segment, row.size() - segment);
+	fields << strField;
+}
+
+QUaModbusCsvWriter::QUaModbusCsvWriter(QIODevice * device)
+	: m_stream(device)
+{
+	m_stream.setCodec("UTF-8");
+	m_firstField = true;
+}
+
+QUaModbusCsvWriter::QUaModbusCsvWriter(QString * string)
+	: m_stream(string, QIODevice::WriteOnly)
+{
+	m_firstField = true;
+}
+
+QUaModbusCsvWriter & QUaModbusCsvWriter::operator<<(const QString & strField)
+{
+	this->separator();
+	// quote only if needed, keeps plain exports identical to the original format
+	bool needsQuotes = false;
+	for (auto c : strField)
+	{
+		if (c == ',' || c == '"' || c == '\n' || c == '\r')
+		{
+			needsQuotes = true;
+			break;
+		}
+	}
+	if (!needsQuotes)
+	{
+		m_stream << strField;
+		return *this;
+	}
+	QString strEscaped = strField;
+	strEscaped.replace('"', "\"\"");
+	m_stream << '"' << strEscaped << '"';
+	return *this;
+}
+
+QUaModbusCsvWriter & QUaModbusCsvWriter::operator<<(const char * strField)
+{
+	return *this << QString(strField);
+}
+
+QUaModbusCsvWriter & QUaModbusCsvWriter::operator<<(const qint64 & field)
+{
+	this->separator();
+	m_stream << field;
+	return *this;
+}
+
+void QUaModbusCsvWriter::endRow()
+{
+	m_stream << '\n';
+	m_firstField = true;
+}
+
+bool QUaModbusCsvWriter::hasError() const
+{
+	return m_stream.status() != QTextStream::Ok;
+}
+
+void QUaModbusCsvWriter::separator()
+{
+	if (!m_firstField)
+	{
+		m_stream << ", ";
+	}
+	m_firstField = false;
+}
+
+QUaModbusCsvIndex::QUaModbusCsvIndex(QUaModbusClientList * list)
+{
+	for (auto client : list->clients())
+	{
+		m_clients.insert(client->browseName().name(), client);
+	}
+}
+
+QUaModbusClient * QUaModbusCsvIndex::client(const QString & strClient)
+{
+	return m_clients.value(strClient, nullptr);
+}
+
+QUaModbusDataBlock * QUaModbusCsvIndex::block(QUaModbusClient * client, const QString & strBlock)
+{
+	auto it = m_blocks.find(client);
+	if (it == m_blocks.end())
+	{
+		it = m_blocks.insert(client, QHash<QString, QUaModbusDataBlock*>());
+		for (auto block : client->dataBlocks()->blocks())
+		{
+			it.value().insert(block->browseName().name(), block);
+		}
+	}
+	return it.value().value(strBlock, nullptr);
+}
+
+QUaModbusValue * QUaModbusCsvIndex::value(QUaModbusDataBlock * block, const QString & strValue)
+{
+	auto it = m_values.find(block);
+	if (it == m_values.end())
+	{
+		it = m_values.insert(block, QHash<QString, QUaModbusValue*>());
+		for (auto value : block->values()->values())
+		{
+			it.value().insert(value->browseName().name(), value);
+		}
+	}
+	return it.value().value(strValue, nullptr);
+}
+
+void QUaModbusCsvIndex::insert(QUaModbusClient * client)
+{
+	m_clients.insert(client->browseName().name(), client);
+}
+
+void QUaModbusCsvIndex::insert(QUaModbusClient * client, QUaModbusDataBlock * block)
+{
+	// NOTE : make sure existing blocks are indexed before adding the new one
+	this->block(client, QString());
+	m_blocks[client].insert(block->browseName().name(), block);
+}
+
+void QUaModbusCsvIndex::insert(QUaModbusDataBlock * block, QUaModbusValue * value)
+{
+	this->value(block, QString());
+	m_values[block].insert(value->browseName().name(), value);
+}
@@ -0,0 +1,77 @@
+#ifndef QUAMODBUSCSV_H
+#define QUAMODBUSCSV_H
+
+#include <QTextStream>
+#include <QStringList>
+#include <QStringView>
+#include <QHash>
+
+class QUaModbusClientList;
+class QUaModbusClient;
+class QUaModbusDataBlock;
+class QUaModbusValue;
+
+// Streaming CSV reader, one row at a time from a device or string.
+// Quote aware : fields may be quoted, contain commas, escaped quotes ("") and line breaks.
+class QUaModbusCsvReader
+{
+public:
+	explicit QUaModbusCsvReader(QIODevice * device);
+	explicit QUaModbusCsvReader(QString  * string);
+
+	// returns false at end of input, strRow is the raw row for log messages
+	bool readRow(QStringList &fields, QString &strRow);
+
+	static void splitRow(QStringView row, QStringList &fields);
+
+private:
+	QTextStream m_stream;
+	QString     m_line;
+};
+
+// Streaming CSV writer, fields are separated by ", " as in the original export
+// and only quoted if they need to
+class QUaModbusCsvWriter
+{
+public:
+	explicit QUaModbusCsvWriter(QIODevice * device);
+	explicit QUaModbusCsvWriter(QString  * string);
+
+	QUaModbusCsvWriter & operator<<(const QString &strField);
+	QUaModbusCsvWriter & operator<<(const char    *strField);
+	QUaModbusCsvWriter & operator<<(const qint64  &field);
+	void endRow();
+
+	bool hasError() const;
+
+private:
+	QTextStream m_stream;
+	bool        m_firstField;
+
+	void separator();
+};
+
+// Name indexes of the client / block / value tree for csv import,
+// so rows are resolved by hash instead of browsing children by name
+class QUaModbusCsvIndex
+{
+public:
+	explicit QUaModbusCsvIndex(QUaModbusClientList * list);
+
+	QUaModbusClient    * client(const QString &strClient);
+	QUaModbusDataBlock * block (QUaModbusClient    * client, const QString &strBlock);
+	QUaModbusValue     * value (QUaModbusDataBlock * block , const QString &strValue);
+
+	// register newly created nodes
+	void insert(QUaModbusClient    * client);
+	void insert(QUaModbusClient    * client, QUaModbusDataBlock * block);
+	void insert(QUaModbusDataBlock * block , QUaModbusValue     * value);
+
+private:
+	QHash<QString, QUaModbusClient*> m_clients;
+	// NOTE : built the first time a client or block is looked into
+	QHash<QUaModbusClient*   , QHash<QString, QUaModbusDataBlock*>> m_blocks;
+	QHash<QUaModbusDataBlock*, QHash<QString, QUaModbusValue*    >> m_values;
+};
+
+#endif // QUAMODBUSCSV_H
@@ -1,6 +1,13 @@
 #include "quamodbusdatablock.h"
 #include "quamodbusclient.h"
+#include "quamodbusclientlist.h"
 #include "quamodbusvalue.h"
+#include "quamodbustrace.h"
+
+#include <QElapsedTimer>
+
+// NOTE : needed for the implementation of QUaBaseObject::addChild
+#include <QUaServer>
 
 #ifdef QUA_ACCESS_CONTROL
 #include <QUaPermissions>
@@ -14,15 +21,25 @@ QUaModbusDataBlock::QUaModbusDataBlock(QUaServer *server)
 #else
 	: QUaBaseObjectProtected(server)
 #endif // !QUA_ACCESS_CONTROL
+	, m_config({ QModbusDataUnit::RegisterType::Invalid, -1, 0 })
+	, m_metrics(new QUaModbusMetrics)
 {
+	m_diagnostics = nullptr;
+	m_lastErrorCache = QModbusError::ConnectionError;
+	m_errorStatus = false;
 	m_loopHandle = -1;
+	m_loopSuspended = false;
 	m_replyRead  = nullptr;
 	m_type = nullptr;
 	m_address = nullptr;
 	m_size = nullptr;
 	m_samplingTime = nullptr;
+#ifdef UA_ENABLE_HISTORIZING
+	m_historizing = nullptr;
+#endif // UA_ENABLE_HISTORIZING
 	m_data = nullptr;
 	m_lastError = nullptr;
+	m_latency = nullptr;
 	m_values = nullptr;
 	// NOTE : QObject parent might not be yet available in constructor
 	type   ()->setDataTypeEnum(QMetaEnum::fromType<QModbusDataBlockType>());
@@ -33,8 +50,8 @@ QUaModbusDataBlock::QUaModbusDataBlock(QUaServer *server)
 	size   ()->setValue(0);
 	samplingTime()->setDataType(QMetaType::UInt);
 	samplingTime()->setValue(1000);
-	lastError   ()->setDataTypeEnum(QMetaEnum::fromType<QModbusError>());
-	lastError   ()->setValue(QModbusError::ConnectionError);
+	latency     ()->setDataType(QMetaType::Double);
+	latency     ()->setValue(0.0);
 	// set initial conditions
 	type()        ->setWriteAccess(true);
 	address()     ->setWriteAccess(true);
@@ -49,6 +66,12 @@ QUaModbusDataBlock::QUaModbusDataBlock(QUaServer *server)
 	QObject::connect(data()        , &QUaBaseVariable::valueChanged, this, &QUaModbusDataBlock::on_dataChanged        , Qt::QueuedConnection);
 	// to safely update error in ua server thread
 	QObject::connect(this, &QUaModbusDataBlock::updateLastError, this, &QUaModbusDataBlock::on_updateLastError);
+#ifdef UA_ENABLE_HISTORIZING
+	historizing()->setDataType(QMetaType::Bool);
+	historizing()->setValue(false);
+	historizing()->setWriteAccess(true);
+	QObject::connect(historizing(), &QUaBaseVariable::valueChanged, this, &QUaModbusDataBlock::on_historizingChanged, Qt::QueuedConnection);
+#endif // UA_ENABLE_HISTORIZING
 	// set descriptions
 	/*
 	type        ()->setDescription(tr("Type of Modbus register for this block."));
@@ -57,6 +80,7 @@ QUaModbusDataBlock::QUaModbusDataBlock(QUaServer *server)
 	samplingTime()->setDescription(tr("Polling time (cycle time) to read this block."));
 	data        ()->setDescription(tr("The current block values as per the last successfull read."));
 	lastError   ()->setDescription(tr("The last error reported while reading or writing this block."));
+	latency     ()->setDescription(tr("Time (in milliseconds) from the last read request to its reply."));
 	values      ()->setDescription(tr("List of converted values."));
 	*/
 }
@@ -77,6 +101,15 @@ QUaModbusDataBlock::~QUaModbusDataBlock()
 	{
 		delete value;
 	}
+#ifdef UA_ENABLE_HISTORIZING
+	// history of a removed block is dropped
+	auto client = this->client();
+	auto list   = client ? client->list() : nullptr;
+	if (list && this->getHistorizing())
+	{
+		list->historian()->remove(this->data()->nodeId());
+	}
+#endif // UA_ENABLE_HISTORIZING
 }
 
 QUaProperty * QUaModbusDataBlock::type()
@@ -115,6 +148,17 @@ QUaProperty * QUaModbusDataBlock::samplingTime()
 	return m_samplingTime;
 }
 
+#ifdef UA_ENABLE_HISTORIZING
+QUaProperty * QUaModbusDataBlock::historizing()
+{
+	if (!m_historizing)
+	{
+		m_historizing = this->browseChild<QUaProperty>("Historizing");
+	}
+	return m_historizing;
+}
+#endif // UA_ENABLE_HISTORIZING
+
 QUaBaseDataVariable * QUaModbusDataBlock::data()
 {
 	if (!m_data)
@@ -133,6 +177,15 @@ QUaBaseDataVariable * QUaModbusDataBlock::lastError()
 	return m_lastError;
 }
 
+QUaBaseDataVariable * QUaModbusDataBlock::latency()
+{
+	if (!m_latency)
+	{
+		m_latency = this->browseChild<QUaBaseDataVariable>("Latency");
+	}
+	return m_latency;
+}
+
 QUaModbusValueList * QUaModbusDataBlock::values()
 {
 	if (!m_values)
@@ -144,13 +197,15 @@ QUaModbusValueList * QUaModbusDataBlock::values()
 
 void QUaModbusDataBlock::remove()
 {
+	// avoid resuming loop before deletion
+	m_loopSuspended = false;
 	// stop loop
 	this->client()->m_workerThread.stopLoopInThread(m_loopHandle);
 	// make handle invalid **after** stopping loop in thread
 	m_loopHandle = -1;
 	// call deleteLater in thread, so thread has time to stop loop first
 	// NOTE : deleteLater will delete the object in the correct thread anyways
-	this->client()->m_workerThread.execInThread([this]() {
+	this->client()->execInThread([this]() {
 		// then delete
 		this->deleteLater();	
 	}, Qt::EventPriority::LowEventPriority);
@@ -163,10 +218,10 @@ void QUaModbusDataBlock::on_typeChanged(const QVariant &value, const bool& netwo
 		return;
 	}
 	auto type = value.value<QModbusDataBlockType>();
-	// set in thread for safety
-	this->client()->m_workerThread.execInThread([this, type]() {
-		m_registerType = static_cast<QModbusDataBlockType>(type);
-	});
+	// update polling loop config
+	QUaModbusDataBlockConfig config = *m_config.load();
+	config.registerType = static_cast<QModbusDataUnit::RegisterType>(type);
+	m_config.store(config, this->client()->m_workerThread);
 	// set data writable according to type
 	if (type == QModbusDataBlockType::Coils ||
 		type == QModbusDataBlockType::HoldingRegisters)
@@ -179,6 +234,7 @@ void QUaModbusDataBlock::on_typeChanged(const QVariant &value, const bool& netwo
 	}
 	// emit
 	emit this->typeChanged(type);
+	this->validateLater();
 	// update permissions in values
 	auto values = this->values()->values();
 	for (auto value : values)
@@ -202,12 +258,13 @@ void QUaModbusDataBlock::on_addressChanged(const QVariant & value, const bool& n
 		return;
 	}
 	auto address = value.value<int>();
-	// set in thread for safety
-	this->client()->m_workerThread.execInThread([this, address]() {
-		m_startAddress = address;
-	});
+	// update polling loop config
+	QUaModbusDataBlockConfig config = *m_config.load();
+	config.startAddress = address;
+	m_config.store(config, this->client()->m_workerThread);
 	// emit
 	emit this->addressChanged(address);
+	this->validateLater();
 }
 
 void QUaModbusDataBlock::on_sizeChanged(const QVariant & value, const bool& networkChange)
@@ -217,12 +274,13 @@ void QUaModbusDataBlock::on_sizeChanged(const QVariant & value, const bool& netw
 		return;
 	}
 	auto size = value.value<quint32>();
-	// set in thread for safety
-	this->client()->m_workerThread.execInThread([this, size]() {
-		m_valueCount = size;
-	});
+	// update polling loop config
+	QUaModbusDataBlockConfig config = *m_config.load();
+	config.valueCount = size;
+	m_config.store(config, this->client()->m_workerThread);
 	// emit
 	emit this->sizeChanged(size);
+	this->validateLater();
 }
 
 void QUaModbusDataBlock::on_samplingTimeChanged(const QVariant & value, const bool& networkChange)
@@ -255,6 +313,35 @@ void QUaModbusDataBlock::on_samplingTimeChanged(const QVariant & value, const bo
 	emit this->samplingTimeChanged(samplingTime);
 }
 
+#ifdef UA_ENABLE_HISTORIZING
+void QUaModbusDataBlock::on_historizingChanged(const QVariant & value, const bool & networkChange)
+{
+	if (!networkChange)
+	{
+		return;
+	}
+	bool historizing = value.value<bool>();
+	this->data()->setHistorizing(historizing);
+	this->data()->setReadHistoryAccess(historizing);
+	auto client = this->client();
+	auto list   = client ? client->list() : nullptr;
+	if (list)
+	{
+		// NOTE : arrays are stored with a deadband, deviation does not apply
+		if (historizing)
+		{
+			list->historian()->setDeviation(this->data()->nodeId(), 0.0);
+		}
+		else
+		{
+			list->historian()->remove(this->data()->nodeId());
+		}
+	}
+	// emit
+	emit this->historizingChanged(historizing);
+}
+#endif // UA_ENABLE_HISTORIZING
+
 void QUaModbusDataBlock::on_dataChanged(const QVariant & value, const bool& networkChange)
 {
 	if (!networkChange)
@@ -272,11 +359,19 @@ void QUaModbusDataBlock::on_dataChanged(const QVariant & value, const bool& netw
 void QUaModbusDataBlock::on_updateLastError(const QModbusError & error)
 {
 	// avoid update or emit if no change, improves performance
-	if (error == this->getLastError())
+	if (error == m_lastErrorCache)
 	{
 		return;
 	}
-	this->lastError()->setValue(error);
+	m_lastErrorCache = error;
+	if (m_errorStatus)
+	{
+		this->data()->setStatusCode(QUaModbusDataBlock::errorToStatus(error));
+	}
+	else
+	{
+		this->lastError()->setValue(error);
+	}
 	// NOTE : need to add custom signal because OPC UA valueChanged
 	//        only works for changes through network
 	// emit
@@ -307,17 +402,54 @@ QUaModbusClient * QUaModbusDataBlock::client() const
 	return this->list()->client();
 }
 
+void QUaModbusDataBlock::validateLater()
+{
+	auto client = this->client();
+	auto list   = client->list();
+	if (!list)
+	{
+		return;
+	}
+	list->validateLater(client);
+}
+
 void QUaModbusDataBlock::startLoop()
 {
+	// do not start until client connects
+	if (this->client()->getState() != QModbusState::ConnectedState)
+	{
+		m_loopSuspended = true;
+		return;
+	}
+	m_loopSuspended = false;
 	auto samplingTime = this->samplingTime()->value().value<quint32>();
+	// last error emitted by this loop, to only emit on transitions
+	QModbusError loopError = QModbusError::NoError;
+	// measures achieved sampling time
+	QElapsedTimer cycleTimer;
+	// spans are labelled with client and block names
+	QString traceName = QString("%1.%2").arg(this->client()->browseName().name()).arg(this->browseName().name());
+	qint64  traceLastTick = -1;
 	// exec read request in client thread
 	m_loopHandle = this->client()->m_workerThread.startLoopInThread(
-	[this]() {
+	[this, loopError, cycleTimer, traceName, traceLastTick, samplingTime]() mutable {
 		//Q_ASSERT(m_loopHandle > 0); // NOTE : this does happen when cleaning all blocks form a client
 		if (m_loopHandle <= 0)
 		{
 			return;
 		}
+		// trace how late the loop woke up with respect to the sampling time
+		qint64 traceTick = -1;
+		if (QUaModbusTrace::isEnabled())
+		{
+			traceTick = QUaModbusTrace::now();
+			auto traceDue = traceLastTick + 1000 * static_cast<qint64>(samplingTime);
+			if (traceLastTick >= 0 && traceTick > traceDue)
+			{
+				QUaModbusTrace::addSpan("schedule", traceName, traceDue, traceTick);
+			}
+		}
+		traceLastTick = traceTick;
 		auto client = this->client();
 		// TODO : can happen in shutdown? possible BUG
 		if (!client)
@@ -327,46 +459,67 @@ void QUaModbusDataBlock::startLoop()
 		// check if ongoing request
 		if (m_replyRead)
 		{
+			m_metrics->addOverrun();
 			return;
 		}
 		// check if request is valid
-		if (m_registerType == QModbusDataBlockType::Invalid)
-		{
-			emit this->updateLastError(QModbusError::ConfigurationError);
-			return;
-		}
-		if (m_startAddress < 0)
+		auto config = m_config.load();
+		if (config->registerType == QModbusDataUnit::RegisterType::Invalid ||
+			config->startAddress < 0 ||
+			config->valueCount == 0)
 		{
-			emit this->updateLastError(QModbusError::ConfigurationError);
+			if (loopError != QModbusError::ConfigurationError)
+			{
+				loopError = QModbusError::ConfigurationError;
+				emit this->updateLastError(loopError);
+			}
 			return;
 		}
-		if (m_valueCount == 0)
+		// check if connected (loop is suspended on disconnect, but state might change in between)
+		auto state = client->getState();
+		if (state != QModbusState::ConnectedState)
 		{
-			emit this->updateLastError(QModbusError::ConfigurationError);
+			m_metrics->addDeferral();
+			if (loopError != QModbusError::ConnectionError)
+			{
+				loopError = QModbusError::ConnectionError;
+				emit this->updateLastError(loopError);
+			}
 			return;
 		}
-		// check if connected
-		auto state = client->getState();
-		if (state != QModbusState::ConnectedState)
+		// check if device is considered dead (circuit breaker)
+		if (!client->requestAllowed())
 		{
-			emit this->updateLastError(QModbusError::ConnectionError);
+			m_metrics->addDeferral();
 			return;
 		}
+		// stamp request, reply is stamped when it arrives
+		QSharedPointer<QUaModbusReplyStamp> stamp(new QUaModbusReplyStamp);
+		stamp->requested = QDateTime::currentDateTimeUtc();
+		stamp->timer.start();
 		// create and send request		
-		auto serverAddress = client->getServerAddress();
+		auto serverAddress = client->m_config.load()->serverAddress;
 		// NOTE : need to pass in a fresh QModbusDataUnit instance or reply for coils returns empty
 		//        wierdly, registers work fine when passing m_modbusDataUnit
-		m_replyRead = client->m_modbusClient->sendReadRequest(
-			QModbusDataUnit(
-				static_cast<QModbusDataUnit::RegisterType>(m_registerType),
-				m_startAddress, 
-				m_valueCount
-			)
-			, serverAddress
+		QModbusDataUnit dataToRead(
+			config->registerType,
+			config->startAddress, 
+			config->valueCount
 		);
+		m_replyRead = client->m_modbusClient->sendReadRequest(dataToRead, serverAddress);
+		// time between read requests
+		if (cycleTimer.isValid())
+		{
+			m_metrics->addCycle(cycleTimer.restart());
+		}
+		else
+		{
+			cycleTimer.start();
+		}
 		// check if no error
 		if (!m_replyRead)
 		{
+			client->updateCircuit(QModbusError::ReplyAbortedError);
 			emit this->updateLastError(QModbusError::ReplyAbortedError);
 			return;
 		}
@@ -374,14 +527,45 @@ void QUaModbusDataBlock::startLoop()
 		if (m_replyRead->isFinished())
 		{
 			// broadcast replies return immediately
+			client->updateCircuit(m_replyRead->error());
 			m_replyRead->deleteLater();
 			m_replyRead = nullptr;
 			return;
 		}
+		// NOTE : reply lives in worker thread, so lambda is exec'd in worker thread. Connected
+		//        before the queued handler so the stamp is written before the handler is posted
+		QObject::connect(m_replyRead, &QModbusReply::finished, m_replyRead,
+		[stamp]() {
+			stamp->latency = static_cast<double>(stamp->timer.nsecsElapsed()) / 1000000.0;
+			stamp->replied = QDateTime::currentDateTimeUtc();
+		});
+		// measure round trip time
+		client->trackReply(m_replyRead, QUaModbusMetrics::requestSize(dataToRead, false), m_metrics);
+		// reply decides the error from now on
+		loopError = QModbusError::NoError;
+		// trace send, reply and (in ua server thread) queue wait
+		QSharedPointer<qint64> traceReceived;
+		if (traceTick >= 0)
+		{
+			auto traceSent = QUaModbusTrace::now();
+			QUaModbusTrace::addSpan("send", traceName, traceTick, traceSent);
+			traceReceived.reset(new qint64(traceSent));
+			QObject::connect(m_replyRead, &QModbusReply::finished, m_replyRead,
+			[traceName, traceSent, traceReceived]() {
+				*traceReceived = QUaModbusTrace::now();
+				QUaModbusTrace::addSpan("reply", traceName, traceSent, *traceReceived);
+			});
+		}
 		// subscribe to finished
 		QObject::connect(m_replyRead, &QModbusReply::finished, this,
-			[this]() {
+			[this, traceName, traceReceived, stamp]() {
 				// NOTE : exec'd in ua server thread (not in worker thread)
+				qint64 traceDispatched = -1;
+				if (traceReceived)
+				{
+					traceDispatched = QUaModbusTrace::now();
+					QUaModbusTrace::addSpan("queue", traceName, *traceReceived, traceDispatched);
+				}
 				if (this->client()->m_disconnectRequested || this->client()->getState() != QModbusState::ConnectedState)
 				{
 					m_replyRead = nullptr;
@@ -397,19 +581,29 @@ void QUaModbusDataBlock::startLoop()
 				// handle error
 				auto error = m_replyRead->error();
 				this->setLastError(error);
+				// device answered, exception responses included
+				if (error == QModbusError::NoError || error == QModbusError::ProtocolError)
+				{
+					this->latency()->setValue(stamp->latency, QUaStatus::Good, stamp->replied);
+				}
 				// update block value
 				QVector<quint16> data = m_replyRead->result().values();
 				// TODO : early exit when refactor QUaModbusValue::setValue
 				if (error == QModbusError::NoError)
 				{
-					Q_ASSERT(data.count() == m_valueCount);
-					this->setData(data, false);
+					Q_ASSERT(data.count() == m_config.load()->valueCount);
+					this->setData(data, false, stamp->replied);
+				}
+				qint64 traceCommitted = traceDispatched >= 0 ? QUaModbusTrace::now() : -1;
+				if (traceCommitted >= 0)
+				{
+					QUaModbusTrace::addSpan("commit", traceName, traceDispatched, traceCommitted);
 				}
 				// update modbus values and errors
-				auto values = this->values()->values();
-				for (auto value : values)
+				this->updateValues(data, error, stamp->replied);
+				if (traceCommitted >= 0)
 				{
-					value->setValue(data, error);
+					QUaModbusTrace::addSpan("decode", traceName, traceCommitted, QUaModbusTrace::now());
 				}
 				// delete reply on next event loop exec
 				m_replyRead->deleteLater();
@@ -421,27 +615,101 @@ void QUaModbusDataBlock::startLoop()
 
 bool QUaModbusDataBlock::loopRunning()
 {
-	return m_loopHandle >= 0;
+	return m_loopHandle >= 0 || m_loopSuspended;
+}
+
+void QUaModbusDataBlock::suspendLoop()
+{
+	if (m_loopHandle <= 0)
+	{
+		return;
+	}
+	// stop loop
+	this->client()->m_workerThread.stopLoopInThread(m_loopHandle);
+	// make handle invalid **after** stopping loop in thread
+	m_loopHandle = -1;
+	m_loopSuspended = true;
+}
+
+void QUaModbusDataBlock::resumeLoop()
+{
+	if (!m_loopSuspended)
+	{
+		return;
+	}
+	this->startLoop();
+}
+
+void QUaModbusDataBlock::updateErrorStatus(const bool & enabled)
+{
+	m_errorStatus = enabled;
+	// add or remove LastError on demand
+	auto lastError = this->lastError();
+	if (enabled && lastError)
+	{
+		delete lastError;
+		m_lastError = nullptr;
+	}
+	else if (!enabled && !lastError)
+	{
+		m_lastError = this->addBaseDataVariable("LastError");
+		m_lastError->setDataTypeEnum(QMetaEnum::fromType<QModbusError>());
+		m_lastError->setValue(m_lastErrorCache);
+	}
+	// NOTE : Data keeps the last good read, its status tells whether it is still valid
+	this->data()->setStatusCode(enabled ? QUaModbusDataBlock::errorToStatus(m_lastErrorCache) : QUaStatusCode(QUaStatus::Good));
+	for (auto value : this->values()->values())
+	{
+		value->updateErrorStatus(enabled);
+	}
+}
+
+void QUaModbusDataBlock::updateDiagnostics(const bool & enabled)
+{
+	if (!enabled)
+	{
+		delete m_diagnostics;
+		m_diagnostics = nullptr;
+		return;
+	}
+	if (!m_diagnostics)
+	{
+		m_diagnostics = this->addChild<QUaModbusDataBlockDiagnostics>("Diagnostics");
+	}
+	m_diagnostics->update(*m_metrics);
 }
 
 void QUaModbusDataBlock::setModbusData(const QVector<quint16>& data)
 {
+	// trace time waiting in worker thread queue
+	qint64  tracePosted = -1;
+	QString traceName;
+	if (QUaModbusTrace::isEnabled())
+	{
+		tracePosted = QUaModbusTrace::now();
+		traceName   = QString("%1.%2").arg(this->client()->browseName().name()).arg(this->browseName().name());
+	}
 	// exec write request in client thread
-	this->client()->m_workerThread.execInThread(
-	[this, data]() {
+	this->client()->execInThread(
+	[this, data, tracePosted, traceName]() {
+		if (tracePosted >= 0)
+		{
+			QUaModbusTrace::addSpan("write queue", traceName, tracePosted, QUaModbusTrace::now());
+		}
 		auto client = this->client();
 		// check if request is valid
-		if (m_registerType != QModbusDataBlockType::Coils &&
-			m_registerType != QModbusDataBlockType::HoldingRegisters)
+		auto config = m_config.load();
+		if (config->registerType != QModbusDataUnit::RegisterType::Coils &&
+			config->registerType != QModbusDataUnit::RegisterType::HoldingRegisters)
 		{
 			return;
 		}
-		if (m_startAddress < 0)
+		if (config->startAddress < 0)
 		{
 			emit this->updateLastError(QModbusError::ConfigurationError);
 			return;
 		}
-		if (m_valueCount == 0)
+		if (config->valueCount == 0)
 		{
 			emit this->updateLastError(QModbusError::ConfigurationError);
 			return;
@@ -455,18 +723,20 @@ void QUaModbusDataBlock::setModbusData(const QVector<quint16>& data)
 		}
 		// create data target 
 		QModbusDataUnit dataToWrite(
-			static_cast<QModbusDataUnit::RegisterType>(m_registerType), 
-			m_startAddress, 
+			config->registerType, 
+			config->startAddress, 
 			data
 		);
 		// create and send request
-		auto serverAddress = client->getServerAddress();
+		auto serverAddress = client->m_config.load()->serverAddress;
 		QModbusReply * p_reply = client->m_modbusClient->sendWriteRequest(dataToWrite, serverAddress);
 		if (!p_reply)
 		{
 			emit this->updateLastError(QModbusError::ReplyAbortedError);
 			return;
 		}
+		// measure round trip time
+		client->trackReply(p_reply, QUaModbusMetrics::requestSize(dataToWrite, true), m_metrics);
 		// subscribe to finished
 		QObject::connect(p_reply, &QModbusReply::finished, this, 
 		[this, p_reply]() mutable {
@@ -505,6 +775,9 @@ QDomElement QUaModbusDataBlock::toDomElement(QDomDocument & domDoc) const
 	elemBlock.setAttribute("Address"     , getAddress());
 	elemBlock.setAttribute("Size"        , getSize());
 	elemBlock.setAttribute("SamplingTime", getSamplingTime());
+#ifdef UA_ENABLE_HISTORIZING
+	elemBlock.setAttribute("Historizing" , getHistorizing() ? 1 : 0);
+#endif // UA_ENABLE_HISTORIZING
 	// add value list element
 	auto elemValueList = const_cast<QUaModbusDataBlock*>(this)->values()->toDomElement(domDoc);
 	elemBlock.appendChild(elemValueList);
@@ -592,6 +865,25 @@ void QUaModbusDataBlock::fromDomElement(QDomElement & domElem, QQueue<QUaLog>& e
 			QUaLogCategory::Serialization
 		);
 	}
+#ifdef UA_ENABLE_HISTORIZING
+	// Historizing (optional)
+	if (domElem.hasAttribute("Historizing"))
+	{
+		auto historizing = domElem.attribute("Historizing").toUInt(&bOK);
+		if (bOK)
+		{
+			this->setHistorizing(historizing != 0);
+		}
+		else
+		{
+			errorLogs << QUaLog(
+				tr("Invalid Historizing attribute '%1' in Block %2. Default value set.").arg(domElem.attribute("Historizing")).arg(strBrowseName),
+				QUaLogLevel::Warning,
+				QUaLogCategory::Serialization
+			);
+		}
+	}
+#endif // UA_ENABLE_HISTORIZING
 	// get value list
 	QDomElement elemValueList = domElem.firstChildElement(QUaModbusValueList::staticMetaObject.className());
 	if (!elemValueList.isNull())
@@ -608,6 +900,24 @@ void QUaModbusDataBlock::fromDomElement(QDomElement & domElem, QQueue<QUaLog>& e
 	}
 }
 
+void QUaModbusDataBlock::updateValues(const QVector<quint16>& data, const QModbusError & error, const QDateTime & timestamp)
+{
+	auto values = this->values()->values();
+	for (auto value : values)
+	{
+		value->setValue(data, error, timestamp);
+	}
+	// warm start cache
+	if (error == QModbusError::NoError)
+	{
+		auto list = this->client()->list();
+		if (list)
+		{
+			list->valueCacheChanged(this);
+		}
+	}
+}
+
 QVector<quint16> QUaModbusDataBlock::variantToInt16Vect(const QVariant & value)
 {
 	QVector<quint16> data;
@@ -670,17 +980,31 @@ void QUaModbusDataBlock::setSamplingTime(const quint32 & samplingTime)
 	this->on_samplingTimeChanged(samplingTime, true);
 }
 
+#ifdef UA_ENABLE_HISTORIZING
+bool QUaModbusDataBlock::getHistorizing() const
+{
+	return const_cast<QUaModbusDataBlock*>(this)->historizing()->value().value<bool>();
+}
+
+void QUaModbusDataBlock::setHistorizing(const bool & historizing)
+{
+	this->historizing()->setValue(historizing);
+	this->on_historizingChanged(historizing, true);
+}
+#endif // UA_ENABLE_HISTORIZING
+
 QVector<quint16> QUaModbusDataBlock::getData() const
 {
 	return QUaModbusDataBlock::variantToInt16Vect(const_cast<QUaModbusDataBlock*>(this)->data()->value());
 }
 
-void QUaModbusDataBlock::setData(const QVector<quint16>& data, const bool &writeModbus/* = true*/)
+void QUaModbusDataBlock::setData(const QVector<quint16>& data, const bool &writeModbus/* = true*/, const QDateTime &timestamp/* = QDateTime()*/)
 {
 	Q_ASSERT_X(data.count() == this->getSize(), "QUaModbusDataBlock::setData", "Received block of incorrect size");
 	auto varData = QVariant::fromValue(data);
 	// set on OPC
-	this->data()->setValue(varData); // TODO : check of memory leak when writing array
+	auto status = m_errorStatus ? QUaModbusDataBlock::errorToStatus(m_lastErrorCache) : QUaStatusCode(QUaStatus::Good);
+	this->data()->setValue(varData, status, timestamp); // TODO : check of memory leak when writing array
 	// emit change c++
 	emit this->dataChanged(data);
 	// check if write to modbus
@@ -693,7 +1017,7 @@ void QUaModbusDataBlock::setData(const QVector<quint16>& data, const bool &write
 
 QModbusError QUaModbusDataBlock::getLastError() const
 {
-	return const_cast<QUaModbusDataBlock*>(this)->lastError()->value().value<QModbusError>();
+	return m_lastErrorCache;
 }
 
 void QUaModbusDataBlock::setLastError(const QModbusError & error)
@@ -702,3 +1026,38 @@ void QUaModbusDataBlock::setLastError(const QModbusError & error)
 	emit this->updateLastError(error);
 }
 
+bool QUaModbusDataBlock::getErrorStatus() const
+{
+	return m_errorStatus;
+}
+
+double QUaModbusDataBlock::getLatency() const
+{
+	return const_cast<QUaModbusDataBlock*>(this)->latency()->value().toDouble();
+}
+
+QUaStatusCode QUaModbusDataBlock::errorToStatus(const QModbusError & error)
+{
+	switch (error)
+	{
+	case QModbusError::NoError:
+		return QUaStatus::Good;
+	case QModbusError::ConnectionError:
+		return QUaStatus::BadNotConnected;
+	case QModbusError::ConfigurationError:
+		return QUaStatus::BadConfigurationError;
+	case QModbusError::TimeoutError:
+		return QUaStatus::BadTimeout;
+	case QModbusError::ProtocolError:
+		// exception response of the device
+		return QUaStatus::BadDeviceFailure;
+	case QModbusError::ReadError:
+	case QModbusError::WriteError:
+	case QModbusError::ReplyAbortedError:
+		return QUaStatus::BadCommunicationError;
+	default:
+		break;
+	}
+	return QUaStatus::BadUnexpectedError;
+}
+
@@ -3,6 +3,9 @@
 
 #include <QModbusDataUnit>
 #include <QModbusReply>
+#include <QSharedPointer>
+#include <QDateTime>
+#include <QElapsedTimer>
 
 #ifndef QUA_ACCESS_CONTROL
 #include <QUaBaseObject>
@@ -18,16 +21,39 @@ class QUaModbusDataBlockList;
 class QUaModbusValue;
 
 #include "quamodbusvaluelist.h"
+#include "quamodbussnapshot.h"
+#include "quamodbusdiagnostics.h"
 
 typedef QModbusDevice::State QModbusState;
 typedef QModbusDevice::Error QModbusError;
 
+// configuration read by the polling loop in the worker thread
+struct QUaModbusDataBlockConfig
+{
+	QModbusDataUnit::RegisterType registerType;
+	int                           startAddress;
+	quint32                       valueCount;
+};
+
+// times of a read request, the reply is stamped in the worker thread as soon as it finishes
+// so queueing to the ua server thread does not shift the source timestamps
+struct QUaModbusReplyStamp
+{
+	QDateTime     requested;
+	QDateTime     replied;
+	QElapsedTimer timer;
+	// request to reply, in milliseconds
+	double        latency = 0.0;
+};
+
 #ifndef QUA_ACCESS_CONTROL
 class QUaModbusDataBlock : public QUaBaseObject
 #else
 class QUaModbusDataBlock : public QUaBaseObjectProtected
 #endif // !QUA_ACCESS_CONTROL
 {
+	friend class QUaModbusClient;
+	friend class QUaModbusClientList;
 	friend class QUaModbusDataBlockList;
 	friend class QUaModbusValue;
 
@@ -38,10 +64,14 @@ class QUaModbusDataBlock : public QUaBaseObjectProtected
 	Q_PROPERTY(QUaProperty * Address      READ address     )
 	Q_PROPERTY(QUaProperty * Size         READ size        )
 	Q_PROPERTY(QUaProperty * SamplingTime READ samplingTime)
+#ifdef UA_ENABLE_HISTORIZING
+	Q_PROPERTY(QUaProperty * Historizing  READ historizing )
+#endif // UA_ENABLE_HISTORIZING
 
 	// UA variables
+	// NOTE : LastError is added per instance (see updateErrorStatus)
 	Q_PROPERTY(QUaBaseDataVariable * Data      READ data     )
-	Q_PROPERTY(QUaBaseDataVariable * LastError READ lastError)
+	Q_PROPERTY(QUaBaseDataVariable * Latency   READ latency  )
 
 	// UA objects
 	Q_PROPERTY(QUaModbusValueList * Values READ values)
@@ -68,11 +98,16 @@ public:
 	QUaProperty * address     ();
 	QUaProperty * size        ();
 	QUaProperty * samplingTime();
+#ifdef UA_ENABLE_HISTORIZING
+	QUaProperty * historizing ();
+#endif // UA_ENABLE_HISTORIZING
 
 	// UA variables
 
 	QUaBaseDataVariable * data();
+	// nullptr if errors are the status code of Data (see QUaModbusClientList::ErrorStatusCodes)
 	QUaBaseDataVariable * lastError();
+	QUaBaseDataVariable * latency();
 
 	// UA objects
 
@@ -96,12 +131,35 @@ public:
 	quint32 getSamplingTime() const;
 	void    setSamplingTime(const quint32 &samplingTime);
 
+#ifdef UA_ENABLE_HISTORIZING
+	// history of Data, served to HistoryRead (see QUaModbusHistorian)
+	bool getHistorizing() const;
+	void setHistorizing(const bool &historizing);
+#endif // UA_ENABLE_HISTORIZING
+
 	QVector<quint16> getData() const;
-	void             setData(const QVector<quint16> &data, const bool &writeModbus = true);
+	// NOTE : timestamp is the source timestamp, current time if invalid
+	void             setData(const QVector<quint16> &data, const bool &writeModbus = true, const QDateTime &timestamp = QDateTime());
 
 	QModbusError getLastError() const;
 	void         setLastError(const QModbusError &error);
 
+	// errors are the status code of Data instead of LastError (see QUaModbusClientList::ErrorStatusCodes)
+	bool getErrorStatus() const;
+
+	// request to reply time of the last read answered by the device, in milliseconds
+	double getLatency() const;
+
+	// status code of Data and values when errors are carried as status codes
+	static QUaStatusCode errorToStatus(const QModbusError &error);
+
+	// decode path of a read reply (in ua server thread) : converts the registers to every value
+	// of the block, with the arrival of the reply as source timestamp. Does not touch Data
+	void updateValues(const QVector<quint16>& data, const QModbusError &error, const QDateTime &timestamp = QDateTime());
+
+	// registers held by the Data variant
+	static QVector<quint16> variantToInt16Vect(const QVariant &value);
+
 	QUaModbusDataBlockList * list() const;
 
 	QUaModbusClient * client() const;
@@ -114,6 +172,9 @@ signals:
 	void samplingTimeChanged(const quint32              &samplingTime);
 	void dataChanged        (const QVector<quint16>     &data        );
 	void lastErrorChanged   (const QModbusError         &error       );
+#ifdef UA_ENABLE_HISTORIZING
+	void historizingChanged (const bool                 &historizing );
+#endif // UA_ENABLE_HISTORIZING
 
 	// (internal) to safely update error in ua server thread
 	void updateLastError(const QModbusError &error);
@@ -127,32 +188,52 @@ private slots:
 	void on_samplingTimeChanged(const QVariant     &value, const bool &networkChange);
 	void on_dataChanged        (const QVariant     &value, const bool &networkChange);
 	void on_updateLastError    (const QModbusError &error);
+#ifdef UA_ENABLE_HISTORIZING
+	void on_historizingChanged (const QVariant     &value, const bool &networkChange);
+#endif // UA_ENABLE_HISTORIZING
 
 private:
 	int m_loopHandle;
+	bool m_loopSuspended;
 	QModbusReply  * m_replyRead;
-	// NOTE : only modify and access in thread
-	QModbusDataBlockType m_registerType;
-	int                  m_startAddress;
-	quint32              m_valueCount;
+	// NOTE : only access in thread, lock-free copy for the polling hot path
+	QUaModbusSnapshot<QUaModbusDataBlockConfig> m_config;
+	// NOTE : only modified in thread, shared with pending replies
+	QSharedPointer<QUaModbusMetrics> m_metrics;
+	QUaModbusDataBlockDiagnostics *  m_diagnostics;
+	QModbusError m_lastErrorCache;
+	// errors as status code of Data instead of LastError
+	bool         m_errorStatus;
 
 	void startLoop();
 	bool loopRunning();
+	// stop waking up while client is not connected
+	void suspendLoop();
+	void resumeLoop();
 	void setModbusData(const QVector<quint16>& data);
+	// publish metrics (in ua server thread)
+	void updateDiagnostics(const bool &enabled);
+	// add or remove LastError of the block and its values (in ua server thread)
+	void updateErrorStatus(const bool &enabled);
+	// register layout of this block or its values changed, client is checked once edits settle
+	void validateLater();
 
 	// XML import / export
 	QDomElement toDomElement  (QDomDocument & domDoc) const;
 	void        fromDomElement(QDomElement  & domElem, QQueue<QUaLog>& errorLogs);
 
 	static quint32 m_minSamplingTime;
-	static QVector<quint16> variantToInt16Vect(const QVariant &value);
 
 	QUaProperty* m_type;
 	QUaProperty* m_address;
 	QUaProperty* m_size;
 	QUaProperty* m_samplingTime;
+#ifdef UA_ENABLE_HISTORIZING
+	QUaProperty* m_historizing;
+#endif // UA_ENABLE_HISTORIZING
 	QUaBaseDataVariable* m_data;
 	QUaBaseDataVariable* m_lastError;
+	QUaBaseDataVariable* m_latency;
 	QUaModbusValueList* m_values;
 };
 
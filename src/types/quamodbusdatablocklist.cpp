@@ -1,6 +1,8 @@
 #include "quamodbusdatablocklist.h"
 #include "quamodbusclient.h"
 #include "quamodbusdatablock.h"
+#include "quamodbusvaluelist.h"
+#include "quamodbusclientlist.h"
 
 // NOTE : had to add this header because the actual implementation of QUaBaseObject::addChild is in here
 //        and was getting "lnk2019 unresolved external symbol template function" without it
@@ -8,6 +10,9 @@
 
 #include <QRegularExpression>
 #include <QRegularExpressionMatch>
+#include <QSignalBlocker>
+#include <QSet>
+#include <QHash>
 
 #ifdef QUA_ACCESS_CONTROL
 #include <QUaPermissions>
@@ -25,7 +30,98 @@ QUaModbusDataBlockList::QUaModbusDataBlockList(QUaServer *server)
 
 QString QUaModbusDataBlockList::addDataBlock(const QUaQualifiedName& blockId)
 {
-	auto strBlockId = blockId.name();
+	// check if id already exists
+	if (this->hasChild(blockId))
+	{
+		return  tr("%1 : Block Id already exists.").arg("Error");
+	}
+	QString strError;
+	return this->createDataBlock(blockId, strError) ? "Success" : strError;
+}
+
+QString QUaModbusDataBlockList::addDataBlocks(const QString & strBlockIds)
+{
+	QStringList listIds;
+	auto strError = QUaModbusClientList::expandIds(strBlockIds, listIds);
+	if (strError.contains("Error", Qt::CaseInsensitive))
+	{
+		return strError;
+	}
+	return this->addDataBlocks(listIds);
+}
+
+QString QUaModbusDataBlockList::addDataBlocks(const QStringList & blockIds)
+{
+	if (blockIds.isEmpty())
+	{
+		return tr("%1 : Block Id list cannot be empty.").arg("Error");
+	}
+	// validate all first, so either all or none are created
+	QSet<QString> setIds;
+	for (auto block : this->blocks())
+	{
+		setIds.insert(block->browseName().name());
+	}
+	for (auto &strBlockId : blockIds)
+	{
+		auto strError = QUaModbusDataBlockList::checkBlockId(strBlockId);
+		if (!strError.isEmpty())
+		{
+			return QString("%1 [%2]").arg(strError).arg(strBlockId);
+		}
+		if (setIds.contains(strBlockId))
+		{
+			return tr("%1 : Block Id %2 already exists.").arg("Error").arg(strBlockId);
+		}
+		setIds.insert(strBlockId);
+	}
+	// create instances
+	auto strNodeIdBase = QString("modbus.%1.").arg(this->client()->browseName().name());
+	auto list          = this->client()->list();
+	bool errorStatus   = list && list->getErrorStatusCodes();
+	QList<QUaModbusDataBlock*> listBlocks;
+	QString strResult = "Success";
+	{
+		// NOTE : views get a single blocksAdded instead of a childAdded per block
+		const QSignalBlocker blocker(this);
+		for (auto &strBlockId : blockIds)
+		{
+			QUaNodeId nodeId = { 0, strNodeIdBase + strBlockId };
+			auto block = this->addChild<QUaModbusDataBlock>(strBlockId, nodeId);
+			if (!block)
+			{
+				strResult = tr("%1 : NodeId %2 already exists.").arg("Error").arg(nodeId);
+				continue;
+			}
+			// NOTE : also adds LastError if errors are not status codes
+			block->updateErrorStatus(errorStatus);
+			block->startLoop();
+			listBlocks << block;
+		}
+	}
+	if (!listBlocks.isEmpty())
+	{
+		emit this->blocksAdded(listBlocks);
+	}
+	return strResult;
+}
+
+void QUaModbusDataBlockList::clear()
+{
+	emit this->aboutToClear();
+	for (auto &block : this->blocks())
+	{
+		block->remove();
+	}
+}
+
+QUaModbusClient * QUaModbusDataBlockList::client()
+{
+	return qobject_cast<QUaModbusClient*>(this->parent());
+}
+
+QString QUaModbusDataBlockList::checkBlockId(const QString & strBlockId)
+{
 	// check empty
 	if (strBlockId.isEmpty())
 	{
@@ -42,42 +138,38 @@ QString QUaModbusDataBlockList::addDataBlock(const QUaQualifiedName& blockId)
 		return tr("%1 : Block Id cannot be 'Name'.").arg("Error");
 	}
 	// check valid characters
-	QRegularExpression rx("^[a-zA-Z0-9_]*$");
+	static const QRegularExpression rx("^[a-zA-Z0-9_]*$");
 	QRegularExpressionMatch match = rx.match(strBlockId, 0, QRegularExpression::PartialPreferCompleteMatch);
 	if (!match.hasMatch())
 	{
 		return  tr("%1 : Block Id can only contain numbers, letters and underscores /^[a-zA-Z0-9_]*$/.").arg("Error");
 	}
-	// check if id already exists
-	if (this->hasChild(blockId))
+	return QString();
+}
+
+QUaModbusDataBlock * QUaModbusDataBlockList::createDataBlock(const QUaQualifiedName & blockId, QString & strError)
+{
+	auto strBlockId = blockId.name();
+	strError = QUaModbusDataBlockList::checkBlockId(strBlockId);
+	if (!strError.isEmpty())
 	{
-		return  tr("%1 : Block Id already exists.").arg("Error");
+		return nullptr;
 	}
 	// create instance
 	QUaNodeId nodeId = { 0, QString("modbus.%1.%2").arg(this->client()->browseName().name()).arg(strBlockId) };
 	auto block = this->addChild<QUaModbusDataBlock>(blockId, nodeId);
 	if (!block)
 	{
-		return  tr("%1 : NodeId %2 already exists.").arg("Error").arg(nodeId);
+		strError = tr("%1 : NodeId %2 already exists.").arg("Error").arg(nodeId);
+		return nullptr;
 	}
+	// NOTE : also adds LastError if errors are not status codes
+	auto list = this->client()->list();
+	block->updateErrorStatus(list && list->getErrorStatusCodes());
 	// start block loop
 	block->startLoop();
-	// return
-	return "Success";
-}
-
-void QUaModbusDataBlockList::clear()
-{
-	emit this->aboutToClear();
-	for (auto &block : this->blocks())
-	{
-		block->remove();
-	}
-}
-
-QUaModbusClient * QUaModbusDataBlockList::client()
-{
-	return qobject_cast<QUaModbusClient*>(this->parent());
+	emit this->blocksAdded({ block });
+	return block;
 }
 
 QList<QUaModbusDataBlock*> QUaModbusDataBlockList::blocks()
@@ -185,3 +277,88 @@ void QUaModbusDataBlockList::fromDomElement(QDomElement & domElem, QQueue<QUaLog
 		}
 	}
 }
+
+void QUaModbusDataBlockList::mergeDomElement(QDomElement & domElem, QQueue<QUaLog>& errorLogs, QUaModbusConfigDiff & diff)
+{
+#ifdef QUA_ACCESS_CONTROL
+	// load permissions if any
+	if (domElem.hasAttribute("Permissions") && !domElem.attribute("Permissions").isEmpty())
+	{
+		QString strError = this->setPermissions(domElem.attribute("Permissions"));
+		if (strError.contains("Error"))
+		{
+			errorLogs << QUaLog(
+				strError,
+				QUaLogLevel::Error,
+				QUaLogCategory::Serialization
+			);
+		}
+	}
+#endif // QUA_ACCESS_CONTROL
+	// blocks not found in domElem are removed at the end
+	QHash<QString, QUaModbusDataBlock*> liveBlocks;
+	for (auto block : this->blocks())
+	{
+		liveBlocks.insert(block->browseName().name(), block);
+	}
+	for (auto elemBlock = domElem.firstChildElement(QUaModbusDataBlock::staticMetaObject.className()); 
+		!elemBlock.isNull(); 
+		elemBlock = elemBlock.nextSiblingElement(QUaModbusDataBlock::staticMetaObject.className()))
+	{
+		QString strBrowseName = elemBlock.attribute("BrowseName");
+		if (strBrowseName.isEmpty())
+		{
+			errorLogs << QUaLog(
+				tr("Cannot add Block with empty BrowseName attribute. Skipping."),
+				QUaLogLevel::Error,
+				QUaLogCategory::Serialization
+			);
+			continue;
+		}
+		auto block = liveBlocks.take(strBrowseName);
+		if (block)
+		{
+			QDomDocument docLive;
+			if (QUaModbusClientList::attributesChanged(block->toDomElement(docLive), elemBlock))
+			{
+				// NOTE : only block attributes, values are merged below
+				auto elemAttrs = QUaModbusClientList::shallowDomElement(elemBlock, QUaModbusValueList::staticMetaObject.className());
+				block->fromDomElement(elemAttrs, errorLogs);
+				diff.blocks.changed++;
+			}
+			// NOTE : a missing value list is an empty one, so live values are removed
+			auto elemValueList = elemBlock.firstChildElement(QUaModbusValueList::staticMetaObject.className());
+			if (elemValueList.isNull())
+			{
+				elemValueList = elemBlock.ownerDocument().createElement(QUaModbusValueList::staticMetaObject.className());
+			}
+			block->values()->mergeDomElement(elemValueList, errorLogs, diff);
+			continue;
+		}
+		auto strNewError = this->addDataBlock(strBrowseName);
+		if (strNewError.contains("Error", Qt::CaseInsensitive))
+		{
+			errorLogs << QUaLog(
+				strNewError,
+				QUaLogLevel::Error,
+				QUaLogCategory::Serialization
+			);
+			continue;
+		}
+		block = this->browseChild<QUaModbusDataBlock>(strBrowseName);
+		Q_CHECK_PTR(block);
+		block->fromDomElement(elemBlock, errorLogs);
+		if (!block->loopRunning())
+		{
+			block->startLoop();
+		}
+		diff.blocks.added++;
+		diff.values.added += block->values()->values().count();
+	}
+	for (auto block : liveBlocks)
+	{
+		diff.values.removed += block->values()->values().count();
+		block->remove();
+		diff.blocks.removed++;
+	}
+}
@@ -14,6 +14,7 @@ class QUaModbusClient;
 class QUaModbusTcpClient;
 class QUaModbusRtuSerialClient;
 class QUaModbusDataBlock;
+struct QUaModbusConfigDiff;
 
 #ifndef QUA_ACCESS_CONTROL
 class QUaModbusDataBlockList : public QUaFolderObject
@@ -25,6 +26,7 @@ class QUaModbusDataBlockList : public QUaFolderObjectProtected
 	friend class QUaModbusTcpClient;
 	friend class QUaModbusRtuSerialClient;
 	friend class QUaModbusDataBlock;
+	friend class QUaModbusClientList;
 
     Q_OBJECT
 
@@ -35,21 +37,37 @@ public:
 
 	Q_INVOKABLE QString addDataBlock(const QUaQualifiedName& blockId);
 
+	// compact id specification, see QUaModbusClientList::expandIds
+	Q_INVOKABLE QString addDataBlocks(const QString &strBlockIds);
+
 	Q_INVOKABLE void clear();
 
 	// C++ API
 
 	QList<QUaModbusDataBlock*> blocks();
 
+	// all ids are validated before any block is created
+	QString addDataBlocks(const QStringList &blockIds);
+
 signals:
 	void aboutToClear();
+	// NOTE : blocks created by addDataBlocks do not emit childAdded, views must use this instead
+	void blocksAdded(const QList<QUaModbusDataBlock*> &blocks);
 
 private:
 	QUaModbusClient * client();
 
+	// returns error if id is not valid, empty otherwise
+	static QString checkBlockId(const QString &strBlockId);
+	// does not look for an existing block, so callers with their own index (csv import) do not
+	// browse the children. nullptr and strError if it fails
+	QUaModbusDataBlock * createDataBlock(const QUaQualifiedName &blockId, QString &strError);
+
 	// XML import / export
 	QDomElement toDomElement  (QDomDocument & domDoc) const;
 	void        fromDomElement(QDomElement  & domElem, QQueue<QUaLog>& errorLogs);
+	// only adds, removes or reconfigures the blocks and values that differ from domElem
+	void        mergeDomElement(QDomElement & domElem, QQueue<QUaLog>& errorLogs, QUaModbusConfigDiff &diff);
 
 };
 
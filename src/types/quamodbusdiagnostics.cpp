@@ -0,0 +1,387 @@
+#include "quamodbusdiagnostics.h"
+
+#include <limits>
+
+const quint32 QUaModbusMetrics::m_rttBuckets[QUaModbusMetrics::m_rttBucketCount] = {
+	1, 2, 3, 5, 7, 10, 15, 20, 30, 50, 70, 100, 150, 200, 300, 500, 700,
+	1000, 1500, 2000, 3000, 5000, 7000, 10000, std::numeric_limits<quint32>::max()
+};
+
+QUaModbusMetrics::QUaModbusMetrics()
+	: m_requests(0)
+	, m_replies(0)
+	, m_timeouts(0)
+	, m_exceptions(0)
+	, m_lastExceptionCode(0)
+	, m_errors(0)
+	, m_bytesSent(0)
+	, m_bytesReceived(0)
+	, m_cycles(0)
+	, m_cycleTimeSum(0)
+	, m_overruns(0)
+	, m_deferrals(0)
+{
+	for (int i = 0; i < m_rttBucketCount; i++)
+	{
+		m_rttHistogram[i].storeRelease(0);
+	}
+}
+
+void QUaModbusMetrics::addRequest(const quint32 & bytes)
+{
+	m_requests.fetchAndAddRelaxed(1);
+	m_bytesSent.fetchAndAddRelaxed(bytes);
+}
+
+void QUaModbusMetrics::addReply(const QModbusReply * reply, const quint32 & bytes, const qint64 & rtt)
+{
+	m_bytesReceived.fetchAndAddRelaxed(bytes);
+	switch (reply->error())
+	{
+	case QModbusDevice::NoError:
+		m_replies.fetchAndAddRelaxed(1);
+		break;
+	case QModbusDevice::ProtocolError:
+		// exception responses are also valid round trips
+		if (!reply->rawResult().isException())
+		{
+			m_errors.fetchAndAddRelaxed(1);
+			return;
+		}
+		m_replies.fetchAndAddRelaxed(1);
+		m_exceptions.fetchAndAddRelaxed(1);
+		m_lastExceptionCode.storeRelease(reply->rawResult().exceptionCode());
+		break;
+	case QModbusDevice::TimeoutError:
+		m_timeouts.fetchAndAddRelaxed(1);
+		return;
+	default:
+		m_errors.fetchAndAddRelaxed(1);
+		return;
+	}
+	// last bucket has no upper bound
+	int bucket = 0;
+	while (bucket < m_rttBucketCount - 1 && rtt > m_rttBuckets[bucket])
+	{
+		bucket++;
+	}
+	m_rttHistogram[bucket].fetchAndAddRelaxed(1);
+}
+
+void QUaModbusMetrics::addCycle(const qint64 & interval)
+{
+	// NOTE : release so a reader that sees the cycle also sees its time
+	m_cycleTimeSum.fetchAndAddRelaxed(static_cast<quint64>(interval));
+	m_cycles.fetchAndAddRelease(1);
+}
+
+void QUaModbusMetrics::addOverrun()
+{
+	m_overruns.fetchAndAddRelaxed(1);
+}
+
+void QUaModbusMetrics::addDeferral()
+{
+	m_deferrals.fetchAndAddRelaxed(1);
+}
+
+quint32 QUaModbusMetrics::requestSize(const QModbusDataUnit & unit, const bool & write)
+{
+	// function code + start address + quantity (or value for single writes)
+	auto count = static_cast<quint32>(unit.valueCount());
+	if (!write || count == 1)
+	{
+		return 5;
+	}
+	// multiple writes add byte count and packed values
+	auto bytes = unit.registerType() == QModbusDataUnit::Coils ? (count + 7) / 8 : 2 * count;
+	return 6 + bytes;
+}
+
+quint32 QUaModbusMetrics::rttCount(const int & bucket) const
+{
+	if (bucket < 0 || bucket >= m_rttBucketCount)
+	{
+		return 0;
+	}
+	return m_rttHistogram[bucket].loadAcquire();
+}
+
+double QUaModbusMetrics::rttPercentile(const quint32 * histogram, const quint32 & total, const double & p)
+{
+	// interpolate linearly inside the bucket that contains the rank
+	double rank  = p * total;
+	double lower = 0.0;
+	quint32 cumulative = 0;
+	for (int i = 0; i < QUaModbusMetrics::m_rttBucketCount - 1; i++)
+	{
+		double upper = QUaModbusMetrics::m_rttBuckets[i];
+		if (histogram[i] > 0 && cumulative + histogram[i] >= rank)
+		{
+			return lower + (upper - lower) * (rank - cumulative) / histogram[i];
+		}
+		cumulative += histogram[i];
+		lower = upper;
+	}
+	// last bucket has no upper bound
+	return lower;
+}
+
+QUaModbusDiagnostics::QUaModbusDiagnostics(QUaServer *server)
+#ifndef QUA_ACCESS_CONTROL
+	: QUaBaseObject(server)
+#else
+	: QUaBaseObjectProtected(server)
+#endif // !QUA_ACCESS_CONTROL
+{
+	m_requestsSent = nullptr;
+	m_replies = nullptr;
+	m_timeouts = nullptr;
+	m_exceptions = nullptr;
+	m_lastExceptionCode = nullptr;
+	m_errors = nullptr;
+	m_bytesSent = nullptr;
+	m_bytesReceived = nullptr;
+	m_roundTripTimeP50 = nullptr;
+	m_roundTripTimeP95 = nullptr;
+	m_roundTripTimeP99 = nullptr;
+	for (int i = 0; i < QUaModbusMetrics::m_rttBucketCount; i++)
+	{
+		m_rttHistogramLast[i] = 0;
+	}
+	// set defaults
+	requestsSent     ()->setDataType(QMetaType::UInt);
+	requestsSent     ()->setValue(0);
+	replies          ()->setDataType(QMetaType::UInt);
+	replies          ()->setValue(0);
+	timeouts         ()->setDataType(QMetaType::UInt);
+	timeouts         ()->setValue(0);
+	exceptions       ()->setDataType(QMetaType::UInt);
+	exceptions       ()->setValue(0);
+	lastExceptionCode()->setDataType(QMetaType::UInt);
+	lastExceptionCode()->setValue(0);
+	errors           ()->setDataType(QMetaType::UInt);
+	errors           ()->setValue(0);
+	bytesSent        ()->setDataType(QMetaType::ULongLong);
+	bytesSent        ()->setValue(0);
+	bytesReceived    ()->setDataType(QMetaType::ULongLong);
+	bytesReceived    ()->setValue(0);
+	roundTripTimeP50 ()->setDataType(QMetaType::Double);
+	roundTripTimeP50 ()->setValue(0.0);
+	roundTripTimeP95 ()->setDataType(QMetaType::Double);
+	roundTripTimeP95 ()->setValue(0.0);
+	roundTripTimeP99 ()->setDataType(QMetaType::Double);
+	roundTripTimeP99 ()->setValue(0.0);
+	// set descriptions
+	/*
+	requestsSent     ()->setDescription(tr("Number of requests sent."));
+	replies          ()->setDescription(tr("Number of replies received, including exception replies."));
+	timeouts         ()->setDescription(tr("Number of requests that timed out (after all retries)."));
+	exceptions       ()->setDescription(tr("Number of Modbus exception replies."));
+	lastExceptionCode()->setDescription(tr("Modbus exception code of the last exception reply."));
+	errors           ()->setDescription(tr("Number of requests that failed for any other reason."));
+	bytesSent        ()->setDescription(tr("Estimated bytes sent on the wire (Modbus ADU)."));
+	bytesReceived    ()->setDescription(tr("Estimated bytes received on the wire (Modbus ADU)."));
+	roundTripTimeP50 ()->setDescription(tr("Median round trip time (in milliseconds) since the last update."));
+	roundTripTimeP95 ()->setDescription(tr("95th percentile of the round trip time (in milliseconds) since the last update."));
+	roundTripTimeP99 ()->setDescription(tr("99th percentile of the round trip time (in milliseconds) since the last update."));
+	*/
+}
+
+QUaBaseDataVariable * QUaModbusDiagnostics::requestsSent()
+{
+	if (!m_requestsSent)
+	{
+		m_requestsSent = this->browseChild<QUaBaseDataVariable>("RequestsSent");
+	}
+	return m_requestsSent;
+}
+
+QUaBaseDataVariable * QUaModbusDiagnostics::replies()
+{
+	if (!m_replies)
+	{
+		m_replies = this->browseChild<QUaBaseDataVariable>("Replies");
+	}
+	return m_replies;
+}
+
+QUaBaseDataVariable * QUaModbusDiagnostics::timeouts()
+{
+	if (!m_timeouts)
+	{
+		m_timeouts = this->browseChild<QUaBaseDataVariable>("Timeouts");
+	}
+	return m_timeouts;
+}
+
+QUaBaseDataVariable * QUaModbusDiagnostics::exceptions()
+{
+	if (!m_exceptions)
+	{
+		m_exceptions = this->browseChild<QUaBaseDataVariable>("Exceptions");
+	}
+	return m_exceptions;
+}
+
+QUaBaseDataVariable * QUaModbusDiagnostics::lastExceptionCode()
+{
+	if (!m_lastExceptionCode)
+	{
+		m_lastExceptionCode = this->browseChild<QUaBaseDataVariable>("LastExceptionCode");
+	}
+	return m_lastExceptionCode;
+}
+
+QUaBaseDataVariable * QUaModbusDiagnostics::errors()
+{
+	if (!m_errors)
+	{
+		m_errors = this->browseChild<QUaBaseDataVariable>("Errors");
+	}
+	return m_errors;
+}
+
+QUaBaseDataVariable * QUaModbusDiagnostics::bytesSent()
+{
+	if (!m_bytesSent)
+	{
+		m_bytesSent = this->browseChild<QUaBaseDataVariable>("BytesSent");
+	}
+	return m_bytesSent;
+}
+
+QUaBaseDataVariable * QUaModbusDiagnostics::bytesReceived()
+{
+	if (!m_bytesReceived)
+	{
+		m_bytesReceived = this->browseChild<QUaBaseDataVariable>("BytesReceived");
+	}
+	return m_bytesReceived;
+}
+
+QUaBaseDataVariable * QUaModbusDiagnostics::roundTripTimeP50()
+{
+	if (!m_roundTripTimeP50)
+	{
+		m_roundTripTimeP50 = this->browseChild<QUaBaseDataVariable>("RoundTripTimeP50");
+	}
+	return m_roundTripTimeP50;
+}
+
+QUaBaseDataVariable * QUaModbusDiagnostics::roundTripTimeP95()
+{
+	if (!m_roundTripTimeP95)
+	{
+		m_roundTripTimeP95 = this->browseChild<QUaBaseDataVariable>("RoundTripTimeP95");
+	}
+	return m_roundTripTimeP95;
+}
+
+QUaBaseDataVariable * QUaModbusDiagnostics::roundTripTimeP99()
+{
+	if (!m_roundTripTimeP99)
+	{
+		m_roundTripTimeP99 = this->browseChild<QUaBaseDataVariable>("RoundTripTimeP99");
+	}
+	return m_roundTripTimeP99;
+}
+
+void QUaModbusDiagnostics::update(const QUaModbusMetrics & metrics)
+{
+	this->requestsSent     ()->setValue(metrics.m_requests         .loadAcquire());
+	this->replies          ()->setValue(metrics.m_replies          .loadAcquire());
+	this->timeouts         ()->setValue(metrics.m_timeouts         .loadAcquire());
+	this->exceptions       ()->setValue(metrics.m_exceptions       .loadAcquire());
+	this->lastExceptionCode()->setValue(metrics.m_lastExceptionCode.loadAcquire());
+	this->errors           ()->setValue(metrics.m_errors           .loadAcquire());
+	this->bytesSent        ()->setValue(metrics.m_bytesSent        .loadAcquire());
+	this->bytesReceived    ()->setValue(metrics.m_bytesReceived    .loadAcquire());
+	// round trip times measured since last update
+	quint32 histogram[QUaModbusMetrics::m_rttBucketCount];
+	quint32 total = 0;
+	for (int i = 0; i < QUaModbusMetrics::m_rttBucketCount; i++)
+	{
+		auto count = metrics.m_rttHistogram[i].loadAcquire();
+		histogram[i] = count - m_rttHistogramLast[i];
+		m_rttHistogramLast[i] = count;
+		total += histogram[i];
+	}
+	// keep last percentiles if no replies in between
+	if (total == 0)
+	{
+		return;
+	}
+	this->roundTripTimeP50()->setValue(QUaModbusMetrics::rttPercentile(histogram, total, 0.50));
+	this->roundTripTimeP95()->setValue(QUaModbusMetrics::rttPercentile(histogram, total, 0.95));
+	this->roundTripTimeP99()->setValue(QUaModbusMetrics::rttPercentile(histogram, total, 0.99));
+}
+
+QUaModbusDataBlockDiagnostics::QUaModbusDataBlockDiagnostics(QUaServer *server)
+	: QUaModbusDiagnostics(server)
+{
+	m_cyclesLast = 0;
+	m_cycleTimeSumLast = 0;
+	m_samplingTimeAchieved = nullptr;
+	m_overruns = nullptr;
+	m_deferrals = nullptr;
+	// set defaults
+	samplingTimeAchieved()->setDataType(QMetaType::Double);
+	samplingTimeAchieved()->setValue(0.0);
+	overruns            ()->setDataType(QMetaType::UInt);
+	overruns            ()->setValue(0);
+	deferrals           ()->setDataType(QMetaType::UInt);
+	deferrals           ()->setValue(0);
+	// set descriptions
+	/*
+	samplingTimeAchieved()->setDescription(tr("Mean time (in milliseconds) between read requests since the last update, compare with SamplingTime."));
+	overruns            ()->setDescription(tr("Number of polling cycles skipped because the previous read was still ongoing."));
+	deferrals           ()->setDescription(tr("Number of polling cycles skipped because the client was disconnected or the device considered dead."));
+	*/
+}
+
+QUaBaseDataVariable * QUaModbusDataBlockDiagnostics::samplingTimeAchieved()
+{
+	if (!m_samplingTimeAchieved)
+	{
+		m_samplingTimeAchieved = this->browseChild<QUaBaseDataVariable>("SamplingTimeAchieved");
+	}
+	return m_samplingTimeAchieved;
+}
+
+QUaBaseDataVariable * QUaModbusDataBlockDiagnostics::overruns()
+{
+	if (!m_overruns)
+	{
+		m_overruns = this->browseChild<QUaBaseDataVariable>("Overruns");
+	}
+	return m_overruns;
+}
+
+QUaBaseDataVariable * QUaModbusDataBlockDiagnostics::deferrals()
+{
+	if (!m_deferrals)
+	{
+		m_deferrals = this->browseChild<QUaBaseDataVariable>("Deferrals");
+	}
+	return m_deferrals;
+}
+
+void QUaModbusDataBlockDiagnostics::update(const QUaModbusMetrics & metrics)
+{
+	QUaModbusDiagnostics::update(metrics);
+	this->overruns ()->setValue(metrics.m_overruns .loadAcquire());
+	this->deferrals()->setValue(metrics.m_deferrals.loadAcquire());
+	// mean polling period since last update
+	auto cycles       = metrics.m_cycles      .loadAcquire();
+	auto cycleTimeSum = metrics.m_cycleTimeSum.loadAcquire();
+	if (cycles == m_cyclesLast)
+	{
+		return;
+	}
+	this->samplingTimeAchieved()->setValue(
+		static_cast<double>(cycleTimeSum - m_cycleTimeSumLast) / (cycles - m_cyclesLast)
+	);
+	m_cyclesLast       = cycles;
+	m_cycleTimeSumLast = cycleTimeSum;
+}
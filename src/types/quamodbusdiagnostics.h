@@ -0,0 +1,155 @@
+#ifndef QUAMODBUSDIAGNOSTICS_H
+#define QUAMODBUSDIAGNOSTICS_H
+
+#include <QAtomicInteger>
+#include <QModbusDataUnit>
+#include <QModbusReply>
+
+#ifndef QUA_ACCESS_CONTROL
+#include <QUaBaseObject>
+#else
+#include <QUaBaseObjectProtected>
+#endif // !QUA_ACCESS_CONTROL
+
+#include <QUaBaseDataVariable>
+
+class QUaModbusDiagnostics;
+class QUaModbusDataBlockDiagnostics;
+
+// Communication counters and round trip time histogram. Updated lock-free in the
+// worker thread (single writer, relaxed atomics) and read in the ua server thread.
+class QUaModbusMetrics
+{
+	friend class QUaModbusDiagnostics;
+	friend class QUaModbusDataBlockDiagnostics;
+
+public:
+	QUaModbusMetrics();
+
+	// NOTE : only call in thread
+	void addRequest (const quint32 &bytes);
+	void addReply   (const QModbusReply * reply, const quint32 &bytes, const qint64 &rtt);
+	void addCycle   (const qint64 &interval);
+	void addOverrun ();
+	void addDeferral();
+
+	// size (in bytes) of the request pdu sent for a data unit
+	static quint32 requestSize(const QModbusDataUnit &unit, const bool &write);
+
+	// replies in a round trip time bucket since creation, can be read in any thread
+	quint32 rttCount(const int &bucket) const;
+	// round trip time (in milliseconds) at percentile p of a histogram with m_rttBucketCount buckets
+	static double rttPercentile(const quint32 * histogram, const quint32 &total, const double &p);
+
+	// round trip time histogram bucket upper bounds (in milliseconds)
+	static const int     m_rttBucketCount = 25;
+	static const quint32 m_rttBuckets[m_rttBucketCount];
+
+private:
+	QAtomicInteger<quint32> m_requests;
+	QAtomicInteger<quint32> m_replies;
+	QAtomicInteger<quint32> m_timeouts;
+	QAtomicInteger<quint32> m_exceptions;
+	QAtomicInteger<quint32> m_lastExceptionCode;
+	QAtomicInteger<quint32> m_errors;
+	QAtomicInteger<quint64> m_bytesSent;
+	QAtomicInteger<quint64> m_bytesReceived;
+	QAtomicInteger<quint32> m_rttHistogram[m_rttBucketCount];
+	QAtomicInteger<quint32> m_cycles;
+	QAtomicInteger<quint64> m_cycleTimeSum;
+	QAtomicInteger<quint32> m_overruns;
+	QAtomicInteger<quint32> m_deferrals;
+};
+
+#ifndef QUA_ACCESS_CONTROL
+class QUaModbusDiagnostics : public QUaBaseObject
+#else
+class QUaModbusDiagnostics : public QUaBaseObjectProtected
+#endif // !QUA_ACCESS_CONTROL
+{
+    Q_OBJECT
+
+	// UA variables
+	Q_PROPERTY(QUaBaseDataVariable * RequestsSent      READ requestsSent     )
+	Q_PROPERTY(QUaBaseDataVariable * Replies           READ replies          )
+	Q_PROPERTY(QUaBaseDataVariable * Timeouts          READ timeouts         )
+	Q_PROPERTY(QUaBaseDataVariable * Exceptions        READ exceptions       )
+	Q_PROPERTY(QUaBaseDataVariable * LastExceptionCode READ lastExceptionCode)
+	Q_PROPERTY(QUaBaseDataVariable * Errors            READ errors           )
+	Q_PROPERTY(QUaBaseDataVariable * BytesSent         READ bytesSent        )
+	Q_PROPERTY(QUaBaseDataVariable * BytesReceived     READ bytesReceived    )
+	Q_PROPERTY(QUaBaseDataVariable * RoundTripTimeP50  READ roundTripTimeP50 )
+	Q_PROPERTY(QUaBaseDataVariable * RoundTripTimeP95  READ roundTripTimeP95 )
+	Q_PROPERTY(QUaBaseDataVariable * RoundTripTimeP99  READ roundTripTimeP99 )
+
+public:
+	Q_INVOKABLE explicit QUaModbusDiagnostics(QUaServer *server);
+
+	// UA variables
+
+	QUaBaseDataVariable * requestsSent     ();
+	QUaBaseDataVariable * replies          ();
+	QUaBaseDataVariable * timeouts         ();
+	QUaBaseDataVariable * exceptions       ();
+	QUaBaseDataVariable * lastExceptionCode();
+	QUaBaseDataVariable * errors           ();
+	QUaBaseDataVariable * bytesSent        ();
+	QUaBaseDataVariable * bytesReceived    ();
+	QUaBaseDataVariable * roundTripTimeP50 ();
+	QUaBaseDataVariable * roundTripTimeP95 ();
+	QUaBaseDataVariable * roundTripTimeP99 ();
+
+	// C++ API
+
+	// NOTE : call in ua server thread, percentiles are computed over the
+	//        round trip times measured since the last update
+	virtual void update(const QUaModbusMetrics &metrics);
+
+private:
+	quint32 m_rttHistogramLast[QUaModbusMetrics::m_rttBucketCount];
+
+	QUaBaseDataVariable* m_requestsSent;
+	QUaBaseDataVariable* m_replies;
+	QUaBaseDataVariable* m_timeouts;
+	QUaBaseDataVariable* m_exceptions;
+	QUaBaseDataVariable* m_lastExceptionCode;
+	QUaBaseDataVariable* m_errors;
+	QUaBaseDataVariable* m_bytesSent;
+	QUaBaseDataVariable* m_bytesReceived;
+	QUaBaseDataVariable* m_roundTripTimeP50;
+	QUaBaseDataVariable* m_roundTripTimeP95;
+	QUaBaseDataVariable* m_roundTripTimeP99;
+};
+
+class QUaModbusDataBlockDiagnostics : public QUaModbusDiagnostics
+{
+    Q_OBJECT
+
+	// UA variables
+	Q_PROPERTY(QUaBaseDataVariable * SamplingTimeAchieved READ samplingTimeAchieved)
+	Q_PROPERTY(QUaBaseDataVariable * Overruns             READ overruns            )
+	Q_PROPERTY(QUaBaseDataVariable * Deferrals            READ deferrals           )
+
+public:
+	Q_INVOKABLE explicit QUaModbusDataBlockDiagnostics(QUaServer *server);
+
+	// UA variables
+
+	QUaBaseDataVariable * samplingTimeAchieved();
+	QUaBaseDataVariable * overruns            ();
+	QUaBaseDataVariable * deferrals           ();
+
+	// C++ API
+
+	void update(const QUaModbusMetrics &metrics) override;
+
+private:
+	quint32 m_cyclesLast;
+	quint64 m_cycleTimeSumLast;
+
+	QUaBaseDataVariable* m_samplingTimeAchieved;
+	QUaBaseDataVariable* m_overruns;
+	QUaBaseDataVariable* m_deferrals;
+};
+
+#endif // QUAMODBUSDIAGNOSTICS_H
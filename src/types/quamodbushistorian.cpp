@@ -0,0 +1,985 @@
+#include "quamodbushistorian.h"
+
+#ifdef UA_ENABLE_HISTORIZING
+
+#include <QtNumeric>
+#include <QtAlgorithms>
+#include <QSequentialIterable>
+
+#include <algorithm>
+#include <limits>
+#include <cstring>
+
+int QUaModbusHistorian::m_chunkSize = 256;
+
+// appends the count lower bits of value to the stream, most significant first
+static void writeBits(QVector<quint64> &words, quint64 &bitCount, const quint64 &value, const int &count)
+{
+	if (count <= 0)
+	{
+		return;
+	}
+	quint64 bits = count == 64 ? value : value & ((Q_UINT64_C(1) << count) - 1);
+	int used = static_cast<int>(bitCount % 64);
+	if (used == 0)
+	{
+		words.append(0);
+	}
+	int free = 64 - used;
+	if (count <= free)
+	{
+		words.last() |= bits << (free - count);
+	}
+	else
+	{
+		int rest = count - free;
+		words.last() |= bits >> rest;
+		words.append(bits << (64 - rest));
+	}
+	bitCount += count;
+}
+
+class QUaModbusBitReader
+{
+public:
+	explicit QUaModbusBitReader(const QVector<quint64> &words)
+		: m_words(words), m_pos(0)
+	{
+	}
+	quint64 read(const int &count)
+	{
+		if (count <= 0)
+		{
+			return 0;
+		}
+		int word  = static_cast<int>(m_pos / 64);
+		int used  = static_cast<int>(m_pos % 64);
+		int avail = 64 - used;
+		quint64 bits;
+		if (count <= avail)
+		{
+			bits = (m_words.at(word) << used) >> (64 - count);
+		}
+		else
+		{
+			int rest = count - avail;
+			quint64 high = (m_words.at(word) << used) >> used;
+			bits = (high << rest) | (m_words.at(word + 1) >> (64 - rest));
+		}
+		m_pos += count;
+		return bits;
+	}
+	bool bit()
+	{
+		return this->read(1) != 0;
+	}
+	// two's complement of count bits
+	qint64 readSigned(const int &count)
+	{
+		auto bits = this->read(count);
+		if (count < 64 && (bits & (Q_UINT64_C(1) << (count - 1))))
+		{
+			bits |= ~((Q_UINT64_C(1) << count) - 1);
+		}
+		return static_cast<qint64>(bits);
+	}
+
+private:
+	const QVector<quint64> &m_words;
+	quint64                 m_pos;
+};
+
+QUaModbusHistorian::QUaModbusHistorian()
+{
+	m_memoryLimit = 0;
+	m_memoryUsed  = 0;
+	m_store       = nullptr;
+}
+
+QUaModbusHistorian::~QUaModbusHistorian()
+{
+	this->flush();
+}
+
+void QUaModbusHistorian::setStore(QUaModbusHistoryStore * store)
+{
+	this->flush();
+	m_store = store;
+}
+
+QUaModbusHistoryStore * QUaModbusHistorian::store() const
+{
+	return m_store;
+}
+
+void QUaModbusHistorian::setDeviation(const QUaNodeId & nodeId, const double & deviation)
+{
+	m_series[QUaModbusHistorian::key(nodeId)].deviation = qMax(0.0, deviation);
+}
+
+void QUaModbusHistorian::remove(const QUaNodeId & nodeId)
+{
+	auto series = m_series.take(QUaModbusHistorian::key(nodeId));
+	for (auto &chunk : series.chunks)
+	{
+		m_memoryUsed -= QUaModbusHistorian::chunkMemory(chunk);
+	}
+}
+
+quint64 QUaModbusHistorian::memoryLimit() const
+{
+	return m_memoryLimit;
+}
+
+void QUaModbusHistorian::setMemoryLimit(const quint64 & memoryLimit)
+{
+	m_memoryLimit = memoryLimit;
+	this->evict();
+}
+
+quint64 QUaModbusHistorian::memoryUsed() const
+{
+	return m_memoryUsed;
+}
+
+bool QUaModbusHistorian::writeHistoryData(const QUaNodeId & nodeId, const QUaHistoryDataPoint & dataPoint, QQueue<QUaLog>& logOut)
+{
+	Point point;
+	point.time   = dataPoint.timestamp.toMSecsSinceEpoch();
+	point.status = dataPoint.status;
+	int  metaType = dataPoint.value.userType();
+	bool isArray  = false;
+	if (!dataPoint.value.isValid())
+	{
+		metaType = QMetaType::UnknownType;
+	}
+	else if (QUaModbusHistorian::isScalar(metaType))
+	{
+		point.bits = QUaModbusHistorian::toBits(dataPoint.value, metaType);
+	}
+	else if (metaType != QMetaType::QString && metaType != QMetaType::QByteArray &&
+		dataPoint.value.canConvert<QVariantList>())
+	{
+		// NOTE : block data, registers or coils
+		isArray = true;
+		QSequentialIterable iterable = dataPoint.value.value<QSequentialIterable>();
+		for (auto it = iterable.begin(); it != iterable.end(); ++it)
+		{
+			point.array << static_cast<quint16>((*it).toUInt());
+		}
+	}
+	else
+	{
+		logOut << QUaLog(
+			tr("Values of type %1 of node %2 cannot be historized.").arg(QMetaType::typeName(metaType)).arg(nodeId),
+			QUaLogLevel::Warning,
+			QUaLogCategory::History
+		);
+		return false;
+	}
+	auto strKey  = QUaModbusHistorian::key(nodeId);
+	auto &series = m_series[strKey];
+	// first point
+	if (!series.hasArchived)
+	{
+		this->archive(strKey, series, point, metaType, isArray);
+		return true;
+	}
+	// NOTE : streams only grow, late points (e.g. a clock step back) are dropped
+	auto &last = series.hasHeld ? series.held : series.archived;
+	if (point.time <= last.time)
+	{
+		return true;
+	}
+	bool sameKind =
+		metaType     == series.archivedMetaType &&
+		isArray      == series.archivedIsArray  &&
+		point.status == series.archived.status;
+	// arrays and invalid values, only changes
+	if (isArray || metaType == QMetaType::UnknownType)
+	{
+		if (sameKind && point.array == series.archived.array)
+		{
+			series.held    = point;
+			series.hasHeld = true;
+			return true;
+		}
+		// NOTE : a step, the repeated points before it add nothing
+		series.hasHeld = false;
+		this->archive(strKey, series, point, metaType, isArray);
+		return true;
+	}
+	double value = QUaModbusHistorian::toDouble(point.bits, metaType);
+	if (!sameKind || !qIsFinite(value))
+	{
+		if (series.hasHeld)
+		{
+			this->archive(strKey, series, series.held, series.archivedMetaType, series.archivedIsArray);
+			series.hasHeld = false;
+		}
+		this->archive(strKey, series, point, metaType, isArray);
+		return true;
+	}
+	// swinging door
+	if (!series.hasHeld)
+	{
+		QUaModbusHistorian::resetDoor(series, point);
+		series.held    = point;
+		series.hasHeld = true;
+		return true;
+	}
+	auto   pivot = QUaModbusHistorian::toDouble(series.archived.bits, series.archivedMetaType);
+	double dt    = static_cast<double>(point.time - series.archived.time);
+	double upper = qMax(series.slopeUpper, (value - (pivot + series.deviation)) / dt);
+	double lower = qMin(series.slopeLower, (value - (pivot - series.deviation)) / dt);
+	if (upper <= lower)
+	{
+		series.slopeUpper = upper;
+		series.slopeLower = lower;
+		series.held       = point;
+		return true;
+	}
+	// door opened, held point is the end of the line and the pivot of the next door
+	Point held = series.held;
+	this->archive(strKey, series, held, series.archivedMetaType, series.archivedIsArray);
+	QUaModbusHistorian::resetDoor(series, point);
+	series.held = point;
+	return true;
+}
+
+bool QUaModbusHistorian::updateHistoryData(const QUaNodeId & nodeId, const QUaHistoryDataPoint & dataPoint, QQueue<QUaLog>& logOut)
+{
+	Q_UNUSED(dataPoint);
+	logOut << QUaLog(
+		tr("Cannot update history of node %1, compressed history is append only.").arg(nodeId),
+		QUaLogLevel::Warning,
+		QUaLogCategory::History
+	);
+	return false;
+}
+
+bool QUaModbusHistorian::removeHistoryData(const QUaNodeId & nodeId, const QDateTime & timeStart, const QDateTime & timeEnd, QQueue<QUaLog>& logOut)
+{
+	// NOTE : only from memory, the store is append only and its history ages out
+	auto it = m_series.find(QUaModbusHistorian::key(nodeId));
+	if (it == m_series.end())
+	{
+		return true;
+	}
+	auto &series = it.value();
+	qint64 start = timeStart.toMSecsSinceEpoch();
+	qint64 end   = timeEnd  .toMSecsSinceEpoch();
+	// only whole chunks, points inside a chunk cannot be removed
+	bool partial = false;
+	for (int i = series.chunks.count() - 1; i >= 0; i--)
+	{
+		auto &chunk = series.chunks[i];
+		if (chunk.lastTime < start || chunk.firstTime > end)
+		{
+			continue;
+		}
+		if (chunk.firstTime < start || chunk.lastTime > end)
+		{
+			partial = true;
+			continue;
+		}
+		m_memoryUsed -= QUaModbusHistorian::chunkMemory(chunk);
+		series.chunks.remove(i);
+	}
+	if (series.hasHeld && series.held.time >= start && series.held.time <= end)
+	{
+		series.hasHeld = false;
+	}
+	if (partial)
+	{
+		logOut << QUaLog(
+			tr("History of node %1 only partially removed, compressed history is removed in chunks of up to %2 points.").arg(nodeId).arg(QUaModbusHistorian::m_chunkSize),
+			QUaLogLevel::Warning,
+			QUaLogCategory::History
+		);
+		return false;
+	}
+	return true;
+}
+
+QDateTime QUaModbusHistorian::firstTimestamp(const QUaNodeId & nodeId, QQueue<QUaLog>& logOut) const
+{
+	Q_UNUSED(logOut);
+	auto strKey = QUaModbusHistorian::key(nodeId);
+	auto series = m_series.value(strKey);
+	auto first  = QUaModbusHistorian::memoryFirstTime(series);
+	if (m_store)
+	{
+		m_store->forEachChunk(strKey, std::numeric_limits<qint64>::min(), first - 1,
+		[&first](const QUaModbusHistoryChunk &chunk) {
+			first = qMin(first, chunk.firstTime);
+			return false;
+		});
+	}
+	return first == std::numeric_limits<qint64>::max() ? QDateTime() : QDateTime::fromMSecsSinceEpoch(first, Qt::UTC);
+}
+
+QDateTime QUaModbusHistorian::lastTimestamp(const QUaNodeId & nodeId, QQueue<QUaLog>& logOut) const
+{
+	Q_UNUSED(logOut);
+	auto strKey = QUaModbusHistorian::key(nodeId);
+	auto series = m_series.value(strKey);
+	if (series.hasHeld)
+	{
+		return QDateTime::fromMSecsSinceEpoch(series.held.time, Qt::UTC);
+	}
+	if (!series.chunks.isEmpty())
+	{
+		return QDateTime::fromMSecsSinceEpoch(series.chunks.last().lastTime, Qt::UTC);
+	}
+	auto last = std::numeric_limits<qint64>::min();
+	if (m_store)
+	{
+		m_store->forEachChunk(strKey, std::numeric_limits<qint64>::min(), std::numeric_limits<qint64>::max(),
+		[&last](const QUaModbusHistoryChunk &chunk) {
+			last = chunk.lastTime;
+			return false;
+		}, true);
+	}
+	return last == std::numeric_limits<qint64>::min() ? QDateTime() : QDateTime::fromMSecsSinceEpoch(last, Qt::UTC);
+}
+
+bool QUaModbusHistorian::hasTimestamp(const QUaNodeId & nodeId, const QDateTime & timestamp, QQueue<QUaLog>& logOut) const
+{
+	Q_UNUSED(logOut);
+	auto strKey = QUaModbusHistorian::key(nodeId);
+	auto time   = timestamp.toMSecsSinceEpoch();
+	return !this->points(strKey, m_series.value(strKey), time, time, 1).isEmpty();
+}
+
+QDateTime QUaModbusHistorian::findTimestamp(const QUaNodeId & nodeId, const QDateTime & timestamp, const QUaHistoryBackend::TimeMatch & match, QQueue<QUaLog>& logOut) const
+{
+	Q_UNUSED(logOut);
+	auto strKey = QUaModbusHistorian::key(nodeId);
+	auto series = m_series.value(strKey);
+	auto time   = timestamp.toMSecsSinceEpoch();
+	if (match == QUaHistoryBackend::TimeMatch::ClosestFromAbove)
+	{
+		auto listPoints = this->points(strKey, series, time, std::numeric_limits<qint64>::max(), 1);
+		return listPoints.isEmpty() ? QDateTime() : listPoints.first().timestamp;
+	}
+	// held point is the latest
+	if (series.hasHeld && series.held.time <= time)
+	{
+		return QDateTime::fromMSecsSinceEpoch(series.held.time, Qt::UTC);
+	}
+	// last chunk starting at or before time
+	auto chunk = std::upper_bound(series.chunks.begin(), series.chunks.end(), time,
+	[](const qint64 &value, const Chunk &other) {
+		return value < other.firstTime;
+	});
+	qint64 found = std::numeric_limits<qint64>::min();
+	auto findIn = [&found, time](const QUaModbusHistoryChunk &other) {
+		for (auto &point : QUaModbusHistorian::decode(other))
+		{
+			if (point.time > time)
+			{
+				break;
+			}
+			found = point.time;
+		}
+	};
+	if (chunk != series.chunks.begin())
+	{
+		findIn(*(--chunk));
+	}
+	// older than memory, newest stored chunk overlapping has it
+	else if (m_store)
+	{
+		m_store->forEachChunk(strKey, std::numeric_limits<qint64>::min(), time,
+		[&findIn](const QUaModbusHistoryChunk &other) {
+			findIn(other);
+			return false;
+		}, true);
+	}
+	return found == std::numeric_limits<qint64>::min() ? QDateTime() : QDateTime::fromMSecsSinceEpoch(found, Qt::UTC);
+}
+
+quint64 QUaModbusHistorian::numDataPointsInRange(const QUaNodeId & nodeId, const QDateTime & timeStart, const QDateTime & timeEnd, QQueue<QUaLog>& logOut) const
+{
+	Q_UNUSED(logOut);
+	auto strKey = QUaModbusHistorian::key(nodeId);
+	auto series = m_series.value(strKey);
+	qint64 start = timeStart.toMSecsSinceEpoch();
+	qint64 end   = timeEnd  .toMSecsSinceEpoch();
+	quint64 count = 0;
+	// NOTE : only chunks at the ends of the range need to be decoded
+	auto countIn = [&count](const QUaModbusHistoryChunk &chunk, const qint64 &start, const qint64 &end) {
+		if (chunk.firstTime >= start && chunk.lastTime <= end)
+		{
+			count += chunk.count;
+			return;
+		}
+		for (auto &point : QUaModbusHistorian::decode(chunk))
+		{
+			count += point.time >= start && point.time <= end ? 1 : 0;
+		}
+	};
+	auto memoryFirst = QUaModbusHistorian::memoryFirstTime(series);
+	if (m_store && start < memoryFirst)
+	{
+		auto storeEnd = qMin(end, memoryFirst - 1);
+		m_store->forEachChunk(strKey, start, storeEnd,
+		[&countIn, start, storeEnd](const QUaModbusHistoryChunk &chunk) {
+			countIn(chunk, start, storeEnd);
+			return true;
+		});
+	}
+	auto chunk = std::lower_bound(series.chunks.begin(), series.chunks.end(), start,
+	[](const Chunk &other, const qint64 &value) {
+		return other.lastTime < value;
+	});
+	for (; chunk != series.chunks.end() && chunk->firstTime <= end; ++chunk)
+	{
+		countIn(*chunk, start, end);
+	}
+	if (series.hasHeld && series.held.time >= start && series.held.time <= end)
+	{
+		count++;
+	}
+	return count;
+}
+
+QVector<QUaHistoryDataPoint> QUaModbusHistorian::readHistoryData(const QUaNodeId & nodeId, const QDateTime & timeStart, const quint64 & numPointsToRead, QQueue<QUaLog>& logOut) const
+{
+	Q_UNUSED(logOut);
+	auto strKey = QUaModbusHistorian::key(nodeId);
+	return this->points(strKey, m_series.value(strKey), timeStart.toMSecsSinceEpoch(), std::numeric_limits<qint64>::max(), numPointsToRead);
+}
+
+#ifdef UA_ENABLE_EVENTS
+bool QUaModbusHistorian::writeHistoryEventsOfType(const QUaNodeId & eventTypeNodeId, const QList<QUaNodeId>& emittersNodeIds, const QUaHistoryEventPoint & eventPoint, QQueue<QUaLog>& logOut)
+{
+	Q_UNUSED(emittersNodeIds);
+	Q_UNUSED(eventPoint);
+	logOut << QUaLog(
+		tr("Events of type %1 are not historized, only Modbus data is.").arg(eventTypeNodeId),
+		QUaLogLevel::Warning,
+		QUaLogCategory::History
+	);
+	return false;
+}
+
+QVector<QUaNodeId> QUaModbusHistorian::eventTypesOfEmitter(const QUaNodeId & emitterNodeId, const QDateTime & timeStart, const QDateTime & timeEnd, QQueue<QUaLog>& logOut)
+{
+	Q_UNUSED(emitterNodeId);
+	Q_UNUSED(timeStart);
+	Q_UNUSED(timeEnd);
+	Q_UNUSED(logOut);
+	return QVector<QUaNodeId>();
+}
+
+QDateTime QUaModbusHistorian::findTimestampEventOfType(const QUaNodeId & emitterNodeId, const QUaNodeId & eventTypeNodeId, const QDateTime & timestamp, const QUaHistoryBackend::TimeMatch & match, QQueue<QUaLog>& logOut)
+{
+	Q_UNUSED(emitterNodeId);
+	Q_UNUSED(eventTypeNodeId);
+	Q_UNUSED(timestamp);
+	Q_UNUSED(match);
+	Q_UNUSED(logOut);
+	return QDateTime();
+}
+
+quint64 QUaModbusHistorian::numEventsOfTypeInRange(const QUaNodeId & emitterNodeId, const QUaNodeId & eventTypeNodeId, const QDateTime & timeStart, const QDateTime & timeEnd, QQueue<QUaLog>& logOut)
+{
+	Q_UNUSED(emitterNodeId);
+	Q_UNUSED(eventTypeNodeId);
+	Q_UNUSED(timeStart);
+	Q_UNUSED(timeEnd);
+	Q_UNUSED(logOut);
+	return 0;
+}
+
+QVector<QUaHistoryEventPoint> QUaModbusHistorian::readHistoryEventsOfType(const QUaNodeId & emitterNodeId, const QUaNodeId & eventTypeNodeId, const QDateTime & timeStart, const quint64 & numPointsOffset, const quint64 & numPointsToRead, const QList<QUaBrowsePath>& columnsToRead, QQueue<QUaLog>& logOut)
+{
+	Q_UNUSED(emitterNodeId);
+	Q_UNUSED(eventTypeNodeId);
+	Q_UNUSED(timeStart);
+	Q_UNUSED(numPointsOffset);
+	Q_UNUSED(numPointsToRead);
+	Q_UNUSED(columnsToRead);
+	Q_UNUSED(logOut);
+	return QVector<QUaHistoryEventPoint>();
+}
+#endif // UA_ENABLE_EVENTS
+
+QString QUaModbusHistorian::key(const QUaNodeId & nodeId)
+{
+	return nodeId;
+}
+
+bool QUaModbusHistorian::isScalar(const int & metaType)
+{
+	switch (metaType)
+	{
+	case QMetaType::Bool:
+	case QMetaType::Char:
+	case QMetaType::SChar:
+	case QMetaType::UChar:
+	case QMetaType::Short:
+	case QMetaType::UShort:
+	case QMetaType::Int:
+	case QMetaType::UInt:
+	case QMetaType::Long:
+	case QMetaType::ULong:
+	case QMetaType::LongLong:
+	case QMetaType::ULongLong:
+	case QMetaType::Float:
+	case QMetaType::Double:
+		return true;
+	default:
+		return false;
+	}
+}
+
+quint64 QUaModbusHistorian::toBits(const QVariant & value, const int & metaType)
+{
+	switch (metaType)
+	{
+	case QMetaType::Float:
+	case QMetaType::Double:
+	{
+		// NOTE : floats are exact as doubles
+		double dValue = value.toDouble();
+		quint64 bits;
+		memcpy(&bits, &dValue, sizeof(quint64));
+		return bits;
+	}
+	case QMetaType::ULong:
+	case QMetaType::ULongLong:
+		return value.toULongLong();
+	default:
+		return static_cast<quint64>(value.toLongLong());
+	}
+}
+
+QVariant QUaModbusHistorian::fromBits(const quint64 & bits, const int & metaType)
+{
+	switch (metaType)
+	{
+	case QMetaType::UnknownType:
+		return QVariant();
+	case QMetaType::Float:
+	case QMetaType::Double:
+	{
+		double dValue;
+		memcpy(&dValue, &bits, sizeof(quint64));
+		return metaType == QMetaType::Float ? QVariant(static_cast<float>(dValue)) : QVariant(dValue);
+	}
+	case QMetaType::ULong:
+	case QMetaType::ULongLong:
+	{
+		QVariant value(static_cast<qulonglong>(bits));
+		value.convert(metaType);
+		return value;
+	}
+	default:
+	{
+		QVariant value(static_cast<qlonglong>(bits));
+		value.convert(metaType);
+		return value;
+	}
+	}
+}
+
+double QUaModbusHistorian::toDouble(const quint64 & bits, const int & metaType)
+{
+	switch (metaType)
+	{
+	case QMetaType::Float:
+	case QMetaType::Double:
+	{
+		double dValue;
+		memcpy(&dValue, &bits, sizeof(quint64));
+		return dValue;
+	}
+	case QMetaType::ULong:
+	case QMetaType::ULongLong:
+		return static_cast<double>(bits);
+	default:
+		return static_cast<double>(static_cast<qint64>(bits));
+	}
+}
+
+QUaHistoryDataPoint QUaModbusHistorian::toDataPoint(const Point & point, const int & metaType, const bool & isArray)
+{
+	QUaHistoryDataPoint dataPoint;
+	dataPoint.timestamp = QDateTime::fromMSecsSinceEpoch(point.time, Qt::UTC);
+	dataPoint.value     = isArray ? QVariant::fromValue(point.array) : QUaModbusHistorian::fromBits(point.bits, metaType);
+	dataPoint.status    = point.status;
+	return dataPoint;
+}
+
+quint64 QUaModbusHistorian::chunkMemory(const Chunk & chunk)
+{
+	return sizeof(Chunk) +
+		static_cast<quint64>(chunk.words    .capacity()) * sizeof(quint64) +
+		static_cast<quint64>(chunk.prevArray.capacity()) * sizeof(quint16);
+}
+
+void QUaModbusHistorian::archive(const QString & strKey, Series & series, const Point & point, const int & metaType, const bool & isArray)
+{
+	series.archived         = point;
+	series.archivedMetaType = metaType;
+	series.archivedIsArray  = isArray;
+	series.hasArchived      = true;
+	// new chunk if full, written to the store or values of another type
+	if (series.chunks.isEmpty() ||
+		series.chunks.last().stored ||
+		series.chunks.last().count    >= static_cast<quint32>(QUaModbusHistorian::m_chunkSize) ||
+		series.chunks.last().metaType != metaType ||
+		series.chunks.last().isArray  != isArray)
+	{
+		// previous chunk is complete
+		if (m_store && !series.chunks.isEmpty() && !series.chunks.last().stored)
+		{
+			m_store->append(strKey, series.chunks.last());
+			series.chunks.last().stored = true;
+		}
+		Chunk chunk;
+		chunk.stored       = false;
+		chunk.isArray      = isArray;
+		chunk.metaType     = metaType;
+		chunk.firstTime    = point.time;
+		chunk.lastTime     = point.time;
+		chunk.count        = 0;
+		chunk.bitCount     = 0;
+		chunk.prevDelta    = 0;
+		chunk.prevBits     = 0;
+		chunk.prevLeading  = -1;
+		chunk.prevTrailing = 0;
+		chunk.prevStatus   = 0;
+		series.chunks << chunk;
+		m_memoryUsed += QUaModbusHistorian::chunkMemory(chunk);
+	}
+	auto &chunk = series.chunks.last();
+	auto memoryBefore = QUaModbusHistorian::chunkMemory(chunk);
+	auto &words    = chunk.words;
+	auto &bitCount = chunk.bitCount;
+	if (chunk.count == 0)
+	{
+		writeBits(words, bitCount, static_cast<quint64>(point.time), 64);
+		writeBits(words, bitCount, point.status, 32);
+	}
+	else
+	{
+		// timestamp, delta of delta is zero for a steady sampling time
+		qint64 delta = point.time - chunk.lastTime;
+		qint64 dod   = delta - chunk.prevDelta;
+		if (dod == 0)
+		{
+			writeBits(words, bitCount, 0, 1);
+		}
+		else if (dod >= -64 && dod < 64)
+		{
+			writeBits(words, bitCount, 0x2, 2);
+			writeBits(words, bitCount, static_cast<quint64>(dod), 7);
+		}
+		else if (dod >= -256 && dod < 256)
+		{
+			writeBits(words, bitCount, 0x6, 3);
+			writeBits(words, bitCount, static_cast<quint64>(dod), 9);
+		}
+		else if (dod >= -2048 && dod < 2048)
+		{
+			writeBits(words, bitCount, 0xE, 4);
+			writeBits(words, bitCount, static_cast<quint64>(dod), 12);
+		}
+		else
+		{
+			writeBits(words, bitCount, 0xF, 4);
+			writeBits(words, bitCount, static_cast<quint64>(dod), 64);
+		}
+		chunk.prevDelta = delta;
+		// status
+		if (point.status == chunk.prevStatus)
+		{
+			writeBits(words, bitCount, 0, 1);
+		}
+		else
+		{
+			writeBits(words, bitCount, 1, 1);
+			writeBits(words, bitCount, point.status, 32);
+		}
+	}
+	if (isArray)
+	{
+		// elements that did not change take one bit
+		writeBits(words, bitCount, static_cast<quint64>(point.array.count()), 16);
+		for (int i = 0; i < point.array.count(); i++)
+		{
+			if (i < chunk.prevArray.count() && point.array.at(i) == chunk.prevArray.at(i))
+			{
+				writeBits(words, bitCount, 0, 1);
+				continue;
+			}
+			writeBits(words, bitCount, 1, 1);
+			writeBits(words, bitCount, point.array.at(i), 16);
+		}
+		chunk.prevArray = point.array;
+	}
+	else if (chunk.count == 0)
+	{
+		writeBits(words, bitCount, point.bits, 64);
+	}
+	else
+	{
+		// xor with previous, only the meaningful bits are written
+		quint64 bitsXor = point.bits ^ chunk.prevBits;
+		if (!bitsXor)
+		{
+			writeBits(words, bitCount, 0, 1);
+		}
+		else
+		{
+			writeBits(words, bitCount, 1, 1);
+			int leading  = qMin(31, static_cast<int>(qCountLeadingZeroBits(bitsXor)));
+			int trailing = static_cast<int>(qCountTrailingZeroBits(bitsXor));
+			if (chunk.prevLeading >= 0 && leading >= chunk.prevLeading && trailing >= chunk.prevTrailing)
+			{
+				// fits in the previous window
+				writeBits(words, bitCount, 0, 1);
+				writeBits(words, bitCount, bitsXor >> chunk.prevTrailing, 64 - chunk.prevLeading - chunk.prevTrailing);
+			}
+			else
+			{
+				int meaningful = 64 - leading - trailing;
+				writeBits(words, bitCount, 1, 1);
+				writeBits(words, bitCount, static_cast<quint64>(leading), 5);
+				writeBits(words, bitCount, static_cast<quint64>(meaningful - 1), 6);
+				writeBits(words, bitCount, bitsXor >> trailing, meaningful);
+				chunk.prevLeading  = leading;
+				chunk.prevTrailing = trailing;
+			}
+		}
+	}
+	chunk.prevBits   = point.bits;
+	chunk.prevStatus = point.status;
+	chunk.lastTime   = point.time;
+	chunk.count++;
+	m_memoryUsed += QUaModbusHistorian::chunkMemory(chunk) - memoryBefore;
+	this->evict();
+}
+
+void QUaModbusHistorian::resetDoor(Series & series, const Point & point)
+{
+	auto pivot = QUaModbusHistorian::toDouble(series.archived.bits, series.archivedMetaType);
+	auto value = QUaModbusHistorian::toDouble(point.bits, series.archivedMetaType);
+	double dt  = static_cast<double>(point.time - series.archived.time);
+	series.slopeUpper = (value - (pivot + series.deviation)) / dt;
+	series.slopeLower = (value - (pivot - series.deviation)) / dt;
+}
+
+void QUaModbusHistorian::evict()
+{
+	while (m_memoryLimit > 0 && m_memoryUsed > m_memoryLimit)
+	{
+		Series * oldest = nullptr;
+		for (auto it = m_series.begin(); it != m_series.end(); ++it)
+		{
+			// NOTE : last chunk is kept, points are appended to it
+			if (it.value().chunks.count() < 2)
+			{
+				continue;
+			}
+			if (!oldest || it.value().chunks.first().firstTime < oldest->chunks.first().firstTime)
+			{
+				oldest = &it.value();
+			}
+		}
+		if (!oldest)
+		{
+			return;
+		}
+		m_memoryUsed -= QUaModbusHistorian::chunkMemory(oldest->chunks.first());
+		oldest->chunks.removeFirst();
+	}
+}
+
+void QUaModbusHistorian::flush()
+{
+	if (!m_store)
+	{
+		return;
+	}
+	for (auto it = m_series.begin(); it != m_series.end(); ++it)
+	{
+		auto &series = it.value();
+		// NOTE : held point ends the current line, archiving it drops no information
+		if (series.hasHeld)
+		{
+			Point held = series.held;
+			series.hasHeld = false;
+			this->archive(it.key(), series, held, series.archivedMetaType, series.archivedIsArray);
+		}
+		if (!series.chunks.isEmpty() && !series.chunks.last().stored)
+		{
+			m_store->append(it.key(), series.chunks.last());
+			series.chunks.last().stored = true;
+		}
+	}
+}
+
+qint64 QUaModbusHistorian::memoryFirstTime(const Series & series)
+{
+	if (!series.chunks.isEmpty())
+	{
+		return series.chunks.first().firstTime;
+	}
+	if (series.hasHeld)
+	{
+		return series.held.time;
+	}
+	return std::numeric_limits<qint64>::max();
+}
+
+QVector<QUaHistoryDataPoint> QUaModbusHistorian::points(const QString & strKey, const Series & series, const qint64 & timeStart, const qint64 & timeEnd, const quint64 & maxCount) const
+{
+	QVector<QUaHistoryDataPoint> result;
+	if (maxCount == 0)
+	{
+		return result;
+	}
+	// older than memory
+	auto memoryFirst = QUaModbusHistorian::memoryFirstTime(series);
+	if (m_store && timeStart < memoryFirst)
+	{
+		auto storeEnd = qMin(timeEnd, memoryFirst - 1);
+		m_store->forEachChunk(strKey, timeStart, storeEnd,
+		[&result, timeStart, storeEnd, maxCount](const QUaModbusHistoryChunk &chunk) {
+			for (auto &point : QUaModbusHistorian::decode(chunk))
+			{
+				if (point.time < timeStart)
+				{
+					continue;
+				}
+				if (point.time > storeEnd)
+				{
+					break;
+				}
+				result << QUaModbusHistorian::toDataPoint(point, chunk.metaType, chunk.isArray);
+				if (static_cast<quint64>(result.count()) >= maxCount)
+				{
+					return false;
+				}
+			}
+			return true;
+		});
+		if (static_cast<quint64>(result.count()) >= maxCount)
+		{
+			return result;
+		}
+	}
+	// first chunk that may have points at or after start
+	auto chunk = std::lower_bound(series.chunks.begin(), series.chunks.end(), timeStart,
+	[](const Chunk &other, const qint64 &value) {
+		return other.lastTime < value;
+	});
+	for (; chunk != series.chunks.end() && chunk->firstTime <= timeEnd; ++chunk)
+	{
+		for (auto &point : QUaModbusHistorian::decode(*chunk))
+		{
+			if (point.time < timeStart)
+			{
+				continue;
+			}
+			if (point.time > timeEnd)
+			{
+				break;
+			}
+			result << QUaModbusHistorian::toDataPoint(point, chunk->metaType, chunk->isArray);
+			if (static_cast<quint64>(result.count()) >= maxCount)
+			{
+				return result;
+			}
+		}
+	}
+	if (series.hasHeld && series.held.time >= timeStart && series.held.time <= timeEnd)
+	{
+		result << QUaModbusHistorian::toDataPoint(series.held, series.archivedMetaType, series.archivedIsArray);
+	}
+	return result;
+}
+
+QVector<QUaModbusHistorian::Point> QUaModbusHistorian::decode(const QUaModbusHistoryChunk & chunk)
+{
+	QVector<Point> listPoints;
+	listPoints.reserve(static_cast<int>(chunk.count));
+	QUaModbusBitReader reader(chunk.words);
+	Point  point;
+	qint64 delta    = 0;
+	int    leading  = -1;
+	int    trailing = 0;
+	for (quint32 i = 0; i < chunk.count; i++)
+	{
+		if (i == 0)
+		{
+			point.time   = static_cast<qint64>(reader.read(64));
+			point.status = static_cast<quint32>(reader.read(32));
+		}
+		else
+		{
+			qint64 dod = 0;
+			if (!reader.bit())
+			{
+				dod = 0;
+			}
+			else if (!reader.bit())
+			{
+				dod = reader.readSigned(7);
+			}
+			else if (!reader.bit())
+			{
+				dod = reader.readSigned(9);
+			}
+			else if (!reader.bit())
+			{
+				dod = reader.readSigned(12);
+			}
+			else
+			{
+				dod = reader.readSigned(64);
+			}
+			delta      += dod;
+			point.time += delta;
+			if (reader.bit())
+			{
+				point.status = static_cast<quint32>(reader.read(32));
+			}
+		}
+		if (chunk.isArray)
+		{
+			auto count = static_cast<int>(reader.read(16));
+			QVector<quint16> array(count);
+			for (int j = 0; j < count; j++)
+			{
+				array[j] = reader.bit() ?
+					static_cast<quint16>(reader.read(16)) :
+					point.array.at(j);
+			}
+			point.array = array;
+		}
+		else if (i == 0)
+		{
+			point.bits = reader.read(64);
+		}
+		else if (reader.bit())
+		{
+			if (reader.bit())
+			{
+				leading  = static_cast<int>(reader.read(5));
+				int meaningful = static_cast<int>(reader.read(6)) + 1;
+				trailing = 64 - leading - meaningful;
+			}
+			point.bits ^= reader.read(64 - leading - trailing) << trailing;
+		}
+		listPoints << point;
+	}
+	return listPoints;
+}
+
+#endif // UA_ENABLE_HISTORIZING
@@ -0,0 +1,212 @@
+#ifndef QUAMODBUSHISTORIAN_H
+#define QUAMODBUSHISTORIAN_H
+
+#include <QUaServer>
+
+#ifdef UA_ENABLE_HISTORIZING
+
+#include <QCoreApplication>
+#include <QHash>
+#include <QVector>
+
+#include "quamodbushistorystore.h"
+
+// In-memory history of the Value of Modbus values and the Data of blocks, served to HistoryRead.
+// Points are compressed before they are stored :
+//   scalars use swinging door compression, a point is only archived once no line from the last
+//   archived point can pass within the deviation of all points since. Zero deviation only drops
+//   points on straight lines, e.g. a constant or a linear ramp
+//   arrays use a deadband, a point is only archived if any element or the status changed
+// the last point received is kept apart (not archived yet) so reads always end with it.
+// Archived points are encoded Gorilla style in chunks of m_chunkSize points : timestamps as
+// delta of delta, values as the xor with the previous one and the status only if it changed.
+// NOTE : only accessed in the ua server thread. Once memoryLimit is exceeded the oldest full
+//        chunk of any node is dropped, so memory is a ring buffer shared by all nodes
+// With a store, chunks are also written to disk once full and reads older than the chunks
+// still in memory are served from the store.
+class QUaModbusHistorian
+{
+	Q_DECLARE_TR_FUNCTIONS(QUaModbusHistorian)
+
+public:
+	QUaModbusHistorian();
+	// NOTE : writes down the last points to the store if any
+	~QUaModbusHistorian();
+
+	// disk tier, nullptr disables it. The last points of each node are written down
+	// to the previous store before it is replaced, so it can be deleted right after
+	void setStore(QUaModbusHistoryStore * store);
+	QUaModbusHistoryStore * store() const;
+
+	// deviation of the swinging door compression of the node (ignored for arrays),
+	// a node without one is stored with zero deviation
+	void setDeviation(const QUaNodeId &nodeId, const double &deviation);
+	// drops the history of the node kept in memory, the one in the store ages out
+	void remove(const QUaNodeId &nodeId);
+
+	// in bytes, zero is no limit
+	quint64 memoryLimit() const;
+	void    setMemoryLimit(const quint64 &memoryLimit);
+	quint64 memoryUsed() const;
+
+	// QUaServer historizer API
+
+	bool writeHistoryData(
+		const QUaNodeId           &nodeId,
+		const QUaHistoryDataPoint &dataPoint,
+		QQueue<QUaLog>            &logOut
+	);
+	// NOTE : archived points are compressed, so they are neither updated nor removed one by one
+	bool updateHistoryData(
+		const QUaNodeId           &nodeId,
+		const QUaHistoryDataPoint &dataPoint,
+		QQueue<QUaLog>            &logOut
+	);
+	bool removeHistoryData(
+		const QUaNodeId &nodeId,
+		const QDateTime &timeStart,
+		const QDateTime &timeEnd,
+		QQueue<QUaLog>  &logOut
+	);
+	QDateTime firstTimestamp(
+		const QUaNodeId &nodeId,
+		QQueue<QUaLog>  &logOut
+	) const;
+	QDateTime lastTimestamp(
+		const QUaNodeId &nodeId,
+		QQueue<QUaLog>  &logOut
+	) const;
+	bool hasTimestamp(
+		const QUaNodeId &nodeId,
+		const QDateTime &timestamp,
+		QQueue<QUaLog>  &logOut
+	) const;
+	// ClosestFromAbove is the first timestamp >= timestamp, ClosestFromBelow the last <= timestamp
+	QDateTime findTimestamp(
+		const QUaNodeId                    &nodeId,
+		const QDateTime                    &timestamp,
+		const QUaHistoryBackend::TimeMatch &match,
+		QQueue<QUaLog>                     &logOut
+	) const;
+	// timeStart and timeEnd included
+	quint64 numDataPointsInRange(
+		const QUaNodeId &nodeId,
+		const QDateTime &timeStart,
+		const QDateTime &timeEnd,
+		QQueue<QUaLog>  &logOut
+	) const;
+	QVector<QUaHistoryDataPoint> readHistoryData(
+		const QUaNodeId &nodeId,
+		const QDateTime &timeStart,
+		const quint64   &numPointsToRead,
+		QQueue<QUaLog>  &logOut
+	) const;
+
+#ifdef UA_ENABLE_EVENTS
+	// NOTE : events are not historized, only the data of the Modbus tree
+	bool writeHistoryEventsOfType(
+		const QUaNodeId            &eventTypeNodeId,
+		const QList<QUaNodeId>     &emittersNodeIds,
+		const QUaHistoryEventPoint &eventPoint,
+		QQueue<QUaLog>             &logOut
+	);
+	QVector<QUaNodeId> eventTypesOfEmitter(
+		const QUaNodeId &emitterNodeId,
+		const QDateTime &timeStart,
+		const QDateTime &timeEnd,
+		QQueue<QUaLog>  &logOut
+	);
+	QDateTime findTimestampEventOfType(
+		const QUaNodeId                    &emitterNodeId,
+		const QUaNodeId                    &eventTypeNodeId,
+		const QDateTime                    &timestamp,
+		const QUaHistoryBackend::TimeMatch &match,
+		QQueue<QUaLog>                     &logOut
+	);
+	quint64 numEventsOfTypeInRange(
+		const QUaNodeId &emitterNodeId,
+		const QUaNodeId &eventTypeNodeId,
+		const QDateTime &timeStart,
+		const QDateTime &timeEnd,
+		QQueue<QUaLog>  &logOut
+	);
+	QVector<QUaHistoryEventPoint> readHistoryEventsOfType(
+		const QUaNodeId            &emitterNodeId,
+		const QUaNodeId            &eventTypeNodeId,
+		const QDateTime            &timeStart,
+		const quint64              &numPointsOffset,
+		const quint64              &numPointsToRead,
+		const QList<QUaBrowsePath> &columnsToRead,
+		QQueue<QUaLog>             &logOut
+	);
+#endif // UA_ENABLE_EVENTS
+
+	static int m_chunkSize;
+
+private:
+	// decoded point, values are the bits of a scalar (see toBits) or the elements of an array
+	struct Point
+	{
+		qint64           time   = 0;
+		quint64          bits   = 0;
+		QVector<quint16> array;
+		quint32          status = 0;
+	};
+	// archived points of one value type, encoded in a bit stream
+	struct Chunk : public QUaModbusHistoryChunk
+	{
+		// written to the store, no more points are appended
+		bool             stored;
+		// encoder state, to append to the stream
+		qint64           prevDelta;
+		quint64          prevBits;
+		int              prevLeading;
+		int              prevTrailing;
+		quint32          prevStatus;
+		QVector<quint16> prevArray;
+	};
+	struct Series
+	{
+		double          deviation        = 0.0;
+		QVector<Chunk>  chunks;
+		// last point archived, swinging door pivot
+		bool            hasArchived      = false;
+		Point           archived;
+		int             archivedMetaType = QMetaType::UnknownType;
+		bool            archivedIsArray  = false;
+		// last point received, not archived yet
+		bool            hasHeld          = false;
+		Point           held;
+		// door slopes, in value units per millisecond
+		double          slopeUpper       = 0.0;
+		double          slopeLower       = 0.0;
+	};
+	QHash<QString, Series>  m_series;
+	quint64                 m_memoryLimit;
+	quint64                 m_memoryUsed;
+	QUaModbusHistoryStore * m_store;
+
+	static QString key(const QUaNodeId &nodeId);
+	static bool    isScalar(const int &metaType);
+	static quint64 toBits  (const QVariant &value, const int &metaType);
+	static QVariant fromBits(const quint64 &bits, const int &metaType);
+	static double  toDouble(const quint64 &bits, const int &metaType);
+	static QUaHistoryDataPoint toDataPoint(const Point &point, const int &metaType, const bool &isArray);
+	static quint64 chunkMemory(const Chunk &chunk);
+
+	void archive(const QString &strKey, Series &series, const Point &point, const int &metaType, const bool &isArray);
+	// closes the last chunk of each node and writes it to the store
+	void flush();
+	// new door from the last archived point through point
+	static void resetDoor(Series &series, const Point &point);
+	void evict();
+	// first time kept in memory, older points are read from the store
+	static qint64 memoryFirstTime(const Series &series);
+	// points in [timeStart, timeEnd], at most maxCount, stored then archived then held
+	QVector<QUaHistoryDataPoint> points(const QString &strKey, const Series &series, const qint64 &timeStart, const qint64 &timeEnd, const quint64 &maxCount) const;
+	static QVector<Point> decode(const QUaModbusHistoryChunk &chunk);
+};
+
+#endif // UA_ENABLE_HISTORIZING
+
+#endif // QUAMODBUSHISTORIAN_H
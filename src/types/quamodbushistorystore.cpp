@@ -0,0 +1,771 @@
+#include "quamodbushistorystore.h"
+
+#ifdef UA_ENABLE_HISTORIZING
+
+#include <QDir>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDataStream>
+#include <QSemaphore>
+#include <QtEndian>
+
+#include <limits>
+#include <algorithm>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif // Q_OS_WIN
+
+qint64 QUaModbusHistoryStore::m_segmentSize   = 64 * 1024 * 1024;
+qint64 QUaModbusHistoryStore::m_segmentPeriod = 3600000;
+int    QUaModbusHistoryStore::m_syncPeriod    = 1000;
+int    QUaModbusHistoryStore::m_openSegments  = 32;
+
+// NOTE : flush only hands the data to the OS, this waits for the disk
+static void syncFile(QFile &file)
+{
+#ifdef Q_OS_WIN
+	_commit(file.handle());
+#else
+	::fsync(file.handle());
+#endif // Q_OS_WIN
+}
+
+QUaModbusHistoryStore::QUaModbusHistoryStore(const QString &strDirPath)
+{
+	m_strDirPath    = strDirPath;
+	m_syncLoop      = 0;
+	m_retentionAge  = 0;
+	m_retentionSize = 0;
+	m_sizeUsed      = 0;
+	m_useCounter    = 0;
+}
+
+QUaModbusHistoryStore::~QUaModbusHistoryStore()
+{
+	if (m_syncLoop > 0)
+	{
+		m_worker.stopLoopInThread(m_syncLoop);
+	}
+	// NOTE : tasks run in order, so this waits for the queued writes
+	QSemaphore done;
+	m_worker.execInThread([this, &done]() {
+		for (auto client : m_clients)
+		{
+			this->closeSegment(client);
+		}
+		done.release();
+	});
+	done.acquire();
+	for (auto client : m_clients)
+	{
+		for (auto segment : client->segments)
+		{
+			this->releaseSegment(segment);
+			delete segment;
+		}
+		delete client;
+	}
+}
+
+QString QUaModbusHistoryStore::dirPath() const
+{
+	return m_strDirPath;
+}
+
+bool QUaModbusHistoryStore::open(QQueue<QUaLog> & errorLogs)
+{
+	Q_ASSERT(m_syncLoop == 0);
+	QDir dir(m_strDirPath);
+	if (!dir.mkpath("."))
+	{
+		errorLogs << QUaLog(
+			tr("Cannot create history store directory %1.").arg(m_strDirPath),
+			QUaLogLevel::Error,
+			QUaLogCategory::History
+		);
+		return false;
+	}
+	for (auto &strName : dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name))
+	{
+		auto client = this->client(strName);
+		QDir dirClient(client->strDirPath);
+		// NOTE : names are creation times, so segments load in order
+		for (auto &strFile : dirClient.entryList({ "*.qums" }, QDir::Files, QDir::Name))
+		{
+			this->loadSegment(client, dirClient.filePath(strFile), errorLogs);
+		}
+	}
+	m_syncLoop = m_worker.startLoopInThread([this]() {
+		this->sync();
+	}, m_syncPeriod);
+	return true;
+}
+
+void QUaModbusHistoryStore::append(const QString & strKey, const QUaModbusHistoryChunk & chunk)
+{
+	{
+		QMutexLocker locker(&m_mutex);
+		m_queued[strKey] << chunk;
+	}
+	m_worker.execInThread([this, strKey, chunk]() {
+		this->writeChunk(strKey, chunk);
+	});
+}
+
+void QUaModbusHistoryStore::forEachChunk(const QString & strKey, const qint64 & timeStart, const qint64 & timeEnd, const Visitor & visitor, const bool & reverse)
+{
+	QMutexLocker locker(&m_mutex);
+	auto overlaps = [timeStart, timeEnd](const qint64 &firstTime, const qint64 &lastTime) {
+		return lastTime >= timeStart && firstTime <= timeEnd;
+	};
+	// not written yet, newer than all on disk
+	auto queued = m_queued.value(strKey);
+	auto visitQueued = [&queued, &overlaps, &visitor, &reverse]() {
+		for (int i = 0; i < queued.count(); i++)
+		{
+			auto &chunk = queued.at(reverse ? queued.count() - 1 - i : i);
+			if (overlaps(chunk.firstTime, chunk.lastTime) && !visitor(chunk))
+			{
+				return false;
+			}
+		}
+		return true;
+	};
+	if (reverse && !visitQueued())
+	{
+		return;
+	}
+	auto client = m_clients.value(QUaModbusHistoryStore::clientName(strKey), nullptr);
+	if (client)
+	{
+		bool stopped = false;
+		int  count   = client->segments.count();
+		for (int s = 0; s < count && !stopped; s++)
+		{
+			auto segment = client->segments.at(reverse ? count - 1 - s : s);
+			if (!overlaps(segment->firstTime, segment->lastTime) || !this->ensureIndexed(segment))
+			{
+				continue;
+			}
+			segment->lastUsed = ++m_useCounter;
+			// NOTE : chunks of a key are appended in time order
+			auto entries = segment->index.value(strKey);
+			for (int e = 0; e < entries.count() && !stopped; e++)
+			{
+				auto &entry = entries.at(reverse ? entries.count() - 1 - e : e);
+				QUaModbusHistoryChunk chunk;
+				if (!overlaps(entry.firstTime, entry.lastTime) || !this->readRecord(segment, entry, chunk))
+				{
+					continue;
+				}
+				stopped = !visitor(chunk);
+			}
+		}
+		this->releaseUnused();
+		if (stopped)
+		{
+			return;
+		}
+	}
+	if (!reverse)
+	{
+		visitQueued();
+	}
+}
+
+qint64 QUaModbusHistoryStore::retentionAge() const
+{
+	QMutexLocker locker(&m_mutex);
+	return m_retentionAge;
+}
+
+void QUaModbusHistoryStore::setRetentionAge(const qint64 & retentionAge)
+{
+	QMutexLocker locker(&m_mutex);
+	m_retentionAge = qMax(Q_INT64_C(0), retentionAge);
+}
+
+quint64 QUaModbusHistoryStore::retentionSize() const
+{
+	QMutexLocker locker(&m_mutex);
+	return m_retentionSize;
+}
+
+void QUaModbusHistoryStore::setRetentionSize(const quint64 & retentionSize)
+{
+	QMutexLocker locker(&m_mutex);
+	m_retentionSize = retentionSize;
+}
+
+quint64 QUaModbusHistoryStore::sizeUsed() const
+{
+	QMutexLocker locker(&m_mutex);
+	return m_sizeUsed;
+}
+
+QString QUaModbusHistoryStore::clientName(const QString & strKey)
+{
+	auto strName = strKey.section('.', 1, 1);
+	return strName.isEmpty() ? QString("_") : strName;
+}
+
+QUaModbusHistoryStore::Client * QUaModbusHistoryStore::client(const QString & strName)
+{
+	QMutexLocker locker(&m_mutex);
+	auto client = m_clients.value(strName, nullptr);
+	if (client)
+	{
+		return client;
+	}
+	client = new Client;
+	client->strDirPath = QDir(m_strDirPath).filePath(strName);
+	client->writer     = nullptr;
+	client->dirty      = false;
+	QDir().mkpath(client->strDirPath);
+	m_clients.insert(strName, client);
+	return client;
+}
+
+void QUaModbusHistoryStore::writeChunk(const QString & strKey, const QUaModbusHistoryChunk & chunk)
+{
+	auto client  = this->client(QUaModbusHistoryStore::clientName(strKey));
+	auto segment = client->writer ? client->segments.last() : nullptr;
+	auto now     = QDateTime::currentMSecsSinceEpoch();
+	if (segment && (static_cast<qint64>(segment->size) >= QUaModbusHistoryStore::m_segmentSize ||
+		now - segment->created >= QUaModbusHistoryStore::m_segmentPeriod))
+	{
+		this->closeSegment(client);
+		segment = nullptr;
+	}
+	if (!segment && this->startSegment(client))
+	{
+		segment = client->segments.last();
+	}
+	auto byteRecord = QUaModbusHistoryStore::serializeRecord(strKey, chunk);
+	bool written = segment &&
+		client->writer->write(byteRecord) == byteRecord.size() &&
+		client->writer->flush();
+	QMutexLocker locker(&m_mutex);
+	auto &queued = m_queued[strKey];
+	if (!queued.isEmpty())
+	{
+		queued.removeFirst();
+	}
+	if (queued.isEmpty())
+	{
+		m_queued.remove(strKey);
+	}
+	// NOTE : disk full or similar, the chunk is lost but the segment is kept consistent
+	if (!written)
+	{
+		if (segment)
+		{
+			client->writer->resize(static_cast<qint64>(segment->size));
+			client->writer->seek(static_cast<qint64>(segment->size));
+		}
+		return;
+	}
+	segment->index[strKey] << Entry({
+		chunk.firstTime,
+		chunk.lastTime,
+		segment->size,
+		static_cast<quint32>(byteRecord.size())
+	});
+	segment->firstTime = qMin(segment->firstTime, chunk.firstTime);
+	segment->lastTime  = qMax(segment->lastTime , chunk.lastTime );
+	segment->size     += static_cast<quint64>(byteRecord.size());
+	m_sizeUsed        += static_cast<quint64>(byteRecord.size());
+	client->dirty      = true;
+}
+
+bool QUaModbusHistoryStore::startSegment(Client * client)
+{
+	// NOTE : names are creation times, unique within the client
+	auto created = QDateTime::currentMSecsSinceEpoch();
+	auto strFileName = QDir(client->strDirPath).filePath(QString("%1.qums").arg(created, 16, 10, QChar('0')));
+	while (QFile::exists(strFileName))
+	{
+		created++;
+		strFileName = QDir(client->strDirPath).filePath(QString("%1.qums").arg(created, 16, 10, QChar('0')));
+	}
+	auto writer = new QFile(strFileName);
+	QByteArray byteHeader;
+	QDataStream stream(&byteHeader, QIODevice::WriteOnly);
+	stream.setByteOrder(QDataStream::LittleEndian);
+	stream << m_magic << m_version;
+	if (!writer->open(QIODevice::WriteOnly) || writer->write(byteHeader) != byteHeader.size() || !writer->flush())
+	{
+		writer->remove();
+		delete writer;
+		return false;
+	}
+	auto segment = new Segment;
+	segment->strFileName = strFileName;
+	segment->created     = created;
+	segment->firstTime   = std::numeric_limits<qint64>::max();
+	segment->lastTime    = std::numeric_limits<qint64>::min();
+	segment->size        = static_cast<quint64>(byteHeader.size());
+	segment->sealed      = false;
+	segment->indexed     = true;
+	segment->reader      = nullptr;
+	segment->map         = nullptr;
+	segment->mapSize     = 0;
+	segment->lastUsed    = 0;
+	client->writer = writer;
+	QMutexLocker locker(&m_mutex);
+	client->segments << segment;
+	m_sizeUsed += segment->size;
+	return true;
+}
+
+void QUaModbusHistoryStore::closeSegment(Client * client)
+{
+	if (!client->writer)
+	{
+		return;
+	}
+	auto segment = client->segments.last();
+	// NOTE : if it fails the segment is recovered on next open
+	auto footerSize = QUaModbusHistoryStore::sealSegment(segment, *client->writer);
+	client->writer->close();
+	delete client->writer;
+	client->writer = nullptr;
+	client->dirty  = false;
+	QMutexLocker locker(&m_mutex);
+	segment->sealed = true;
+	if (footerSize > 0)
+	{
+		segment->size += static_cast<quint64>(footerSize);
+		m_sizeUsed    += static_cast<quint64>(footerSize);
+	}
+}
+
+void QUaModbusHistoryStore::sync()
+{
+	auto now = QDateTime::currentMSecsSinceEpoch();
+	QList<Client*> listClients;
+	{
+		// NOTE : clients are added in the ua server thread
+		QMutexLocker locker(&m_mutex);
+		listClients = m_clients.values();
+	}
+	for (auto client : listClients)
+	{
+		if (!client->writer)
+		{
+			continue;
+		}
+		// idle segments are sealed too, so they become subject to retention
+		if (now - client->segments.last()->created >= QUaModbusHistoryStore::m_segmentPeriod)
+		{
+			this->closeSegment(client);
+			continue;
+		}
+		if (client->dirty)
+		{
+			syncFile(*client->writer);
+			client->dirty = false;
+		}
+	}
+	this->applyRetention();
+}
+
+void QUaModbusHistoryStore::applyRetention()
+{
+	QMutexLocker locker(&m_mutex);
+	if (m_retentionAge > 0)
+	{
+		auto oldest = QDateTime::currentMSecsSinceEpoch() - m_retentionAge;
+		for (auto client : m_clients)
+		{
+			auto segments = client->segments;
+			for (auto segment : segments)
+			{
+				if (segment->sealed && segment->lastTime < oldest)
+				{
+					this->removeSegment(client, segment);
+				}
+			}
+		}
+	}
+	while (m_retentionSize > 0 && m_sizeUsed > m_retentionSize)
+	{
+		Client  * clientOldest  = nullptr;
+		Segment * segmentOldest = nullptr;
+		for (auto client : m_clients)
+		{
+			for (auto segment : client->segments)
+			{
+				if (segment->sealed && (!segmentOldest || segment->lastTime < segmentOldest->lastTime))
+				{
+					clientOldest  = client;
+					segmentOldest = segment;
+				}
+			}
+		}
+		if (!segmentOldest)
+		{
+			break;
+		}
+		this->removeSegment(clientOldest, segmentOldest);
+	}
+}
+
+qint64 QUaModbusHistoryStore::sealSegment(const Segment * segment, QFile & file)
+{
+	QByteArray byteFooter;
+	QDataStream stream(&byteFooter, QIODevice::WriteOnly);
+	stream.setByteOrder(QDataStream::LittleEndian);
+	stream << static_cast<quint32>(segment->index.count());
+	for (auto it = segment->index.begin(); it != segment->index.end(); ++it)
+	{
+		auto byteKey = it.key().toUtf8();
+		stream << static_cast<quint32>(byteKey.size());
+		stream.writeRawData(byteKey.constData(), byteKey.size());
+		stream << static_cast<quint32>(it.value().count());
+		for (auto &entry : it.value())
+		{
+			stream << entry.firstTime << entry.lastTime << entry.offset << entry.size;
+		}
+	}
+	// trailer, fixed size at the end of the file
+	stream << segment->size << segment->firstTime << segment->lastTime << m_trailerMagic << m_version;
+	if (!file.seek(static_cast<qint64>(segment->size)) ||
+		file.write(byteFooter) != byteFooter.size() ||
+		!file.flush())
+	{
+		return -1;
+	}
+	syncFile(file);
+	return byteFooter.size();
+}
+
+bool QUaModbusHistoryStore::loadSegment(Client * client, const QString & strFileName, QQueue<QUaLog> & errorLogs)
+{
+	QFile file(strFileName);
+	auto size = file.size();
+	auto data = file.open(QIODevice::ReadWrite) && size > 0 ? file.map(0, size) : nullptr;
+	auto chars = reinterpret_cast<const char*>(data);
+	if (!data || size < 8 ||
+		qFromLittleEndian<quint32>(chars    ) != m_magic ||
+		qFromLittleEndian<quint32>(chars + 4) != m_version)
+	{
+		errorLogs << QUaLog(
+			tr("History segment %1 cannot be read or has an unknown format or version. Skipping.").arg(strFileName),
+			QUaLogLevel::Warning,
+			QUaLogCategory::History
+		);
+		return false;
+	}
+	bool bOK;
+	auto segment = new Segment;
+	segment->strFileName = strFileName;
+	segment->created     = QFileInfo(strFileName).baseName().toLongLong(&bOK);
+	segment->created     = bOK ? segment->created : QFileInfo(strFileName).lastModified().toMSecsSinceEpoch();
+	segment->firstTime   = std::numeric_limits<qint64>::max();
+	segment->lastTime    = std::numeric_limits<qint64>::min();
+	segment->size        = static_cast<quint64>(size);
+	segment->sealed      = true;
+	segment->indexed     = false;
+	segment->reader      = nullptr;
+	segment->map         = nullptr;
+	segment->mapSize     = 0;
+	segment->lastUsed    = 0;
+	// sealed, the trailer is enough until a query needs the segment
+	if (size >= 8 + m_trailerSize)
+	{
+		auto trailer = chars + size - m_trailerSize;
+		auto footerOffset = qFromLittleEndian<quint64>(trailer);
+		if (qFromLittleEndian<quint32>(trailer + 24) == m_trailerMagic &&
+			qFromLittleEndian<quint32>(trailer + 28) == m_version &&
+			footerOffset >= 8 && footerOffset <= static_cast<quint64>(size - m_trailerSize))
+		{
+			segment->firstTime = qFromLittleEndian<qint64>(trailer + 8 );
+			segment->lastTime  = qFromLittleEndian<qint64>(trailer + 16);
+			file.unmap(data);
+			QMutexLocker locker(&m_mutex);
+			client->segments << segment;
+			m_sizeUsed += segment->size;
+			return true;
+		}
+	}
+	// NOTE : not sealed (e.g. after a crash), complete records are kept
+	auto validSize = QUaModbusHistoryStore::scanSegment(segment, chars, static_cast<quint64>(size));
+	file.unmap(data);
+	if (segment->index.isEmpty())
+	{
+		file.remove();
+		delete segment;
+		return true;
+	}
+	segment->size = validSize;
+	qint64 footerSize = -1;
+	if (file.resize(static_cast<qint64>(validSize)))
+	{
+		footerSize = QUaModbusHistoryStore::sealSegment(segment, file);
+	}
+	if (footerSize < 0)
+	{
+		errorLogs << QUaLog(
+			tr("History segment %1 was not closed and cannot be recovered. %2. Skipping.").arg(strFileName).arg(file.errorString()),
+			QUaLogLevel::Warning,
+			QUaLogCategory::History
+		);
+		delete segment;
+		return false;
+	}
+	errorLogs << QUaLog(
+		tr("History segment %1 was not closed, recovered up to its last complete chunk, %2 bytes dropped.").arg(strFileName).arg(static_cast<quint64>(size) - validSize),
+		QUaLogLevel::Warning,
+		QUaLogCategory::History
+	);
+	segment->size += static_cast<quint64>(footerSize);
+	QMutexLocker locker(&m_mutex);
+	client->segments << segment;
+	m_sizeUsed += segment->size;
+	return true;
+}
+
+quint64 QUaModbusHistoryStore::scanSegment(Segment * segment, const char * data, const quint64 & size)
+{
+	quint64 offset = 8;
+	while (offset < size)
+	{
+		QString strKey;
+		QUaModbusHistoryChunk chunk;
+		quint32 recordSize;
+		if (!QUaModbusHistoryStore::parseRecord(data + offset, size - offset, strKey, chunk, recordSize))
+		{
+			break;
+		}
+		segment->index[strKey] << Entry({ chunk.firstTime, chunk.lastTime, offset, recordSize });
+		segment->firstTime = qMin(segment->firstTime, chunk.firstTime);
+		segment->lastTime  = qMax(segment->lastTime , chunk.lastTime );
+		offset += recordSize;
+	}
+	segment->indexed = true;
+	return offset;
+}
+
+bool QUaModbusHistoryStore::ensureMapped(Segment * segment, const quint64 & size)
+{
+	if (segment->map && segment->mapSize >= size)
+	{
+		return true;
+	}
+	if (!segment->reader)
+	{
+		segment->reader = new QFile(segment->strFileName);
+		if (!segment->reader->open(QIODevice::ReadOnly))
+		{
+			delete segment->reader;
+			segment->reader = nullptr;
+			return false;
+		}
+	}
+	if (segment->map)
+	{
+		segment->reader->unmap(segment->map);
+		segment->map = nullptr;
+	}
+	// NOTE : the segment being written is mapped up to what was written so far
+	segment->mapSize = segment->size;
+	if (segment->mapSize < size)
+	{
+		return false;
+	}
+	segment->map = segment->reader->map(0, static_cast<qint64>(segment->mapSize));
+	return segment->map != nullptr;
+}
+
+bool QUaModbusHistoryStore::ensureIndexed(Segment * segment)
+{
+	if (segment->indexed)
+	{
+		return true;
+	}
+	if (segment->size < 8 + m_trailerSize || !this->ensureMapped(segment, segment->size))
+	{
+		return false;
+	}
+	auto chars   = reinterpret_cast<const char*>(segment->map);
+	auto trailer = chars + segment->size - m_trailerSize;
+	auto footerOffset = qFromLittleEndian<quint64>(trailer);
+	// NOTE : a segment that failed to seal has no footer
+	if (qFromLittleEndian<quint32>(trailer + 24) != m_trailerMagic ||
+		footerOffset < 8 || footerOffset > segment->size - m_trailerSize)
+	{
+		return false;
+	}
+	QDataStream stream(QByteArray::fromRawData(chars + footerOffset, static_cast<int>(segment->size - m_trailerSize - footerOffset)));
+	stream.setByteOrder(QDataStream::LittleEndian);
+	quint32 keyCount = 0;
+	stream >> keyCount;
+	for (quint32 k = 0; k < keyCount && stream.status() == QDataStream::Ok; k++)
+	{
+		quint32 keySize = 0;
+		stream >> keySize;
+		if (keySize > segment->size)
+		{
+			break;
+		}
+		QByteArray byteKey(static_cast<int>(keySize), Qt::Uninitialized);
+		stream.readRawData(byteKey.data(), byteKey.size());
+		quint32 entryCount = 0;
+		stream >> entryCount;
+		QVector<Entry> entries;
+		for (quint32 e = 0; e < entryCount && stream.status() == QDataStream::Ok; e++)
+		{
+			Entry entry;
+			stream >> entry.firstTime >> entry.lastTime >> entry.offset >> entry.size;
+			entries << entry;
+		}
+		segment->index.insert(QString::fromUtf8(byteKey), entries);
+	}
+	if (stream.status() != QDataStream::Ok)
+	{
+		segment->index.clear();
+		return false;
+	}
+	segment->indexed = true;
+	return true;
+}
+
+bool QUaModbusHistoryStore::readRecord(Segment * segment, const Entry & entry, QUaModbusHistoryChunk & chunk)
+{
+	if (!this->ensureMapped(segment, entry.offset + entry.size))
+	{
+		return false;
+	}
+	QString strKey;
+	quint32 size;
+	return QUaModbusHistoryStore::parseRecord(reinterpret_cast<const char*>(segment->map) + entry.offset, entry.size, strKey, chunk, size);
+}
+
+void QUaModbusHistoryStore::releaseSegment(Segment * segment)
+{
+	if (segment->reader)
+	{
+		if (segment->map)
+		{
+			segment->reader->unmap(segment->map);
+		}
+		delete segment->reader;
+	}
+	segment->reader  = nullptr;
+	segment->map     = nullptr;
+	segment->mapSize = 0;
+	// NOTE : the segment being written keeps its index, it is not on disk yet
+	if (segment->sealed)
+	{
+		segment->index.clear();
+		segment->indexed = false;
+	}
+}
+
+void QUaModbusHistoryStore::releaseUnused()
+{
+	QList<Segment*> listOpen;
+	for (auto client : m_clients)
+	{
+		for (auto segment : client->segments)
+		{
+			if (segment->sealed && (segment->map || segment->indexed))
+			{
+				listOpen << segment;
+			}
+		}
+	}
+	if (listOpen.count() <= QUaModbusHistoryStore::m_openSegments)
+	{
+		return;
+	}
+	std::sort(listOpen.begin(), listOpen.end(), [](const Segment * segment, const Segment * other) {
+		return segment->lastUsed < other->lastUsed;
+	});
+	for (int i = 0; i < listOpen.count() - QUaModbusHistoryStore::m_openSegments; i++)
+	{
+		this->releaseSegment(listOpen.at(i));
+	}
+}
+
+void QUaModbusHistoryStore::removeSegment(Client * client, Segment * segment)
+{
+	this->releaseSegment(segment);
+	QFile::remove(segment->strFileName);
+	client->segments.removeOne(segment);
+	m_sizeUsed -= segment->size;
+	delete segment;
+}
+
+QByteArray QUaModbusHistoryStore::serializeRecord(const QString & strKey, const QUaModbusHistoryChunk & chunk)
+{
+	QByteArray byteRecord;
+	QDataStream stream(&byteRecord, QIODevice::WriteOnly);
+	stream.setByteOrder(QDataStream::LittleEndian);
+	auto byteKey = strKey.toUtf8();
+	// size is set once known
+	stream << m_recordMagic << static_cast<quint32>(0) << static_cast<quint32>(byteKey.size());
+	stream.writeRawData(byteKey.constData(), byteKey.size());
+	stream << static_cast<qint32>(chunk.metaType) << static_cast<quint32>(chunk.isArray ? 1 : 0);
+	stream << chunk.firstTime << chunk.lastTime << chunk.count << chunk.bitCount;
+	stream << static_cast<quint32>(chunk.words.count());
+	for (auto &word : chunk.words)
+	{
+		stream << word;
+	}
+	// NOTE : size includes the crc, written last so a torn record is detected
+	qToLittleEndian<quint32>(static_cast<quint32>(byteRecord.size() + 4), byteRecord.data() + 4);
+	stream << static_cast<quint32>(qChecksum(byteRecord.constData(), static_cast<uint>(byteRecord.size())));
+	return byteRecord;
+}
+
+bool QUaModbusHistoryStore::parseRecord(const char * data, const quint64 & available, QString & strKey, QUaModbusHistoryChunk & chunk, quint32 & size)
+{
+	if (available < 12 || qFromLittleEndian<quint32>(data) != m_recordMagic)
+	{
+		return false;
+	}
+	size = qFromLittleEndian<quint32>(data + 4);
+	if (size < 12 || size > available ||
+		qFromLittleEndian<quint32>(data + size - 4) != qChecksum(data, size - 4))
+	{
+		return false;
+	}
+	QDataStream stream(QByteArray::fromRawData(data + 8, static_cast<int>(size - 12)));
+	stream.setByteOrder(QDataStream::LittleEndian);
+	quint32 keySize = 0;
+	stream >> keySize;
+	if (keySize > size)
+	{
+		return false;
+	}
+	QByteArray byteKey(static_cast<int>(keySize), Qt::Uninitialized);
+	stream.readRawData(byteKey.data(), byteKey.size());
+	qint32  metaType  = 0;
+	quint32 isArray   = 0;
+	quint32 wordCount = 0;
+	stream >> metaType >> isArray >> chunk.firstTime >> chunk.lastTime >> chunk.count >> chunk.bitCount >> wordCount;
+	if (stream.status() != QDataStream::Ok || wordCount > size / sizeof(quint64))
+	{
+		return false;
+	}
+	chunk.words.resize(static_cast<int>(wordCount));
+	for (auto &word : chunk.words)
+	{
+		stream >> word;
+	}
+	if (stream.status() != QDataStream::Ok)
+	{
+		return false;
+	}
+	strKey         = QString::fromUtf8(byteKey);
+	chunk.metaType = metaType;
+	chunk.isArray  = isArray != 0;
+	return true;
+}
+
+#endif // UA_ENABLE_HISTORIZING
@@ -0,0 +1,165 @@
+#ifndef QUAMODBUSHISTORYSTORE_H
+#define QUAMODBUSHISTORYSTORE_H
+
+#include <QUaServer>
+
+#ifdef UA_ENABLE_HISTORIZING
+
+#include <QCoreApplication>
+#include <QMutex>
+#include <QFile>
+#include <QHash>
+#include <QVector>
+#include <functional>
+
+#include <QLambdaThreadWorker>
+
+// encoded points of one node, see QUaModbusHistorian
+struct QUaModbusHistoryChunk
+{
+	bool             isArray;
+	int              metaType;
+	qint64           firstTime;
+	qint64           lastTime;
+	quint32          count;
+	quint64          bitCount;
+	QVector<quint64> words;
+};
+
+// Append only on-disk store of the chunks of QUaModbusHistorian, for retention beyond memory.
+// Each client has a directory of segment files, written by a worker thread one after the other,
+// a segment is sealed once it reaches m_segmentSize bytes or is m_segmentPeriod old :
+//   Header | Record[] | Footer | Trailer
+// Records are the chunks as appended (key, time range, encoded words, crc16). The footer indexes
+// the records of each key by time range and the trailer has the time range of the segment, so
+// opening a store only reads trailers and queries only map and index the segments they overlap.
+// Writes are flushed to the OS right away (readers see them) and fsync'ed every m_syncPeriod.
+// A segment left unsealed by a crash is recovered on open, up to its last complete record.
+// Retention deletes whole sealed segments, by age of their last point and by total size.
+// NOTE : append and reads in the ua server thread, all file writes in the worker thread
+class QUaModbusHistoryStore
+{
+	Q_DECLARE_TR_FUNCTIONS(QUaModbusHistoryStore)
+
+public:
+	// return false to stop visiting
+	typedef std::function<bool(const QUaModbusHistoryChunk &chunk)> Visitor;
+
+	explicit QUaModbusHistoryStore(const QString &strDirPath);
+	// NOTE : waits for the queued writes and seals the segments being written
+	~QUaModbusHistoryStore();
+
+	QString dirPath() const;
+
+	// synchronous, loads the segments found in the directory, false if it cannot be used
+	bool open(QQueue<QUaLog> &errorLogs);
+
+	// asynchronous, the chunk of the node is written in the worker thread
+	void append(const QString &strKey, const QUaModbusHistoryChunk &chunk);
+	// visits the chunks of the node overlapping [timeStart, timeEnd] in time order, or newest
+	// first if reverse, including the ones appended but not written yet
+	void forEachChunk(const QString &strKey, const qint64 &timeStart, const qint64 &timeEnd, const Visitor &visitor, const bool &reverse = false);
+
+	// in milliseconds, sealed segments whose last point is older are deleted, zero is no limit
+	qint64  retentionAge() const;
+	void    setRetentionAge(const qint64 &retentionAge);
+	// in bytes, oldest sealed segments are deleted beyond it, zero is no limit
+	quint64 retentionSize() const;
+	void    setRetentionSize(const quint64 &retentionSize);
+	// in bytes, all segments
+	quint64 sizeUsed() const;
+
+	static qint64 m_segmentSize;
+	static qint64 m_segmentPeriod;
+	static int    m_syncPeriod;
+	// sealed segments kept mapped and indexed after a query
+	static int    m_openSegments;
+
+	static const quint32 m_magic   = 0x534D5551; // "QUMS"
+	static const quint32 m_version = 1;
+
+private:
+	static const quint32 m_recordMagic  = 0x524D5551; // "QUMR"
+	static const quint32 m_trailerMagic = 0x464D5551; // "QUMF"
+	static const int     m_trailerSize  = 32;
+
+	struct Entry
+	{
+		qint64  firstTime;
+		qint64  lastTime;
+		quint64 offset;
+		quint32 size;
+	};
+	struct Segment
+	{
+		QString  strFileName;
+		qint64   created;
+		qint64   firstTime;
+		qint64   lastTime;
+		quint64  size;
+		bool     sealed;
+		// records of each key, always loaded for the segment being written
+		bool     indexed;
+		QHash<QString, QVector<Entry>> index;
+		// read access, remapped when the segment grew past mapSize
+		QFile  * reader;
+		uchar  * map;
+		quint64  mapSize;
+		quint64  lastUsed;
+	};
+	struct Client
+	{
+		QString          strDirPath;
+		// in creation order, the last one is written if not sealed
+		QList<Segment*>  segments;
+		// NOTE : only accessed in worker thread
+		QFile          * writer;
+		bool             dirty;
+	};
+
+	QString             m_strDirPath;
+	QLambdaThreadWorker m_worker;
+	int                 m_syncLoop;
+	// NOTE : guards all below, the worker only locks to publish what it wrote
+	mutable QMutex                                  m_mutex;
+	QHash<QString, Client*>                         m_clients;
+	QHash<QString, QVector<QUaModbusHistoryChunk>>  m_queued;
+	qint64                                          m_retentionAge;
+	quint64                                         m_retentionSize;
+	quint64                                         m_sizeUsed;
+	quint64                                         m_useCounter;
+
+	// client of a node id, "ns=0;s=modbus.<client>.<block>..."
+	static QString clientName(const QString &strKey);
+	Client * client(const QString &strName);
+
+	// worker thread
+	void writeChunk(const QString &strKey, const QUaModbusHistoryChunk &chunk);
+	bool startSegment(Client * client);
+	void closeSegment(Client * client);
+	void sync();
+	void applyRetention();
+	// appends footer and trailer, returns their size or -1. Also used when recovering on open
+	static qint64 sealSegment(const Segment * segment, QFile &file);
+
+	// open
+	bool loadSegment(Client * client, const QString &strFileName, QQueue<QUaLog> &errorLogs);
+	// rebuilds the index of an unsealed segment, returns the size of its complete records
+	static quint64 scanSegment(Segment * segment, const char * data, const quint64 &size);
+
+	// reads, with m_mutex locked
+	bool ensureMapped (Segment * segment, const quint64 &size);
+	bool ensureIndexed(Segment * segment);
+	bool readRecord   (Segment * segment, const Entry &entry, QUaModbusHistoryChunk &chunk);
+	void releaseSegment(Segment * segment);
+	void releaseUnused();
+	void removeSegment(Client * client, Segment * segment);
+
+	static QByteArray serializeRecord(const QString &strKey, const QUaModbusHistoryChunk &chunk);
+	// false if data is not a complete record, size is set to the size of the record
+	static bool       parseRecord(const char * data, const quint64 &available, QString &strKey, QUaModbusHistoryChunk &chunk, quint32 &size);
+};
+
+#endif // UA_ENABLE_HISTORIZING
+
+#endif // QUAMODBUSHISTORYSTORE_H
@@ -0,0 +1,92 @@
+#include "quamodbushostcache.h"
+
+#include <QAbstractSocket>
+
+int QUaModbusHostCache::m_ttl = 300000;
+
+QUaModbusHostCache * QUaModbusHostCache::instance()
+{
+	static QUaModbusHostCache * cache = new QUaModbusHostCache;
+	return cache;
+}
+
+QUaModbusHostCache::QUaModbusHostCache()
+	: QObject(nullptr)
+{
+	m_clock.start();
+}
+
+void QUaModbusHostCache::lookup(const QString & strHost, QObject * context, const Callback & callback)
+{
+	// nothing to resolve
+	QHostAddress address;
+	if (address.setAddress(strHost))
+	{
+		callback(address);
+		return;
+	}
+	// NOTE : host names are case insensitive
+	auto strKey = strHost.trimmed().toLower();
+	if (strKey.isEmpty())
+	{
+		callback(QHostAddress());
+		return;
+	}
+	auto entry = m_entries.find(strKey);
+	if (entry != m_entries.end())
+	{
+		if (m_clock.elapsed() - entry.value().resolved < QUaModbusHostCache::m_ttl)
+		{
+			callback(entry.value().address);
+			return;
+		}
+		m_entries.erase(entry);
+	}
+	// wait for running lookup if any
+	bool running = m_pending.contains(strKey);
+	m_pending[strKey] << Pending({ QPointer<QObject>(context), callback });
+	if (running)
+	{
+		return;
+	}
+	int lookupId = QHostInfo::lookupHost(strKey, this, SLOT(on_lookedUp(QHostInfo)));
+	m_lookups.insert(lookupId, strKey);
+}
+
+void QUaModbusHostCache::clear()
+{
+	m_entries.clear();
+}
+
+void QUaModbusHostCache::on_lookedUp(const QHostInfo & hostInfo)
+{
+	auto strKey = m_lookups.take(hostInfo.lookupId());
+	auto listPending = m_pending.take(strKey);
+	// prefer IPv4, most Modbus devices do not support IPv6
+	QHostAddress address;
+	for (auto &hostAddress : hostInfo.addresses())
+	{
+		if (hostAddress.protocol() == QAbstractSocket::IPv4Protocol)
+		{
+			address = hostAddress;
+			break;
+		}
+		if (address.isNull())
+		{
+			address = hostAddress;
+		}
+	}
+	// NOTE : failures are not cached, next connection attempt tries again
+	if (hostInfo.error() == QHostInfo::NoError && !address.isNull())
+	{
+		m_entries.insert(strKey, { address, m_clock.elapsed() });
+	}
+	for (auto &pending : listPending)
+	{
+		if (!pending.context)
+		{
+			continue;
+		}
+		pending.callback(address);
+	}
+}
@@ -0,0 +1,57 @@
+#ifndef QUAMODBUSHOSTCACHE_H
+#define QUAMODBUSHOSTCACHE_H
+
+#include <QObject>
+#include <QPointer>
+#include <QHostAddress>
+#include <QHostInfo>
+#include <QElapsedTimer>
+#include <QHash>
+#include <functional>
+
+// Process wide cache of the addresses of the host names used as NetworkAddress, so a config with
+// many clients on the same host (e.g. a gateway) resolves it once per m_ttl, asynchronously.
+// Lookups of a host already being resolved wait for the running one instead of starting another.
+// NOTE : only use in the ua server thread, where the clients are connected
+class QUaModbusHostCache : public QObject
+{
+	Q_OBJECT
+
+public:
+	typedef std::function<void(const QHostAddress &address)> Callback;
+
+	// NOTE : created on first use, never deleted
+	static QUaModbusHostCache * instance();
+
+	// calls back with the address of the host, or a null address if it cannot be resolved.
+	// literal IP addresses and cached hosts call back before returning, else once resolved
+	// unless context is deleted in between
+	void lookup(const QString &strHost, QObject * context, const Callback &callback);
+	// drops cached addresses, e.g. after the network changed
+	void clear();
+
+	static int m_ttl;
+
+private slots:
+	void on_lookedUp(const QHostInfo &hostInfo);
+
+private:
+	explicit QUaModbusHostCache();
+
+	struct Entry
+	{
+		QHostAddress address;
+		qint64       resolved;
+	};
+	struct Pending
+	{
+		QPointer<QObject> context;
+		Callback          callback;
+	};
+	QElapsedTimer                   m_clock;
+	QHash<QString, Entry>           m_entries;
+	QHash<QString, QList<Pending>>  m_pending;
+	QHash<int, QString>             m_lookups;
+};
+
+#endif // QUAMODBUSHOSTCACHE_H
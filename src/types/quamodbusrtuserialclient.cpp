@@ -1,6 +1,6 @@
 #include "quamodbusrtuserialclient.h"
 
-#include <QSerialPortInfo>
+#include "quamodbusserialportregistry.h"
 
 #ifdef QUA_ACCESS_CONTROL
 #include <QUaPermissions>
@@ -80,24 +80,13 @@ QString QUaModbusRtuSerialClient::ComPorts = "QUaModbusRtuSerialClient::ComPorts
 
 QUaEnumMap QUaModbusRtuSerialClient::EnumComPorts()
 {
-	QUaEnumMap mapPorts;
-	QList<QSerialPortInfo> list = QSerialPortInfo::availablePorts();
-	for (int i = 0; i < list.count(); i++)
-	{
-		QSerialPortInfo portInfo = list.at(i);
-		mapPorts.insert(i, 
-			{ 
-				{ "", portInfo.portName().toUtf8() },
-				{ "", "" }
-			}
-		);
-	}
-	return mapPorts;
+	// NOTE : cached, no system scan
+	return QUaModbusSerialPortRegistry::instance()->ports();
 }
 
 void QUaModbusRtuSerialClient::resetModbusClient()
 {
-	m_workerThread.execInThread([this]() {
+	this->execInThread([this]() {
 		// instantiate in thread so it runs on the thread
 		m_modbusClient.reset(new QModbusRtuSerialMaster(nullptr), [](QObject* client) {
 			client->deleteLater();
@@ -129,11 +118,15 @@ QDomElement QUaModbusRtuSerialClient::toDomElement(QDomDocument & domDoc) const
 	elemSerialClient.setAttribute("BrowseName"    , this->browseName()  );
 	elemSerialClient.setAttribute("ServerAddress" , getServerAddress()  );
 	elemSerialClient.setAttribute("KeepConnecting", getKeepConnecting() );
-	elemSerialClient.setAttribute("ComPort"       , QString(QUaModbusRtuSerialClient::EnumComPorts().value(getComPortKey()).displayName.text()));
+	elemSerialClient.setAttribute("ComPort"       , QUaModbusSerialPortRegistry::instance()->portName(getComPortKey()));
 	elemSerialClient.setAttribute("Parity"        , QMetaEnum::fromType<QParity>  ().valueToKey(getParity()   ));
 	elemSerialClient.setAttribute("BaudRate"      , QMetaEnum::fromType<QBaudRate>().valueToKey(getBaudRate() ));
 	elemSerialClient.setAttribute("DataBits"      , QMetaEnum::fromType<QDataBits>().valueToKey(getDataBits() ));
 	elemSerialClient.setAttribute("StopBits"      , QMetaEnum::fromType<QStopBits>().valueToKey(getStopBits() ));
+	elemSerialClient.setAttribute("Timeout"        , getTimeout        ());
+	elemSerialClient.setAttribute("NumberOfRetries", getNumberOfRetries());
+	elemSerialClient.setAttribute("AdaptiveTimeout", getAdaptiveTimeout());
+	elemSerialClient.setAttribute("DiagnosticsEnabled", getDiagnosticsEnabled());
 	// add block list element
 	auto elemBlockList = const_cast<QUaModbusRtuSerialClient*>(this)->dataBlocks()->toDomElement(domDoc);
 	elemSerialClient.appendChild(elemBlockList);
@@ -194,11 +187,7 @@ void QUaModbusRtuSerialClient::fromDomElement(QDomElement & domElem, QQueue<QUaL
 	auto comPort = domElem.attribute("ComPort");
 	if (!comPort.isEmpty())
 	{
-		this->setComPortKey(QUaModbusRtuSerialClient::EnumComPorts().key(
-			{ 
-				{ "", comPort.toUtf8() },
-				{ "", "" }
-			}, 0));
+		this->setComPortKey(QUaModbusSerialPortRegistry::instance()->portKey(comPort));
 	}
 	else
 	{
@@ -268,6 +257,74 @@ void QUaModbusRtuSerialClient::fromDomElement(QDomElement & domElem, QQueue<QUaL
 			QUaLogCategory::Serialization
 		);
 	}
+	// Timeout (optional)
+	if (domElem.hasAttribute("Timeout"))
+	{
+		auto timeout = domElem.attribute("Timeout").toUInt(&bOK);
+		if (bOK)
+		{
+			this->setTimeout(timeout);
+		}
+		else
+		{
+			errorLogs << QUaLog(
+				tr("Invalid Timeout attribute '%1' in Modbus client %2. Default value set.").arg(domElem.attribute("Timeout")).arg(strBrowseName),
+				QUaLogLevel::Warning,
+				QUaLogCategory::Serialization
+			);
+		}
+	}
+	// NumberOfRetries (optional)
+	if (domElem.hasAttribute("NumberOfRetries"))
+	{
+		auto numberOfRetries = domElem.attribute("NumberOfRetries").toUInt(&bOK);
+		if (bOK)
+		{
+			this->setNumberOfRetries(numberOfRetries);
+		}
+		else
+		{
+			errorLogs << QUaLog(
+				tr("Invalid NumberOfRetries attribute '%1' in Modbus client %2. Default value set.").arg(domElem.attribute("NumberOfRetries")).arg(strBrowseName),
+				QUaLogLevel::Warning,
+				QUaLogCategory::Serialization
+			);
+		}
+	}
+	// AdaptiveTimeout (optional)
+	if (domElem.hasAttribute("AdaptiveTimeout"))
+	{
+		auto adaptiveTimeout = (bool)domElem.attribute("AdaptiveTimeout").toUInt(&bOK);
+		if (bOK)
+		{
+			this->setAdaptiveTimeout(adaptiveTimeout);
+		}
+		else
+		{
+			errorLogs << QUaLog(
+				tr("Invalid AdaptiveTimeout attribute '%1' in Modbus client %2. Default value set.").arg(domElem.attribute("AdaptiveTimeout")).arg(strBrowseName),
+				QUaLogLevel::Warning,
+				QUaLogCategory::Serialization
+			);
+		}
+	}
+	// DiagnosticsEnabled (optional)
+	if (domElem.hasAttribute("DiagnosticsEnabled"))
+	{
+		auto diagnosticsEnabled = (bool)domElem.attribute("DiagnosticsEnabled").toUInt(&bOK);
+		if (bOK)
+		{
+			this->setDiagnosticsEnabled(diagnosticsEnabled);
+		}
+		else
+		{
+			errorLogs << QUaLog(
+				tr("Invalid DiagnosticsEnabled attribute '%1' in Modbus client %2. Default value set.").arg(domElem.attribute("DiagnosticsEnabled")).arg(strBrowseName),
+				QUaLogLevel::Warning,
+				QUaLogCategory::Serialization
+			);
+		}
+	}
 	// get block list
 	QDomElement elemBlockList = domElem.firstChildElement(QUaModbusDataBlockList::staticMetaObject.className());
 	if (!elemBlockList.isNull())
@@ -308,9 +365,9 @@ void QUaModbusRtuSerialClient::on_stateChanged(const QModbusDevice::State &state
 void QUaModbusRtuSerialClient::on_comPortChanged(const QVariant & value)
 {
 	// NOTE : if connected, will not change until reconnect
-	QString strComPort = QUaModbusRtuSerialClient::EnumComPorts().value(value.toInt()).displayName.text();
+	QString strComPort = QUaModbusSerialPortRegistry::instance()->portName(value.toInt());
 	// set in thread, for thread-safety
-	m_workerThread.execInThread([this, strComPort]() {
+	this->execInThread([this, strComPort]() {
 		m_modbusClient->setConnectionParameter(QModbusDevice::SerialPortNameParameter, strComPort);
 	});
 	// emit
@@ -322,7 +379,7 @@ void QUaModbusRtuSerialClient::on_parityChanged(const QVariant & value)
 	// NOTE : if connected, will not change until reconnect
 	QParity parity = value.value<QParity>();
 	// set in thread, for thread-safety
-	m_workerThread.execInThread([this, parity]() {
+	this->execInThread([this, parity]() {
 		m_modbusClient->setConnectionParameter(QModbusDevice::SerialParityParameter, parity);
 	});
 	// emit
@@ -334,7 +391,7 @@ void QUaModbusRtuSerialClient::on_baudRateChanged(const QVariant & value)
 	// NOTE : if connected, will not change until reconnect
 	QBaudRate baudRate = value.value<QBaudRate>();
 	// set in thread, for thread-safety
-	m_workerThread.execInThread([this, baudRate]() {
+	this->execInThread([this, baudRate]() {
 		m_modbusClient->setConnectionParameter(QModbusDevice::SerialBaudRateParameter, baudRate);
 	});
 	// emit
@@ -346,7 +403,7 @@ void QUaModbusRtuSerialClient::on_dataBitsChanged(const QVariant & value)
 	// NOTE : if connected, will not change until reconnect
 	QDataBits dataBits = value.value<QDataBits>();
 	// set in thread, for thread-safety
-	m_workerThread.execInThread([this, dataBits]() {
+	this->execInThread([this, dataBits]() {
 		m_modbusClient->setConnectionParameter(QModbusDevice::SerialDataBitsParameter, dataBits);
 	});
 	// emit
@@ -358,7 +415,7 @@ void QUaModbusRtuSerialClient::on_stopBitsChanged(const QVariant & value)
 	// NOTE : if connected, will not change until reconnect
 	QStopBits stopBits = value.value<QStopBits>();
 	// set in thread, for thread-safety
-	m_workerThread.execInThread([this, stopBits]() {
+	this->execInThread([this, stopBits]() {
 		m_modbusClient->setConnectionParameter(QModbusDevice::SerialStopBitsParameter, stopBits);
 	});
 	// emit
@@ -369,17 +426,13 @@ QString QUaModbusRtuSerialClient::getComPort() const
 {
 	QMutexLocker locker(&(const_cast<QUaModbusRtuSerialClient*>(this)->m_mutex));
 	auto key = this->comPort()->value().toInt();
-	return QUaModbusRtuSerialClient::EnumComPorts().value(key).displayName.text();
+	return QUaModbusSerialPortRegistry::instance()->portName(key);
 }
 
 void QUaModbusRtuSerialClient::setComPort(const QString & strComPort)
 {
 	QMutexLocker locker(&m_mutex);
-	auto comPort = QUaModbusRtuSerialClient::EnumComPorts().key(
-		{ 
-			{ "", strComPort.toUtf8() },
-			{ "", "" }
-		}, 0);
+	auto comPort = QUaModbusSerialPortRegistry::instance()->portKey(strComPort);
 	this->comPort()->setValue(comPort);
 	this->on_comPortChanged(comPort);
 }
@@ -0,0 +1,124 @@
+#include "quamodbusserialportregistry.h"
+
+#include <QCoreApplication>
+#include <QSerialPortInfo>
+#include <QFileSystemWatcher>
+#include <QTimer>
+#include <QThread>
+
+int QUaModbusSerialPortRegistry::m_refreshDelay = 500;
+int QUaModbusSerialPortRegistry::m_pollPeriod   = 3000;
+
+QUaModbusSerialPortRegistry * QUaModbusSerialPortRegistry::instance()
+{
+	// NOTE : thread safe initialization, first use can be in a client worker thread
+	static QUaModbusSerialPortRegistry * registry = []() {
+		auto newRegistry = new QUaModbusSerialPortRegistry;
+		auto app = QCoreApplication::instance();
+		if (app && newRegistry->thread() != app->thread())
+		{
+			newRegistry->moveToThread(app->thread());
+		}
+		// timers and watcher must be started in the thread they live in
+		QMetaObject::invokeMethod(newRegistry, [newRegistry]() {
+			newRegistry->startWatching();
+		}, Qt::AutoConnection);
+		return newRegistry;
+	}();
+	return registry;
+}
+
+QUaModbusSerialPortRegistry::QUaModbusSerialPortRegistry()
+	: QObject(nullptr)
+{
+	// NOTE : children, so they move to the main thread with the registry
+	m_watcher      = new QFileSystemWatcher(this);
+	m_refreshTimer = new QTimer(this);
+	// initial scan, keys in system order as before the registry existed
+	this->refresh();
+}
+
+void QUaModbusSerialPortRegistry::startWatching()
+{
+	QObject::connect(m_refreshTimer, &QTimer::timeout, this, &QUaModbusSerialPortRegistry::refresh);
+#ifdef Q_OS_UNIX
+	// udev creates and removes device nodes on hotplug, a burst of changes is scanned once
+	m_refreshTimer->setSingleShot(true);
+	m_refreshTimer->setInterval(QUaModbusSerialPortRegistry::m_refreshDelay);
+	QObject::connect(m_watcher, &QFileSystemWatcher::directoryChanged, this, &QUaModbusSerialPortRegistry::on_devicesChanged);
+	m_watcher->addPath("/dev");
+#else
+	// NOTE : no device notifications without a window, poll instead
+	m_refreshTimer->setInterval(QUaModbusSerialPortRegistry::m_pollPeriod);
+	m_refreshTimer->start();
+#endif // Q_OS_UNIX
+}
+
+void QUaModbusSerialPortRegistry::on_devicesChanged()
+{
+	// restart, so it scans once devices settle
+	m_refreshTimer->start();
+}
+
+QUaEnumMap QUaModbusSerialPortRegistry::ports() const
+{
+	QReadLocker locker(&m_lock);
+	return m_ports;
+}
+
+QString QUaModbusSerialPortRegistry::portName(const int & portKey) const
+{
+	QReadLocker locker(&m_lock);
+	return m_ports.value(portKey).displayName.text();
+}
+
+int QUaModbusSerialPortRegistry::portKey(const QString & strPortName, const int & defaultKey/* = 0*/) const
+{
+	QReadLocker locker(&m_lock);
+	return m_keys.value(strPortName, defaultKey);
+}
+
+bool QUaModbusSerialPortRegistry::isAvailable(const int & portKey) const
+{
+	QReadLocker locker(&m_lock);
+	return m_available.contains(portKey);
+}
+
+void QUaModbusSerialPortRegistry::refresh()
+{
+	// NOTE : scan outside the lock, lookups are not blocked by it
+	auto listPorts = QSerialPortInfo::availablePorts();
+	QList<QPair<int, QString>> listAdded;
+	QSet<int> setAvailable;
+	bool changed = false;
+	{
+		QWriteLocker locker(&m_lock);
+		for (auto &portInfo : listPorts)
+		{
+			auto strPortName = portInfo.portName();
+			if (!m_keys.contains(strPortName))
+			{
+				int portKey = m_ports.isEmpty() ? 0 : m_ports.lastKey() + 1;
+				m_keys.insert(strPortName, portKey);
+				m_ports.insert(portKey,
+					{
+						{ "", strPortName.toUtf8() },
+						{ "", "" }
+					}
+				);
+				listAdded << qMakePair(portKey, strPortName);
+			}
+			setAvailable.insert(m_keys.value(strPortName));
+		}
+		changed = setAvailable != m_available;
+		m_available = setAvailable;
+	}
+	for (auto &added : listAdded)
+	{
+		emit this->portAdded(added.first, added.second);
+	}
+	if (changed)
+	{
+		emit this->portsChanged();
+	}
+}
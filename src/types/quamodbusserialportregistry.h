@@ -0,0 +1,61 @@
+#ifndef QUAMODBUSSERIALPORTREGISTRY_H
+#define QUAMODBUSSERIALPORTREGISTRY_H
+
+#include <QObject>
+#include <QReadWriteLock>
+#include <QHash>
+#include <QSet>
+
+#include <QUaServer>
+
+class QTimer;
+class QFileSystemWatcher;
+
+// Process wide cache of the local serial ports, so port keys and names resolve without
+// scanning the system. Shared by the ComPorts enum, import / export and the client widgets.
+// Keys are stable for the lifetime of the process : an unplugged port keeps its key, so clients
+// using it keep their config, and a new port gets the next free key.
+// Rescanned on hotplug, i.e. when device nodes change in /dev (udev) on unix, polled elsewhere.
+class QUaModbusSerialPortRegistry : public QObject
+{
+	Q_OBJECT
+
+public:
+	// NOTE : created on first use and lives in the main thread, never deleted
+	static QUaModbusSerialPortRegistry * instance();
+
+	// thread safe, no system scan
+	QUaEnumMap ports() const;
+	QString    portName(const int &portKey) const;
+	int        portKey (const QString &strPortName, const int &defaultKey = 0) const;
+	// false if unplugged since it was seen
+	bool       isAvailable(const int &portKey) const;
+
+public slots:
+	// scans the system, emits portAdded for new ports and portsChanged if anything changed
+	void refresh();
+
+signals:
+	void portAdded(const int &portKey, const QString &strPortName);
+	void portsChanged();
+
+private slots:
+	void on_devicesChanged();
+
+private:
+	explicit QUaModbusSerialPortRegistry();
+
+	mutable QReadWriteLock m_lock;
+	QUaEnumMap             m_ports;
+	QHash<QString, int>    m_keys;
+	QSet<int>              m_available;
+	QFileSystemWatcher   * m_watcher;
+	QTimer               * m_refreshTimer;
+
+	void startWatching();
+
+	static int m_refreshDelay;
+	static int m_pollPeriod;
+};
+
+#endif // QUAMODBUSSERIALPORTREGISTRY_H
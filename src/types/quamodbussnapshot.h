@@ -0,0 +1,46 @@
+#ifndef QUAMODBUSSNAPSHOT_H
+#define QUAMODBUSSNAPSHOT_H
+
+#include <QAtomicPointer>
+
+#include <QLambdaThreadWorker>
+
+// Immutable configuration copy that is read lock-free in a worker thread
+// and replaced atomically (RCU-style) from the ua server thread.
+// NOTE : only read in the worker thread (or in the writer thread), and do not keep
+//        the pointer across event loop iterations; the replaced copy is deleted by
+//        a task queued in the worker thread, which only runs once readers are done.
+template<typename T>
+class QUaModbusSnapshot
+{
+public:
+	explicit QUaModbusSnapshot(const T &value = T())
+		: m_ptr(new T(value))
+	{
+	}
+
+	~QUaModbusSnapshot()
+	{
+		delete m_ptr.loadAcquire();
+	}
+
+	const T * load() const
+	{
+		return m_ptr.loadAcquire();
+	}
+
+	// NOTE : only call from a single writer thread
+	void store(const T &value, QLambdaThreadWorker &readerThread)
+	{
+		const T * oldPtr = m_ptr.fetchAndStoreOrdered(new T(value));
+		readerThread.execInThread([oldPtr]() {
+			delete oldPtr;
+		});
+	}
+
+private:
+	Q_DISABLE_COPY(QUaModbusSnapshot)
+	QAtomicPointer<const T> m_ptr;
+};
+
+#endif // QUAMODBUSSNAPSHOT_H
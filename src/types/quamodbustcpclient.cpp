@@ -1,9 +1,26 @@
 #include "quamodbustcpclient.h"
 
+#include <QTcpSocket>
+
+#include "quamodbushostcache.h"
+
 #ifdef QUA_ACCESS_CONTROL
 #include <QUaPermissions>
 #endif // QUA_ACCESS_CONTROL
 
+#ifdef Q_OS_WIN
+#include <winsock2.h>
+#include <mstcpip.h>
+#else
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#endif // Q_OS_WIN
+
+int QUaModbusTcpClient::m_keepAliveIdle     = 10;
+int QUaModbusTcpClient::m_keepAliveInterval = 5;
+int QUaModbusTcpClient::m_keepAliveCount    = 3;
+
 QUaModbusTcpClient::QUaModbusTcpClient(QUaServer *server)
 	: QUaModbusClient(server)
 {
@@ -68,7 +85,7 @@ void QUaModbusTcpClient::setNetworkPort(const quint16 & networkPort)
 
 void QUaModbusTcpClient::resetModbusClient()
 {
-    m_workerThread.execInThread([this]() {
+    this->execInThread([this]() {
 		// instantiate in thread so it runs on the thread
 		m_modbusClient.reset(new QModbusTcpClient(nullptr), [](QObject* client) {
 			client->deleteLater();
@@ -79,6 +96,74 @@ void QUaModbusTcpClient::resetModbusClient()
 		// setup client (call base class method)
         this->QUaModbusClient::resetModbusClient();
 		QObject::connect(m_modbusClient.data(), &QModbusClient::stateChanged, this, &QUaModbusTcpClient::on_stateChanged, Qt::QueuedConnection);
+		// enable tcp keep-alive so the os detects dead peers on idle connections
+		auto modbusClient = m_modbusClient.data();
+		QObject::connect(modbusClient, &QModbusClient::stateChanged, modbusClient,
+		[modbusClient](QModbusDevice::State state) {
+			if (state != QModbusDevice::State::ConnectedState)
+			{
+				return;
+			}
+			// NOTE : socket is an internal child of the qt modbus tcp client
+			auto socket = modbusClient->findChild<QTcpSocket*>();
+			if (!socket)
+			{
+				return;
+			}
+			QUaModbusTcpClient::setKeepAlive(socket);
+		});
+	});
+}
+
+void QUaModbusTcpClient::setKeepAlive(QTcpSocket * socket)
+{
+	socket->setSocketOption(QAbstractSocket::KeepAliveOption, 1);
+	auto descriptor = socket->socketDescriptor();
+	if (descriptor == -1)
+	{
+		return;
+	}
+#ifdef Q_OS_WIN
+	// NOTE : windows uses a fixed number of probes
+	struct tcp_keepalive keepAlive;
+	keepAlive.onoff             = 1;
+	keepAlive.keepalivetime     = static_cast<ULONG>(QUaModbusTcpClient::m_keepAliveIdle     * 1000);
+	keepAlive.keepaliveinterval = static_cast<ULONG>(QUaModbusTcpClient::m_keepAliveInterval * 1000);
+	DWORD bytesReturned = 0;
+	WSAIoctl(static_cast<SOCKET>(descriptor), SIO_KEEPALIVE_VALS, &keepAlive, sizeof(keepAlive), nullptr, 0, &bytesReturned, nullptr, nullptr);
+#else
+	int fd = static_cast<int>(descriptor);
+#ifdef Q_OS_MACOS
+	setsockopt(fd, IPPROTO_TCP, TCP_KEEPALIVE , &QUaModbusTcpClient::m_keepAliveIdle    , sizeof(int));
+#else
+	setsockopt(fd, IPPROTO_TCP, TCP_KEEPIDLE  , &QUaModbusTcpClient::m_keepAliveIdle    , sizeof(int));
+#endif // Q_OS_MACOS
+	setsockopt(fd, IPPROTO_TCP, TCP_KEEPINTVL , &QUaModbusTcpClient::m_keepAliveInterval, sizeof(int));
+	setsockopt(fd, IPPROTO_TCP, TCP_KEEPCNT   , &QUaModbusTcpClient::m_keepAliveCount   , sizeof(int));
+#endif // Q_OS_WIN
+}
+
+void QUaModbusTcpClient::startConnect()
+{
+	auto strNetworkAddress = this->getNetworkAddress();
+	auto connectGeneration = m_connectGeneration;
+	QUaModbusHostCache::instance()->lookup(strNetworkAddress, this,
+	[this, strNetworkAddress, connectGeneration](const QHostAddress &address) {
+		// disconnected while resolving
+		if (connectGeneration != m_connectGeneration)
+		{
+			return;
+		}
+		// NOTE : property keeps the host name, only the connection uses the address.
+		//        If not resolved, connect anyway so the socket reports the error
+		if (!address.isNull() && this->getNetworkAddress() == strNetworkAddress)
+		{
+			auto strAddress = address.toString();
+			this->execInThread([this, strAddress]() {
+				m_modbusClient->setConnectionParameter(QModbusDevice::NetworkAddressParameter, strAddress);
+			});
+		}
+		this->connectDevice();
 	});
 }
 
@@ -99,6 +184,10 @@ QDomElement QUaModbusTcpClient::toDomElement(QDomDocument & domDoc) const
 	elemTcpClient.setAttribute("KeepConnecting", getKeepConnecting());
 	elemTcpClient.setAttribute("NetworkAddress", getNetworkAddress());
 	elemTcpClient.setAttribute("NetworkPort"   , getNetworkPort   ());
+	elemTcpClient.setAttribute("Timeout"        , getTimeout        ());
+	elemTcpClient.setAttribute("NumberOfRetries", getNumberOfRetries());
+	elemTcpClient.setAttribute("AdaptiveTimeout", getAdaptiveTimeout());
+	elemTcpClient.setAttribute("DiagnosticsEnabled", getDiagnosticsEnabled());
 	// add block list element
 	auto elemBlockList = const_cast<QUaModbusTcpClient*>(this)->dataBlocks()->toDomElement(domDoc);
 	elemTcpClient.appendChild(elemBlockList);
@@ -183,6 +272,74 @@ void QUaModbusTcpClient::fromDomElement(QDomElement & domElem, QQueue<QUaLog>& e
 			QUaLogCategory::Serialization
 		);
 	}
+	// Timeout (optional)
+	if (domElem.hasAttribute("Timeout"))
+	{
+		auto timeout = domElem.attribute("Timeout").toUInt(&bOK);
+		if (bOK)
+		{
+			this->setTimeout(timeout);
+		}
+		else
+		{
+			errorLogs << QUaLog(
+				tr("Invalid Timeout attribute '%1' in Modbus client %2. Default value set.").arg(domElem.attribute("Timeout")).arg(strBrowseName),
+				QUaLogLevel::Warning,
+				QUaLogCategory::Serialization
+			);
+		}
+	}
+	// NumberOfRetries (optional)
+	if (domElem.hasAttribute("NumberOfRetries"))
+	{
+		auto numberOfRetries = domElem.attribute("NumberOfRetries").toUInt(&bOK);
+		if (bOK)
+		{
+			this->setNumberOfRetries(numberOfRetries);
+		}
+		else
+		{
+			errorLogs << QUaLog(
+				tr("Invalid NumberOfRetries attribute '%1' in Modbus client %2. Default value set.").arg(domElem.attribute("NumberOfRetries")).arg(strBrowseName),
+				QUaLogLevel::Warning,
+				QUaLogCategory::Serialization
+			);
+		}
+	}
+	// AdaptiveTimeout (optional)
+	if (domElem.hasAttribute("AdaptiveTimeout"))
+	{
+		auto adaptiveTimeout = (bool)domElem.attribute("AdaptiveTimeout").toUInt(&bOK);
+		if (bOK)
+		{
+			this->setAdaptiveTimeout(adaptiveTimeout);
+		}
+		else
+		{
+			errorLogs << QUaLog(
+				tr("Invalid AdaptiveTimeout attribute '%1' in Modbus client %2. Default value set.").arg(domElem.attribute("AdaptiveTimeout")).arg(strBrowseName),
+				QUaLogLevel::Warning,
+				QUaLogCategory::Serialization
+			);
+		}
+	}
+	// DiagnosticsEnabled (optional)
+	if (domElem.hasAttribute("DiagnosticsEnabled"))
+	{
+		auto diagnosticsEnabled = (bool)domElem.attribute("DiagnosticsEnabled").toUInt(&bOK);
+		if (bOK)
+		{
+			this->setDiagnosticsEnabled(diagnosticsEnabled);
+		}
+		else
+		{
+			errorLogs << QUaLog(
+				tr("Invalid DiagnosticsEnabled attribute '%1' in Modbus client %2. Default value set.").arg(domElem.attribute("DiagnosticsEnabled")).arg(strBrowseName),
+				QUaLogLevel::Warning,
+				QUaLogCategory::Serialization
+			);
+		}
+	}
 	// get block list
 	QDomElement elemBlockList = domElem.firstChildElement(QUaModbusDataBlockList::staticMetaObject.className());
 	if (!elemBlockList.isNull())
@@ -220,7 +377,7 @@ void QUaModbusTcpClient::on_networkAddressChanged(const QVariant & value)
 	// NOTE : if connected, will not change until reconnect
 	QString strNetworkAddress = value.toString();
 	// set in thread, for thread-safety
-	m_workerThread.execInThread([this, strNetworkAddress]() {
+	this->execInThread([this, strNetworkAddress]() {
 		m_modbusClient->setConnectionParameter(QModbusDevice::NetworkAddressParameter, strNetworkAddress);
 	});
 	// emit
@@ -233,7 +390,7 @@ void QUaModbusTcpClient::on_networkPortChanged(const QVariant & value)
 	// NOTE : if connected, will not change until reconnect
 	quint16 uiPort = value.value<quint16>();
 	// set in thread, for thread-safety
-	m_workerThread.execInThread([this, uiPort]() {
+	this->execInThread([this, uiPort]() {
 		m_modbusClient->setConnectionParameter(QModbusDevice::NetworkPortParameter, uiPort);
 	});
 	// emit
@@ -4,6 +4,7 @@
 #include "quamodbusclient.h"
 
 class QUaModbusClientList;
+class QTcpSocket;
 
 class QUaModbusTcpClient : public QUaModbusClient
 {
@@ -38,6 +39,8 @@ signals:
 
 protected:
 	void resetModbusClient() override;
+	// resolves host names asynchronously, see QUaModbusHostCache
+	void startConnect() override;
 	// XML import / export
 	QDomElement toDomElement  (QDomDocument & domDoc) const override;
 	void        fromDomElement(QDomElement  & domElem, QQueue<QUaLog>& errorLogs) override;
@@ -47,6 +50,14 @@ private slots:
 	void on_networkAddressChanged(const QVariant &value);
 	void on_networkPortChanged   (const QVariant &value);
 
+private:
+	// os defaults (2 hours idle on linux) are too long to detect dead peers
+	static void setKeepAlive(QTcpSocket * socket);
+
+	static int m_keepAliveIdle;     // seconds idle before the first probe
+	static int m_keepAliveInterval; // seconds between probes
+	static int m_keepAliveCount;    // unanswered probes before the connection drops (not on windows)
+
 };
 
 #endif // QUAMODBUSTCPCLIENT_H
@@ -0,0 +1,159 @@
+#include "quamodbustrace.h"
+
+#include <QMutexLocker>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+
+int                             QUaModbusTrace::m_capacity = 65536;
+QAtomicInt                      QUaModbusTrace::m_enabled(0);
+QMutex                          QUaModbusTrace::m_mutex;
+QVector<QUaModbusTrace::Span>   QUaModbusTrace::m_spans;
+int                             QUaModbusTrace::m_next = 0;
+QHash<Qt::HANDLE, int>          QUaModbusTrace::m_threadIds;
+QHash<int, QString>             QUaModbusTrace::m_threadNames;
+
+bool QUaModbusTrace::isEnabled()
+{
+	return m_enabled.loadAcquire() != 0;
+}
+
+void QUaModbusTrace::setEnabled(const bool & enabled)
+{
+	QMutexLocker locker(&m_mutex);
+	if (enabled && !QUaModbusTrace::isEnabled())
+	{
+		m_spans.clear();
+		m_spans.reserve(m_capacity);
+		m_next = 0;
+	}
+	m_enabled.storeRelease(enabled ? 1 : 0);
+}
+
+qint64 QUaModbusTrace::now()
+{
+	// NOTE : thread-safe initialization of function statics (c++11)
+	static QElapsedTimer clock = []() {
+		QElapsedTimer timer;
+		timer.start();
+		return timer;
+	}();
+	return clock.nsecsElapsed() / 1000;
+}
+
+void QUaModbusTrace::addSpan(const char * name, const QString & label, const qint64 & start, const qint64 & end)
+{
+	if (!QUaModbusTrace::isEnabled())
+	{
+		return;
+	}
+	QMutexLocker locker(&m_mutex);
+	Span span = { name, label, start, qMax(end - start, Q_INT64_C(0)), QUaModbusTrace::threadId(), 0.0, false };
+	QUaModbusTrace::append(span);
+}
+
+void QUaModbusTrace::addCounter(const char * name, const QString & label, const double & value)
+{
+	if (!QUaModbusTrace::isEnabled())
+	{
+		return;
+	}
+	QMutexLocker locker(&m_mutex);
+	Span span = { name, label, QUaModbusTrace::now(), 0, QUaModbusTrace::threadId(), value, true };
+	QUaModbusTrace::append(span);
+}
+
+void QUaModbusTrace::append(const Span & span)
+{
+	// NOTE : call with mutex locked, overwrite oldest once full
+	if (m_spans.count() < m_capacity)
+	{
+		m_spans.append(span);
+		return;
+	}
+	m_spans[m_next] = span;
+	m_next = (m_next + 1) % m_capacity;
+}
+
+void QUaModbusTrace::setThreadName(const QString & name)
+{
+	QMutexLocker locker(&m_mutex);
+	m_threadNames[QUaModbusTrace::threadId()] = name;
+}
+
+QByteArray QUaModbusTrace::chromeJson()
+{
+	QMutexLocker locker(&m_mutex);
+	QJsonArray events;
+	// thread names as metadata events
+	for (auto it = m_threadIds.begin(); it != m_threadIds.end(); ++it)
+	{
+		auto tid = it.value();
+		events.append(QJsonObject({
+			{ "name", "thread_name" },
+			{ "ph"  , "M" },
+			{ "pid" , 1 },
+			{ "tid" , tid },
+			{ "args", QJsonObject({ { "name", m_threadNames.value(tid, QString("Thread %1").arg(tid)) } }) }
+		}));
+	}
+	// spans from oldest to newest
+	int count = m_spans.count();
+	for (int i = 0; i < count; i++)
+	{
+		auto &span = m_spans.at((m_next + i) % count);
+		if (span.counter)
+		{
+			events.append(QJsonObject({
+				{ "name", span.name },
+				{ "cat" , "modbus" },
+				{ "ph"  , "C" },
+				{ "ts"  , static_cast<double>(span.start) },
+				{ "pid" , 1 },
+				{ "args", QJsonObject({ { span.label, span.value } }) }
+			}));
+			continue;
+		}
+		events.append(QJsonObject({
+			{ "name", span.name },
+			{ "cat" , "modbus" },
+			{ "ph"  , "X" },
+			{ "ts"  , static_cast<double>(span.start) },
+			{ "dur" , static_cast<double>(span.duration) },
+			{ "pid" , 1 },
+			{ "tid" , span.threadId },
+			{ "args", QJsonObject({ { "block", span.label } }) }
+		}));
+	}
+	QJsonObject trace({
+		{ "traceEvents"    , events },
+		{ "displayTimeUnit", "ms" }
+	});
+	return QJsonDocument(trace).toJson(QJsonDocument::Compact);
+}
+
+bool QUaModbusTrace::writeChromeJson(QIODevice * device)
+{
+	if (!device || !device->isWritable())
+	{
+		return false;
+	}
+	auto json = QUaModbusTrace::chromeJson();
+	return device->write(json) == json.size();
+}
+
+int QUaModbusTrace::threadId()
+{
+	// NOTE : call with mutex locked, small sequential ids are friendlier to trace viewers
+	auto handle = QThread::currentThreadId();
+	auto it = m_threadIds.find(handle);
+	if (it != m_threadIds.end())
+	{
+		return it.value();
+	}
+	int tid = m_threadIds.count() + 1;
+	m_threadIds.insert(handle, tid);
+	return tid;
+}
@@ -0,0 +1,60 @@
+#ifndef QUAMODBUSTRACE_H
+#define QUAMODBUSTRACE_H
+
+#include <QAtomicInt>
+#include <QMutex>
+#include <QVector>
+#include <QHash>
+#include <QIODevice>
+
+// Opt-in recorder of timed spans (poll cycle stages, queue waits) into a ring buffer
+// shared by all threads, exported as Chrome trace JSON (chrome://tracing, Perfetto).
+// NOTE : check isEnabled() before taking timestamps, recording is a no-op when disabled
+class QUaModbusTrace
+{
+public:
+	static bool isEnabled();
+	// NOTE : enabling clears previously recorded spans
+	static void setEnabled(const bool &enabled);
+
+	// monotonic timestamp in microseconds
+	static qint64 now();
+
+	// record a span that happened in the current thread
+	static void addSpan(const char * name, const QString &label, const qint64 &start, const qint64 &end);
+
+	// record a sample of a counter (e.g. event loop lag), each label is a series of the counter track
+	static void addCounter(const char * name, const QString &label, const double &value);
+
+	// name the current thread in the exported trace
+	static void setThreadName(const QString &name);
+
+	static QByteArray chromeJson();
+	static bool       writeChromeJson(QIODevice * device);
+
+	// maximum number of spans kept, oldest are overwritten
+	static int m_capacity;
+
+private:
+	struct Span
+	{
+		const char * name;
+		QString      label;
+		qint64       start;
+		qint64       duration;
+		int          threadId;
+		double       value;   // counters only
+		bool         counter;
+	};
+	static QAtomicInt               m_enabled;
+	static QMutex                   m_mutex;
+	static QVector<Span>            m_spans;
+	static int                      m_next;
+	static QHash<Qt::HANDLE, int>   m_threadIds;
+	static QHash<int, QString>      m_threadNames;
+
+	static int threadId();
+	static void append(const Span &span);
+};
+
+#endif // QUAMODBUSTRACE_H
@@ -2,6 +2,10 @@
 #include "quamodbusvalue.h"
 #include "quamodbusvaluelist.h"
 #include "quamodbusdatablock.h"
+#include "quamodbustrace.h"
+#ifdef UA_ENABLE_HISTORIZING
+#include "quamodbusclientlist.h"
+#endif // UA_ENABLE_HISTORIZING
 
 #include <QUaProperty>
 #include <QUaBaseDataVariable>
@@ -19,6 +23,7 @@ QUaModbusValue::QUaModbusValue(QUaServer *server)
 {
 	// set defaults
 	m_loopId = 0;
+	m_lastKnown = false;
 	m_type = nullptr;
 	m_registersUsed = nullptr;
 	m_addressOffset = nullptr;
@@ -26,26 +31,29 @@ QUaModbusValue::QUaModbusValue(QUaServer *server)
 	m_cyclicWritePeriod = nullptr;
 	m_cyclicWriteMode = nullptr;
 #endif // !QUAMODBUS_NOCYCLIC_WRITE
+#ifdef UA_ENABLE_HISTORIZING
+	m_historizing = nullptr;
+	m_historyDeviation = nullptr;
+#endif // UA_ENABLE_HISTORIZING
 	m_value = nullptr;
 	m_lastError = nullptr;
 	m_typeCache = QModbusValueType::Invalid;
 	m_addressOffsetCache = -1; 
 	m_lastErrorCache = QModbusError::ConfigurationError;
-	type             ()->setDataTypeEnum(QMetaEnum::fromType<QModbusValueType>());
-	type             ()->setValue(m_typeCache);
-	registersUsed    ()->setDataType(QMetaType::UShort);
-	registersUsed    ()->setValue(0);
-	addressOffset    ()->setDataType(QMetaType::Int);
-	addressOffset    ()->setValue(m_addressOffsetCache);
-	lastError        ()->setDataTypeEnum(QMetaEnum::fromType<QModbusError>());
-	lastError        ()->setValue(m_lastErrorCache);
+	m_errorStatus = false;
+	// NOTE : no UA properties until updateCompact(false)
+	m_compact = true;
+#ifndef QUAMODBUS_NOCYCLIC_WRITE
+	m_cyclicWritePeriodCache = 0;
+	m_cyclicWriteModeCache = QModbusCyclicWriteMode::Current;
+#endif // !QUAMODBUS_NOCYCLIC_WRITE
+#ifdef UA_ENABLE_HISTORIZING
+	m_historizingCache = false;
+	m_historyDeviationCache = 0.0;
+#endif // UA_ENABLE_HISTORIZING
 	// set initial conditions
-	type             ()->setWriteAccess(true);
-	addressOffset    ()->setWriteAccess(true);
 	value            ()->setWriteAccess(false); // set to true, when type != ValueType::Invalid
 	// handle state changes
-	QObject::connect(type()             , &QUaBaseVariable::valueChanged, this, &QUaModbusValue::on_typeChanged             , Qt::QueuedConnection);
-	QObject::connect(addressOffset()    , &QUaBaseVariable::valueChanged, this, &QUaModbusValue::on_addressOffsetChanged    , Qt::QueuedConnection);
 	QObject::connect(value()            , &QUaBaseVariable::valueChanged, this, &QUaModbusValue::on_valueChanged            , Qt::QueuedConnection);
 	// to safely update error in ua server thread
 	QObject::connect(this, &QUaModbusValue::updateLastError, this, &QUaModbusValue::on_updateLastError);
@@ -60,21 +68,22 @@ QUaModbusValue::QUaModbusValue(QUaServer *server)
 	*/
 
 #ifndef QUAMODBUS_NOCYCLIC_WRITE
-	cyclicWritePeriod()->setDataType(QMetaType::UInt);
-	cyclicWritePeriod()->setValue(0);
-	cyclicWriteMode()->setDataTypeEnum(QMetaEnum::fromType<QModbusCyclicWriteMode>());
-	cyclicWriteMode()->setValue(QModbusCyclicWriteMode::Current);
-	QObject::connect(cyclicWritePeriod(), &QUaBaseVariable::valueChanged, this, &QUaModbusValue::on_cyclicWritePeriodChanged, Qt::QueuedConnection);
-	QObject::connect(cyclicWriteMode()  , &QUaBaseVariable::valueChanged, this, &QUaModbusValue::on_cyclicWriteModeChanged  , Qt::QueuedConnection);
 	QObject::connect(this, &QUaModbusValue::cyclicWrite    , this, &QUaModbusValue::on_cyclicWrite    );
-	cyclicWritePeriod()->setWriteAccess(true);
-	cyclicWriteMode()->setWriteAccess(true);
 #endif // !QUAMODBUS_NOCYCLIC_WRITE
 }
 
 QUaModbusValue::~QUaModbusValue()
 {
 	emit this->aboutToDestroy();
+#ifdef UA_ENABLE_HISTORIZING
+	// history of a removed value is dropped
+	auto client = this->client();
+	auto list   = client ? client->list() : nullptr;
+	if (list && this->getHistorizing())
+	{
+		list->historian()->remove(this->value()->nodeId());
+	}
+#endif // UA_ENABLE_HISTORIZING
 	// stop loop
 	if (m_loopId > 0)
 	{
@@ -130,28 +139,35 @@ QUaProperty* QUaModbusValue::cyclicWriteMode()
 
 quint32 QUaModbusValue::getCyclicWritePeriod() const
 {
-	return const_cast<QUaModbusValue*>(this)->cyclicWritePeriod()->value<quint32>();
+	return m_cyclicWritePeriodCache;
 }
 
 void QUaModbusValue::setCyclicWritePeriod(const quint32& cyclicWritePeriod)
 {
-	this->cyclicWritePeriod()->setValue(cyclicWritePeriod);
+	if (!m_compact)
+	{
+		this->cyclicWritePeriod()->setValue(cyclicWritePeriod);
+	}
 	this->on_cyclicWritePeriodChanged(cyclicWritePeriod, true);
 }
 
 QModbusCyclicWriteMode QUaModbusValue::getCyclicWriteMode() const
 {
-	return const_cast<QUaModbusValue*>(this)->cyclicWriteMode()->value().value<QModbusCyclicWriteMode>();
+	return m_cyclicWriteModeCache;
 }
 
 void QUaModbusValue::setCyclicWriteMode(const QModbusCyclicWriteMode& cyclicWriteMode)
 {
-	this->cyclicWriteMode()->setValue(cyclicWriteMode);
+	if (!m_compact)
+	{
+		this->cyclicWriteMode()->setValue(cyclicWriteMode);
+	}
 	this->on_cyclicWriteModeChanged(cyclicWriteMode, true);
 }
 
 void QUaModbusValue::on_cyclicWritePeriodChanged(const QVariant& value, const bool& networkChange)
 {
+	m_cyclicWritePeriodCache = value.value<quint32>();
 	if (!networkChange)
 	{
 		return;
@@ -187,6 +203,7 @@ void QUaModbusValue::on_cyclicWritePeriodChanged(const QVariant& value, const bo
 
 void QUaModbusValue::on_cyclicWriteModeChanged(const QVariant& value, const bool& networkChange)
 {
+	m_cyclicWriteModeCache = value.value<QModbusCyclicWriteMode>();
 	if (!networkChange)
 	{
 		return;
@@ -229,6 +246,108 @@ void QUaModbusValue::on_cyclicWrite()
 }
 #endif // !QUAMODBUS_NOCYCLIC_WRITE
 
+#ifdef UA_ENABLE_HISTORIZING
+QUaProperty* QUaModbusValue::historizing()
+{
+	if (!m_historizing)
+	{
+		m_historizing = this->browseChild<QUaProperty>("Historizing");
+	}
+	return m_historizing;
+}
+
+QUaProperty* QUaModbusValue::historyDeviation()
+{
+	if (!m_historyDeviation)
+	{
+		m_historyDeviation = this->browseChild<QUaProperty>("HistoryDeviation");
+	}
+	return m_historyDeviation;
+}
+
+bool QUaModbusValue::getHistorizing() const
+{
+	return m_historizingCache;
+}
+
+void QUaModbusValue::setHistorizing(const bool& historizing)
+{
+	if (!m_compact)
+	{
+		this->historizing()->setValue(historizing);
+	}
+	this->on_historizingChanged(historizing, true);
+}
+
+double QUaModbusValue::getHistoryDeviation() const
+{
+	return m_historyDeviationCache;
+}
+
+void QUaModbusValue::setHistoryDeviation(const double& historyDeviation)
+{
+	if (!m_compact)
+	{
+		this->historyDeviation()->setValue(historyDeviation);
+	}
+	this->on_historyDeviationChanged(historyDeviation, true);
+}
+
+void QUaModbusValue::on_historizingChanged(const QVariant& value, const bool& networkChange)
+{
+	m_historizingCache = value.value<bool>();
+	if (!networkChange)
+	{
+		return;
+	}
+	this->updateHistorizing();
+	emit this->historizingChanged(value.value<bool>());
+}
+
+void QUaModbusValue::on_historyDeviationChanged(const QVariant& value, const bool& networkChange)
+{
+	m_historyDeviationCache = value.value<double>();
+	if (!networkChange)
+	{
+		return;
+	}
+	// NOTE : a negative deviation would close the door on every point
+	auto deviation = m_historyDeviationCache;
+	if (!(deviation >= 0.0))
+	{
+		if (!m_compact)
+		{
+			this->historyDeviation()->setValue(0.0);
+		}
+		m_historyDeviationCache = 0.0;
+		deviation = 0.0;
+	}
+	this->updateHistorizing();
+	emit this->historyDeviationChanged(deviation);
+}
+
+void QUaModbusValue::updateHistorizing()
+{
+	bool historizing = this->getHistorizing();
+	this->value()->setHistorizing(historizing);
+	this->value()->setReadHistoryAccess(historizing);
+	auto client = this->client();
+	auto list   = client ? client->list() : nullptr;
+	if (!list)
+	{
+		return;
+	}
+	if (historizing)
+	{
+		list->historian()->setDeviation(this->value()->nodeId(), this->getHistoryDeviation());
+	}
+	else
+	{
+		list->historian()->remove(this->value()->nodeId());
+	}
+}
+#endif // UA_ENABLE_HISTORIZING
+
 QUaBaseDataVariable * QUaModbusValue::value()
 {
 	if (!m_value)
@@ -252,6 +371,48 @@ void QUaModbusValue::remove()
 	this->deleteLater();
 }
 
+QString QUaModbusValue::xmlConfig()
+{
+	QDomDocument domDoc;
+	domDoc.appendChild(this->toDomElement(domDoc));
+	return domDoc.toString();
+}
+
+QString QUaModbusValue::setXmlConfig(QString strXmlConfig)
+{
+	QDomDocument domDoc;
+	QString strParseError;
+	int line, column;
+	if (!domDoc.setContent(strXmlConfig, &strParseError, &line, &column))
+	{
+		return tr("%1 : Invalid XML in line %2 column %3. %4").arg("Error").arg(line).arg(column).arg(strParseError);
+	}
+	auto elemNew = domDoc.documentElement();
+	QString strClassName = QUaModbusValue::staticMetaObject.className();
+	if (elemNew.tagName() != strClassName)
+	{
+		return tr("%1 : Expected %2 element, found %3.").arg("Error").arg(strClassName).arg(elemNew.tagName());
+	}
+	// NOTE : attributes not given keep their current value
+	auto elemValue = this->toDomElement(domDoc);
+	auto attrsNew  = elemNew.attributes();
+	for (int i = 0; i < attrsNew.count(); i++)
+	{
+		auto attrNew = attrsNew.item(i).toAttr();
+		elemValue.setAttribute(attrNew.name(), attrNew.value());
+	}
+	// NOTE : neither renames nor changes permissions
+	elemValue.setAttribute("BrowseName", this->browseName().name());
+	elemValue.removeAttribute("Permissions");
+	QQueue<QUaLog> errorLogs;
+	this->fromDomElement(elemValue, errorLogs);
+	if (!errorLogs.isEmpty())
+	{
+		return QUaLog::toString(errorLogs);
+	}
+	return "Success.";
+}
+
 void QUaModbusValue::on_typeChanged(const QVariant &value, const bool& networkChange)
 {
 	auto type = value.value<QModbusValueType>();
@@ -265,16 +426,20 @@ void QUaModbusValue::on_typeChanged(const QVariant &value, const bool& networkCh
 	// convert to metatype to set as UA type
 	auto metaType = QUaModbusValue::typeToMeta(type);
 	this->value()->setDataType(metaType);
-	// update value is possible
+	// update value is possible, from the last read of the block
 	auto blockError   = this->block()->getLastError();
 	auto blockData    = this->block()->getData();
-	this->setValue(blockData, blockError);
+	this->setValue(blockData, blockError, this->block()->data()->sourceTimestamp());
 	// update number of registers used
 	auto registersUsed = QUaModbusValue::typeBlockSize(type);
-	this->registersUsed()->setValue(registersUsed);
+	if (!m_compact)
+	{
+		this->registersUsed()->setValue(registersUsed);
+	}
 	// emit
 	emit this->typeChanged(type);
 	emit this->registersUsedChanged(registersUsed);
+	this->block()->validateLater();
 }
 
 QModbusValueType QUaModbusValue::getType() const
@@ -288,13 +453,16 @@ void QUaModbusValue::setType(const QModbusValueType & type)
 	{
 		return;
 	}	
-	this->type()->setValue(type);
+	if (!m_compact)
+	{
+		this->type()->setValue(type);
+	}
 	this->on_typeChanged(type, true);
 }
 
 quint16 QUaModbusValue::getRegistersUsed() const
 {
-	return const_cast<QUaModbusValue*>(this)->registersUsed()->value().value<quint16>();
+	return static_cast<quint16>(QUaModbusValue::typeBlockSize(m_typeCache));
 }
 
 int QUaModbusValue::getAddressOffset() const
@@ -304,7 +472,10 @@ int QUaModbusValue::getAddressOffset() const
 
 void QUaModbusValue::setAddressOffset(const int & addressOffset)
 {
-	this->addressOffset()->setValue(addressOffset);
+	if (!m_compact)
+	{
+		this->addressOffset()->setValue(addressOffset);
+	}
 	this->on_addressOffsetChanged(addressOffset, true);
 }
 
@@ -349,12 +520,13 @@ void QUaModbusValue::on_addressOffsetChanged(const QVariant & value, const bool&
 	{
 		return;
 	}
-	// update value is possible
+	// update value is possible, from the last read of the block
 	auto blockError   = this->block()->getLastError();
 	auto blockData    = this->block()->getData();
-	this->setValue(blockData, blockError);
+	this->setValue(blockData, blockError, this->block()->data()->sourceTimestamp());
 	// emit
 	emit this->addressOffsetChanged(offset);
+	this->block()->validateLater();
 }
 
 // OPC UA network change
@@ -404,16 +576,29 @@ void QUaModbusValue::on_valueChanged(const QVariant & value, const bool& network
 	// just write
 	auto client = this->client();
 	auto block  = this->block();
+	// trace time waiting in worker thread queue
+	qint64  tracePosted = -1;
+	QString traceName;
+	if (QUaModbusTrace::isEnabled())
+	{
+		tracePosted = QUaModbusTrace::now();
+		traceName   = QString("%1.%2").arg(client->browseName().name()).arg(block->browseName().name());
+	}
 	// exec write request in client thread
-	this->client()->m_workerThread.execInThread(
-	[this, data, client, block, addressOffset, typeBlockSize, value]() {
+	this->client()->execInThread(
+	[this, data, client, block, addressOffset, typeBlockSize, value, tracePosted, traceName]() {
+		if (tracePosted >= 0)
+		{
+			QUaModbusTrace::addSpan("write queue", traceName, tracePosted, QUaModbusTrace::now());
+		}
 		// copy from block
-		auto registerType = block->m_registerType;
-		auto startAddress = block->m_startAddress + addressOffset;
+		auto config       = block->m_config.load();
+		auto registerType = config->registerType;
+		auto startAddress = config->startAddress + addressOffset;
 		auto valueCount   = typeBlockSize;
 		// check if request is valid
-		if (registerType != QModbusDataBlockType::Coils &&
-			registerType != QModbusDataBlockType::HoldingRegisters)
+		if (registerType != QModbusDataUnit::RegisterType::Coils &&
+			registerType != QModbusDataUnit::RegisterType::HoldingRegisters)
 		{
 			return;
 		}
@@ -436,18 +621,20 @@ void QUaModbusValue::on_valueChanged(const QVariant & value, const bool& network
 		}
 		// create data target 
 		QModbusDataUnit dataToWrite(
-			static_cast<QModbusDataUnit::RegisterType>(registerType),
+			registerType,
 			startAddress, 
 			data
 		);
 		// create and send request
-		auto serverAddress = client->getServerAddress();
+		auto serverAddress = client->m_config.load()->serverAddress;
 		QModbusReply* p_reply = client->m_modbusClient->sendWriteRequest(dataToWrite, serverAddress);
 		if (!p_reply)
 		{
 			emit this->updateLastError(QModbusError::ReplyAbortedError);
 			return;
 		}
+		// measure round trip time
+		client->trackReply(p_reply, QUaModbusMetrics::requestSize(dataToWrite, true), block->m_metrics);
 		// subscribe to finished
 		QObject::connect(p_reply, &QModbusReply::finished, this,
 		[this, p_reply, value]() mutable {
@@ -486,13 +673,21 @@ void QUaModbusValue::on_updateLastError(const QModbusError & error)
 	}
 	m_lastErrorCache = error;
 	// update
-	this->lastError()->setValue(error);
+	if (!m_errorStatus && !m_compact)
+	{
+		this->lastError()->setValue(error);
+	}
+	// NOTE : a last known value stays uncertain until the first good read
+	else if (!m_lastKnown)
+	{
+		this->value()->setStatusCode(QUaModbusDataBlock::errorToStatus(error));
+	}
 	// emit
 	emit this->lastErrorChanged(error);
 }
 
 // programmatic change from block upstream (modbus response to read request)
-void QUaModbusValue::setValue(const QVector<quint16>& block, const QModbusError &blockError)
+void QUaModbusValue::setValue(const QVector<quint16>& block, const QModbusError &blockError, const QDateTime &timestamp)
 {
 	// check configuration
 	if (!m_wellConfigured)
@@ -521,12 +716,24 @@ void QUaModbusValue::setValue(const QVector<quint16>& block, const QModbusError
 	// convert to value
 	auto value = QUaModbusValue::blockToValue(block.mid(addressOffset, typeBlockSize), type);
 	// avoid update or emit if no change, improves performance
-	if (this->getValue() == value)
+	// NOTE : a last known value is updated even if equal, to clear its uncertain status
+	if (this->getValue() == value && !m_lastKnown)
 	{
 		return;
 	}
-	// NOTE : set value before emitting to avoid recursion
+	// NOTE : set value before emitting to avoid recursion, good status clears a last known value
+	this->value()->setValue(value, QUaStatus::Good, timestamp);
+	m_lastKnown = false;
+	// emit
+	emit this->valueChanged(value);
+}
+
+void QUaModbusValue::setLastKnownValue(const QVariant & value, const QDateTime & timestamp)
+{
 	this->value()->setValue(value);
+	this->value()->setStatusCode(QUaStatus::UncertainLastUsableValue);
+	this->value()->setSourceTimestamp(timestamp);
+	m_lastKnown = true;
 	// emit
 	emit this->valueChanged(value);
 }
@@ -551,6 +758,110 @@ void QUaModbusValue::updateWellConfigured(const QModbusValueType& type, const in
 	}
 }
 
+void QUaModbusValue::updateErrorStatus(const bool & enabled)
+{
+	m_errorStatus = enabled;
+	// NOTE : a compact value has no LastError either way
+	bool errorStatus = m_errorStatus || m_compact;
+	// add or remove LastError on demand
+	auto lastError = this->lastError();
+	if (errorStatus && lastError)
+	{
+		delete lastError;
+		m_lastError = nullptr;
+	}
+	else if (!errorStatus && !lastError)
+	{
+		m_lastError = this->addBaseDataVariable("LastError");
+		m_lastError->setDataTypeEnum(QMetaEnum::fromType<QModbusError>());
+		m_lastError->setValue(m_lastErrorCache);
+	}
+	if (m_lastKnown)
+	{
+		return;
+	}
+	this->value()->setStatusCode(errorStatus ? QUaModbusDataBlock::errorToStatus(m_lastErrorCache) : QUaStatusCode(QUaStatus::Good));
+}
+
+void QUaModbusValue::updateCompact(const bool & enabled)
+{
+	if (m_compact == enabled)
+	{
+		return;
+	}
+	m_compact = enabled;
+	if (enabled)
+	{
+		// NOTE : the caches keep the configuration, deleting a node drops its queued changes
+		QList<QUaProperty*> listProps = { this->type(), this->registersUsed(), this->addressOffset() };
+#ifndef QUAMODBUS_NOCYCLIC_WRITE
+		listProps << this->cyclicWritePeriod() << this->cyclicWriteMode();
+		m_cyclicWritePeriod = nullptr;
+		m_cyclicWriteMode   = nullptr;
+#endif // !QUAMODBUS_NOCYCLIC_WRITE
+#ifdef UA_ENABLE_HISTORIZING
+		listProps << this->historizing() << this->historyDeviation();
+		m_historizing      = nullptr;
+		m_historyDeviation = nullptr;
+#endif // UA_ENABLE_HISTORIZING
+		m_type          = nullptr;
+		m_registersUsed = nullptr;
+		m_addressOffset = nullptr;
+		qDeleteAll(listProps);
+	}
+	else
+	{
+		QStringList listNames = { "Type", "RegistersUsed", "AddressOffset" };
+#ifndef QUAMODBUS_NOCYCLIC_WRITE
+		listNames << "CyclicWritePeriod" << "CyclicWriteMode";
+#endif // !QUAMODBUS_NOCYCLIC_WRITE
+#ifdef UA_ENABLE_HISTORIZING
+		listNames << "Historizing" << "HistoryDeviation";
+#endif // UA_ENABLE_HISTORIZING
+		for (auto &strName : listNames)
+		{
+			this->addProperty(strName);
+		}
+		this->setupProperties();
+	}
+	// add or remove LastError
+	this->updateErrorStatus(m_errorStatus);
+}
+
+void QUaModbusValue::setupProperties()
+{
+	type             ()->setDataTypeEnum(QMetaEnum::fromType<QModbusValueType>());
+	type             ()->setValue(m_typeCache);
+	registersUsed    ()->setDataType(QMetaType::UShort);
+	registersUsed    ()->setValue(this->getRegistersUsed());
+	addressOffset    ()->setDataType(QMetaType::Int);
+	addressOffset    ()->setValue(m_addressOffsetCache);
+	type             ()->setWriteAccess(true);
+	addressOffset    ()->setWriteAccess(true);
+	QObject::connect(type()             , &QUaBaseVariable::valueChanged, this, &QUaModbusValue::on_typeChanged             , Qt::QueuedConnection);
+	QObject::connect(addressOffset()    , &QUaBaseVariable::valueChanged, this, &QUaModbusValue::on_addressOffsetChanged    , Qt::QueuedConnection);
+#ifndef QUAMODBUS_NOCYCLIC_WRITE
+	cyclicWritePeriod()->setDataType(QMetaType::UInt);
+	cyclicWritePeriod()->setValue(m_cyclicWritePeriodCache);
+	cyclicWriteMode()->setDataTypeEnum(QMetaEnum::fromType<QModbusCyclicWriteMode>());
+	cyclicWriteMode()->setValue(m_cyclicWriteModeCache);
+	QObject::connect(cyclicWritePeriod(), &QUaBaseVariable::valueChanged, this, &QUaModbusValue::on_cyclicWritePeriodChanged, Qt::QueuedConnection);
+	QObject::connect(cyclicWriteMode()  , &QUaBaseVariable::valueChanged, this, &QUaModbusValue::on_cyclicWriteModeChanged  , Qt::QueuedConnection);
+	cyclicWritePeriod()->setWriteAccess(true);
+	cyclicWriteMode()->setWriteAccess(true);
+#endif // !QUAMODBUS_NOCYCLIC_WRITE
+#ifdef UA_ENABLE_HISTORIZING
+	historizing()->setDataType(QMetaType::Bool);
+	historizing()->setValue(m_historizingCache);
+	historyDeviation()->setDataType(QMetaType::Double);
+	historyDeviation()->setValue(m_historyDeviationCache);
+	QObject::connect(historizing()     , &QUaBaseVariable::valueChanged, this, &QUaModbusValue::on_historizingChanged     , Qt::QueuedConnection);
+	QObject::connect(historyDeviation(), &QUaBaseVariable::valueChanged, this, &QUaModbusValue::on_historyDeviationChanged, Qt::QueuedConnection);
+	historizing()->setWriteAccess(true);
+	historyDeviation()->setWriteAccess(true);
+#endif // UA_ENABLE_HISTORIZING
+}
+
 QDomElement QUaModbusValue::toDomElement(QDomDocument & domDoc) const
 {
 	// add value element
@@ -570,6 +881,10 @@ QDomElement QUaModbusValue::toDomElement(QDomDocument & domDoc) const
 	elemValue.setAttribute("CyclicWriteMode"  , QMetaEnum::fromType<QModbusCyclicWriteMode>().valueToKey(this->getCyclicWriteMode()));
 	elemValue.setAttribute("CyclicWritePeriod", this->getCyclicWritePeriod());
 #endif // !QUAMODBUS_NOCYCLIC_WRITE
+#ifdef UA_ENABLE_HISTORIZING
+	elemValue.setAttribute("Historizing"     , this->getHistorizing() ? 1 : 0);
+	elemValue.setAttribute("HistoryDeviation", this->getHistoryDeviation());
+#endif // UA_ENABLE_HISTORIZING
 	// return value element
 	return elemValue;
 }
@@ -653,6 +968,42 @@ void QUaModbusValue::fromDomElement(QDomElement & domElem, QQueue<QUaLog>& error
 		);
 	}
 #endif // !QUAMODBUS_NOCYCLIC_WRITE
+#ifdef UA_ENABLE_HISTORIZING
+	// Historizing (optional)
+	if (domElem.hasAttribute("Historizing"))
+	{
+		auto historizing = domElem.attribute("Historizing").toUInt(&bOK);
+		if (bOK)
+		{
+			this->setHistorizing(historizing != 0);
+		}
+		else
+		{
+			errorLogs << QUaLog(
+				tr("Invalid Historizing attribute '%1' in Value %2. Default value set.").arg(domElem.attribute("Historizing")).arg(strBrowseName),
+				QUaLogLevel::Warning,
+				QUaLogCategory::Serialization
+			);
+		}
+	}
+	// HistoryDeviation (optional)
+	if (domElem.hasAttribute("HistoryDeviation"))
+	{
+		auto deviation = domElem.attribute("HistoryDeviation").toDouble(&bOK);
+		if (bOK && deviation >= 0.0)
+		{
+			this->setHistoryDeviation(deviation);
+		}
+		else
+		{
+			errorLogs << QUaLog(
+				tr("Invalid HistoryDeviation attribute '%1' in Value %2. Default value set.").arg(domElem.attribute("HistoryDeviation")).arg(strBrowseName),
+				QUaLogLevel::Warning,
+				QUaLogCategory::Serialization
+			);
+		}
+	}
+#endif // UA_ENABLE_HISTORIZING
 }
 
 int QUaModbusValue::typeBlockSize(const QModbusValueType & type)
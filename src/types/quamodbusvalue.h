@@ -27,20 +27,14 @@ class QUaModbusValue : public QUaBaseObjectProtected
 {
 	friend class QUaModbusValueList;
 	friend class QUaModbusDataBlock;
+	friend class QUaModbusClientList;
 
     Q_OBJECT
 
-	// UA properties
-	Q_PROPERTY(QUaProperty * Type              READ type             )
-	Q_PROPERTY(QUaProperty * RegistersUsed     READ registersUsed    )
-	Q_PROPERTY(QUaProperty * AddressOffset     READ addressOffset    )
-#ifndef QUAMODBUS_NOCYCLIC_WRITE
-	Q_PROPERTY(QUaProperty * CyclicWritePeriod READ cyclicWritePeriod)
-	Q_PROPERTY(QUaProperty * CyclicWriteMode   READ cyclicWriteMode  )
-#endif // !QUAMODBUS_NOCYCLIC_WRITE
 	// UA variables
+	// NOTE : UA properties and LastError are added per instance (see updateCompact and updateErrorStatus),
+	//        so a compact value only instantiates Value
 	Q_PROPERTY(QUaBaseDataVariable * Value     READ value    )
-	Q_PROPERTY(QUaBaseDataVariable * LastError READ lastError)
 
 public:
 	Q_INVOKABLE explicit QUaModbusValue(QUaServer *server);
@@ -87,12 +81,20 @@ public:
 	// UA variables
 
 	QUaBaseDataVariable * value();
+	// nullptr if errors are the status code of Value (see QUaModbusClientList::ErrorStatusCodes)
 	QUaBaseDataVariable * lastError();
 
+	// NOTE : UA properties are nullptr in compact mode (see QUaModbusClientList::CompactValues)
+
 	// UA methods
 
 	Q_INVOKABLE void remove();
 
+	// configuration of this value only, the way to edit it in compact mode
+	Q_INVOKABLE QString xmlConfig();
+
+	Q_INVOKABLE QString setXmlConfig(QString strXmlConfig);
+
 	// C++ API
 	QModbusValueType getType() const;
 	void             setType(const QModbusValueType &type);
@@ -126,6 +128,19 @@ public:
 	void setCyclicWriteMode(const QModbusCyclicWriteMode& cyclicWriteMode);
 #endif // !QUAMODBUS_NOCYCLIC_WRITE
 
+#ifdef UA_ENABLE_HISTORIZING
+	QUaProperty* historizing();
+	QUaProperty* historyDeviation();
+
+	// history of Value, served to HistoryRead (see QUaModbusHistorian)
+	bool getHistorizing() const;
+	void setHistorizing(const bool& historizing);
+
+	// swinging door compression deviation, in value units
+	double getHistoryDeviation() const;
+	void   setHistoryDeviation(const double& historyDeviation);
+#endif // UA_ENABLE_HISTORIZING
+
 	QModbusError getLastError() const;
 	void         setLastError(const QModbusError &error);
 
@@ -160,6 +175,11 @@ signals:
 	void cyclicWrite();
 #endif // !QUAMODBUS_NOCYCLIC_WRITE
 
+#ifdef UA_ENABLE_HISTORIZING
+	void historizingChanged     (const bool&   historizing     );
+	void historyDeviationChanged(const double& historyDeviation);
+#endif // UA_ENABLE_HISTORIZING
+
 private slots:
 	void on_typeChanged             (const QVariant     &value, const bool& networkChange);
 	void on_addressOffsetChanged    (const QVariant     &value, const bool& networkChange);
@@ -171,13 +191,31 @@ private slots:
 	// cyclic write with last value
 	void on_cyclicWrite();
 #endif // !QUAMODBUS_NOCYCLIC_WRITE
+#ifdef UA_ENABLE_HISTORIZING
+	void on_historizingChanged     (const QVariant     &value, const bool& networkChange);
+	void on_historyDeviationChanged(const QVariant     &value, const bool& networkChange);
+#endif // UA_ENABLE_HISTORIZING
 
 private:
 	int m_loopId;
 	bool m_wellConfigured;
+	// restored from the value cache, until the first good read
+	bool m_lastKnown;
 	QModbusValueType m_typeCache;
 	int m_addressOffsetCache;
 	QModbusError m_lastErrorCache;
+	// errors as status code of Value instead of LastError
+	bool m_errorStatus;
+	// configuration only in the caches, without property nodes
+	bool m_compact;
+#ifndef QUAMODBUS_NOCYCLIC_WRITE
+	quint32 m_cyclicWritePeriodCache;
+	QModbusCyclicWriteMode m_cyclicWriteModeCache;
+#endif // !QUAMODBUS_NOCYCLIC_WRITE
+#ifdef UA_ENABLE_HISTORIZING
+	bool m_historizingCache;
+	double m_historyDeviationCache;
+#endif // UA_ENABLE_HISTORIZING
 	QUaProperty* m_type;
 	QUaProperty* m_registersUsed;
 	QUaProperty* m_addressOffset;
@@ -185,12 +223,28 @@ private:
 	QUaProperty* m_cyclicWritePeriod;
 	QUaProperty* m_cyclicWriteMode;
 #endif // !QUAMODBUS_NOCYCLIC_WRITE
+#ifdef UA_ENABLE_HISTORIZING
+	QUaProperty* m_historizing;
+	QUaProperty* m_historyDeviation;
+	// applies Historizing and HistoryDeviation to Value and the historian
+	void updateHistorizing();
+#endif // UA_ENABLE_HISTORIZING
 	QUaBaseDataVariable* m_value;
 	QUaBaseDataVariable* m_lastError;
 
-	void setValue(const QVector<quint16> &block, const QModbusError &blockError);
+	// timestamp is the arrival of the block read, the source timestamp of the value
+	void setValue(const QVector<quint16> &block, const QModbusError &blockError, const QDateTime &timestamp = QDateTime());
+	// warm start, shown as uncertain with its original timestamp until the first good read
+	void setLastKnownValue(const QVariant &value, const QDateTime &timestamp);
 
 	void updateWellConfigured(const QModbusValueType& type, const int& addressOffset);
+	// add or remove LastError (in ua server thread)
+	void updateErrorStatus(const bool &enabled);
+	// add or remove the UA properties (in ua server thread), errors are the status code of Value while compact.
+	// NOTE : new instances are compact, the value list calls it right after creation
+	void updateCompact(const bool &enabled);
+	// set up the UA properties from the caches
+	void setupProperties();
 
 	// XML import / export
 	QDomElement toDomElement  (QDomDocument & domDoc) const;
@@ -0,0 +1,134 @@
+#include "quamodbusvaluecache.h"
+
+#include <QFile>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QSemaphore>
+
+QUaModbusValueCache::QUaModbusValueCache(const QString &strFileName)
+{
+	m_strFileName = strFileName;
+}
+
+QUaModbusValueCache::~QUaModbusValueCache()
+{
+	// NOTE : tasks run in order, so this waits for the queued writes
+	QSemaphore done;
+	m_worker.execInThread([&done]() {
+		done.release();
+	});
+	done.acquire();
+}
+
+QString QUaModbusValueCache::fileName() const
+{
+	return m_strFileName;
+}
+
+bool QUaModbusValueCache::read(Entries & entries, QQueue<QUaLog>& errorLogs) const
+{
+	entries.clear();
+	QFile file(m_strFileName);
+	// first start, nothing to restore
+	if (!file.exists())
+	{
+		return true;
+	}
+	if (!file.open(QIODevice::ReadOnly))
+	{
+		errorLogs << QUaLog(
+			tr("Cannot open value cache %1. %2").arg(m_strFileName).arg(file.errorString()),
+			QUaLogLevel::Warning,
+			QUaLogCategory::Serialization
+		);
+		return false;
+	}
+	QDataStream stream(&file);
+	stream.setVersion(QDataStream::Qt_5_10);
+	quint32 magic   = 0;
+	quint32 version = 0;
+	quint32 count   = 0;
+	stream >> magic >> version >> count;
+	if (magic != QUaModbusValueCache::m_magic || version != QUaModbusValueCache::m_version)
+	{
+		errorLogs << QUaLog(
+			tr("Value cache %1 has an unknown format or version. Values are not restored.").arg(m_strFileName),
+			QUaLogLevel::Warning,
+			QUaLogCategory::Serialization
+		);
+		return false;
+	}
+	entries.reserve(static_cast<int>(qMin<quint32>(count, 1000000)));
+	for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; i++)
+	{
+		QString strKey;
+		Entry   entry;
+		stream >> strKey >> entry.type >> entry.value >> entry.timestamp;
+		entries.insert(strKey, entry);
+	}
+	if (stream.status() != QDataStream::Ok)
+	{
+		entries.clear();
+		errorLogs << QUaLog(
+			tr("Value cache %1 is truncated or corrupted. Values are not restored.").arg(m_strFileName),
+			QUaLogLevel::Warning,
+			QUaLogCategory::Serialization
+		);
+		return false;
+	}
+	return true;
+}
+
+void QUaModbusValueCache::reset(const Entries & entries)
+{
+	m_worker.execInThread([this, entries]() {
+		m_entries = entries;
+	});
+}
+
+void QUaModbusValueCache::write(const Entries & changed, const Types & live, const ErrorCallback & onError)
+{
+	m_worker.execInThread([this, changed, live, onError]() {
+		// NOTE : values removed or retyped since the last write are pruned
+		for (auto it = m_entries.begin(); it != m_entries.end();)
+		{
+			auto type = live.find(it.key());
+			if (type == live.end() || type.value() != it.value().type)
+			{
+				it = m_entries.erase(it);
+				continue;
+			}
+			++it;
+		}
+		for (auto it = changed.begin(); it != changed.end(); ++it)
+		{
+			m_entries.insert(it.key(), it.value());
+		}
+		// NOTE : replaced on commit, readers never see a partial file
+		QSaveFile file(m_strFileName);
+		if (!file.open(QIODevice::WriteOnly))
+		{
+			onError(QUaLog(
+				tr("Cannot open value cache %1. %2").arg(m_strFileName).arg(file.errorString()),
+				QUaLogLevel::Warning,
+				QUaLogCategory::Serialization
+			));
+			return;
+		}
+		QDataStream stream(&file);
+		stream.setVersion(QDataStream::Qt_5_10);
+		stream << QUaModbusValueCache::m_magic << QUaModbusValueCache::m_version << static_cast<quint32>(m_entries.count());
+		for (auto it = m_entries.begin(); it != m_entries.end(); ++it)
+		{
+			stream << it.key() << it.value().type << it.value().value << it.value().timestamp;
+		}
+		if (!file.commit())
+		{
+			onError(QUaLog(
+				tr("Cannot write value cache %1. %2").arg(m_strFileName).arg(file.errorString()),
+				QUaLogLevel::Warning,
+				QUaLogCategory::Serialization
+			));
+		}
+	});
+}
@@ -0,0 +1,60 @@
+#ifndef QUAMODBUSVALUECACHE_H
+#define QUAMODBUSVALUECACHE_H
+
+#include <QCoreApplication>
+#include <QHash>
+#include <QVariant>
+#include <QDateTime>
+
+#include <QUaServer>
+#include <QLambdaThreadWorker>
+
+#include <functional>
+
+// Last known values of the client / block / value tree, persisted to a file for warm starts.
+// Entries are keyed by "client.block.value" browse names and keep the value type, so a value
+// whose type changed since is not restored. Writes merge into the entries of the worker thread,
+// drop the ones of values no longer live and replace the file atomically, so a crash never leaves
+// a half written cache.
+// Layout (QDataStream) : magic | version | count | { key | type | value | source timestamp }[]
+class QUaModbusValueCache
+{
+	Q_DECLARE_TR_FUNCTIONS(QUaModbusValueCache)
+
+public:
+	struct Entry
+	{
+		qint32    type;
+		QVariant  value;
+		QDateTime timestamp;
+	};
+	typedef QHash<QString, Entry> Entries;
+	// value type of each live value, keyed like the entries
+	typedef QHash<QString, qint32> Types;
+	typedef std::function<void(const QUaLog &log)> ErrorCallback;
+
+	explicit QUaModbusValueCache(const QString &strFileName);
+	// NOTE : waits for the pending write
+	~QUaModbusValueCache();
+
+	QString fileName() const;
+
+	// synchronous, returns false if the file exists but is not a valid cache
+	bool read(Entries &entries, QQueue<QUaLog> &errorLogs) const;
+	// entries the next writes are merged into, e.g. the ones restored by read
+	void reset(const Entries &entries);
+	// asynchronous, merged into the current entries and written in the worker thread. Entries
+	// not in live, or of another type, are dropped. Calls back in the worker thread if it fails
+	void write(const Entries &changed, const Types &live, const ErrorCallback &onError);
+
+	static const quint32 m_magic   = 0x43564D51; // "QMVC"
+	static const quint32 m_version = 1;
+
+private:
+	QString             m_strFileName;
+	QLambdaThreadWorker m_worker;
+	// NOTE : only accessed in worker thread
+	Entries             m_entries;
+};
+
+#endif // QUAMODBUSVALUECACHE_H
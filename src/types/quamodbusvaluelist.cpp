@@ -2,6 +2,7 @@
 #include "quamodbusdatablock.h"
 #include "quamodbusvalue.h"
 #include "quamodbusclient.h"
+#include "quamodbusclientlist.h"
 
 // NOTE : had to add this header because the actual implementation of QUaBaseObject::addChild is in here
 //        and was getting "lnk2019 unresolved external symbol template function" without it
@@ -9,6 +10,9 @@
 
 #include <QRegularExpression>
 #include <QRegularExpressionMatch>
+#include <QSignalBlocker>
+#include <QSet>
+#include <QHash>
 
 #ifdef QUA_ACCESS_CONTROL
 #include <QUaPermissions>
@@ -26,34 +30,23 @@ QUaModbusValueList::QUaModbusValueList(QUaServer *server)
 
 QString QUaModbusValueList::addValue(const QUaQualifiedName& valueId)
 {
-	auto strValueId = valueId.name();
-	// check empty
-	if (strValueId.isEmpty())
-	{
-		return tr("%1 : Value Id argument cannot be empty.").arg("Error");
-	}
-	// check valid length
-	if (strValueId.count() > 130)
-	{
-		return tr("%1 : Value Id cannot contain more than 120 characters.").arg("Error");
-	}
-	// check not called Name
-	if (strValueId.compare("Name", Qt::CaseSensitive) == 0)
-	{
-		return tr("%1 : Value Id cannot be 'Name'.").arg("Error");
-	}
-	// check valid characters
-	QRegularExpression rx("^[a-zA-Z0-9_]*$");
-	QRegularExpressionMatch match = rx.match(strValueId, 0, QRegularExpression::PartialPreferCompleteMatch);
-	if (!match.hasMatch())
-	{
-		return tr("%1 : Value Id can only contain numbers, letters and underscores /^[a-zA-Z0-9_]*$/.").arg("Error");
-	}
 	// check if id already exists
 	if (this->hasChild(valueId))
 	{
 		return tr("%1 : Value Id already exists.").arg("Error");
 	}
+	QString strError;
+	return this->createValue(valueId, strError) ? "Success" : strError;
+}
+
+QUaModbusValue * QUaModbusValueList::createValue(const QUaQualifiedName & valueId, QString & strError)
+{
+	auto strValueId = valueId.name();
+	strError = QUaModbusValueList::checkValueId(strValueId);
+	if (!strError.isEmpty())
+	{
+		return nullptr;
+	}
 	// create instance
 	QUaNodeId strNodeId = { 
 		0, 
@@ -65,10 +58,84 @@ QString QUaModbusValueList::addValue(const QUaQualifiedName& valueId)
 	auto value = this->addChild<QUaModbusValue>(valueId, strNodeId);
 	if (!value)
 	{
-		return  tr("%1 : NodeId %2 already exists.").arg("Error").arg(strNodeId);
+		strError = tr("%1 : NodeId %2 already exists.").arg("Error").arg(strNodeId);
+		return nullptr;
+	}
+	// NOTE : compact values never instantiate the UA properties
+	auto list = this->block()->client()->list();
+	value->updateErrorStatus(this->block()->getErrorStatus());
+	value->updateCompact(list && list->getCompactValues());
+	emit this->valuesAdded({ value });
+	return value;
+}
+
+QString QUaModbusValueList::addValues(const QString & strValueIds)
+{
+	QStringList listIds;
+	auto strError = QUaModbusClientList::expandIds(strValueIds, listIds);
+	if (strError.contains("Error", Qt::CaseInsensitive))
+	{
+		return strError;
 	}
-	// return
-	return "Success";
+	return this->addValues(listIds);
+}
+
+QString QUaModbusValueList::addValues(const QStringList & valueIds)
+{
+	if (valueIds.isEmpty())
+	{
+		return tr("%1 : Value Id list cannot be empty.").arg("Error");
+	}
+	// validate all first, so either all or none are created
+	QSet<QString> setIds;
+	for (auto value : this->values())
+	{
+		setIds.insert(value->browseName().name());
+	}
+	for (auto &strValueId : valueIds)
+	{
+		auto strError = QUaModbusValueList::checkValueId(strValueId);
+		if (!strError.isEmpty())
+		{
+			return QString("%1 [%2]").arg(strError).arg(strValueId);
+		}
+		if (setIds.contains(strValueId))
+		{
+			return tr("%1 : Value Id %2 already exists.").arg("Error").arg(strValueId);
+		}
+		setIds.insert(strValueId);
+	}
+	// create instances
+	auto strNodeIdBase = QString("modbus.%1.%2.")
+		.arg(this->block()->client()->browseName().name())
+		.arg(this->block()->browseName().name());
+	bool errorStatus = this->block()->getErrorStatus();
+	auto list        = this->block()->client()->list();
+	bool compact     = list && list->getCompactValues();
+	QList<QUaModbusValue*> listValues;
+	QString strResult = "Success";
+	{
+		// NOTE : views get a single valuesAdded instead of a childAdded per value
+		const QSignalBlocker blocker(this);
+		for (auto &strValueId : valueIds)
+		{
+			QUaNodeId nodeId = { 0, strNodeIdBase + strValueId };
+			auto value = this->addChild<QUaModbusValue>(strValueId, nodeId);
+			if (!value)
+			{
+				strResult = tr("%1 : NodeId %2 already exists.").arg("Error").arg(nodeId);
+				continue;
+			}
+			value->updateErrorStatus(errorStatus);
+			value->updateCompact(compact);
+			listValues << value;
+		}
+	}
+	if (!listValues.isEmpty())
+	{
+		emit this->valuesAdded(listValues);
+	}
+	return strResult;
 }
 
 void QUaModbusValueList::clear()
@@ -80,6 +147,33 @@ void QUaModbusValueList::clear()
 	}
 }
 
+QString QUaModbusValueList::checkValueId(const QString & strValueId)
+{
+	// check empty
+	if (strValueId.isEmpty())
+	{
+		return tr("%1 : Value Id argument cannot be empty.").arg("Error");
+	}
+	// check valid length
+	if (strValueId.count() > 130)
+	{
+		return tr("%1 : Value Id cannot contain more than 120 characters.").arg("Error");
+	}
+	// check not called Name
+	if (strValueId.compare("Name", Qt::CaseSensitive) == 0)
+	{
+		return tr("%1 : Value Id cannot be 'Name'.").arg("Error");
+	}
+	// check valid characters
+	static const QRegularExpression rx("^[a-zA-Z0-9_]*$");
+	QRegularExpressionMatch match = rx.match(strValueId, 0, QRegularExpression::PartialPreferCompleteMatch);
+	if (!match.hasMatch())
+	{
+		return tr("%1 : Value Id can only contain numbers, letters and underscores /^[a-zA-Z0-9_]*$/.").arg("Error");
+	}
+	return QString();
+}
+
 QUaModbusDataBlock * QUaModbusValueList::block()
 {
 	return qobject_cast<QUaModbusDataBlock*>(this->parent());
@@ -184,3 +278,73 @@ void QUaModbusValueList::fromDomElement(QDomElement & domElem, QQueue<QUaLog>& e
 		value->fromDomElement(elemValue, errorLogs);
 	}
 }
+
+void QUaModbusValueList::mergeDomElement(QDomElement & domElem, QQueue<QUaLog>& errorLogs, QUaModbusConfigDiff & diff)
+{
+#ifdef QUA_ACCESS_CONTROL
+	// load permissions if any
+	if (domElem.hasAttribute("Permissions") && !domElem.attribute("Permissions").isEmpty())
+	{
+		QString strError = this->setPermissions(domElem.attribute("Permissions"));
+		if (strError.contains("Error"))
+		{
+			errorLogs << QUaLog(
+				strError,
+				QUaLogLevel::Error,
+				QUaLogCategory::Serialization
+			);
+		}
+	}
+#endif // QUA_ACCESS_CONTROL
+	// values not found in domElem are removed at the end
+	QHash<QString, QUaModbusValue*> liveValues;
+	for (auto value : this->values())
+	{
+		liveValues.insert(value->browseName().name(), value);
+	}
+	for (auto elemValue = domElem.firstChildElement(QUaModbusValue::staticMetaObject.className()); 
+		!elemValue.isNull(); 
+		elemValue = elemValue.nextSiblingElement(QUaModbusValue::staticMetaObject.className()))
+	{
+		QString strBrowseName = elemValue.attribute("BrowseName");
+		if (strBrowseName.isEmpty())
+		{
+			errorLogs << QUaLog(
+				tr("Cannot add Value with empty BrowseName attribute. Skipping."),
+				QUaLogLevel::Error,
+				QUaLogCategory::Serialization
+			);
+			continue;
+		}
+		auto value = liveValues.take(strBrowseName);
+		if (value)
+		{
+			QDomDocument docLive;
+			if (QUaModbusClientList::attributesChanged(value->toDomElement(docLive), elemValue))
+			{
+				value->fromDomElement(elemValue, errorLogs);
+				diff.values.changed++;
+			}
+			continue;
+		}
+		auto strNewError = this->addValue(strBrowseName);
+		if (strNewError.contains("Error", Qt::CaseInsensitive))
+		{
+			errorLogs << QUaLog(
+				strNewError,
+				QUaLogLevel::Error,
+				QUaLogCategory::Serialization
+			);
+			continue;
+		}
+		value = this->browseChild<QUaModbusValue>(strBrowseName);
+		Q_CHECK_PTR(value);
+		value->fromDomElement(elemValue, errorLogs);
+		diff.values.added++;
+	}
+	for (auto value : liveValues)
+	{
+		value->remove();
+		diff.values.removed++;
+	}
+}
@@ -12,6 +12,7 @@
 
 class QUaModbusDataBlock;
 class QUaModbusValue;
+struct QUaModbusConfigDiff;
 
 #ifndef QUA_ACCESS_CONTROL
 class QUaModbusValueList : public QUaFolderObject
@@ -21,6 +22,8 @@ class QUaModbusValueList : public QUaFolderObjectProtected
 {
 	friend class QUaModbusDataBlock;
 	friend class QUaModbusValue;
+	friend class QUaModbusDataBlockList;
+	friend class QUaModbusClientList;
 
     Q_OBJECT
 
@@ -31,21 +34,37 @@ public:
 
 	Q_INVOKABLE QString addValue(const QUaQualifiedName& valueId);
 
+	// compact id specification, see QUaModbusClientList::expandIds
+	Q_INVOKABLE QString addValues(const QString &strValueIds);
+
 	Q_INVOKABLE void clear();
 
 	// C++ API
 
 	QList<QUaModbusValue*> values();
 
+	// all ids are validated before any value is created
+	QString addValues(const QStringList &valueIds);
+
 signals:
 	void aboutToClear();
+	// NOTE : values created by addValues do not emit childAdded, views must use this instead
+	void valuesAdded(const QList<QUaModbusValue*> &values);
 
 private:
 	QUaModbusDataBlock * block();
 
+	// returns error if id is not valid, empty otherwise
+	static QString checkValueId(const QString &strValueId);
+	// does not look for an existing value, so callers with their own index (csv import) do not
+	// browse the children. nullptr and strError if it fails
+	QUaModbusValue * createValue(const QUaQualifiedName &valueId, QString &strError);
+
 	// XML import / export
 	QDomElement toDomElement  (QDomDocument & domDoc) const;
 	void        fromDomElement(QDomElement  & domElem, QQueue<QUaLog>& errorLogs);
+	// only adds, removes or reconfigures the values that differ from domElem
+	void        mergeDomElement(QDomElement & domElem, QQueue<QUaLog>& errorLogs, QUaModbusConfigDiff &diff);
 
 };
 
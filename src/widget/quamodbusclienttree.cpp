@@ -121,15 +121,12 @@ QUaModelItemTraits::NewChildCallback<QUaNode*, 1>(
 	if (client)
 	{
 		auto blockList = client->dataBlocks();
-		return QObject::connect(blockList, &QUaNode::childAdded,
-			[callback](QUaNode* child) {
-				// only blocks
-				auto block = qobject_cast<QUaModbusDataBlock*>(child);
-				if (!block)
+		return QObject::connect(blockList, &QUaModbusDataBlockList::blocksAdded,
+			[callback](const QList<QUaModbusDataBlock*> &blocks) {
+				for (auto block : blocks)
 				{
-					return;
+					callback(block);
 				}
-				callback(block);
 			});
 	}
 	// handle block
@@ -137,15 +134,12 @@ QUaModelItemTraits::NewChildCallback<QUaNode*, 1>(
 	if (block)
 	{
 		auto valueList = block->values();
-		return QObject::connect(valueList, &QUaNode::childAdded,
-			[callback](QUaNode* child) {
-				// only values
-				auto value = qobject_cast<QUaModbusValue*>(child);
-				if (!value)
+		return QObject::connect(valueList, &QUaModbusValueList::valuesAdded,
+			[callback](const QList<QUaModbusValue*> &values) {
+				for (auto value : values)
 				{
-					return;
+					callback(value);
 				}
-				callback(value);
 			});
 	}
 	// values have no children
@@ -410,9 +404,9 @@ void QUaModbusClientTree::setClientList(QUaModbusClientList * listClients)
 			auto block = qobject_cast<QUaModbusDataBlock*>(node);
 			if (block)
 			{
+				// NOTE : LastError might not exist, see QUaModbusClientList::ErrorStatusCodes
 				auto enumError = QMetaEnum::fromType<QModbusError>();
-				auto error     = block->lastError();
-				auto modError  = error->value().value<QModbusError>();
+				auto modError  = block->getLastError();
 				auto strError  = QString(enumError.valueToKey(modError));
 				return strError;
 			}
@@ -420,8 +414,7 @@ void QUaModbusClientTree::setClientList(QUaModbusClientList * listClients)
 			if (value)
 			{
 				auto enumError = QMetaEnum::fromType<QModbusError>();
-				auto error     = value->lastError();
-				auto modError  = error->value().value<QModbusError>();
+				auto modError  = value->getLastError();
 				auto strError  = QString(enumError.valueToKey(modError));
 				return strError;
 			}
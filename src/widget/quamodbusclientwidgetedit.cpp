@@ -4,6 +4,7 @@
 #include <QMetaEnum>
 
 #include <QUaModbusRtuSerialClient>
+#include <QUaModbusSerialPortRegistry>
 
 #include <QUaWidgetEventFilter>
 
@@ -24,13 +25,10 @@ QUaModbusClientWidgetEdit::QUaModbusClientWidgetEdit(QWidget *parent) :
 	}
 	auto comboBoxTypeEventHandler = new QUaWidgetEventFilter(ui->comboBoxType);
 	comboBoxTypeEventHandler->installEventCallback(QEvent::Wheel, blockWheel);	
-	// setup com port combo
-	auto mapComPorts = QUaModbusRtuSerialClient::EnumComPorts();
-	for (int i = 0; i < mapComPorts.keys().count(); i++)
-	{
-		auto strComPort = QString(mapComPorts.value(mapComPorts.keys().at(i)).displayName.text());
-		ui->comboBoxComPort->addItem(strComPort, mapComPorts.keys().at(i));
-	}
+	// setup com port combo, updated on hotplug
+	this->updateComPorts();
+	QObject::connect(QUaModbusSerialPortRegistry::instance(), &QUaModbusSerialPortRegistry::portsChanged,
+		this, &QUaModbusClientWidgetEdit::updateComPorts);
 	auto comboBoxComPortEventHandler = new QUaWidgetEventFilter(ui->comboBoxComPort);
 	comboBoxComPortEventHandler->installEventCallback(QEvent::Wheel, blockWheel);
 	// setup parity combo
@@ -79,9 +77,9 @@ QUaModbusClientWidgetEdit::QUaModbusClientWidgetEdit(QWidget *parent) :
 	this->setNetworkPort(502);
 	this->setKeepConnecting(false);
 	this->setIpAddress("127.0.0.1");
-	if (mapComPorts.count() > 0)
+	if (ui->comboBoxComPort->count() > 0)
 	{
-		this->setComPort(QString(mapComPorts.value(mapComPorts.keys().at(0)).displayName.text()));
+		ui->comboBoxComPort->setCurrentIndex(0);
 	}
 	this->setParity(QParity::EvenParity);
 	this->setBaudRate(QBaudRate::Baud19200);
@@ -286,18 +284,25 @@ void QUaModbusClientWidgetEdit::setComPort(const QString & strComPort)
 
 int QUaModbusClientWidgetEdit::comPortKey() const
 {
-	auto strComPort  = this->comPort();
-	auto mapComPorts = QUaModbusRtuSerialClient::EnumComPorts();
-	return mapComPorts.key({ 
-		{ "", strComPort.toUtf8() },
-		{ "", "" }
-	}, -1);
+	return QUaModbusSerialPortRegistry::instance()->portKey(this->comPort(), -1);
 }
 
 void QUaModbusClientWidgetEdit::setComPortKey(const int & comPortKey)
 {
-	auto mapComPorts = QUaModbusRtuSerialClient::EnumComPorts();
-	this->setComPort(mapComPorts.value(comPortKey).displayName.text());
+	this->setComPort(QUaModbusSerialPortRegistry::instance()->portName(comPortKey));
+}
+
+void QUaModbusClientWidgetEdit::updateComPorts()
+{
+	// NOTE : unplugged ports are kept, so a client using one can still be shown and edited
+	auto strComPort  = this->comPort();
+	auto mapComPorts = QUaModbusSerialPortRegistry::instance()->ports();
+	ui->comboBoxComPort->clear();
+	for (auto it = mapComPorts.begin(); it != mapComPorts.end(); ++it)
+	{
+		ui->comboBoxComPort->addItem(QString(it.value().displayName.text()), it.key());
+	}
+	this->setComPort(strComPort);
 }
 
 QParity QUaModbusClientWidgetEdit::parity() const
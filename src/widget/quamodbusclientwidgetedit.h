@@ -93,6 +93,7 @@ public:
 
 private slots:
     void on_comboBoxType_currentIndexChanged(int index);
+	void updateComPorts();
 
 private:
     Ui::QUaModbusClientWidgetEdit *ui;
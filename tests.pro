@@ -6,14 +6,26 @@ amalgamation \
 qadvanceddocking \
 01_console \
 02_widget \
-03_access_control
+03_access_control \
+04_bench_southbound \
+05_bench_codecs \
+06_bench_config \
+07_test_config
 # directories
 amalgamation.subdir      = $$PWD/libs/QUaServer.git/src/amalgamation
 qadvanceddocking.subdir  = $$PWD/libs/QAdvancedDocking.git/src
 01_console.subdir        = $$PWD/tests/01_console
 02_widget.subdir         = $$PWD/tests/02_widget
 03_access_control.subdir = $$PWD/tests/03_access_control
+04_bench_southbound.subdir = $$PWD/tests/04_bench_southbound
+05_bench_codecs.subdir     = $$PWD/tests/05_bench_codecs
+06_bench_config.subdir     = $$PWD/tests/06_bench_config
+07_test_config.subdir      = $$PWD/tests/07_test_config
 # dependencies
 01_console.depends         = amalgamation
 02_widget.depends          = amalgamation
 03_access_control.depends  = amalgamation qadvanceddocking
+04_bench_southbound.depends = amalgamation
+05_bench_codecs.depends     = amalgamation
+06_bench_config.depends     = amalgamation
+07_test_config.depends      = amalgamation
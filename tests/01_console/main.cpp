@@ -14,7 +14,14 @@ int main(int argc, char *argv[])
 	QUaFolderObject * objsFolder = server.objectsFolder();
 
 	// add list entry point to object's folder
-	objsFolder->addChild<QUaModbusClientList>("ModbusClients");
+	auto modCliList = objsFolder->addChild<QUaModbusClientList>("ModbusClients");
+	// runtime messages of the list
+	QObject::connect(modCliList, &QUaModbusClientList::logMessage, &a,
+	[](const QUaLog &log) {
+		QQueue<QUaLog> logs;
+		logs << log;
+		qWarning().noquote() << QUaLog::toString(logs);
+	});
 
 	server.start();
 
@@ -6,6 +6,7 @@
 #include <QFileDialog>
 #include <QStandardPaths>
 #include <QMessageBox>
+#include <QDebug>
 
 #include <QUaModbusClientList>
 #include <QUaModbusClient>
@@ -37,6 +38,13 @@ QUaModbusClientWidgetTest::QUaModbusClientWidgetTest(QWidget *parent) :
 	auto modCliList = objsFolder->addChild<QUaModbusClientList>("ModbusClients", "ns=0;s=modbus.clients");
 	// set client list into widget
 	ui->widgetModbus->setClientList(modCliList);
+	// runtime messages of the list
+	QObject::connect(modCliList, &QUaModbusClientList::logMessage, this,
+	[](const QUaLog &log) {
+		QQueue<QUaLog> logs;
+		logs << log;
+		qWarning().noquote() << QUaLog::toString(logs);
+	});
 
 	// change widgets
 	QObject::connect(ui->widgetModbus, &QUaModbusClientTree::nodeSelectionChanged, this,
@@ -119,10 +127,16 @@ void QUaModbusClientWidgetTest::on_pushButtonImport_clicked()
 		// load config into client list
 		auto modCliList = m_server.objectsFolder()->browseChild<QUaModbusClientList>("ModbusClients");
 		Q_CHECK_PTR(modCliList);
-		auto strError   = modCliList->setXmlConfig(fileConfig.readAll());
-		if (strError.contains("Error"))
+		// NOTE : streamed from file, no need to hold whole config in memory
+		auto errorLogs = modCliList->readXmlConfig(&fileConfig);
+		bool hasError  = false;
+		for (auto &errorLog : errorLogs)
+		{
+			hasError = hasError || errorLog.level == QUaLogLevel::Error;
+		}
+		if (hasError)
 		{
-			msgBox.setText(strError);
+			msgBox.setText(QUaLog::toString(errorLogs));
 			msgBox.exec();
 			return;
 		}
@@ -154,9 +168,8 @@ void QUaModbusClientWidgetTest::on_pushButtonExport_clicked()
 		// convert config to xml
 		auto modCliList = m_server.objectsFolder()->browseChild<QUaModbusClientList>("ModbusClients");
 		Q_CHECK_PTR(modCliList);
-		// get config
-		QTextStream stream(&file);
-		stream << modCliList->xmlConfig();
+		// write config
+		modCliList->writeXmlConfig(&file);
 	}
 	else
 	{
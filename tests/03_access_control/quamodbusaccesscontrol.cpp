@@ -11,6 +11,7 @@
 #include <QMessageBox>
 #include <QInputDialog>
 #include <QDockWidget>
+#include <QDebug>
 
 #include <QUaAcCommonDialog>
 #include <QUaDockWidgetPerms>
@@ -334,7 +335,14 @@ void QUaModbusAccessControl::setupInfoModel()
 	QUaFolderObject * objsFolder = m_server.objectsFolder();
 	auto ac = objsFolder->addChild<QUaAccessControl>("AccessControl");
 	// setup modbus gateway information model
-	objsFolder->addChild<QUaModbusClientList>("ModbusClients");
+	auto mod = objsFolder->addChild<QUaModbusClientList>("ModbusClients");
+	// runtime messages of the list
+	QObject::connect(mod, &QUaModbusClientList::logMessage, this,
+	[](const QUaLog &log) {
+		QQueue<QUaLog> logs;
+		logs << log;
+		qWarning().noquote() << QUaLog::toString(logs);
+	});
 
 	// disable anon login
 	m_server.setAnonymousLoginAllowed(false);
@@ -752,14 +760,16 @@ void QUaModbusAccessControl::setRootPermissionsToLists(QUaUser * root)
 			handleBlockAdded(block);
 		}
 		// subscribe to block added
-		// NOTE : needs to be a queued connection because we want to wait until browseName is set
+		// NOTE : bulk added blocks do not emit childAdded, blocksAdded is emitted once browseName is set
 		m_connsModPerms <<
-		QObject::connect(listBlocks, &QUaNode::childAdded, this,
-		[this, client, handleBlockAdded](QUaNode * node) {
-			auto block = dynamic_cast<QUaModbusDataBlock*>(node);
-			Q_CHECK_PTR(block);
-			handleBlockAdded(block);
-		}, Qt::QueuedConnection);
+		QObject::connect(listBlocks, &QUaModbusDataBlockList::blocksAdded, this,
+		[handleBlockAdded](const QList<QUaModbusDataBlock*> &blocks) {
+			for (auto block : blocks)
+			{
+				Q_CHECK_PTR(block);
+				handleBlockAdded(block);
+			}
+		});
 	};
 	// handle existing clients
 	for (auto client : mod->clients())
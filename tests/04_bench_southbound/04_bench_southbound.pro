@@ -0,0 +1,24 @@
+QT += core
+QT -= gui
+
+TARGET  = 04_bench_southbound
+CONFIG += console
+CONFIG -= app_bundle
+
+TEMPLATE = app
+
+INCLUDEPATH += $$PWD/
+
+SOURCES += \
+main.cpp \
+quamodbusconfiggenerator.cpp \
+quamodbussimulator.cpp
+
+HEADERS += \
+quamodbusconfiggenerator.h \
+quamodbussimulator.h
+
+include($$PWD/../../src/types/quamodbusclient.pri)
+include($$PWD/../../libs/QDeferred.git/src/qlambdathreadworker.pri)
+include($$PWD/../../libs/QUaServer.git/src/wrapper/quaserver.pri)
+include($$PWD/../../libs/QUaServer.git/src/helper/add_qt_path_win.pri)
@@ -0,0 +1,311 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QFile>
+#include <QDir>
+#include <QMap>
+#include <QVector>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QTextStream>
+
+#include <QUaServer>
+
+#include <QUaModbusClientList>
+#include <QUaModbusClient>
+#include <QUaModbusDataBlock>
+#include <QUaModbusDiagnostics>
+
+#include "quamodbusconfiggenerator.h"
+#include "quamodbussimulator.h"
+
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#endif // Q_OS_LINUX
+
+// cpu time (in milliseconds) per thread name, empty if not supported
+QMap<QString, double> threadCpuTimes()
+{
+	QMap<QString, double> times;
+#ifdef Q_OS_LINUX
+	double msPerTick = 1000.0 / sysconf(_SC_CLK_TCK);
+	QDir tasks("/proc/self/task");
+	for (auto strTid : tasks.entryList(QDir::Dirs | QDir::NoDotAndDotDot))
+	{
+		QFile fileStat(tasks.filePath(strTid + "/stat"));
+		QFile fileComm(tasks.filePath(strTid + "/comm"));
+		if (!fileStat.open(QIODevice::ReadOnly) || !fileComm.open(QIODevice::ReadOnly))
+		{
+			continue;
+		}
+		// fields after the command name, utime and stime are 14th and 15th overall
+		auto strStat = QString::fromUtf8(fileStat.readAll());
+		auto fields  = strStat.mid(strStat.lastIndexOf(')') + 2).split(' ');
+		if (fields.count() < 13)
+		{
+			continue;
+		}
+		auto ticks   = fields.at(11).toDouble() + fields.at(12).toDouble();
+		auto strName = QString("%1 (%2)").arg(QString::fromUtf8(fileComm.readAll()).trimmed()).arg(strTid);
+		times[strName] = ticks * msPerTick;
+	}
+#endif // Q_OS_LINUX
+	return times;
+}
+
+// resident set size in kB, -1 if not supported
+qint64 residentSetSize(const QString &strField = "VmRSS")
+{
+#ifdef Q_OS_LINUX
+	QFile fileStatus("/proc/self/status");
+	if (!fileStatus.open(QIODevice::ReadOnly))
+	{
+		return -1;
+	}
+	for (auto line : QString::fromUtf8(fileStatus.readAll()).split('\n'))
+	{
+		if (line.startsWith(strField + ":"))
+		{
+			return line.mid(strField.length() + 1).trimmed().split(' ').first().toLongLong();
+		}
+	}
+#else
+	Q_UNUSED(strField);
+#endif // Q_OS_LINUX
+	return -1;
+}
+
+struct Counters
+{
+	quint64 requests  = 0;
+	quint64 replies   = 0;
+	quint64 timeouts  = 0;
+	quint64 errors    = 0;
+	quint64 bytesSent = 0;
+	quint64 bytesRecv = 0;
+	quint64 overruns  = 0;
+	quint64 deferrals = 0;
+};
+
+// round trip time histogram of all clients since they were created
+QVector<quint32> rttHistogram(QUaModbusClientList * list)
+{
+	QVector<quint32> histogram(QUaModbusMetrics::m_rttBucketCount, 0);
+	for (auto client : list->clients())
+	{
+		for (int i = 0; i < QUaModbusMetrics::m_rttBucketCount; i++)
+		{
+			histogram[i] += client->metrics().rttCount(i);
+		}
+	}
+	return histogram;
+}
+
+// sum of the published diagnostics of all clients and blocks
+Counters readCounters(QUaModbusClientList * list)
+{
+	Counters counters;
+	for (auto client : list->clients())
+	{
+		auto diagnostics = client->browseChild<QUaModbusDiagnostics>("Diagnostics");
+		if (!diagnostics)
+		{
+			continue;
+		}
+		counters.requests  += diagnostics->requestsSent ()->value().toULongLong();
+		counters.replies   += diagnostics->replies      ()->value().toULongLong();
+		counters.timeouts  += diagnostics->timeouts     ()->value().toULongLong();
+		counters.errors    += diagnostics->errors       ()->value().toULongLong();
+		counters.bytesSent += diagnostics->bytesSent    ()->value().toULongLong();
+		counters.bytesRecv += diagnostics->bytesReceived()->value().toULongLong();
+		for (auto block : client->dataBlocks()->blocks())
+		{
+			auto blockDiagnostics = block->browseChild<QUaModbusDataBlockDiagnostics>("Diagnostics");
+			if (!blockDiagnostics)
+			{
+				continue;
+			}
+			counters.overruns  += blockDiagnostics->overruns ()->value().toULongLong();
+			counters.deferrals += blockDiagnostics->deferrals()->value().toULongLong();
+		}
+	}
+	return counters;
+}
+
+int main(int argc, char *argv[])
+{
+	QCoreApplication a(argc, argv);
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription("Southbound load benchmark against simulated Modbus TCP devices.");
+	parser.addHelpOption();
+	QCommandLineOption optDevices ("devices" , "Number of simulated devices (one client each).", "n"   , "10"   );
+	QCommandLineOption optBlocks  ("blocks"  , "Data blocks per device."                       , "n"   , "4"    );
+	QCommandLineOption optSize    ("size"    , "Registers per block."                          , "n"   , "64"   );
+	QCommandLineOption optValues  ("values"  , "Converted values per block."                   , "n"   , "8"    );
+	QCommandLineOption optSampling("sampling", "Block sampling time."                          , "ms"  , "100"  );
+	QCommandLineOption optLatency ("latency" , "Simulated device response latency."            , "ms"  , "0"    );
+	QCommandLineOption optWarmup  ("warmup"  , "Time to connect and settle before measuring."   , "s"   , "3"    );
+	QCommandLineOption optDuration("duration", "Measurement duration."                         , "s"   , "30"   );
+	QCommandLineOption optPort    ("port"    , "First simulated device port."                  , "port", "15020");
+	QCommandLineOption optJson    ("json"    , "Also write results as JSON to file."           , "file");
+	parser.addOptions({ optDevices, optBlocks, optSize, optValues, optSampling,
+		optLatency, optWarmup, optDuration, optPort, optJson });
+	parser.process(a);
+
+	int     devices  = parser.value(optDevices ).toInt();
+	int     blocks   = parser.value(optBlocks  ).toInt();
+	int     size     = parser.value(optSize    ).toInt();
+	int     values   = parser.value(optValues  ).toInt();
+	quint32 sampling = parser.value(optSampling).toUInt();
+	quint32 latency  = parser.value(optLatency ).toUInt();
+	int     warmup   = parser.value(optWarmup  ).toInt();
+	int     duration = parser.value(optDuration).toInt();
+	quint16 port     = static_cast<quint16>(parser.value(optPort).toUInt());
+
+	QTextStream out(stdout);
+
+	// start simulated devices
+	QUaModbusSimulator simulator;
+	if (!simulator.start(port, devices, static_cast<quint16>(blocks * size), latency))
+	{
+		out << "Error : failed to start simulated devices on ports " << port << " to " << port + devices - 1 << endl;
+		return 1;
+	}
+
+	// NOTE : ua server is not started, the address space is all that is needed
+	QUaServer server;
+	QUaFolderObject * objsFolder = server.objectsFolder();
+	auto list = objsFolder->addChild<QUaModbusClientList>("ModbusClients");
+	// one tcp client per simulated device, blocks split the device registers
+	QUaModbusConfigGenerator generator;
+	generator.clients      = devices;
+	generator.blocks       = blocks;
+	generator.size         = size;
+	generator.values       = values;
+	generator.samplingTime = sampling;
+	generator.basePort     = port;
+	generator.ports        = devices;
+	generator.diagnostics  = true;
+	auto strResult = list->setXmlConfig(generator.xml());
+	if (strResult.contains("Error"))
+	{
+		out << strResult << endl;
+		return 1;
+	}
+	for (auto client : list->clients())
+	{
+		client->connectDevice();
+	}
+
+	// measure in windows of one second
+	QElapsedTimer clock;
+	clock.start();
+	Counters countersStart;
+	Counters countersLast;
+	QMap<QString, double> cpuStart;
+	QVector<quint32> rttStart;
+	qint64 runStart = -1;
+	QTimer timer;
+	QObject::connect(&timer, &QTimer::timeout, [&]() {
+		// start measuring after warmup
+		if (runStart < 0 && clock.elapsed() >= 1000 * warmup)
+		{
+			runStart      = clock.elapsed();
+			countersStart = readCounters(list);
+			cpuStart      = threadCpuTimes();
+			rttStart      = rttHistogram(list);
+			return;
+		}
+		if (runStart < 0 || clock.elapsed() - runStart < 1000 * duration)
+		{
+			return;
+		}
+		timer.stop();
+		// results
+		double seconds = (clock.elapsed() - runStart) / 1000.0;
+		auto countersEnd = readCounters(list);
+		auto cpuEnd = threadCpuTimes();
+		// percentiles of all replies in the run, not an average of published ones
+		auto rttEnd = rttHistogram(list);
+		quint32 rttTotal = 0;
+		for (int i = 0; i < rttEnd.count(); i++)
+		{
+			rttEnd[i] -= rttStart.at(i);
+			rttTotal  += rttEnd.at(i);
+		}
+		double polls = countersEnd.replies - countersStart.replies;
+		QJsonObject results;
+		results["devices"      ] = devices;
+		results["blocks"       ] = devices * blocks;
+		results["values"       ] = generator.tagCount();
+		results["samplingTime" ] = static_cast<double>(sampling);
+		results["latency"      ] = static_cast<double>(latency);
+		results["duration"     ] = seconds;
+		results["pollsPerSec"  ] = polls / seconds;
+		results["targetPerSec" ] = sampling > 0 ? devices * blocks * 1000.0 / sampling : 0.0;
+		results["requests"     ] = static_cast<double>(countersEnd.requests  - countersStart.requests );
+		results["timeouts"     ] = static_cast<double>(countersEnd.timeouts  - countersStart.timeouts );
+		results["errors"       ] = static_cast<double>(countersEnd.errors    - countersStart.errors   );
+		results["overruns"     ] = static_cast<double>(countersEnd.overruns  - countersStart.overruns );
+		results["deferrals"    ] = static_cast<double>(countersEnd.deferrals - countersStart.deferrals);
+		results["bytesSentPerSec"] = (countersEnd.bytesSent - countersStart.bytesSent) / seconds;
+		results["bytesRecvPerSec"] = (countersEnd.bytesRecv - countersStart.bytesRecv) / seconds;
+		results["rttP50"       ] = rttTotal > 0 ? QUaModbusMetrics::rttPercentile(rttEnd.constData(), rttTotal, 0.50) : 0.0;
+		results["rttP95"       ] = rttTotal > 0 ? QUaModbusMetrics::rttPercentile(rttEnd.constData(), rttTotal, 0.95) : 0.0;
+		results["rttP99"       ] = rttTotal > 0 ? QUaModbusMetrics::rttPercentile(rttEnd.constData(), rttTotal, 0.99) : 0.0;
+		results["rssKb"        ] = static_cast<double>(residentSetSize());
+		results["rssPeakKb"    ] = static_cast<double>(residentSetSize("VmHWM"));
+		QJsonArray threads;
+		for (auto it = cpuEnd.begin(); it != cpuEnd.end(); ++it)
+		{
+			double cpu = 100.0 * (it.value() - cpuStart.value(it.key(), 0.0)) / (1000.0 * seconds);
+			threads.append(QJsonObject({ { "thread", it.key() }, { "cpuPercent", cpu } }));
+		}
+		results["threads"] = threads;
+		// report
+		out << QString("Devices %1, blocks %2, values %3, sampling %4 ms, latency %5 ms, %6 s")
+			.arg(devices).arg(results["blocks"].toInt()).arg(results["values"].toInt())
+			.arg(sampling).arg(latency).arg(seconds, 0, 'f', 1) << endl;
+		out << QString("Polls/sec     : %1 (target %2)")
+			.arg(results["pollsPerSec"].toDouble(), 0, 'f', 1)
+			.arg(results["targetPerSec"].toDouble(), 0, 'f', 1) << endl;
+		out << QString("RTT p50/95/99 : %1 / %2 / %3 ms")
+			.arg(results["rttP50"].toDouble(), 0, 'f', 2)
+			.arg(results["rttP95"].toDouble(), 0, 'f', 2)
+			.arg(results["rttP99"].toDouble(), 0, 'f', 2) << endl;
+		out << QString("Timeouts %1, errors %2, overruns %3, deferrals %4")
+			.arg(results["timeouts"].toDouble()).arg(results["errors"].toDouble())
+			.arg(results["overruns"].toDouble()).arg(results["deferrals"].toDouble()) << endl;
+		out << QString("Wire          : %1 B/s sent, %2 B/s received")
+			.arg(results["bytesSentPerSec"].toDouble(), 0, 'f', 0)
+			.arg(results["bytesRecvPerSec"].toDouble(), 0, 'f', 0) << endl;
+		out << QString("RSS           : %1 kB (peak %2 kB)")
+			.arg(results["rssKb"].toDouble()).arg(results["rssPeakKb"].toDouble()) << endl;
+		for (auto thread : threads)
+		{
+			auto objThread = thread.toObject();
+			if (objThread["cpuPercent"].toDouble() < 0.1)
+			{
+				continue;
+			}
+			out << QString("CPU %1 % : %2")
+				.arg(objThread["cpuPercent"].toDouble(), 6, 'f', 1)
+				.arg(objThread["thread"].toString()) << endl;
+		}
+		if (parser.isSet(optJson))
+		{
+			QFile fileJson(parser.value(optJson));
+			if (fileJson.open(QIODevice::WriteOnly | QIODevice::Truncate))
+			{
+				fileJson.write(QJsonDocument(results).toJson());
+			}
+		}
+		a.quit();
+	});
+	timer.start(1000);
+
+	return a.exec();
+}
@@ -0,0 +1,165 @@
+#include "quamodbusconfiggenerator.h"
+
+#include <QXmlStreamWriter>
+#include <QBuffer>
+
+// types that use at most two registers, so values can be two registers apart
+static const char * valueTypes[] = { "Decimal", "Int", "Float", "IntSwapped", "FloatSwapped" };
+
+QUaModbusConfigGenerator::QUaModbusConfigGenerator()
+{
+	clients        = 2000;
+	blocks         = 20;
+	values         = 50;
+	size           = 0;
+	samplingTime   = 1000;
+	networkAddress = "127.0.0.1";
+	basePort       = 15020;
+	ports          = 1;
+	diagnostics    = false;
+	keepConnecting = true;
+}
+
+int QUaModbusConfigGenerator::blockSize() const
+{
+	return size > 0 ? size : 2 * qBound(1, values, m_maxValues);
+}
+
+int QUaModbusConfigGenerator::valueCount() const
+{
+	return qMin(qBound(1, values, m_maxValues), this->blockSize() / 2);
+}
+
+int QUaModbusConfigGenerator::registerCount() const
+{
+	return blocks * this->blockSize();
+}
+
+int QUaModbusConfigGenerator::tagCount() const
+{
+	return clients * blocks * this->valueCount();
+}
+
+void QUaModbusConfigGenerator::writeXml(QIODevice * device) const
+{
+	int valueCount = this->valueCount();
+	QXmlStreamWriter xml(device);
+	xml.setAutoFormatting(true);
+	xml.writeStartDocument();
+	xml.writeStartElement("QUaModbusClientList");
+	for (int c = 0; c < clients; c++)
+	{
+		xml.writeStartElement("QUaModbusTcpClient");
+		xml.writeAttribute("BrowseName"    , this->clientName(c));
+		xml.writeAttribute("ServerAddress" , "1");
+		xml.writeAttribute("KeepConnecting", keepConnecting ? "1" : "0");
+		xml.writeAttribute("NetworkAddress", networkAddress);
+		xml.writeAttribute("NetworkPort"   , QString::number(basePort + c % qMax(1, ports)));
+		if (diagnostics)
+		{
+			xml.writeAttribute("DiagnosticsEnabled", "1");
+		}
+		xml.writeStartElement("QUaModbusDataBlockList");
+		for (int b = 0; b < blocks; b++)
+		{
+			xml.writeStartElement("QUaModbusDataBlock");
+			xml.writeAttribute("BrowseName"  , this->blockName(b));
+			xml.writeAttribute("Type"        , "HoldingRegisters");
+			xml.writeAttribute("Address"     , QString::number(b * this->blockSize()));
+			xml.writeAttribute("Size"        , QString::number(this->blockSize()));
+			xml.writeAttribute("SamplingTime", QString::number(samplingTime));
+			xml.writeStartElement("QUaModbusValueList");
+			for (int v = 0; v < valueCount; v++)
+			{
+				xml.writeStartElement("QUaModbusValue");
+				xml.writeAttribute("BrowseName"   , this->valueName(v));
+				xml.writeAttribute("Type"         , valueTypes[v % 5]);
+				xml.writeAttribute("AddressOffset", QString::number(2 * v));
+				xml.writeEndElement(); // QUaModbusValue
+			}
+			xml.writeEndElement(); // QUaModbusValueList
+			xml.writeEndElement(); // QUaModbusDataBlock
+		}
+		xml.writeEndElement(); // QUaModbusDataBlockList
+		xml.writeEndElement(); // QUaModbusTcpClient
+	}
+	xml.writeEndElement(); // QUaModbusClientList
+	xml.writeEndDocument();
+}
+
+QString QUaModbusConfigGenerator::xml() const
+{
+	QBuffer buffer;
+	buffer.open(QIODevice::WriteOnly);
+	this->writeXml(&buffer);
+	return QString::fromUtf8(buffer.data());
+}
+
+QString QUaModbusConfigGenerator::csvClients() const
+{
+	QString strCsv = "Name, Type, ServerAddress, KeepConnecting, NetworkAddress, NetworkPort\n";
+	for (int c = 0; c < clients; c++)
+	{
+		strCsv += QString("%1, Tcp, 1, %2, %3, %4\n")
+			.arg(this->clientName(c))
+			.arg(keepConnecting ? 1 : 0)
+			.arg(networkAddress)
+			.arg(basePort + c % qMax(1, ports));
+	}
+	return strCsv;
+}
+
+QString QUaModbusConfigGenerator::csvBlocks() const
+{
+	QString strCsv = "Name, Client, Type, Address, Size, SamplingTime\n";
+	for (int c = 0; c < clients; c++)
+	{
+		for (int b = 0; b < blocks; b++)
+		{
+			strCsv += QString("%1, %2, HoldingRegisters, %3, %4, %5\n")
+				.arg(this->blockName(b))
+				.arg(this->clientName(c))
+				.arg(b * this->blockSize())
+				.arg(this->blockSize())
+				.arg(samplingTime);
+		}
+	}
+	return strCsv;
+}
+
+QString QUaModbusConfigGenerator::csvValues() const
+{
+	int valueCount = this->valueCount();
+	QString strCsv = "Name, Client, Block, Type, AddressOffset\n";
+	for (int c = 0; c < clients; c++)
+	{
+		for (int b = 0; b < blocks; b++)
+		{
+			for (int v = 0; v < valueCount; v++)
+			{
+				strCsv += QString("%1, %2, %3, %4, %5\n")
+					.arg(this->valueName(v))
+					.arg(this->clientName(c))
+					.arg(this->blockName(b))
+					.arg(valueTypes[v % 5])
+					.arg(2 * v);
+			}
+		}
+	}
+	return strCsv;
+}
+
+QString QUaModbusConfigGenerator::clientName(const int & client) const
+{
+	return QString("Client%1").arg(client);
+}
+
+QString QUaModbusConfigGenerator::blockName(const int & block) const
+{
+	return QString("Block%1").arg(block);
+}
+
+QString QUaModbusConfigGenerator::valueName(const int & value) const
+{
+	return QString("Value%1").arg(value);
+}
@@ -0,0 +1,49 @@
+#ifndef QUAMODBUSCONFIGGENERATOR_H
+#define QUAMODBUSCONFIGGENERATOR_H
+
+#include <QString>
+#include <QIODevice>
+
+// Synthetic configuration of arbitrary size, in the same XML schema as
+// QUaModbusClientList::xmlConfig and the same CSV columns as csvClients/Blocks/Values
+class QUaModbusConfigGenerator
+{
+public:
+	QUaModbusConfigGenerator();
+
+	int     clients;        // tcp clients
+	int     blocks;         // holding register blocks per client
+	int     values;         // values per block, two registers apart
+	int     size;           // registers per block, 0 to just fit the values
+	quint32 samplingTime;   // block sampling time in ms
+	QString networkAddress;
+	quint16 basePort;
+	int     ports;          // clients are spread round robin over ports
+	bool    diagnostics;    // publish client and block diagnostics (xml only)
+	bool    keepConnecting; // clients connect on their own once loaded
+
+	// registers per block
+	int blockSize() const;
+	// values per block, limited by the block size
+	int valueCount() const;
+	// registers needed per client, blocks are laid out one after the other
+	int registerCount() const;
+	int tagCount() const;
+
+	void    writeXml(QIODevice * device) const;
+	QString xml() const;
+	QString csvClients() const;
+	QString csvBlocks() const;
+	QString csvValues() const;
+
+	QString clientName(const int &client) const;
+	QString blockName (const int &block ) const;
+	QString valueName (const int &value ) const;
+
+	// max values per block so it fits a single read request
+	static const int m_maxValues = 62;
+	// registers of a client, the most a simulated device holds
+	static const int m_maxRegisters = 65535;
+};
+
+#endif // QUAMODBUSCONFIGGENERATOR_H
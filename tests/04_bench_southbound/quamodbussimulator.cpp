@@ -0,0 +1,110 @@
+#include "quamodbussimulator.h"
+
+#include <QThread>
+#include <QSemaphore>
+#include <QAtomicInt>
+
+#ifdef Q_OS_LINUX
+#include <pthread.h>
+#endif // Q_OS_LINUX
+
+QUaModbusSimulatedServer::QUaModbusSimulatedServer(const quint32 &latency, QObject *parent)
+	: QModbusTcpServer(parent)
+{
+	m_latency = latency;
+}
+
+QModbusResponse QUaModbusSimulatedServer::processRequest(const QModbusPdu &request)
+{
+	if (m_latency > 0)
+	{
+		QThread::msleep(m_latency);
+	}
+	return QModbusTcpServer::processRequest(request);
+}
+
+QUaModbusSimulator::QUaModbusSimulator(QObject *parent)
+	: QObject(parent)
+{
+}
+
+QUaModbusSimulator::~QUaModbusSimulator()
+{
+	this->stop();
+}
+
+bool QUaModbusSimulator::start(const quint16 &basePort, const int &devices, const quint16 &registers, const quint32 &latency)
+{
+	this->stop();
+	QSemaphore started;
+	QAtomicInt failed(0);
+	// NOTE : sized before the threads start, each one only writes its own slot through a raw
+	//        pointer, so no thread detaches or reallocates the shared container
+	m_servers.fill(nullptr, devices);
+	auto servers = m_servers.data();
+	for (int i = 0; i < devices; i++)
+	{
+		auto thread = new QLambdaThreadWorker;
+		m_threads << thread;
+		quint16 port = basePort + static_cast<quint16>(i);
+		// instantiate in thread so it runs on the thread
+		thread->execInThread([servers, i, port, registers, latency, &started, &failed]() {
+#ifdef Q_OS_LINUX
+			// name thread so it can be told apart in the cpu report
+			pthread_setname_np(pthread_self(), QString("sim%1").arg(i).left(15).toUtf8().constData());
+#endif // Q_OS_LINUX
+			auto server = new QUaModbusSimulatedServer(latency);
+			// all register types, holding registers hold their own address
+			QModbusDataUnitMap map;
+			map.insert(QModbusDataUnit::Coils           , QModbusDataUnit(QModbusDataUnit::Coils           , 0, registers));
+			map.insert(QModbusDataUnit::DiscreteInputs  , QModbusDataUnit(QModbusDataUnit::DiscreteInputs  , 0, registers));
+			map.insert(QModbusDataUnit::InputRegisters  , QModbusDataUnit(QModbusDataUnit::InputRegisters  , 0, registers));
+			map.insert(QModbusDataUnit::HoldingRegisters, QModbusDataUnit(QModbusDataUnit::HoldingRegisters, 0, registers));
+			server->setMap(map);
+			for (quint16 address = 0; address < registers; address++)
+			{
+				server->setData(QModbusDataUnit::HoldingRegisters, address, address);
+				server->setData(QModbusDataUnit::InputRegisters  , address, address);
+			}
+			server->setServerAddress(1);
+			server->setConnectionParameter(QModbusDevice::NetworkAddressParameter, "127.0.0.1");
+			server->setConnectionParameter(QModbusDevice::NetworkPortParameter   , port);
+			if (!server->connectDevice())
+			{
+				failed.ref();
+			}
+			servers[i] = server;
+			started.release();
+		});
+	}
+	// wait until all devices listen
+	started.acquire(devices);
+	return failed.loadAcquire() == 0;
+}
+
+void QUaModbusSimulator::stop()
+{
+	for (int i = 0; i < m_threads.count(); i++)
+	{
+		auto server = m_servers.at(i);
+		QSemaphore stopped;
+		// delete in the thread it lives in
+		m_threads.at(i)->execInThread([server, &stopped]() {
+			if (server)
+			{
+				server->disconnectDevice();
+				delete server;
+			}
+			stopped.release();
+		});
+		stopped.acquire();
+		delete m_threads.at(i);
+	}
+	m_threads.clear();
+	m_servers.clear();
+}
+
+int QUaModbusSimulator::devices() const
+{
+	return m_servers.count();
+}
@@ -0,0 +1,45 @@
+#ifndef QUAMODBUSSIMULATOR_H
+#define QUAMODBUSSIMULATOR_H
+
+#include <QObject>
+#include <QList>
+#include <QVector>
+#include <QModbusTcpServer>
+
+#include <QLambdaThreadWorker>
+
+// Modbus TCP server that answers after a fixed latency, like a slow device would
+class QUaModbusSimulatedServer : public QModbusTcpServer
+{
+public:
+	explicit QUaModbusSimulatedServer(const quint32 &latency, QObject *parent = nullptr);
+
+protected:
+	// NOTE : blocks the server thread on purpose, devices answer one request at a time
+	QModbusResponse processRequest(const QModbusPdu &request) override;
+
+private:
+	quint32 m_latency;
+};
+
+// N simulated devices on consecutive localhost ports, each one in its own thread
+class QUaModbusSimulator : public QObject
+{
+	Q_OBJECT
+
+public:
+	explicit QUaModbusSimulator(QObject *parent = nullptr);
+	~QUaModbusSimulator();
+
+	// returns false if any device failed to listen
+	bool start(const quint16 &basePort, const int &devices, const quint16 &registers, const quint32 &latency);
+	void stop();
+
+	int devices() const;
+
+private:
+	QList<QLambdaThreadWorker*>       m_threads;
+	QVector<QUaModbusSimulatedServer*> m_servers;
+};
+
+#endif // QUAMODBUSSIMULATOR_H
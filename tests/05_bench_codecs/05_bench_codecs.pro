@@ -0,0 +1,22 @@
+QT += core testlib
+QT -= gui
+
+TARGET  = 05_bench_codecs
+CONFIG += console
+CONFIG -= app_bundle
+
+TEMPLATE = app
+
+INCLUDEPATH += $$PWD/
+
+SOURCES += \
+main.cpp \
+quamodbusbenchcodecs.cpp
+
+HEADERS += \
+quamodbusbenchcodecs.h
+
+include($$PWD/../../src/types/quamodbusclient.pri)
+include($$PWD/../../libs/QDeferred.git/src/qlambdathreadworker.pri)
+include($$PWD/../../libs/QUaServer.git/src/wrapper/quaserver.pri)
+include($$PWD/../../libs/QUaServer.git/src/helper/add_qt_path_win.pri)
@@ -0,0 +1,98 @@
+#include <QCoreApplication>
+#include <QTemporaryDir>
+#include <QXmlStreamReader>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QFile>
+
+#include <QtTest>
+
+#include "quamodbusbenchcodecs.h"
+
+// convert benchmark results from QTest xml output to json
+bool xmlToJson(const QString &strXmlFile, const QString &strJsonFile)
+{
+	QFile fileXml(strXmlFile);
+	if (!fileXml.open(QIODevice::ReadOnly))
+	{
+		return false;
+	}
+	QJsonArray results;
+	QString strFunction;
+	QXmlStreamReader xml(&fileXml);
+	while (!xml.atEnd())
+	{
+		if (!xml.readNextStartElement())
+		{
+			continue;
+		}
+		auto attrs = xml.attributes();
+		if (xml.name() == QLatin1String("TestFunction"))
+		{
+			strFunction = attrs.value("name").toString();
+		}
+		else if (xml.name() == QLatin1String("BenchmarkResult"))
+		{
+			double value      = attrs.value("value").toDouble();
+			double iterations = attrs.value("iterations").toDouble();
+			results.append(QJsonObject({
+				{ "name"      , QString("%1/%2").arg(strFunction).arg(attrs.value("tag").toString()) },
+				{ "function"  , strFunction },
+				{ "tag"       , attrs.value("tag").toString() },
+				{ "metric"    , attrs.value("metric").toString() },
+				{ "value"     , value },
+				{ "iterations", iterations },
+				{ "perIteration", iterations > 0 ? value / iterations : value }
+			}));
+		}
+	}
+	if (xml.hasError())
+	{
+		return false;
+	}
+	QFile fileJson(strJsonFile);
+	if (!fileJson.open(QIODevice::WriteOnly | QIODevice::Truncate))
+	{
+		return false;
+	}
+	QJsonObject root({
+		{ "benchmark", "05_bench_codecs" },
+		{ "qtVersion", QString(qVersion()) },
+		{ "results"  , results }
+	});
+	fileJson.write(QJsonDocument(root).toJson());
+	return true;
+}
+
+int main(int argc, char *argv[])
+{
+	QCoreApplication a(argc, argv);
+
+	// NOTE : --json <file> is ours, all other arguments go to QTest (e.g. -tickcounter, function names)
+	QStringList args = a.arguments();
+	QString strJsonFile;
+	int jsonIndex = args.indexOf("--json");
+	if (jsonIndex > 0 && jsonIndex + 1 < args.count())
+	{
+		strJsonFile = args.at(jsonIndex + 1);
+		args.removeAt(jsonIndex + 1);
+		args.removeAt(jsonIndex);
+	}
+	QTemporaryDir tempDir;
+	QString strXmlFile = tempDir.filePath("results.xml");
+	if (!strJsonFile.isEmpty())
+	{
+		args << "-o" << strXmlFile + ",xml" << "-o" << "-,txt";
+	}
+
+	QUaModbusBenchCodecs bench;
+	int result = QTest::qExec(&bench, args);
+
+	if (!strJsonFile.isEmpty() && !xmlToJson(strXmlFile, strJsonFile))
+	{
+		qWarning() << "Error : failed to write benchmark results to" << strJsonFile;
+		return result != 0 ? result : 1;
+	}
+	return result;
+}
@@ -0,0 +1,190 @@
+#include "quamodbusbenchcodecs.h"
+
+#include <QtTest>
+
+#include <QUaServer>
+
+#include <QUaModbusClientList>
+#include <QUaModbusClient>
+#include <QUaModbusDataBlock>
+#include <QUaModbusValue>
+
+// block sizes covering a single register up to the max read request
+static const QList<int> blockSizes = { 1, 2, 4, 8, 16, 32, 64, 125 };
+
+// all valid value types
+static QList<QModbusValueType> valueTypes()
+{
+	QList<QModbusValueType> types;
+	auto metaEnum = QMetaEnum::fromType<QModbusValueType>();
+	for (int i = 0; i < metaEnum.keyCount(); i++)
+	{
+		auto type = static_cast<QModbusValueType>(metaEnum.value(i));
+		if (type == QModbusValueType::Invalid)
+		{
+			continue;
+		}
+		types << type;
+	}
+	return types;
+}
+
+static QString typeName(const QModbusValueType &type)
+{
+	return QString(QMetaEnum::fromType<QModbusValueType>().valueToKey(type));
+}
+
+// registers with all bits in use so no conversion takes a shortcut
+static QVector<quint16> testBlock(const int &size, const quint16 &seed)
+{
+	QVector<quint16> block(size);
+	for (int i = 0; i < size; i++)
+	{
+		block[i] = static_cast<quint16>(seed + 0x1111 * (i + 1));
+	}
+	return block;
+}
+
+QUaModbusBenchCodecs::QUaModbusBenchCodecs(QObject *parent)
+	: QObject(parent)
+{
+	m_server = nullptr;
+	m_list   = nullptr;
+	m_client = nullptr;
+}
+
+void QUaModbusBenchCodecs::initTestCase()
+{
+	// NOTE : ua server is not started, only needed to instantiate the fan-out objects
+	m_server = new QUaServer;
+	m_list = m_server->objectsFolder()->addChild<QUaModbusClientList>("ModbusClients");
+	QVERIFY(!m_list->addTcpClient("Client").contains("Error"));
+	m_client = m_list->clients().first();
+}
+
+void QUaModbusBenchCodecs::cleanupTestCase()
+{
+	delete m_server;
+	m_server = nullptr;
+	m_list   = nullptr;
+	m_client = nullptr;
+}
+
+void QUaModbusBenchCodecs::blockToValue_data()
+{
+	QTest::addColumn<QModbusValueType>("type");
+	QTest::addColumn<QVector<quint16>>("block");
+	for (auto type : valueTypes())
+	{
+		QTest::newRow(typeName(type).toUtf8().constData())
+			<< type << testBlock(QUaModbusValue::typeBlockSize(type), 0);
+	}
+}
+
+void QUaModbusBenchCodecs::blockToValue()
+{
+	QFETCH(QModbusValueType, type);
+	QFETCH(QVector<quint16>, block);
+	QVariant value;
+	QBENCHMARK {
+		value = QUaModbusValue::blockToValue(block, type);
+	}
+	QVERIFY(value.isValid());
+}
+
+void QUaModbusBenchCodecs::valueToBlock_data()
+{
+	QTest::addColumn<QModbusValueType>("type");
+	QTest::addColumn<QVariant>("value");
+	for (auto type : valueTypes())
+	{
+		QVariant value = QUaModbusValue::blockToValue(testBlock(QUaModbusValue::typeBlockSize(type), 0), type);
+		QTest::newRow(typeName(type).toUtf8().constData()) << type << value;
+	}
+}
+
+void QUaModbusBenchCodecs::valueToBlock()
+{
+	QFETCH(QModbusValueType, type);
+	QFETCH(QVariant, value);
+	QVector<quint16> block;
+	QBENCHMARK {
+		block = QUaModbusValue::valueToBlock(value, type);
+	}
+	QCOMPARE(block.count(), QUaModbusValue::typeBlockSize(type));
+}
+
+void QUaModbusBenchCodecs::variantToInt16Vect_data()
+{
+	QTest::addColumn<QVariant>("data");
+	for (auto size : blockSizes)
+	{
+		// same variant the block data variable holds
+		QTest::newRow(QString::number(size).toUtf8().constData())
+			<< QVariant::fromValue(testBlock(size, 0));
+	}
+}
+
+void QUaModbusBenchCodecs::variantToInt16Vect()
+{
+	QFETCH(QVariant, data);
+	QVector<quint16> block;
+	QBENCHMARK {
+		block = QUaModbusDataBlock::variantToInt16Vect(data);
+	}
+	QCOMPARE(block, data.value<QVector<quint16>>());
+}
+
+void QUaModbusBenchCodecs::replyFanOut_data()
+{
+	QTest::addColumn<QModbusValueType>("type");
+	QTest::addColumn<int>("size");
+	for (auto size : blockSizes)
+	{
+		for (auto type : valueTypes())
+		{
+			if (QUaModbusValue::typeBlockSize(type) > size)
+			{
+				continue;
+			}
+			QTest::newRow(QString("%1/%2").arg(typeName(type)).arg(size).toUtf8().constData())
+				<< type << size;
+		}
+	}
+}
+
+void QUaModbusBenchCodecs::replyFanOut()
+{
+	QFETCH(QModbusValueType, type);
+	QFETCH(int, size);
+	// block packed with as many values of the type as fit
+	static int blockCount = 0;
+	QString strBlockId = QString("Block%1").arg(blockCount++);
+	QVERIFY(!m_client->dataBlocks()->addDataBlock(strBlockId).contains("Error"));
+	auto block = m_client->dataBlocks()->browseChild<QUaModbusDataBlock>(strBlockId);
+	QVERIFY(block);
+	block->setType(QModbusDataBlockType::HoldingRegisters);
+	block->setAddress(0);
+	block->setSize(size);
+	int typeSize = QUaModbusValue::typeBlockSize(type);
+	int valueCount = size / typeSize;
+	for (int i = 0; i < valueCount; i++)
+	{
+		QString strValueId = QString("Value%1").arg(i);
+		QVERIFY(!block->values()->addValue(strValueId).contains("Error"));
+		auto value = block->values()->browseChild<QUaModbusValue>(strValueId);
+		QVERIFY(value);
+		value->setType(type);
+		value->setAddressOffset(i * typeSize);
+	}
+	// alternate replies so every value changes on each pass, like a live process would
+	QVector<quint16> dataA = testBlock(size, 0);
+	QVector<quint16> dataB = testBlock(size, 0x0101);
+	bool toggle = false;
+	QBENCHMARK {
+		block->updateValues(toggle ? dataA : dataB, QModbusError::NoError);
+		toggle = !toggle;
+	}
+	QCOMPARE(block->values()->values().count(), valueCount);
+	block->remove();
+}
@@ -0,0 +1,41 @@
+#ifndef QUAMODBUSBENCHCODECS_H
+#define QUAMODBUSBENCHCODECS_H
+
+#include <QObject>
+
+class QUaServer;
+class QUaModbusClientList;
+class QUaModbusClient;
+
+// QTest benchmarks of the per-tag hot path : value codecs, block data conversion
+// and the fan-out of a read reply to all values of a block
+class QUaModbusBenchCodecs : public QObject
+{
+	Q_OBJECT
+
+public:
+	explicit QUaModbusBenchCodecs(QObject *parent = nullptr);
+
+private slots:
+	void initTestCase();
+	void cleanupTestCase();
+
+	void blockToValue_data();
+	void blockToValue();
+
+	void valueToBlock_data();
+	void valueToBlock();
+
+	void variantToInt16Vect_data();
+	void variantToInt16Vect();
+
+	void replyFanOut_data();
+	void replyFanOut();
+
+private:
+	QUaServer           * m_server;
+	QUaModbusClientList * m_list;
+	QUaModbusClient     * m_client;
+};
+
+#endif // QUAMODBUSBENCHCODECS_H
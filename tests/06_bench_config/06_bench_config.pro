@@ -0,0 +1,25 @@
+QT += core
+QT -= gui
+
+TARGET  = 06_bench_config
+CONFIG += console
+CONFIG -= app_bundle
+
+TEMPLATE = app
+
+INCLUDEPATH += $$PWD/
+INCLUDEPATH += $$PWD/../04_bench_southbound/
+
+SOURCES += \
+main.cpp \
+$$PWD/../04_bench_southbound/quamodbusconfiggenerator.cpp \
+$$PWD/../04_bench_southbound/quamodbussimulator.cpp
+
+HEADERS += \
+$$PWD/../04_bench_southbound/quamodbusconfiggenerator.h \
+$$PWD/../04_bench_southbound/quamodbussimulator.h
+
+include($$PWD/../../src/types/quamodbusclient.pri)
+include($$PWD/../../libs/QDeferred.git/src/qlambdathreadworker.pri)
+include($$PWD/../../libs/QUaServer.git/src/wrapper/quaserver.pri)
+include($$PWD/../../libs/QUaServer.git/src/helper/add_qt_path_win.pri)
@@ -0,0 +1,265 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QFile>
+#include <QDir>
+#include <QSet>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+
+#include <QUaServer>
+
+#include <QUaModbusClientList>
+#include <QUaModbusClient>
+#include <QUaModbusDataBlock>
+
+#include "quamodbusconfiggenerator.h"
+#include "quamodbussimulator.h"
+
+// resident set size in kB, -1 if not supported
+qint64 residentSetSize(const QString &strField = "VmRSS")
+{
+#ifdef Q_OS_LINUX
+	QFile fileStatus("/proc/self/status");
+	if (!fileStatus.open(QIODevice::ReadOnly))
+	{
+		return -1;
+	}
+	for (auto line : QString::fromUtf8(fileStatus.readAll()).split('\n'))
+	{
+		if (line.startsWith(strField + ":"))
+		{
+			return line.mid(strField.length() + 1).trimmed().split(' ').first().toLongLong();
+		}
+	}
+#else
+	Q_UNUSED(strField);
+#endif // Q_OS_LINUX
+	return -1;
+}
+
+bool writeFile(const QString &strFileName, const QString &strContents)
+{
+	QFile file(strFileName);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+	{
+		return false;
+	}
+	return file.write(strContents.toUtf8()) >= 0;
+}
+
+int main(int argc, char *argv[])
+{
+	QCoreApplication a(argc, argv);
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription("Generates large synthetic configurations and benchmarks loading them.");
+	parser.addHelpOption();
+	QCommandLineOption optClients ("clients" , "Number of tcp clients."                                   , "n"     , "2000" );
+	QCommandLineOption optBlocks  ("blocks"  , "Blocks per client."                                       , "n"     , "20"   );
+	QCommandLineOption optValues  ("values"  , "Values per block (max 62)."                               , "n"     , "50"   );
+	QCommandLineOption optSampling("sampling", "Block sampling time."                                     , "ms"    , "1000" );
+	QCommandLineOption optFormat  ("format"  , "Configuration format to load, xml or csv."                , "format", "xml"  );
+	QCommandLineOption optGenerate("generate", "Only write config.xml and clients/blocks/values.csv to dir.", "dir");
+	QCommandLineOption optPoll    ("poll"    , "Also time until first successful poll of every block against simulated devices.");
+	QCommandLineOption optPorts   ("ports"   , "Simulated devices, clients are spread over them."         , "n"     , "1"    );
+	QCommandLineOption optPort    ("port"    , "First simulated device port."                             , "port"  , "15020");
+	QCommandLineOption optTimeout ("timeout" , "Give up waiting for first poll after."                    , "s"     , "300"  );
+	QCommandLineOption optJson    ("json"    , "Also write results as JSON to file."                      , "file");
+	QCommandLineOption optCompact ("compact" , "Load values in compact mode, without configuration nodes.");
+	parser.addOptions({ optClients, optBlocks, optValues, optSampling, optFormat,
+		optGenerate, optPoll, optPorts, optPort, optTimeout, optJson, optCompact });
+	parser.process(a);
+
+	QUaModbusConfigGenerator generator;
+	generator.clients      = parser.value(optClients ).toInt();
+	generator.blocks       = parser.value(optBlocks  ).toInt();
+	generator.values       = parser.value(optValues  ).toInt();
+	generator.samplingTime = parser.value(optSampling).toUInt();
+	generator.ports        = parser.value(optPorts   ).toInt();
+	generator.basePort     = static_cast<quint16>(parser.value(optPort).toUInt());
+	// NOTE : otherwise clients try to connect while loading, before the simulated devices are up,
+	//        and first polls measure their reconnect backoff
+	generator.keepConnecting = !parser.isSet(optPoll);
+	bool isCsv = parser.value(optFormat).compare("csv", Qt::CaseInsensitive) == 0;
+
+	QTextStream out(stdout);
+	if (generator.values > QUaModbusConfigGenerator::m_maxValues)
+	{
+		out << "Values per block limited to " << QUaModbusConfigGenerator::m_maxValues << endl;
+	}
+	// NOTE : blocks do not overlap, so all of them must fit the address space
+	if (generator.registerCount() > QUaModbusConfigGenerator::m_maxRegisters)
+	{
+		generator.blocks = QUaModbusConfigGenerator::m_maxRegisters / generator.blockSize();
+		out << "Blocks per client limited to " << generator.blocks << endl;
+	}
+
+	// generator only
+	if (parser.isSet(optGenerate))
+	{
+		QDir dir(parser.value(optGenerate));
+		if (!dir.mkpath(".") ||
+			!writeFile(dir.filePath("config.xml" ), generator.xml       ()) ||
+			!writeFile(dir.filePath("clients.csv"), generator.csvClients()) ||
+			!writeFile(dir.filePath("blocks.csv" ), generator.csvBlocks ()) ||
+			!writeFile(dir.filePath("values.csv" ), generator.csvValues ()))
+		{
+			out << "Error : failed to write configuration to " << dir.absolutePath() << endl;
+			return 1;
+		}
+		out << "Written " << generator.tagCount() << " tags to " << dir.absolutePath() << endl;
+		return 0;
+	}
+
+	QJsonObject results;
+	results["clients"] = generator.clients;
+	results["blocks" ] = generator.clients * generator.blocks;
+	results["tags"   ] = generator.tagCount();
+	results["format" ] = isCsv ? "csv" : "xml";
+	results["compact"] = parser.isSet(optCompact);
+	QElapsedTimer timer;
+
+	// generate
+	timer.start();
+	QString strXml, strCsvClients, strCsvBlocks, strCsvValues;
+	if (isCsv)
+	{
+		strCsvClients = generator.csvClients();
+		strCsvBlocks  = generator.csvBlocks ();
+		strCsvValues  = generator.csvValues ();
+	}
+	else
+	{
+		strXml = generator.xml();
+	}
+	results["generateMs"] = static_cast<double>(timer.elapsed());
+	results["configBytes"] = static_cast<double>(
+		isCsv ? strCsvClients.toUtf8().size() + strCsvBlocks.toUtf8().size() + strCsvValues.toUtf8().size()
+		      : strXml.toUtf8().size());
+	qint64 rssBefore = residentSetSize();
+
+	// NOTE : ua server is not started, the address space is all that is needed
+	QUaServer server;
+	QUaFolderObject * objsFolder = server.objectsFolder();
+	auto list = objsFolder->addChild<QUaModbusClientList>("ModbusClients");
+	// NOTE : values take it from the list when created
+	list->setCompactValues(parser.isSet(optCompact));
+
+	// load
+	int errorCount = 0;
+	timer.restart();
+	if (isCsv)
+	{
+		QQueue<QUaLog> errorLogs;
+		errorLogs << list->setCsvClients(strCsvClients);
+		errorLogs << list->setCsvBlocks (strCsvBlocks );
+		errorLogs << list->setCsvValues (strCsvValues );
+		for (auto &log : errorLogs)
+		{
+			errorCount += log.level == QUaLogLevel::Error ? 1 : 0;
+		}
+	}
+	else
+	{
+		auto strResult = list->setXmlConfig(strXml);
+		errorCount = strResult.count("Error");
+	}
+	double loadMs = timer.elapsed();
+	results["loadMs"    ] = loadMs;
+	results["loadErrors"] = errorCount;
+	results["tagsPerSec"] = loadMs > 0 ? 1000.0 * generator.tagCount() / loadMs : 0.0;
+
+	// queued work posted while loading (property changes, worker thread config)
+	timer.restart();
+	a.processEvents();
+	results["settleMs"] = static_cast<double>(timer.elapsed());
+	results["rssLoadedKb"] = rssBefore >= 0 ? static_cast<double>(residentSetSize() - rssBefore) : -1.0;
+
+	// export back, the other half of a config round trip
+	timer.restart();
+	auto strExport = list->xmlConfig();
+	results["exportMs"] = static_cast<double>(timer.elapsed());
+	strExport.clear();
+
+	auto report = [&]() {
+		results["rssPeakKb"] = static_cast<double>(residentSetSize("VmHWM"));
+		out << QString("Tags %1 (%2 clients, %3 blocks), %4%5, %6 kB")
+			.arg(generator.tagCount()).arg(generator.clients).arg(results["blocks"].toInt())
+			.arg(results["format"].toString()).arg(results["compact"].toBool() ? " compact" : "")
+			.arg(results["configBytes"].toDouble() / 1024.0, 0, 'f', 0) << endl;
+		for (auto key : { "generateMs", "loadMs", "settleMs", "exportMs", "firstPollMs", "allPolledMs" })
+		{
+			if (!results.contains(key))
+			{
+				continue;
+			}
+			out << QString("%1 : %2 ms").arg(QString(key), -15).arg(results[key].toDouble(), 0, 'f', 0) << endl;
+		}
+		out << QString("Load rate       : %1 tags/s, %2 errors")
+			.arg(results["tagsPerSec"].toDouble(), 0, 'f', 0).arg(errorCount) << endl;
+		out << QString("RSS             : +%1 kB loaded (peak %2 kB)")
+			.arg(results["rssLoadedKb"].toDouble()).arg(results["rssPeakKb"].toDouble()) << endl;
+		if (parser.isSet(optJson))
+		{
+			QFile fileJson(parser.value(optJson));
+			if (fileJson.open(QIODevice::WriteOnly | QIODevice::Truncate))
+			{
+				fileJson.write(QJsonDocument(results).toJson());
+			}
+		}
+	};
+
+	if (!parser.isSet(optPoll))
+	{
+		report();
+		return 0;
+	}
+
+	// first successful poll of every block
+	QUaModbusSimulator simulator;
+	if (!simulator.start(generator.basePort, generator.ports, static_cast<quint16>(generator.registerCount()), 0))
+	{
+		out << "Error : failed to start simulated devices" << endl;
+		return 1;
+	}
+	QSet<QUaModbusDataBlock*> pending;
+	for (auto client : list->clients())
+	{
+		for (auto block : client->dataBlocks()->blocks())
+		{
+			pending << block;
+			QObject::connect(block, &QUaModbusDataBlock::dataChanged, block, [&, block]() {
+				if (!pending.remove(block))
+				{
+					return;
+				}
+				if (!results.contains("firstPollMs"))
+				{
+					results["firstPollMs"] = static_cast<double>(timer.elapsed());
+				}
+				if (pending.isEmpty())
+				{
+					results["allPolledMs"] = static_cast<double>(timer.elapsed());
+					a.quit();
+				}
+			});
+		}
+	}
+	timer.restart();
+	for (auto client : list->clients())
+	{
+		client->connectDevice();
+	}
+	QTimer::singleShot(1000 * parser.value(optTimeout).toInt(), &a, [&]() {
+		out << "Timeout : " << pending.count() << " blocks never polled" << endl;
+		results["notPolled"] = pending.count();
+		a.quit();
+	});
+	a.exec();
+	report();
+
+	return 0;
+}
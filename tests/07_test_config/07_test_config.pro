@@ -0,0 +1,22 @@
+QT += core testlib
+QT -= gui
+
+TARGET  = 07_test_config
+CONFIG += console
+CONFIG -= app_bundle
+
+TEMPLATE = app
+
+INCLUDEPATH += $$PWD/
+
+SOURCES += \
+main.cpp \
+quamodbustestconfig.cpp
+
+HEADERS += \
+quamodbustestconfig.h
+
+include($$PWD/../../src/types/quamodbusclient.pri)
+include($$PWD/../../libs/QDeferred.git/src/qlambdathreadworker.pri)
+include($$PWD/../../libs/QUaServer.git/src/wrapper/quaserver.pri)
+include($$PWD/../../libs/QUaServer.git/src/helper/add_qt_path_win.pri)
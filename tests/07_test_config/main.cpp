@@ -0,0 +1,12 @@
+#include <QCoreApplication>
+#include <QtTest>
+
+#include "quamodbustestconfig.h"
+
+int main(int argc, char *argv[])
+{
+	QCoreApplication a(argc, argv);
+
+	QUaModbusTestConfig test;
+	return QTest::qExec(&test, argc, argv);
+}
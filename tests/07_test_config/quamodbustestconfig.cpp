@@ -0,0 +1,1013 @@
+#include "quamodbustestconfig.h"
+
+#include <QtTest>
+#include <QMap>
+#include <QTemporaryFile>
+#include <QBuffer>
+#include <QTemporaryDir>
+#include <QtEndian>
+#include <QModbusTcpServer>
+
+#include <QUaServer>
+
+#include <QUaModbusClientList>
+#include <QUaModbusClient>
+#include <QUaModbusTcpClient>
+#include <QUaModbusDataBlockList>
+#include <QUaModbusDataBlock>
+#include <QUaModbusValueList>
+#include <QUaModbusValue>
+
+#include "quamodbusbinaryconfig.h"
+#include "quamodbuscsv.h"
+#include "quamodbusconfigvalidator.h"
+#include "quamodbusvaluecache.h"
+#include "quamodbushostcache.h"
+#include "quamodbushistorian.h"
+
+// non default attributes everywhere, so a lost attribute shows up in the comparison
+static const char * testConfig = R"(<?xml version="1.0" encoding="UTF-8"?>
+<QUaModbusClientList LagThreshold="750" ConnectConcurrency="4">
+ <QUaModbusTcpClient BrowseName="Plc_1" ServerAddress="3" KeepConnecting="0" NetworkAddress="192.168.1.10" NetworkPort="1502" Timeout="750" NumberOfRetries="5" AdaptiveTimeout="1" DiagnosticsEnabled="1">
+  <QUaModbusDataBlockList>
+   <QUaModbusDataBlock BrowseName="Holding" Type="HoldingRegisters" Address="100" Size="20" SamplingTime="250">
+    <QUaModbusValueList>
+     <QUaModbusValue BrowseName="Speed" Type="Float" AddressOffset="0" CyclicWriteMode="Toggle" CyclicWritePeriod="5000"/>
+     <QUaModbusValue BrowseName="Count" Type="Int64Swapped" AddressOffset="2"/>
+     <QUaModbusValue BrowseName="Flag" Type="Binary7" AddressOffset="6"/>
+    </QUaModbusValueList>
+   </QUaModbusDataBlock>
+   <QUaModbusDataBlock BrowseName="Coils" Type="Coils" Address="0" Size="16" SamplingTime="1000">
+    <QUaModbusValueList/>
+   </QUaModbusDataBlock>
+  </QUaModbusDataBlockList>
+ </QUaModbusTcpClient>
+ <QUaModbusTcpClient BrowseName="Plc_2" ServerAddress="1" KeepConnecting="0" NetworkAddress="plc2.local" NetworkPort="502" Timeout="1000" NumberOfRetries="3" AdaptiveTimeout="0" DiagnosticsEnabled="0">
+  <QUaModbusDataBlockList>
+   <QUaModbusDataBlock BrowseName="Input" Type="InputRegisters" Address="0" Size="125" SamplingTime="100">
+    <QUaModbusValueList>
+     <QUaModbusValue BrowseName="Temperature" Type="Decimal" AddressOffset="124"/>
+     <QUaModbusValue BrowseName="Energy" Type="Float64" AddressOffset="10"/>
+    </QUaModbusValueList>
+   </QUaModbusDataBlock>
+  </QUaModbusDataBlockList>
+ </QUaModbusTcpClient>
+ <QUaModbusRtuSerialClient BrowseName="Meter" ServerAddress="7" KeepConnecting="0" ComPort="" Parity="EvenParity" BaudRate="Baud9600" DataBits="Data7" StopBits="TwoStop" Timeout="300" NumberOfRetries="1" AdaptiveTimeout="0" DiagnosticsEnabled="0">
+  <QUaModbusDataBlockList>
+   <QUaModbusDataBlock BrowseName="Readings" Type="HoldingRegisters" Address="4000" Size="8" SamplingTime="2000">
+    <QUaModbusValueList>
+     <QUaModbusValue BrowseName="Voltage" Type="FloatSwapped" AddressOffset="0"/>
+    </QUaModbusValueList>
+   </QUaModbusDataBlock>
+  </QUaModbusDataBlockList>
+ </QUaModbusRtuSerialClient>
+</QUaModbusClientList>
+)";
+
+QUaModbusTestConfig::QUaModbusTestConfig(QObject *parent)
+	: QObject(parent)
+{
+	m_source = nullptr;
+	m_target = nullptr;
+}
+
+QUaModbusTestConfig::~QUaModbusTestConfig()
+{
+}
+
+void QUaModbusTestConfig::init()
+{
+	// NOTE : ua servers are not started, the address space is all that is needed
+	m_serverSource.reset(new QUaServer);
+	m_serverTarget.reset(new QUaServer);
+	m_source = m_serverSource->objectsFolder()->addChild<QUaModbusClientList>("ModbusClients");
+	m_target = m_serverTarget->objectsFolder()->addChild<QUaModbusClientList>("ModbusClients");
+	QCOMPARE(m_source->setXmlConfig(testConfig), QString("Success."));
+	QCOMPARE(m_source->clients().count(), 3);
+}
+
+void QUaModbusTestConfig::cleanup()
+{
+	m_source = nullptr;
+	m_target = nullptr;
+	m_serverSource.reset();
+	m_serverTarget.reset();
+}
+
+void QUaModbusTestConfig::xmlRoundTrip()
+{
+	m_target->setXmlConfig(m_source->xmlConfig());
+	QCOMPARE(canonical(m_target), canonical(m_source));
+}
+
+void QUaModbusTestConfig::binaryRoundTrip()
+{
+	auto byteConfig = m_source->binaryConfig();
+	auto errorLogs  = m_target->setBinaryConfig(byteConfig);
+	QVERIFY2(errorLogs.isEmpty(), qPrintable(QUaLog::toString(errorLogs)));
+	QCOMPARE(canonical(m_target), canonical(m_source));
+	// same tree gives the same bytes
+	QCOMPARE(m_target->binaryConfig(), byteConfig);
+}
+
+void QUaModbusTestConfig::binaryMappedFile()
+{
+	QTemporaryFile file;
+	QVERIFY(file.open());
+	QVERIFY(m_source->writeBinaryConfig(&file));
+	QVERIFY(file.seek(0));
+	auto errorLogs = m_target->readBinaryConfig(&file);
+	QVERIFY2(errorLogs.isEmpty(), qPrintable(QUaLog::toString(errorLogs)));
+	QCOMPARE(canonical(m_target), canonical(m_source));
+}
+
+void QUaModbusTestConfig::binaryCorrupted()
+{
+	auto byteConfig = m_source->binaryConfig();
+	// flip a bit in the string data
+	byteConfig[byteConfig.size() - 1] = byteConfig.at(byteConfig.size() - 1) ^ 0x01;
+	auto errorLogs = m_target->setBinaryConfig(byteConfig);
+	QCOMPARE(errorLogs.count(), 1);
+	QVERIFY(m_target->clients().isEmpty());
+}
+
+void QUaModbusTestConfig::binaryTruncated()
+{
+	auto byteConfig = m_source->binaryConfig();
+	for (int size : { 0, 4, 8, static_cast<int>(sizeof(QUaModbusBinaryConfig::Header)), byteConfig.size() - 1 })
+	{
+		auto errorLogs = m_target->setBinaryConfig(byteConfig.left(size));
+		QCOMPARE(errorLogs.count(), 1);
+		QVERIFY(m_target->clients().isEmpty());
+	}
+}
+
+void QUaModbusTestConfig::binaryVersion()
+{
+	auto byteConfig = m_source->binaryConfig();
+	byteConfig[4] = static_cast<char>(QUaModbusBinaryConfig::m_version + 1);
+	auto errorLogs = m_target->setBinaryConfig(byteConfig);
+	QCOMPARE(errorLogs.count(), 1);
+	QVERIFY(m_target->clients().isEmpty());
+	// older layouts are not read either, the version changes with the layout
+	byteConfig[4] = static_cast<char>(QUaModbusBinaryConfig::m_version - 1);
+	errorLogs = m_target->setBinaryConfig(byteConfig);
+	QCOMPARE(errorLogs.count(), 1);
+	QVERIFY(m_target->clients().isEmpty());
+}
+
+void QUaModbusTestConfig::binaryInvalidEnum()
+{
+	typedef QUaModbusBinaryConfig Binary;
+	auto byteConfig = m_source->binaryConfig();
+	auto word = [&byteConfig](const size_t &offset) {
+		return qFromLittleEndian<quint32>(byteConfig.constData() + offset);
+	};
+	auto setWord = [&byteConfig](const size_t &offset, const quint32 &value) {
+		qToLittleEndian<quint32>(value, byteConfig.data() + offset);
+	};
+	// type of the first value out of range, with a valid checksum
+	setWord(word(offsetof(Binary::Header, valuesOffset)) + offsetof(Binary::ValueRecord, type), 99);
+	setWord(offsetof(Binary::Header, checksum), Binary::checksum(byteConfig.constData() + sizeof(Binary::Header), byteConfig.size() - sizeof(Binary::Header)));
+	auto errorLogs = m_target->setBinaryConfig(byteConfig);
+	QCOMPARE(errorLogs.count(), 1);
+	QVERIFY(m_target->clients().isEmpty());
+}
+
+void QUaModbusTestConfig::bulkAdd()
+{
+	auto blocks = m_source->clients().first()->dataBlocks();
+	QSignalSpy spyBlocksAdded(blocks, &QUaModbusDataBlockList::blocksAdded);
+	QSignalSpy spyBlockChild (blocks, &QUaNode::childAdded);
+	QCOMPARE(blocks->addDataBlocks("Extra, Bank[08..11]"), QString("Success"));
+	QCOMPARE(spyBlocksAdded.count(), 1);
+	QCOMPARE(spyBlocksAdded.first().first().value<QList<QUaModbusDataBlock*>>().count(), 5);
+	QCOMPARE(spyBlockChild.count(), 0);
+	QCOMPARE(blocks->blocks().count(), 7);
+	for (auto strId : { "Extra", "Bank08", "Bank09", "Bank10", "Bank11" })
+	{
+		QVERIFY(blocks->browseChild<QUaModbusDataBlock>(strId));
+	}
+	auto values = blocks->browseChild<QUaModbusDataBlock>("Bank08")->values();
+	QSignalSpy spyValuesAdded(values, &QUaModbusValueList::valuesAdded);
+	QCOMPARE(values->addValues("Temp[1..100]"), QString("Success"));
+	QCOMPARE(spyValuesAdded.count(), 1);
+	QCOMPARE(values->values().count(), 100);
+	QVERIFY(values->browseChild<QUaModbusValue>("Temp100"));
+	// single add still notifies views
+	QCOMPARE(values->addValue("Single"), QString("Success"));
+	QCOMPARE(spyValuesAdded.count(), 2);
+}
+
+void QUaModbusTestConfig::bulkAddInvalid()
+{
+	auto blocks = m_source->clients().first()->dataBlocks();
+	auto strBefore = canonical(m_source);
+	// existing id, invalid id, duplicated id, bad range
+	QVERIFY(blocks->addDataBlocks("New, Holding").contains("Error"));
+	QVERIFY(blocks->addDataBlocks("New, Bad-Id").contains("Error"));
+	QVERIFY(blocks->addDataBlocks("New, New").contains("Error"));
+	QVERIFY(blocks->addDataBlocks("New[5..1]").contains("Error"));
+	QVERIFY(blocks->addDataBlocks("").contains("Error"));
+	// nothing created
+	QCOMPARE(canonical(m_source), strBefore);
+}
+
+void QUaModbusTestConfig::xmlMalformed()
+{
+	// first client is complete, the syntax error comes after it
+	QString strConfig = testConfig;
+	strConfig.replace("</QUaModbusRtuSerialClient>", "</QUaModbusRtuSerialClientt>");
+	QVERIFY(m_target->setXmlConfig(strConfig).contains("Error"));
+	QVERIFY(m_target->clients().isEmpty());
+	QVERIFY(m_target->mergeXmlConfig(strConfig).contains("Error"));
+	QVERIFY(m_target->clients().isEmpty());
+	// devices are rewound after the check, also with a leading offset
+	QBuffer buffer;
+	buffer.setData(strConfig.toUtf8());
+	QVERIFY(buffer.open(QIODevice::ReadOnly));
+	auto errorLogs = m_target->readXmlConfig(&buffer);
+	QVERIFY(!errorLogs.isEmpty());
+	QVERIFY(m_target->clients().isEmpty());
+	QVERIFY(buffer.seek(0));
+	errorLogs = m_target->mergeXmlConfig(&buffer);
+	QVERIFY(!errorLogs.isEmpty());
+	QVERIFY(m_target->clients().isEmpty());
+	QByteArray byteConfig = QByteArray(" ") + QByteArray(testConfig).trimmed();
+	buffer.close();
+	buffer.setData(byteConfig);
+	QVERIFY(buffer.open(QIODevice::ReadOnly));
+	QVERIFY(buffer.seek(1));
+	errorLogs = m_target->readXmlConfig(&buffer);
+	QVERIFY2(errorLogs.isEmpty(), qPrintable(QUaLog::toString(errorLogs)));
+	QCOMPARE(canonical(m_target), canonical(m_source));
+}
+
+static QList<QStringList> readCsvRows(QUaModbusCsvReader &reader)
+{
+	QList<QStringList> rows;
+	QStringList fields;
+	QString     strRow;
+	while (reader.readRow(fields, strRow))
+	{
+		rows << fields;
+	}
+	return rows;
+}
+
+void QUaModbusTestConfig::csvReader()
+{
+	// quoted separators, escaped quotes and embedded newlines
+	QString strCsv = "a,\"b,c\",d\n"
+		"\"say \"\"hi\"\"\",\"\"\"\",\"\"\n"
+		"\"line1\nline2\",e\n"
+		"f,g";
+	QUaModbusCsvReader reader(&strCsv);
+	auto rows = readCsvRows(reader);
+	QCOMPARE(rows.count(), 4);
+	QCOMPARE(rows.at(0), QStringList({ "a", "b,c", "d" }));
+	QCOMPARE(rows.at(1), QStringList({ "say \"hi\"", "\"", "" }));
+	QCOMPARE(rows.at(2), QStringList({ "line1\nline2", "e" }));
+	QCOMPARE(rows.at(3), QStringList({ "f", "g" }));
+	// crlf input, also inside a quoted field, reads as the lf one (from string and device)
+	QString strCsvCrLf = strCsv;
+	strCsvCrLf.replace("\n", "\r\n");
+	QUaModbusCsvReader readerCrLf(&strCsvCrLf);
+	QCOMPARE(readCsvRows(readerCrLf), rows);
+	QBuffer buffer;
+	buffer.setData(strCsvCrLf.toUtf8());
+	QVERIFY(buffer.open(QIODevice::ReadOnly));
+	QUaModbusCsvReader readerDevice(&buffer);
+	QCOMPARE(readCsvRows(readerDevice), rows);
+	// unbalanced quote takes the rest of the input as one field instead of failing
+	QString strUnbalanced = "a,\"b\nc,d";
+	QUaModbusCsvReader readerUnbalanced(&strUnbalanced);
+	rows = readCsvRows(readerUnbalanced);
+	QCOMPARE(rows.count(), 1);
+	QCOMPARE(rows.at(0), QStringList({ "a", "b\nc,d" }));
+}
+
+void QUaModbusTestConfig::csvRoundTrip()
+{
+	QList<QStringList> rows = {
+		{ "plain", "b,c", "say \"hi\"" },
+		{ "line1\nline2", "", "\"" },
+	};
+	QString strCsv;
+	{
+		QUaModbusCsvWriter writer(&strCsv);
+		for (auto &row : rows)
+		{
+			for (auto &field : row)
+			{
+				writer << field;
+			}
+			writer.endRow();
+		}
+		QVERIFY(!writer.hasError());
+	}
+	// NOTE : writer separates with ", ", readers trim the fields
+	QUaModbusCsvReader reader(&strCsv);
+	auto rowsRead = readCsvRows(reader);
+	QCOMPARE(rowsRead.count(), rows.count());
+	for (int r = 0; r < rows.count(); r++)
+	{
+		QCOMPARE(rowsRead.at(r).count(), rows.at(r).count());
+		for (int f = 0; f < rows.at(r).count(); f++)
+		{
+			QCOMPARE(rowsRead.at(r).at(f).trimmed(), rows.at(r).at(f));
+		}
+	}
+}
+
+void QUaModbusTestConfig::mergeUnchanged()
+{
+	auto clientsBefore = m_source->clients();
+	auto blocksBefore  = clientsBefore.first()->dataBlocks()->blocks();
+	QQueue<QUaLog> logs;
+	QObject::connect(m_source, &QUaModbusClientList::logMessage, this, [&logs](const QUaLog &log) {
+		logs << log;
+	});
+	QCOMPARE(m_source->mergeXmlConfig(testConfig), QString("Success."));
+	QCOMPARE(m_source->clients(), clientsBefore);
+	QCOMPARE(clientsBefore.first()->dataBlocks()->blocks(), blocksBefore);
+	QCOMPARE(logs.count(), 1);
+	auto strSummary = QUaLog::toString(logs);
+	QVERIFY2(strSummary.contains("Clients added 0, removed 0, changed 0"), qPrintable(strSummary));
+	QVERIFY2(strSummary.contains("Blocks added 0, removed 0, changed 0"), qPrintable(strSummary));
+	QVERIFY2(strSummary.contains("Values added 0, removed 0, changed 0"), qPrintable(strSummary));
+}
+
+void QUaModbusTestConfig::mergeChanges()
+{
+	// Plc_1 untouched, Plc_2 block and values changed, Meter removed, Plc_3 added
+	QString strConfig = testConfig;
+	strConfig.replace(R"(SamplingTime="100")", R"(SamplingTime="200")");
+	strConfig.replace(R"(<QUaModbusValue BrowseName="Energy" Type="Float64" AddressOffset="10"/>)",
+		R"(<QUaModbusValue BrowseName="Pressure" Type="Float" AddressOffset="20"/>)");
+	auto meterStart = strConfig.indexOf("<QUaModbusRtuSerialClient");
+	auto meterEnd   = strConfig.indexOf("</QUaModbusRtuSerialClient>") + QString("</QUaModbusRtuSerialClient>").length();
+	strConfig.replace(meterStart, meterEnd - meterStart,
+		R"(<QUaModbusTcpClient BrowseName="Plc_3" ServerAddress="1" KeepConnecting="0" NetworkAddress="127.0.0.1" NetworkPort="502"><QUaModbusDataBlockList/></QUaModbusTcpClient>)");
+	auto plc1       = m_source->clients().first();
+	auto plc1Blocks = plc1->dataBlocks()->blocks();
+	QQueue<QUaLog> logs;
+	QObject::connect(m_source, &QUaModbusClientList::logMessage, this, [&logs](const QUaLog &log) {
+		logs << log;
+	});
+	QCOMPARE(m_source->mergeXmlConfig(strConfig), QString("Success."));
+	auto strSummary = QUaLog::toString(logs);
+	QVERIFY2(strSummary.contains("Clients added 1, removed 1, changed 0"), qPrintable(strSummary));
+	QVERIFY2(strSummary.contains("Blocks added 0, removed 1, changed 1"), qPrintable(strSummary));
+	QVERIFY2(strSummary.contains("Values added 1, removed 2, changed 0"), qPrintable(strSummary));
+	// same objects for what did not change
+	QCOMPARE(m_source->clients().first(), plc1);
+	QCOMPARE(plc1->dataBlocks()->blocks(), plc1Blocks);
+	// merged tree equals a fresh load, once deferred removals are done
+	QCOMPARE(m_target->setXmlConfig(strConfig), QString("Success."));
+	QTRY_COMPARE(canonical(m_source), canonical(m_target));
+}
+
+void QUaModbusTestConfig::mergeReconnect()
+{
+	// Plc_1 is moved from one local server to another while connected,
+	// each server has its own value in the first register of the Holding block
+	QModbusTcpServer servers[2];
+	for (int i = 0; i < 2; i++)
+	{
+		QModbusDataUnitMap map;
+		map.insert(QModbusDataUnit::HoldingRegisters, { QModbusDataUnit::HoldingRegisters, 0, 200 });
+		servers[i].setMap(map);
+		servers[i].setServerAddress(3);
+		servers[i].setData(QModbusDataUnit::HoldingRegisters, 100, static_cast<quint16>(i + 1));
+		servers[i].setConnectionParameter(QModbusDevice::NetworkAddressParameter, "127.0.0.1");
+		servers[i].setConnectionParameter(QModbusDevice::NetworkPortParameter, 15021 + i);
+		QVERIFY(servers[i].connectDevice());
+	}
+	auto plc1  = qobject_cast<QUaModbusTcpClient*>(m_source->clients().first());
+	QVERIFY(plc1);
+	auto block = plc1->dataBlocks()->blocks().first();
+	plc1->setNetworkAddress("127.0.0.1");
+	plc1->setNetworkPort(15021);
+	plc1->connectDevice();
+	QTRY_COMPARE(plc1->getState(), QModbusState::ConnectedState);
+	QTRY_COMPARE(block->getData().value(0), static_cast<quint16>(1));
+	QString strConfig = m_source->xmlConfig();
+	strConfig.replace(R"(NetworkPort="15021")", R"(NetworkPort="15022")");
+	QList<QModbusState> states;
+	QObject::connect(plc1, &QUaModbusClient::stateChanged, this, [&states](const QModbusState &state) {
+		states << state;
+	});
+	QCOMPARE(m_source->mergeXmlConfig(strConfig), QString("Success."));
+	// disconnected and connected again, now reading the second server
+	QTRY_VERIFY(states.contains(QModbusState::UnconnectedState));
+	QTRY_COMPARE(plc1->getState(), QModbusState::ConnectedState);
+	QTRY_COMPARE(block->getData().value(0), static_cast<quint16>(2));
+	// attributes not used when connecting do not disconnect
+	states.clear();
+	strConfig.replace(R"(Timeout="750")", R"(Timeout="800")");
+	QCOMPARE(m_source->mergeXmlConfig(strConfig), QString("Success."));
+	QTest::qWait(500);
+	QVERIFY(states.isEmpty());
+	QCOMPARE(plc1->getState(), QModbusState::ConnectedState);
+	plc1->disconnectDevice();
+	QTRY_COMPARE(plc1->getState(), QModbusState::UnconnectedState);
+}
+
+void QUaModbusTestConfig::mergeMissingLists()
+{
+	// Plc_1 without block list and Plc_2 block without value list
+	QString strConfig = testConfig;
+	auto blocksStart = strConfig.indexOf("<QUaModbusDataBlockList>");
+	auto blocksEnd   = strConfig.indexOf("</QUaModbusDataBlockList>") + QString("</QUaModbusDataBlockList>").length();
+	strConfig.remove(blocksStart, blocksEnd - blocksStart);
+	auto valuesStart = strConfig.indexOf("<QUaModbusValueList>");
+	auto valuesEnd   = strConfig.indexOf("</QUaModbusValueList>") + QString("</QUaModbusValueList>").length();
+	strConfig.remove(valuesStart, valuesEnd - valuesStart);
+	QQueue<QUaLog> logs;
+	QObject::connect(m_source, &QUaModbusClientList::logMessage, this, [&logs](const QUaLog &log) {
+		logs << log;
+	});
+	QCOMPARE(m_source->mergeXmlConfig(strConfig), QString("Success."));
+	auto strSummary = QUaLog::toString(logs);
+	QVERIFY2(strSummary.contains("Blocks added 0, removed 2, changed 0"), qPrintable(strSummary));
+	QVERIFY2(strSummary.contains("Values added 0, removed 5, changed 0"), qPrintable(strSummary));
+	auto clients = m_source->clients();
+	QTRY_VERIFY(clients.at(0)->dataBlocks()->blocks().isEmpty());
+	QTRY_VERIFY(clients.at(1)->dataBlocks()->blocks().first()->values()->values().isEmpty());
+}
+
+void QUaModbusTestConfig::backgroundImport()
+{
+	bool finished  = false;
+	bool cancelled = true;
+	QQueue<QUaLog> errorLogs;
+	QObject::connect(m_target, &QUaModbusClientList::importFinished, this,
+	[&](const QQueue<QUaLog> &importLogs, const bool &importCancelled) {
+		finished  = true;
+		cancelled = importCancelled;
+		errorLogs = importLogs;
+	});
+	// nested in an application element, as in application configs
+	auto byteConfig = QString("<App>%1</App>").arg(m_source->xmlConfig().section('\n', 1)).toUtf8();
+	QVERIFY(m_target->startXmlImport(byteConfig));
+	QVERIFY(m_target->isImporting());
+	QVERIFY(!m_target->startXmlImport(byteConfig));
+	QTRY_VERIFY(finished);
+	QVERIFY(!cancelled);
+	QVERIFY2(errorLogs.isEmpty(), qPrintable(QUaLog::toString(errorLogs)));
+	QCOMPARE(m_target->importProgress()->value().toDouble(), 100.0);
+	QCOMPARE(canonical(m_target), canonical(m_source));
+}
+
+void QUaModbusTestConfig::backgroundImportCancel()
+{
+	bool finished  = false;
+	bool cancelled = false;
+	QObject::connect(m_target, &QUaModbusClientList::importFinished, this,
+	[&](const QQueue<QUaLog> &, const bool &importCancelled) {
+		finished  = true;
+		cancelled = importCancelled;
+	});
+	QVERIFY(m_target->startXmlImport(m_source->xmlConfig().toUtf8()));
+	m_target->cancelImport();
+	QTRY_VERIFY(finished);
+	QVERIFY(cancelled);
+	QVERIFY(m_target->clients().isEmpty());
+	QVERIFY(!m_target->isImporting());
+}
+
+void QUaModbusTestConfig::validateConflicts()
+{
+	// Dup reads the same range as Holding, Over overlaps both, Tail does not fit in Holding
+	QString strConfig = testConfig;
+	strConfig.replace(R"(<QUaModbusValue BrowseName="Flag" Type="Binary7" AddressOffset="6"/>)",
+		R"(<QUaModbusValue BrowseName="Flag" Type="Binary7" AddressOffset="6"/><QUaModbusValue BrowseName="Tail" Type="Float" AddressOffset="19"/>)");
+	strConfig.replace(R"(<QUaModbusDataBlock BrowseName="Coils")",
+		R"(<QUaModbusDataBlock BrowseName="Dup" Type="HoldingRegisters" Address="100" Size="20" SamplingTime="250"><QUaModbusValueList/></QUaModbusDataBlock>)"
+		R"(<QUaModbusDataBlock BrowseName="Over" Type="HoldingRegisters" Address="110" Size="20" SamplingTime="250"><QUaModbusValueList/></QUaModbusDataBlock>)"
+		R"(<QUaModbusDataBlock BrowseName="Coils")");
+	auto byteConfig = strConfig.toUtf8();
+	QBuffer buffer(&byteConfig);
+	QVERIFY(buffer.open(QIODevice::ReadOnly));
+	auto errorLogs = m_target->readXmlConfig(&buffer);
+	QCOMPARE(errorLogs.count(), 4);
+	auto strLogs = QUaLog::toString(errorLogs);
+	QCOMPARE(strLogs.count("read the same HoldingRegisters range [100, 120)"), 1);
+	QCOMPARE(strLogs.count("overlap on HoldingRegisters range [110, 120)"), 2);
+	QCOMPARE(strLogs.count("Value Tail of block Holding of client Plc_1 uses registers [19, 21) but block size is 20"), 1);
+	// already checked, edits made by the import are not logged again
+	QQueue<QUaLog> logs;
+	QObject::connect(m_target, &QUaModbusClientList::logMessage, this, [&logs](const QUaLog &log) {
+		logs << log;
+	});
+	QTest::qWait(500);
+	QVERIFY(logs.isEmpty());
+	// contiguous blocks of a type are merged
+	auto coverage = QUaModbusConfigValidator::coverage(m_target->clients().first());
+	QCOMPARE(coverage.count(), 2);
+	auto holding = coverage.value(QModbusDataBlockType::HoldingRegisters);
+	QCOMPARE(holding.count(), 1);
+	QCOMPARE(holding.first().start, 100);
+	QCOMPARE(holding.first().end  , 130);
+	QCOMPARE(holding.first().blocks.count(), 3);
+	auto coils = coverage.value(QModbusDataBlockType::Coils);
+	QCOMPARE(coils.count(), 1);
+	QCOMPARE(coils.first().start, 0);
+	QCOMPARE(coils.first().end  , 16);
+}
+
+void QUaModbusTestConfig::validateOnEdit()
+{
+	QQueue<QUaLog> logs;
+	QObject::connect(m_source, &QUaModbusClientList::logMessage, this, [&logs](const QUaLog &log) {
+		logs << log;
+	});
+	auto blocks = m_source->clients().at(1)->dataBlocks();
+	QCOMPARE(blocks->addDataBlock("Shadow"), QString("Success"));
+	auto shadow = blocks->browseChild<QUaModbusDataBlock>("Shadow");
+	shadow->setType(QModbusDataBlockType::InputRegisters);
+	shadow->setAddress(100);
+	shadow->setSize(50);
+	// a burst of edits is checked once
+	QTRY_COMPARE(logs.count(), 1);
+	QVERIFY2(QUaLog::toString(logs).contains("Blocks Input and Shadow of client Plc_2 overlap on InputRegisters range [100, 125)"),
+		qPrintable(QUaLog::toString(logs)));
+	logs.clear();
+	shadow->setType(QModbusDataBlockType::HoldingRegisters);
+	auto temperature = blocks->browseChild<QUaModbusDataBlock>("Input")->values()->browseChild<QUaModbusValue>("Temperature");
+	temperature->setType(QModbusValueType::Float);
+	QTRY_COMPARE(logs.count(), 1);
+	QVERIFY2(QUaLog::toString(logs).contains("Value Temperature of block Input of client Plc_2 uses registers [124, 126) but block size is 125"),
+		qPrintable(QUaLog::toString(logs)));
+}
+
+void QUaModbusTestConfig::warmStart()
+{
+	QTemporaryDir dir;
+	QVERIFY(dir.isValid());
+	auto strFileName = dir.filePath("config.xml.values");
+	auto timestamp   = QDateTime(QDate(2020, 1, 1), QTime(12, 0), Qt::UTC);
+	// NOTE : appended in the worker threads, only read once the caches are gone
+	QQueue<QUaLog> writeLogs;
+	{
+		// Count has another type in the config, Gone is not in the config
+		QUaModbusValueCache cache(strFileName);
+		QUaModbusValueCache::Entries entries;
+		entries.insert("Plc_1.Holding.Speed", { static_cast<qint32>(QModbusValueType::Float), 12.5f, timestamp });
+		entries.insert("Plc_1.Holding.Count", { static_cast<qint32>(QModbusValueType::Int  ), 7    , timestamp });
+		entries.insert("Plc_1.Holding.Gone" , { static_cast<qint32>(QModbusValueType::Float), 1.0f , timestamp });
+		QUaModbusValueCache::Types live;
+		for (auto it = entries.begin(); it != entries.end(); ++it)
+		{
+			live.insert(it.key(), it.value().type);
+		}
+		auto onError = [&writeLogs](const QUaLog &log) {
+			writeLogs << log;
+		};
+		cache.write(entries, live, onError);
+		// entries of values no longer live are pruned
+		live.remove("Plc_1.Holding.Gone");
+		cache.write(QUaModbusValueCache::Entries(), live, onError);
+		// failures are reported
+		QUaModbusValueCache cacheMissing(dir.filePath("missing/config.xml.values"));
+		cacheMissing.write(entries, live, onError);
+	}
+	QCOMPARE(writeLogs.count(), 1);
+	{
+		QUaModbusValueCache cache(strFileName);
+		QUaModbusValueCache::Entries entries;
+		QQueue<QUaLog> readLogs;
+		QVERIFY(cache.read(entries, readLogs));
+		QCOMPARE(entries.count(), 2);
+		QVERIFY(!entries.contains("Plc_1.Holding.Gone"));
+	}
+	auto errorLogs = m_source->setValueCacheFile(strFileName);
+	QVERIFY2(errorLogs.isEmpty(), qPrintable(QUaLog::toString(errorLogs)));
+	QCOMPARE(m_source->valueCacheFile(), strFileName);
+	auto values = m_source->clients().first()->dataBlocks()->browseChild<QUaModbusDataBlock>("Holding")->values();
+	auto speed  = values->browseChild<QUaModbusValue>("Speed");
+	QCOMPARE(speed->getValue().toFloat(), 12.5f);
+	QCOMPARE(speed->value()->sourceTimestamp(), timestamp);
+	QVERIFY(values->browseChild<QUaModbusValue>("Count")->getValue() != QVariant(7));
+	m_source->setValueCacheFile(QString());
+	QVERIFY(m_source->valueCacheFile().isEmpty());
+	// corrupted cache is a cold start
+	QFile file(strFileName);
+	QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+	file.write("garbage");
+	file.close();
+	QCOMPARE(m_target->setValueCacheFile(strFileName).count(), 1);
+}
+
+void QUaModbusTestConfig::hostCache()
+{
+	auto cache = QUaModbusHostCache::instance();
+	// literal addresses are not resolved
+	QHostAddress literal;
+	cache->lookup("192.168.1.10", this, [&literal](const QHostAddress &address) {
+		literal = address;
+	});
+	QCOMPARE(literal, QHostAddress("192.168.1.10"));
+	// concurrent lookups of a host share one
+	int calls = 0;
+	QHostAddress resolved;
+	auto callback = [&calls, &resolved](const QHostAddress &address) {
+		calls++;
+		resolved = address;
+	};
+	cache->lookup("localhost", this, callback);
+	cache->lookup("LocalHost", this, callback);
+	QTRY_COMPARE(calls, 2);
+	QVERIFY(resolved.isLoopback());
+	// cached, calls back before returning
+	cache->lookup("localhost", this, callback);
+	QCOMPARE(calls, 3);
+	cache->clear();
+}
+
+void QUaModbusTestConfig::hostLookupDisconnect()
+{
+	// disconnected while the host name is resolved, the lookup result does not connect
+	QUaModbusHostCache::instance()->clear();
+	auto plc2 = qobject_cast<QUaModbusTcpClient*>(m_source->clients().at(1));
+	QVERIFY(plc2);
+	plc2->setNetworkAddress("localhost");
+	QList<QModbusState> states;
+	QObject::connect(plc2, &QUaModbusClient::stateChanged, this, [&states](const QModbusState &state) {
+		states << state;
+	});
+	plc2->startConnect();
+	plc2->disconnectDevice();
+	// joins the running lookup, called back after the client one
+	int calls = 0;
+	QUaModbusHostCache::instance()->lookup("localhost", this, [&calls](const QHostAddress &) {
+		calls++;
+	});
+	QTRY_COMPARE(calls, 1);
+	QTest::qWait(500);
+	QVERIFY(states.isEmpty());
+	QCOMPARE(plc2->getState(), QModbusState::UnconnectedState);
+	QUaModbusHostCache::instance()->clear();
+}
+
+void QUaModbusTestConfig::replyTimestamps()
+{
+	// every value of Plc_1 Holding changes with the first read
+	QModbusTcpServer server;
+	QModbusDataUnitMap map;
+	map.insert(QModbusDataUnit::HoldingRegisters, { QModbusDataUnit::HoldingRegisters, 0, 200 });
+	server.setMap(map);
+	server.setServerAddress(3);
+	server.setData(QModbusDataUnit::HoldingRegisters, 101, 0x4000); // Speed
+	server.setData(QModbusDataUnit::HoldingRegisters, 105, 0x0001); // Count
+	server.setData(QModbusDataUnit::HoldingRegisters, 106, 0x0080); // Flag
+	server.setConnectionParameter(QModbusDevice::NetworkAddressParameter, "127.0.0.1");
+	server.setConnectionParameter(QModbusDevice::NetworkPortParameter, 15023);
+	QVERIFY(server.connectDevice());
+	auto plc1  = qobject_cast<QUaModbusTcpClient*>(m_source->clients().first());
+	QVERIFY(plc1);
+	auto block = plc1->dataBlocks()->blocks().first();
+	plc1->setNetworkAddress("127.0.0.1");
+	plc1->setNetworkPort(15023);
+	// source timestamps as they are when each node changes
+	QList<QDateTime> dataStamps;
+	QList<QDateTime> latencyStamps;
+	QObject::connect(block, &QUaModbusDataBlock::dataChanged, this, [block, &dataStamps, &latencyStamps]() {
+		dataStamps    << block->data   ()->sourceTimestamp();
+		latencyStamps << block->latency()->sourceTimestamp();
+	});
+	QMap<QString, QPair<QDateTime, QDateTime>> valueStamps;
+	for (auto value : block->values()->values())
+	{
+		QObject::connect(value, &QUaModbusValue::valueChanged, this, [block, value, &valueStamps]() {
+			valueStamps[value->browseName().name()] = qMakePair(value->value()->sourceTimestamp(), block->data()->sourceTimestamp());
+		});
+	}
+	auto before = QDateTime::currentDateTimeUtc();
+	plc1->connectDevice();
+	QTRY_COMPARE(valueStamps.count(), 3);
+	auto after = QDateTime::currentDateTimeUtc();
+	// reply stamp is the source timestamp of Data, of Latency and of the values decoded from it
+	QVERIFY(!dataStamps.isEmpty());
+	QVERIFY(dataStamps.first() >= before && dataStamps.first() <= after);
+	QCOMPARE(latencyStamps.first(), dataStamps.first());
+	for (auto it = valueStamps.begin(); it != valueStamps.end(); ++it)
+	{
+		QVERIFY2(it.value().first == it.value().second, qPrintable(it.key()));
+	}
+	QVERIFY(block->getLatency() > 0.0);
+	// Latency is updated with every reply
+	auto latencyStamp = block->latency()->sourceTimestamp();
+	QTRY_VERIFY(block->latency()->sourceTimestamp() > latencyStamp);
+	QVERIFY(block->getLatency() > 0.0);
+	plc1->disconnectDevice();
+	QTRY_COMPARE(plc1->getState(), QModbusState::UnconnectedState);
+}
+
+void QUaModbusTestConfig::errorStatusCodes()
+{
+	auto blocks = m_source->clients().first()->dataBlocks();
+	auto block  = blocks->browseChild<QUaModbusDataBlock>("Holding");
+	auto speed  = block->values()->browseChild<QUaModbusValue>("Speed");
+	QVERIFY(block->lastError());
+	QVERIFY(speed->lastError());
+	// errors become the status code, LastError nodes are removed
+	m_source->setErrorStatusCodes(true);
+	QVERIFY(!block->lastError());
+	QVERIFY(!speed->lastError());
+	QCOMPARE(block->getLastError(), QModbusError::ConnectionError);
+	QVERIFY(block->data  ()->statusCode() == QUaModbusDataBlock::errorToStatus(QModbusError::ConnectionError));
+	QVERIFY(speed->value()->statusCode() == QUaModbusDataBlock::errorToStatus(speed->getLastError()));
+	// blocks and values added later follow the list
+	QCOMPARE(blocks->addDataBlocks("Extra"), QString("Success"));
+	auto extra = blocks->browseChild<QUaModbusDataBlock>("Extra");
+	QVERIFY(!extra->lastError());
+	QCOMPARE(extra->values()->addValue("Single"), QString("Success"));
+	QVERIFY(!extra->values()->browseChild<QUaModbusValue>("Single")->lastError());
+	// survives the config round trips
+	auto errorLogs = m_target->setBinaryConfig(m_source->binaryConfig());
+	QVERIFY2(errorLogs.isEmpty(), qPrintable(QUaLog::toString(errorLogs)));
+	QVERIFY(m_target->getErrorStatusCodes());
+	QCOMPARE(canonical(m_target), canonical(m_source));
+	// and back, LastError nodes are added again with the current error
+	m_source->setErrorStatusCodes(false);
+	QVERIFY(block->lastError());
+	QCOMPARE(block->lastError()->value().value<QModbusError>(), QModbusError::ConnectionError);
+	QVERIFY(speed->lastError());
+	QVERIFY(block->data()->statusCode() == QUaStatusCode(QUaStatus::Good));
+	QCOMPARE(blocks->addDataBlock("Extra2"), QString("Success"));
+	QVERIFY(blocks->browseChild<QUaModbusDataBlock>("Extra2")->lastError());
+}
+
+void QUaModbusTestConfig::compactValues()
+{
+	auto block = m_source->clients().first()->dataBlocks()->browseChild<QUaModbusDataBlock>("Holding");
+	auto speed = block->values()->browseChild<QUaModbusValue>("Speed");
+	QVERIFY(speed->type());
+	// only Value is left, the configuration stays in C++
+	m_source->setCompactValues(true);
+	QVERIFY(!speed->type());
+	QVERIFY(!speed->registersUsed());
+	QVERIFY(!speed->addressOffset());
+	QVERIFY(!speed->lastError());
+	QVERIFY(speed->value());
+	QCOMPARE(speed->getType(), QModbusValueType::Float);
+	QCOMPARE(speed->getRegistersUsed(), quint16(2));
+	QCOMPARE(speed->getAddressOffset(), 0);
+#ifndef QUAMODBUS_NOCYCLIC_WRITE
+	QVERIFY(!speed->cyclicWritePeriod());
+	QCOMPARE(speed->getCyclicWriteMode(), QModbusCyclicWriteMode::Toggle);
+	QCOMPARE(speed->getCyclicWritePeriod(), quint32(5000));
+#endif // !QUAMODBUS_NOCYCLIC_WRITE
+	QVERIFY(speed->value()->statusCode() == QUaModbusDataBlock::errorToStatus(speed->getLastError()));
+	// edited through its xml config, attributes not given are kept
+	QCOMPARE(speed->setXmlConfig("<QUaModbusValue Type=\"Int\" AddressOffset=\"8\"/>"), QString("Success."));
+	QCOMPARE(speed->getType(), QModbusValueType::Int);
+	QCOMPARE(speed->getAddressOffset(), 8);
+#ifndef QUAMODBUS_NOCYCLIC_WRITE
+	QCOMPARE(speed->getCyclicWritePeriod(), quint32(5000));
+#endif // !QUAMODBUS_NOCYCLIC_WRITE
+	QVERIFY(speed->setXmlConfig("<QUaModbusDataBlock/>").contains("Error"));
+	QVERIFY(speed->setXmlConfig("<QUaModbusValue").contains("Error"));
+	QVERIFY(speed->xmlConfig().contains("Type=\"Int\""));
+	// values added later follow the list
+	QCOMPARE(block->values()->addValue("Extra"), QString("Success"));
+	auto extra = block->values()->browseChild<QUaModbusValue>("Extra");
+	QVERIFY(!extra->type());
+	QCOMPARE(extra->browseChildren<QUaNode>().count(), 1);
+	// same value again is a no-op
+	QSignalSpy spyCompact(m_source, &QUaModbusClientList::compactValuesChanged);
+	m_source->setCompactValues(true);
+	QCOMPARE(spyCompact.count(), 0);
+	// survives the config round trips
+	auto errorLogs = m_target->setBinaryConfig(m_source->binaryConfig());
+	QVERIFY2(errorLogs.isEmpty(), qPrintable(QUaLog::toString(errorLogs)));
+	QVERIFY(m_target->getCompactValues());
+	QCOMPARE(canonical(m_target), canonical(m_source));
+	auto target = m_target->clients().first()->dataBlocks()->browseChild<QUaModbusDataBlock>("Holding");
+	QVERIFY(!target->values()->browseChild<QUaModbusValue>("Speed")->type());
+	// and back, properties are added again with the current configuration
+	m_source->setCompactValues(false);
+	QVERIFY(speed->type());
+	QCOMPARE(speed->type()->value().value<QModbusValueType>(), QModbusValueType::Int);
+	QCOMPARE(speed->registersUsed()->value().value<quint16>(), quint16(2));
+	QCOMPARE(speed->addressOffset()->value().toInt(), 8);
+	QVERIFY(speed->lastError());
+	QCOMPARE(spyCompact.count(), 1);
+	QCOMPARE(block->values()->addValue("Extra2"), QString("Success"));
+	auto extra2 = block->values()->browseChild<QUaModbusValue>("Extra2");
+	QVERIFY(extra2->type());
+	QVERIFY(extra2->addressOffset());
+	QVERIFY(extra2->lastError());
+}
+
+#ifdef UA_ENABLE_HISTORIZING
+void QUaModbusTestConfig::historian()
+{
+	QUaModbusHistorian historian;
+	QQueue<QUaLog> logs;
+	auto start = QDateTime(QDate(2020, 1, 1), QTime(12, 0), Qt::UTC);
+	auto end   = start.addDays(1);
+	auto write = [&historian, &logs](const QUaNodeId &nodeId, const QDateTime &timestamp, const QVariant &value, const quint32 &status) {
+		QUaHistoryDataPoint point;
+		point.timestamp = timestamp;
+		point.value     = value;
+		point.status    = status;
+		QVERIFY(historian.writeHistoryData(nodeId, point, logs));
+	};
+	// a ramp is a straight line, only its ends are kept
+	QUaNodeId ramp = { 0, "test.ramp" };
+	for (int i = 0; i < 1000; i++)
+	{
+		write(ramp, start.addMSecs(i * 100), 2.5 * i, 0);
+	}
+	QCOMPARE(historian.numDataPointsInRange(ramp, start, end, logs), Q_UINT64_C(2));
+	QCOMPARE(historian.findTimestamp(ramp, start.addMSecs(50), QUaHistoryBackend::TimeMatch::ClosestFromAbove, logs), start.addMSecs(99900));
+	QCOMPARE(historian.findTimestamp(ramp, start.addMSecs(50), QUaHistoryBackend::TimeMatch::ClosestFromBelow, logs), start);
+	// with a deviation, noise within it is dropped too
+	QUaNodeId noisy = { 0, "test.noisy" };
+	historian.setDeviation(noisy, 0.5);
+	for (int i = 0; i < 1000; i++)
+	{
+		write(noisy, start.addMSecs(i * 100), 10.0 + (i % 3) * 0.2, 0);
+	}
+	QCOMPARE(historian.numDataPointsInRange(noisy, start, end, logs), Q_UINT64_C(2));
+	// without a deviation, every point that is not on a line is kept exactly, across chunks
+	QUaNodeId exact = { 0, "test.exact" };
+	QVector<QUaHistoryDataPoint> written;
+	quint32 seed = 12345;
+	qint64  time = start.toMSecsSinceEpoch();
+	for (int i = 0; i < 1000; i++)
+	{
+		seed  = seed * 1103515245 + 12345;
+		time += 90 + (seed >> 16) % 20;
+		QUaHistoryDataPoint point;
+		point.timestamp = QDateTime::fromMSecsSinceEpoch(time, Qt::UTC);
+		point.value     = static_cast<double>(seed) / 7.0;
+		point.status    = i % 100 == 50 ? 0x80000000 : 0;
+		written << point;
+		write(exact, point.timestamp, point.value, point.status);
+	}
+	auto read = historian.readHistoryData(exact, start, written.count(), logs);
+	QCOMPARE(read.count(), written.count());
+	for (int i = 0; i < written.count(); i++)
+	{
+		QCOMPARE(read.at(i).timestamp, written.at(i).timestamp);
+		QCOMPARE(read.at(i).value    , written.at(i).value    );
+		QCOMPARE(read.at(i).status   , written.at(i).status   );
+	}
+	QCOMPARE(historian.readHistoryData(exact, written.at(10).timestamp, 5, logs).first().timestamp, written.at(10).timestamp);
+	QVERIFY(historian.hasTimestamp(exact, written.at(500).timestamp, logs));
+	QVERIFY(!historian.hasTimestamp(exact, written.at(500).timestamp.addMSecs(1), logs));
+	// block data only when it changes, late points are dropped
+	QUaNodeId data = { 0, "test.data" };
+	for (int i = 0; i < 20; i++)
+	{
+		write(data, start.addSecs(i), QVariant::fromValue(QVector<quint16>({ 1, 2, static_cast<quint16>(i < 10 ? 3 : 4) })), 0);
+	}
+	write(data, start, QVariant::fromValue(QVector<quint16>({ 5, 6, 7 })), 0);
+	QCOMPARE(historian.numDataPointsInRange(data, start, end, logs), Q_UINT64_C(3));
+	QCOMPARE(historian.readHistoryData(data, start.addSecs(10), 1, logs).first().value.toList().last().toUInt(), 4u);
+	QVERIFY(logs.isEmpty());
+	// memory limit drops the oldest chunks first
+	auto used = historian.memoryUsed();
+	QVERIFY(used > 0);
+	historian.setMemoryLimit(used / 2);
+	QVERIFY(historian.memoryUsed() <= used / 2);
+	QVERIFY(historian.firstTimestamp(exact, logs) > written.first().timestamp);
+	QCOMPARE(historian.lastTimestamp(exact, logs), written.last().timestamp);
+	historian.remove(exact);
+	QCOMPARE(historian.numDataPointsInRange(exact, start, end, logs), Q_UINT64_C(0));
+	// settings survive the config round trips
+	auto value = m_source->clients().first()->dataBlocks()->browseChild<QUaModbusDataBlock>("Holding")->values()->browseChild<QUaModbusValue>("Speed");
+	value->setHistorizing(true);
+	value->setHistoryDeviation(0.25);
+	QVERIFY(value->value()->historizing());
+	auto errorLogs = m_target->setBinaryConfig(m_source->binaryConfig());
+	QVERIFY2(errorLogs.isEmpty(), qPrintable(QUaLog::toString(errorLogs)));
+	QCOMPARE(canonical(m_target), canonical(m_source));
+}
+
+void QUaModbusTestConfig::historyStore()
+{
+	QTemporaryDir dir;
+	QVERIFY(dir.isValid());
+	QQueue<QUaLog> logs;
+	auto start = QDateTime(QDate(2020, 1, 1), QTime(12, 0), Qt::UTC);
+	auto end   = start.addDays(1);
+	// small segments so retention has something to delete,
+	// NOTE : restored on scope exit, also when a failed check returns early
+	struct Restore
+	{
+		qint64 segmentSize;
+		int    syncPeriod;
+		~Restore()
+		{
+			QUaModbusHistoryStore::m_segmentSize = segmentSize;
+			QUaModbusHistoryStore::m_syncPeriod  = syncPeriod;
+		}
+	} restore = { QUaModbusHistoryStore::m_segmentSize, QUaModbusHistoryStore::m_syncPeriod };
+	Q_UNUSED(restore)
+	QUaModbusHistoryStore::m_segmentSize = 4096;
+	QUaModbusHistoryStore::m_syncPeriod  = 10;
+	QUaNodeId speed = { 0, "modbus.Plc_1.Holding.Speed" };
+	QVector<QUaHistoryDataPoint> written;
+	auto compare = [&written](const QVector<QUaHistoryDataPoint> &read) {
+		QCOMPARE(read.count(), written.count());
+		for (int i = 0; i < written.count(); i++)
+		{
+			QCOMPARE(read.at(i).timestamp, written.at(i).timestamp);
+			QCOMPARE(read.at(i).value    , written.at(i).value    );
+			QCOMPARE(read.at(i).status   , written.at(i).status   );
+		}
+	};
+	// chunks dropped from memory are read from disk
+	{
+		QUaModbusHistoryStore store(dir.path());
+		QVERIFY(store.open(logs));
+		QUaModbusHistorian historian;
+		historian.setStore(&store);
+		historian.setMemoryLimit(1);
+		quint32 seed = 12345;
+		qint64  time = start.toMSecsSinceEpoch();
+		for (int i = 0; i < 4000; i++)
+		{
+			seed  = seed * 1103515245 + 12345;
+			time += 90 + (seed >> 16) % 20;
+			QUaHistoryDataPoint point;
+			point.timestamp = QDateTime::fromMSecsSinceEpoch(time, Qt::UTC);
+			point.value     = static_cast<double>(seed) / 7.0;
+			point.status    = 0;
+			written << point;
+			QVERIFY(historian.writeHistoryData(speed, point, logs));
+		}
+		compare(historian.readHistoryData(speed, start, written.count(), logs));
+	}
+	// last chunks were written down on close, all is read back after a restart
+	{
+		QUaModbusHistoryStore store(dir.path());
+		QVERIFY(store.open(logs));
+		QUaModbusHistorian historian;
+		historian.setStore(&store);
+		compare(historian.readHistoryData(speed, start, written.count(), logs));
+		QCOMPARE(historian.numDataPointsInRange(speed, start, end, logs), static_cast<quint64>(written.count()));
+		QCOMPARE(historian.firstTimestamp(speed, logs), written.first().timestamp);
+		QCOMPARE(historian.lastTimestamp (speed, logs), written.last ().timestamp);
+		auto between = written.at(700).timestamp.addMSecs(1);
+		QCOMPARE(historian.findTimestamp(speed, between, QUaHistoryBackend::TimeMatch::ClosestFromBelow, logs), written.at(700).timestamp);
+		QCOMPARE(historian.findTimestamp(speed, between, QUaHistoryBackend::TimeMatch::ClosestFromAbove, logs), written.at(701).timestamp);
+	}
+	QVERIFY2(logs.isEmpty(), qPrintable(QUaLog::toString(logs)));
+	// a segment left unsealed is recovered up to its last complete chunk
+	QDir dirClient(QDir(dir.path()).filePath("Plc_1"));
+	auto listFiles = dirClient.entryList({ "*.qums" }, QDir::Files, QDir::Name);
+	QVERIFY(listFiles.count() > 2);
+	QFile file(dirClient.filePath(listFiles.last()));
+	QVERIFY(file.resize(file.size() - 4));
+	{
+		QUaModbusHistoryStore store(dir.path());
+		QVERIFY(store.open(logs));
+		QCOMPARE(logs.count(), 1);
+		QCOMPARE(logs.first().level, QUaLogLevel::Warning);
+		logs.clear();
+		QUaModbusHistorian historian;
+		historian.setStore(&store);
+		compare(historian.readHistoryData(speed, start, written.count(), logs));
+		// oldest segments are deleted beyond the retention size
+		store.setRetentionSize(2 * 4096);
+		QTRY_VERIFY(store.sizeUsed() <= 2 * 4096);
+		QVERIFY(historian.firstTimestamp(speed, logs) > written.first().timestamp);
+		QCOMPARE(historian.lastTimestamp(speed, logs), written.last().timestamp);
+	}
+	QVERIFY(dirClient.entryList({ "*.qums" }, QDir::Files).count() < listFiles.count());
+}
+#endif // UA_ENABLE_HISTORIZING
+
+QString QUaModbusTestConfig::canonical(const QDomElement & domElem, const int & depth)
+{
+	QMap<QString, QString> attrs;
+	auto domAttrs = domElem.attributes();
+	for (int i = 0; i < domAttrs.count(); i++)
+	{
+		auto attr = domAttrs.item(i).toAttr();
+		attrs.insert(attr.name(), attr.value());
+	}
+	QString strCanonical = QString(depth, ' ') + domElem.tagName();
+	for (auto it = attrs.begin(); it != attrs.end(); ++it)
+	{
+		strCanonical += QString(" %1=\"%2\"").arg(it.key()).arg(it.value());
+	}
+	strCanonical += "\n";
+	for (auto elemChild = domElem.firstChildElement(); !elemChild.isNull(); elemChild = elemChild.nextSiblingElement())
+	{
+		strCanonical += canonical(elemChild, depth + 1);
+	}
+	return strCanonical;
+}
+
+QString QUaModbusTestConfig::canonical(QUaModbusClientList * list)
+{
+	QDomDocument doc;
+	return canonical(list->toDomElement(doc));
+}
@@ -0,0 +1,67 @@
+#ifndef QUAMODBUSTESTCONFIG_H
+#define QUAMODBUSTESTCONFIG_H
+
+#include <QObject>
+#include <QScopedPointer>
+#include <QDomElement>
+
+class QUaServer;
+class QUaModbusClientList;
+
+// Round trip checks of the config import / export paths against toDomElement
+class QUaModbusTestConfig : public QObject
+{
+	Q_OBJECT
+
+public:
+	explicit QUaModbusTestConfig(QObject *parent = nullptr);
+	~QUaModbusTestConfig();
+
+private slots:
+	void init();
+	void cleanup();
+
+	void xmlRoundTrip();
+	void binaryRoundTrip();
+	void binaryMappedFile();
+	void binaryCorrupted();
+	void binaryTruncated();
+	void binaryVersion();
+	void binaryInvalidEnum();
+	void bulkAdd();
+	void bulkAddInvalid();
+	void csvReader();
+	void csvRoundTrip();
+	void xmlMalformed();
+	void mergeUnchanged();
+	void mergeChanges();
+	void mergeReconnect();
+	void mergeMissingLists();
+	void backgroundImport();
+	void backgroundImportCancel();
+	void validateConflicts();
+	void validateOnEdit();
+	void warmStart();
+	void hostCache();
+	void hostLookupDisconnect();
+	void replyTimestamps();
+	void errorStatusCodes();
+	void compactValues();
+#ifdef UA_ENABLE_HISTORIZING
+	void historian();
+	void historyStore();
+#endif // UA_ENABLE_HISTORIZING
+
+private:
+	// NOTE : one server per list, client node ids are fixed by name
+	QScopedPointer<QUaServer> m_serverSource;
+	QScopedPointer<QUaServer> m_serverTarget;
+	QUaModbusClientList     * m_source;
+	QUaModbusClientList     * m_target;
+
+	// order independent text of an element tree, attributes sorted by name
+	static QString canonical(const QDomElement &domElem, const int &depth = 0);
+	static QString canonical(QUaModbusClientList * list);
+};
+
+#endif // QUAMODBUSTESTCONFIG_H